@@ -0,0 +1,522 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This program runs a set of standard benchmarks.  Every system is constructed programmatically,
+ * so no input files are needed and the results are reproducible.  For each benchmark it measures
+ * the overall simulation speed, the time per step spent in each Force (using Context profiling),
+ * the time to evaluate each force group on its own, and the time to apply constraints.  The overall
+ * speed is measured with profiling disabled, since profiling changes how forces are computed.  The
+ * per-Force breakdown comes from a second, profiled run of the same length.  Results are written as
+ * JSON, one object per line.
+ *
+ * Usage: OpenMMBenchmark [options]
+ *
+ *   --platform=NAME       the Platform to use (default: CPU if it is available, otherwise Reference)
+ *   --plugins=DIR         the directory to load plugins from (default: the default plugins directory)
+ *   --property=KEY=VALUE  a Platform property to set.  This may be given multiple times.
+ *   --benchmark=NAMES     a comma separated list of benchmarks to run (default: all of them)
+ *   --steps=N             the number of time steps to run for each benchmark (default: 100)
+ *   --scale=X             a factor to multiply the size of every system by (default: 1)
+ *   --output=FILE         the file to write results to (default: standard output)
+ *   --list                list the available benchmarks and exit
+ */
+
+#ifdef WIN32
+  #define _USE_MATH_DEFINES // Needed to get M_PI
+#endif
+#include "OpenMM.h"
+#include "sfmt/SFMT.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * A System to benchmark, along with everything needed to simulate it.
+ */
+struct BenchmarkSystem {
+    unique_ptr<System> system;
+    unique_ptr<Integrator> integrator;
+    unique_ptr<ReactionCoordinate> reactionCoordinate;
+    vector<Vec3> positions;
+    map<int, string> groupNames;
+    function<void (Integrator&, const vector<Vec3>&)> prepareIntegrator;
+};
+
+struct Benchmark {
+    string name, description;
+    function<void (BenchmarkSystem&, double)> create;
+};
+
+static double getTime() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Parameters for rigid TIP3P water.
+
+static const double OH_DISTANCE = 0.09572;
+static const double HOH_ANGLE = 104.52*M_PI/180;
+static const double WATER_SPACING = 0.3107;
+
+/**
+ * Choose the number of grid points along each side of a cubic box so it holds about the requested number
+ * of items, but is always large enough for the given cutoff.
+ */
+static int getGridSize(double numItems, double spacing, double cutoff) {
+    int size = (int) ceil(cbrt(numItems));
+    int minSize = (int) ceil((2*cutoff+0.2)/spacing);
+    return max(size, minSize);
+}
+
+static void createArgon(BenchmarkSystem& bench, double scale, bool custom) {
+    const double sigma = 0.3405, epsilon = 0.996, cutoff = 1.0;
+    const double spacing = cbrt(1.0/21.0);
+    int gridSize = getGridSize(4000*scale, spacing, cutoff);
+    double boxSize = gridSize*spacing;
+    System* system = new System();
+    bench.system.reset(system);
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = NULL;
+    CustomNonbondedForce* customNonbonded = NULL;
+    if (custom) {
+        customNonbonded = new CustomNonbondedForce("4*eps*((sigma/r)^12-(sigma/r)^6); sigma=0.5*(sigma1+sigma2); eps=sqrt(eps1*eps2)");
+        customNonbonded->addPerParticleParameter("sigma");
+        customNonbonded->addPerParticleParameter("eps");
+        customNonbonded->setNonbondedMethod(CustomNonbondedForce::CutoffPeriodic);
+        customNonbonded->setCutoffDistance(cutoff);
+        customNonbonded->setUseLongRangeCorrection(true);
+        system->addForce(customNonbonded);
+        bench.groupNames[0] = "custom nonbonded";
+    }
+    else {
+        nonbonded = new NonbondedForce();
+        nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+        nonbonded->setCutoffDistance(cutoff);
+        system->addForce(nonbonded);
+        bench.groupNames[0] = "nonbonded";
+    }
+    for (int i = 0; i < gridSize; i++)
+        for (int j = 0; j < gridSize; j++)
+            for (int k = 0; k < gridSize; k++) {
+                system->addParticle(39.95);
+                if (custom)
+                    customNonbonded->addParticle({sigma, epsilon});
+                else
+                    nonbonded->addParticle(0.0, sigma, epsilon);
+                bench.positions.push_back(Vec3(i, j, k)*spacing);
+            }
+}
+
+static void createWater(BenchmarkSystem& bench, double numMolecules) {
+    const double cutoff = 0.9;
+    int gridSize = getGridSize(numMolecules, WATER_SPACING, cutoff);
+    double boxSize = gridSize*WATER_SPACING;
+    System* system = new System();
+    bench.system.reset(system);
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(cutoff);
+    nonbonded->setEwaldErrorTolerance(5e-4);
+    nonbonded->setReciprocalSpaceForceGroup(1);
+    system->addForce(nonbonded);
+    bench.groupNames[0] = "direct space";
+    bench.groupNames[1] = "reciprocal space";
+    double hhDistance = 2*OH_DISTANCE*sin(0.5*HOH_ANGLE);
+    for (int i = 0; i < gridSize; i++)
+        for (int j = 0; j < gridSize; j++)
+            for (int k = 0; k < gridSize; k++) {
+                int first = system->getNumParticles();
+                system->addParticle(15.999);
+                system->addParticle(1.008);
+                system->addParticle(1.008);
+                nonbonded->addParticle(-0.834, 0.315061, 0.636386);
+                nonbonded->addParticle(0.417, 1.0, 0.0);
+                nonbonded->addParticle(0.417, 1.0, 0.0);
+                system->addConstraint(first, first+1, OH_DISTANCE);
+                system->addConstraint(first, first+2, OH_DISTANCE);
+                system->addConstraint(first+1, first+2, hhDistance);
+                for (int m = 0; m < 3; m++)
+                    for (int n = m+1; n < 3; n++)
+                        nonbonded->addException(first+m, first+n, 0.0, 1.0, 0.0);
+
+                // Alternate the orientation of neighboring molecules so the box has no net dipole.
+
+                Vec3 oxygen = Vec3(i, j, k)*WATER_SPACING;
+                double sign = ((i+j+k)%2 == 0 ? 1.0 : -1.0);
+                bench.positions.push_back(oxygen);
+                bench.positions.push_back(oxygen+Vec3(sign*OH_DISTANCE, 0, 0));
+                bench.positions.push_back(oxygen+Vec3(sign*OH_DISTANCE*cos(HOH_ANGLE), OH_DISTANCE*sin(HOH_ANGLE), 0));
+            }
+}
+
+static void createGBProtein(BenchmarkSystem& bench, double scale) {
+    // Build a compact random chain of particles with bonded interactions, charges, and implicit solvent.
+
+    const double cutoff = 2.0, bondLength = 0.15;
+    int numParticles = max(100, (int) (2000*scale));
+    System* system = new System();
+    bench.system.reset(system);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffNonPeriodic);
+    nonbonded->setCutoffDistance(cutoff);
+    system->addForce(nonbonded);
+    GBSAOBCForce* gb = new GBSAOBCForce();
+    gb->setNonbondedMethod(GBSAOBCForce::CutoffNonPeriodic);
+    gb->setCutoffDistance(cutoff);
+    gb->setForceGroup(1);
+    system->addForce(gb);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    PeriodicTorsionForce* torsions = new PeriodicTorsionForce();
+    bonds->setForceGroup(2);
+    angles->setForceGroup(2);
+    torsions->setForceGroup(2);
+    system->addForce(bonds);
+    system->addForce(angles);
+    system->addForce(torsions);
+    bench.groupNames[0] = "nonbonded";
+    bench.groupNames[1] = "implicit solvent";
+    bench.groupNames[2] = "bonded";
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<Vec3>& pos = bench.positions;
+    vector<pair<int, int> > bondPairs;
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(12.0);
+        double charge = (i%4 == 0 ? 0.3 : (i%4 == 2 ? -0.3 : 0.0));
+        nonbonded->addParticle(charge, 0.3, 0.4);
+        gb->addParticle(charge, 0.15, 0.8);
+        if (i == 0) {
+            pos.push_back(Vec3());
+            continue;
+        }
+
+        // Take a random step that keeps the new particle away from all earlier ones, with a bias
+        // toward the origin to keep the chain compact.
+
+        Vec3 next;
+        for (int attempt = 0; ; attempt++) {
+            Vec3 dir(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5);
+            dir -= pos[i-1]*(0.5/(sqrt(pos[i-1].dot(pos[i-1]))+1.0));
+            next = pos[i-1]+dir*(bondLength/sqrt(dir.dot(dir)));
+            bool clash = false;
+            for (int j = 0; j < i-1 && !clash; j++) {
+                Vec3 delta = next-pos[j];
+                clash = (delta.dot(delta) < 0.25*0.25);
+            }
+            if (!clash || attempt == 100)
+                break;
+        }
+        pos.push_back(next);
+        bonds->addBond(i-1, i, bondLength, 250000.0);
+        bondPairs.push_back(make_pair(i-1, i));
+        if (i > 1) {
+            Vec3 v1 = pos[i-2]-pos[i-1], v2 = pos[i]-pos[i-1];
+            double angle = acos(v1.dot(v2)/sqrt(v1.dot(v1)*v2.dot(v2)));
+            angles->addAngle(i-2, i-1, i, angle, 400.0);
+        }
+        if (i > 2)
+            torsions->addTorsion(i-3, i-2, i-1, i, 3, 0.0, 2.0);
+    }
+    nonbonded->createExceptionsFromBonds(bondPairs, 0.8333, 0.5);
+}
+
+static void setReconstructionTarget(BenchmarkSystem& bench) {
+    CustomReactionCoordinate* rc = new CustomReactionCoordinate(2, "sqrt((x2-x1)^2+(y2-y1)^2+(z2-z1)^2)");
+    bench.reactionCoordinate.reset(rc);
+    int numParticles = bench.system->getNumParticles();
+    for (int i = 0; i+1 < numParticles; i += 2)
+        rc->addGroup({i, i+1});
+}
+
+static vector<Benchmark> getBenchmarks() {
+    vector<Benchmark> benchmarks;
+    benchmarks.push_back({"argon", "Lennard-Jones fluid with a cutoff, Verlet integrator",
+        [] (BenchmarkSystem& bench, double scale) {
+            createArgon(bench, scale, false);
+            bench.integrator.reset(new VerletIntegrator(0.004));
+        }});
+    for (auto size : vector<pair<string, double> >{{"small", 500}, {"medium", 2500}, {"large", 10000}}) {
+        double numMolecules = size.second;
+        benchmarks.push_back({"water-"+size.first, "Rigid water box with PME, Langevin integrator",
+            [numMolecules] (BenchmarkSystem& bench, double scale) {
+                createWater(bench, numMolecules*scale);
+                bench.integrator.reset(new LangevinMiddleIntegrator(300.0, 1.0, 0.002));
+            }});
+    }
+    benchmarks.push_back({"gb-protein", "Protein-like chain with bonded forces and GBSA-OBC implicit solvent",
+        [] (BenchmarkSystem& bench, double scale) {
+            createGBProtein(bench, scale);
+            bench.integrator.reset(new LangevinMiddleIntegrator(300.0, 1.0, 0.001));
+        }});
+    benchmarks.push_back({"custom-nonbonded", "Lennard-Jones fluid computed with CustomNonbondedForce",
+        [] (BenchmarkSystem& bench, double scale) {
+            createArgon(bench, scale, true);
+            bench.integrator.reset(new VerletIntegrator(0.004));
+        }});
+    benchmarks.push_back({"custom-integrator", "Rigid water box with PME, velocity Verlet implemented with CustomIntegrator",
+        [] (BenchmarkSystem& bench, double scale) {
+            createWater(bench, 500*scale);
+            CustomIntegrator* integrator = new CustomIntegrator(0.002);
+            integrator->addPerDofVariable("x1", 0);
+            integrator->addUpdateContextState();
+            integrator->addComputePerDof("v", "v+0.5*dt*f/m");
+            integrator->addComputePerDof("x", "x+dt*v");
+            integrator->addComputePerDof("x1", "x");
+            integrator->addConstrainPositions();
+            integrator->addComputePerDof("v", "v+0.5*dt*f/m+(x-x1)/dt");
+            integrator->addConstrainVelocities();
+            bench.integrator.reset(integrator);
+        }});
+    benchmarks.push_back({"indirect-reconstruction", "Lennard-Jones fluid with IndirectReconstructionIntegrator biased on pair distances",
+        [] (BenchmarkSystem& bench, double scale) {
+            createArgon(bench, 0.5*scale, false);
+            setReconstructionTarget(bench);
+            bench.integrator.reset(new IndirectReconstructionIntegrator(120.0, 10.0, 0.00001, bench.reactionCoordinate.get()));
+            bench.prepareIntegrator = [&bench] (Integrator& integrator, const vector<Vec3>& positions) {
+                dynamic_cast<IndirectReconstructionIntegrator&>(integrator).setMacroscopicVariable(bench.reactionCoordinate->value(positions));
+            };
+        }});
+    benchmarks.push_back({"damped-reconstruction", "Lennard-Jones fluid with DampedReconstructionIntegrator biased on pair distances",
+        [] (BenchmarkSystem& bench, double scale) {
+            createArgon(bench, 0.5*scale, false);
+            setReconstructionTarget(bench);
+            bench.integrator.reset(new DampedReconstructionIntegrator(120.0, 10.0, 0.00001, 1.0, bench.reactionCoordinate.get()));
+            bench.prepareIntegrator = [&bench] (Integrator& integrator, const vector<Vec3>& positions) {
+                dynamic_cast<DampedReconstructionIntegrator&>(integrator).setMacroscopicVariable(bench.reactionCoordinate->value(positions));
+            };
+        }});
+    return benchmarks;
+}
+
+static string quote(const string& s) {
+    string result = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result+"\"";
+}
+
+static string runBenchmark(const Benchmark& benchmark, Platform& platform, const map<string, string>& properties, int steps, double scale) {
+    BenchmarkSystem bench;
+    benchmark.create(bench, scale);
+    System& system = *bench.system;
+    Integrator& integrator = *bench.integrator;
+    Context context(system, integrator, platform, properties);
+    context.setPositions(bench.positions);
+    if (system.getNumConstraints() > 0)
+        context.applyConstraints(1e-5);
+    context.setVelocitiesToTemperature(300.0, 1);
+    if (bench.prepareIntegrator)
+        bench.prepareIntegrator(integrator, bench.positions);
+
+    // Run a few steps so any initialization is done before timing starts.
+
+    integrator.step(min(steps, 10));
+
+    // Time the simulation.  Profiling is disabled for this, since it changes how forces are computed.
+
+    double startTime = getTime();
+    integrator.step(steps);
+    context.getState(State::Positions);
+    double elapsed = getTime()-startTime;
+
+    // Run it again with profiling enabled to see how the time divides between forces and integration.
+
+    context.setProfilingEnabled(true);
+    startTime = getTime();
+    integrator.step(steps);
+    context.getState(State::Positions);
+    double profiledElapsed = getTime()-startTime;
+    map<string, double> profile = context.getProfile();
+    map<string, int> counts = context.getProfileCounts();
+    context.setProfilingEnabled(false);
+    double forceTime = 0.0;
+    for (auto& entry : profile)
+        if (entry.first.rfind("Force ", 0) == 0 && entry.first.rfind("Force group ", 0) != 0)
+            forceTime += entry.second;
+    forceTime += profile["Begin computation"]+profile["Finish computation"];
+
+    // Time each force group on its own.
+
+    int evaluations = max(5, steps/10);
+    map<string, double> groupTimes;
+    for (auto& group : bench.groupNames) {
+        context.getState(State::Forces, false, 1<<group.first);
+        startTime = getTime();
+        for (int i = 0; i < evaluations; i++)
+            context.getState(State::Forces, false, 1<<group.first);
+        groupTimes[group.second] = (getTime()-startTime)/evaluations;
+    }
+
+    // Time applying constraints to slightly perturbed positions.
+
+    double constraintTime = 0.0;
+    if (system.getNumConstraints() > 0) {
+        vector<Vec3> positions = context.getState(State::Positions).getPositions();
+        OpenMM_SFMT::SFMT sfmt;
+        init_gen_rand(0, sfmt);
+        for (int i = 0; i < evaluations; i++) {
+            vector<Vec3> perturbed = positions;
+            for (Vec3& p : perturbed)
+                p += Vec3(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5)*0.005;
+            context.setPositions(perturbed);
+            startTime = getTime();
+            context.applyConstraints(1e-5);
+            constraintTime += getTime()-startTime;
+        }
+        constraintTime /= evaluations;
+    }
+
+    // Format the results.
+
+    double simulatedTime = steps*integrator.getStepSize();
+    stringstream out;
+    out.precision(6);
+    out << "{\"benchmark\": " << quote(benchmark.name);
+    out << ", \"platform\": " << quote(platform.getName());
+    out << ", \"particles\": " << system.getNumParticles();
+    out << ", \"steps\": " << steps;
+    out << ", \"step_size_ps\": " << integrator.getStepSize();
+    out << ", \"ms_per_step\": " << 1000*elapsed/steps;
+    out << ", \"ns_per_day\": " << (elapsed > 0 ? 86400*1e-3*simulatedTime/elapsed : 0.0);
+    out << ", \"ms_per_step_forces\": " << 1000*forceTime/steps;
+    out << ", \"ms_per_step_profiled\": " << 1000*profiledElapsed/steps;
+    out << ", \"ms_per_step_integration\": " << 1000*max(0.0, profiledElapsed-forceTime)/steps;
+    out << ", \"profile\": {";
+    bool first = true;
+    for (auto& entry : profile) {
+        out << (first ? "" : ", ") << quote(entry.first) << ": {\"ms_per_step\": " << 1000*entry.second/steps << ", \"count\": " << counts[entry.first] << "}";
+        first = false;
+    }
+    out << "}, \"ms_per_evaluation\": {";
+    first = true;
+    for (auto& entry : groupTimes) {
+        out << (first ? "" : ", ") << quote(entry.first) << ": " << 1000*entry.second;
+        first = false;
+    }
+    if (system.getNumConstraints() > 0)
+        out << (first ? "" : ", ") << "\"constraints\": " << 1000*constraintTime;
+    out << "}}";
+    return out.str();
+}
+
+int main(int argc, char* argv[]) {
+    string platformName, pluginsDir = Platform::getDefaultPluginsDirectory(), outputFile;
+    map<string, string> properties;
+    vector<string> selected;
+    int steps = 100;
+    double scale = 1.0;
+    bool list = false;
+    vector<Benchmark> benchmarks = getBenchmarks();
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            size_t equals = arg.find('=');
+            string key = arg.substr(0, equals);
+            string value = (equals == string::npos ? "" : arg.substr(equals+1));
+            if (key == "--platform")
+                platformName = value;
+            else if (key == "--plugins")
+                pluginsDir = value;
+            else if (key == "--property") {
+                size_t separator = value.find('=');
+                if (separator == string::npos)
+                    throw OpenMMException("Illegal property: "+value);
+                properties[value.substr(0, separator)] = value.substr(separator+1);
+            }
+            else if (key == "--benchmark") {
+                stringstream names(value);
+                for (string name; getline(names, name, ',');)
+                    selected.push_back(name);
+            }
+            else if (key == "--steps")
+                steps = stoi(value);
+            else if (key == "--scale")
+                scale = stod(value);
+            else if (key == "--output")
+                outputFile = value;
+            else if (key == "--list")
+                list = true;
+            else
+                throw OpenMMException("Unknown argument: "+arg);
+        }
+        if (list) {
+            for (auto& benchmark : benchmarks)
+                cout << benchmark.name << ": " << benchmark.description << endl;
+            return 0;
+        }
+        if (steps < 1 || scale <= 0)
+            throw OpenMMException("The number of steps and the scale must be positive");
+        for (const string& name : selected)
+            if (find_if(benchmarks.begin(), benchmarks.end(), [&] (const Benchmark& b) {return b.name == name;}) == benchmarks.end())
+                throw OpenMMException("Unknown benchmark: "+name);
+        Platform::loadPluginsFromDirectory(pluginsDir);
+        if (platformName == "") {
+            platformName = "Reference";
+            for (int i = 0; i < Platform::getNumPlatforms(); i++)
+                if (Platform::getPlatform(i).getName() == "CPU")
+                    platformName = "CPU";
+        }
+        Platform& platform = Platform::getPlatformByName(platformName);
+        ofstream file;
+        if (outputFile != "") {
+            file.open(outputFile);
+            if (!file.is_open())
+                throw OpenMMException("Cannot open output file: "+outputFile);
+        }
+        ostream& out = (outputFile == "" ? cout : file);
+        for (auto& benchmark : benchmarks) {
+            if (selected.size() > 0 && find(selected.begin(), selected.end(), benchmark.name) == selected.end())
+                continue;
+            out << runBenchmark(benchmark, platform, properties, steps, scale) << endl;
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -56,8 +56,10 @@
 #include "openmm/HarmonicBondForce.h"
 #include "openmm/IndirectReconstructionIntegrator.h"
 #include "openmm/KernelImpl.h"
+#include "openmm/LocalEnergyMinimizer.h"
 #include "openmm/MonteCarloBarostat.h"
 #include "openmm/PeriodicTorsionForce.h"
+#include "openmm/RandomWalkEnsembleIntegrator.h"
 #include "openmm/RandomWalkIntegrator.h"
 #include "openmm/ReactionCoordinate.h"
 #include "openmm/RBTorsionForce.h"
@@ -69,6 +71,7 @@
 #include "openmm/VerletIntegrator.h"
 #include "openmm/NoseHooverIntegrator.h"
 #include "openmm/NoseHooverChain.h"
+#include "openmm/OpenMMException.h"
 #include "openmm/ATMForce.h"
 #include "openmm/internal/CustomCPPForceImpl.h"
 #include <iosfwd>
@@ -121,6 +124,48 @@ public:
      * energy directly, <i>or</i> add it to an internal buffer so that it will be included here.
      */
     virtual double finishComputation(ContextImpl& context, bool includeForce, bool includeEnergy, int groups, bool& valid) = 0;
+    /**
+     * Block until all work that has been queued for computing forces and energies has completed.  Platforms
+     * that execute work asynchronously override this, so that when profiling is enabled the time recorded for
+     * each stage is the time it takes to execute rather than the time to launch it.  The default
+     * implementation does nothing.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    virtual void synchronize(ContextImpl& context) {
+    }
+};
+
+/**
+ * This kernel computes the forces and energies of all ForceImpls in a Context.  It is optional: if a Platform
+ * does not provide it, ContextImpl calls calcForcesAndEnergy() on each ForceImpl in turn.  A Platform may
+ * provide it to compute independent forces concurrently.
+ */
+class ScheduleForcesKernel : public KernelImpl {
+public:
+    static std::string Name() {
+        return "ScheduleForces";
+    }
+    ScheduleForcesKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     */
+    virtual void initialize(const System& system) = 0;
+    /**
+     * Compute the forces and energies of a set of ForceImpls.  This is called between beginComputation() and
+     * finishComputation() of the CalcForcesAndEnergyKernel.
+     *
+     * @param context       the context in which to execute this kernel
+     * @param forceImpls    the ForceImpls to compute
+     * @param includeForce  true if forces should be computed
+     * @param includeEnergy true if potential energy should be computed
+     * @param groups        a set of bit flags for which force groups to include
+     * @return the sum of the energies returned by the ForceImpls
+     */
+    virtual double execute(ContextImpl& context, const std::vector<ForceImpl*>& forceImpls, bool includeForce, bool includeEnergy, int groups) = 0;
 };
 
 /**
@@ -132,7 +177,7 @@ public:
     static std::string Name() {
         return "UpdateTime";
     }
-    UpdateStateDataKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    UpdateStateDataKernel(std::string name, const Platform& platform) : KernelImpl(name, platform), hasDefaultSnapshot(false) {
     }
     /**
      * Initialize the kernel.
@@ -238,6 +283,50 @@ public:
      * @param stream    an input stream the checkpoint data should be read from
      */
     virtual void loadCheckpoint(ContextImpl& context, std::istream& stream) = 0;
+    /**
+     * Save the current positions, velocities, forces, time, and periodic box vectors in buffers owned by
+     * the kernel so they can later be restored with restoreSnapshot().  Each call replaces the previously saved snapshot.
+     *
+     * Platforms should override this and restoreSnapshot().  The default implementation copies the positions,
+     * velocities, time, and periodic box vectors through the other methods of this kernel, just as
+     * Context::getState() would.  It does not save forces.
+     *
+     * @param context    the context whose state should be saved
+     * @param energy     the potential energy corresponding to the current positions.  It is returned
+     *                   by restoreSnapshot().
+     */
+    virtual void saveSnapshot(ContextImpl& context, double energy) {
+        getPositions(context, defaultSnapshotPositions);
+        getVelocities(context, defaultSnapshotVelocities);
+        getPeriodicBoxVectors(context, defaultSnapshotBoxVectors[0], defaultSnapshotBoxVectors[1], defaultSnapshotBoxVectors[2]);
+        defaultSnapshotTime = getTime(context);
+        defaultSnapshotEnergy = energy;
+        hasDefaultSnapshot = true;
+    }
+    /**
+     * Restore the positions, velocities, forces, time, and periodic box vectors saved by the most recent
+     * call to saveSnapshot().  This may exchange the Context's buffers with the saved ones instead of
+     * copying them, so it consumes the snapshot: saveSnapshot() must be called again before the next
+     * call to this method.
+     *
+     * @param context    the context whose state should be restored
+     * @return the potential energy that was passed to saveSnapshot()
+     */
+    virtual double restoreSnapshot(ContextImpl& context) {
+        if (!hasDefaultSnapshot)
+            throw OpenMMException("restoreSnapshot() was called without a saved snapshot");
+        setPeriodicBoxVectors(context, defaultSnapshotBoxVectors[0], defaultSnapshotBoxVectors[1], defaultSnapshotBoxVectors[2]);
+        setPositions(context, defaultSnapshotPositions);
+        setVelocities(context, defaultSnapshotVelocities);
+        setTime(context, defaultSnapshotTime);
+        hasDefaultSnapshot = false;
+        return defaultSnapshotEnergy;
+    }
+private:
+    std::vector<Vec3> defaultSnapshotPositions, defaultSnapshotVelocities;
+    Vec3 defaultSnapshotBoxVectors[3];
+    double defaultSnapshotTime, defaultSnapshotEnergy;
+    bool hasDefaultSnapshot;
 };
 
 /**
@@ -296,6 +385,47 @@ public:
     virtual void computePositions(ContextImpl& context) = 0;
 };
 
+/**
+ * This kernel performs local energy minimization.  It is optional: if a Platform does not provide it,
+ * LocalEnergyMinimizer uses a generic implementation based on the public Context API.
+ */
+class MinimizeKernel : public KernelImpl {
+public:
+    static std::string Name() {
+        return "Minimize";
+    }
+    MinimizeKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     */
+    virtual void initialize(const System& system) = 0;
+    /**
+     * Search for a new set of particle positions that represent a local potential energy minimum.
+     * On exit, the context will have been updated with the new positions.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param tolerance      the RMS force (in kJ/mol/nm) at which to halt minimization
+     * @param maxIterations  the maximum number of iterations to perform, or 0 for no limit
+     * @param reporter       an optional MinimizationReporter to invoke after each iteration
+     */
+    virtual void execute(ContextImpl& context, double tolerance, int maxIterations, MinimizationReporter* reporter) = 0;
+    /**
+     * Minimize a batch of conformations of the System independently of each other.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param positions      on input, the initial positions of each conformation.  On exit, the minimized positions.
+     * @param energies       on exit, the potential energy of each minimized conformation.  This has already
+     *                       been resized to match positions.
+     * @param tolerance      the RMS force (in kJ/mol/nm) at which to halt minimization
+     * @param maxIterations  the maximum number of iterations to perform for each conformation, or 0 for no limit
+     */
+    virtual void executeBatch(ContextImpl& context, std::vector<std::vector<Vec3> >& positions, std::vector<double>& energies,
+            double tolerance, int maxIterations) = 0;
+};
+
 /**
  * This kernel is invoked by HarmonicBondForce to calculate the forces acting on the system and the energy of the system.
  */
@@ -1518,7 +1648,8 @@ public:
     CalcPmeReciprocalForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
     }
     /**
-     * Initialize the kernel.
+     * Initialize the kernel, using the default B-spline interpolation order of 5.  By default this calls the
+     * version that takes an interpolation order.  Subclasses must override at least one of the two versions.
      * 
      * @param gridx        the x size of the PME grid
      * @param gridy        the y size of the PME grid
@@ -1527,7 +1658,26 @@ public:
      * @param alpha        the Ewald blending parameter
      * @param deterministic whether it should attempt to make the resulting forces deterministic
      */
-    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic) = 0;
+    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic) {
+        initialize(gridx, gridy, gridz, numParticles, alpha, deterministic, 5);
+    }
+    /**
+     * Initialize the kernel.  By default this calls the version without an interpolation order if order is 5,
+     * and throws an exception for any other order.  Subclasses must override at least one of the two versions.
+     * 
+     * @param gridx        the x size of the PME grid
+     * @param gridy        the y size of the PME grid
+     * @param gridz        the z size of the PME grid
+     * @param numParticles the number of particles in the system
+     * @param alpha        the Ewald blending parameter
+     * @param deterministic whether it should attempt to make the resulting forces deterministic
+     * @param order        the B-spline interpolation order (4, 5, 6, or 8)
+     */
+    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic, int order) {
+        if (order != 5)
+            throw OpenMMException(getName()+" does not support PME interpolation order "+std::to_string(order));
+        initialize(gridx, gridy, gridz, numParticles, alpha, deterministic);
+    }
     /**
      * Begin computing the force and energy.
      *
@@ -1591,7 +1741,8 @@ public:
     CalcDispersionPmeReciprocalForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
     }
     /**
-     * Initialize the kernel.
+     * Initialize the kernel, using the default B-spline interpolation order of 5.  By default this calls the
+     * version that takes an interpolation order.  Subclasses must override at least one of the two versions.
      * 
      * @param gridx        the x size of the PME grid
      * @param gridy        the y size of the PME grid
@@ -1600,7 +1751,26 @@ public:
      * @param alpha        the Ewald blending parameter
      * @param deterministic whether it should attempt to make the resulting forces deterministic
      */
-    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic) = 0;
+    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic) {
+        initialize(gridx, gridy, gridz, numParticles, alpha, deterministic, 5);
+    }
+    /**
+     * Initialize the kernel.  By default this calls the version without an interpolation order if order is 5,
+     * and throws an exception for any other order.  Subclasses must override at least one of the two versions.
+     * 
+     * @param gridx        the x size of the PME grid
+     * @param gridy        the y size of the PME grid
+     * @param gridz        the z size of the PME grid
+     * @param numParticles the number of particles in the system
+     * @param alpha        the Ewald blending parameter
+     * @param deterministic whether it should attempt to make the resulting forces deterministic
+     * @param order        the B-spline interpolation order (4, 5, 6, or 8)
+     */
+    virtual void initialize(int gridx, int gridy, int gridz, int numParticles, double alpha, bool deterministic, int order) {
+        if (order != 5)
+            throw OpenMMException(getName()+" does not support PME interpolation order "+std::to_string(order));
+        initialize(gridx, gridy, gridz, numParticles, alpha, deterministic);
+    }
     /**
      * Begin computing the force and energy.
      *
@@ -1628,7 +1798,6 @@ public:
 };
 
 /**
-<<<<<<< HEAD
  * This kernel is invoked by RandomWalkIntegrator to take one time step.
  */
 class IntegrateRandomWalkStepKernel : public KernelImpl {
@@ -1667,6 +1836,102 @@ protected:
     double _period;
 };
 
+/**
+ * This kernel is invoked by RandomWalkEnsembleIntegrator.  It stores the positions of every chain, makes
+ * the proposals, and applies the Metropolis criterion.  The integrator is responsible for computing the
+ * energies of the proposals.
+ */
+class IntegrateRandomWalkEnsembleStepKernel : public KernelImpl {
+public:
+    static std::string Name() {
+        return "IntegrateRandomWalkEnsembleStep";
+    }
+    IntegrateRandomWalkEnsembleStepKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel will be used for
+     */
+    virtual void initialize(const System& system, const RandomWalkEnsembleIntegrator& integrator) = 0;
+    /**
+     * Set the current positions of one chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param positions  the positions of the particles
+     */
+    virtual void setChainPositions(ContextImpl& context, int chain, const std::vector<Vec3>& positions) = 0;
+    /**
+     * Get the current positions of one chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param positions  on exit, contains the positions of the particles
+     */
+    virtual void getChainPositions(ContextImpl& context, int chain, std::vector<Vec3>& positions) = 0;
+    /**
+     * Copy the current positions of the context into every chain whose positions have not been set yet.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    virtual void initializeChains(ContextImpl& context) = 0;
+    /**
+     * Copy the positions of one chain into the context.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param proposal   if true, copy the proposed positions from the last call to propose().  Otherwise
+     *                   copy the current positions.
+     */
+    virtual void loadChain(ContextImpl& context, int chain, bool proposal) = 0;
+    /**
+     * Make a new proposal for every chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     */
+    virtual void propose(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator) = 0;
+    /**
+     * Set the energies of the current positions of all chains.
+     *
+     * @param energies   the energy of each chain
+     */
+    virtual void setChainEnergies(const std::vector<double>& energies) = 0;
+    /**
+     * Accept or reject the proposal of every chain with the Metropolis criterion.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     * @param energies   the energy of each chain's proposal
+     */
+    virtual void acceptOrReject(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator, const std::vector<double>& energies) = 0;
+    /**
+     * Get the energy of the current positions of one chain.
+     */
+    virtual double getChainEnergy(int chain) = 0;
+    /**
+     * Get the number of proposals made for each chain since the statistics were last reset.
+     */
+    virtual long long getNumProposed() = 0;
+    /**
+     * Get the number of proposals accepted for one chain since the statistics were last reset.
+     */
+    virtual long long getNumAccepted(int chain) = 0;
+    /**
+     * Reset the acceptance statistics of all chains.
+     */
+    virtual void resetStatistics() = 0;
+    /**
+     * Compute the kinetic energy.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     */
+    virtual double computeKineticEnergy(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator) = 0;
+};
+
 /**
  * This kernel is invoked by IndirectReconstructionIntegrator to take one time step.
  */
@@ -1741,68 +2006,11 @@ public:
         return "IntegrateDampedReconstructionStepKernel";
     }
     IntegrateDampedReconstructionStepKernel(std::string name, const Platform& platform) : KernelImpl(name, platform), reactionCoordinate(0) {
-=======
- * This kernel is invoked by ATMForce to calculate the forces acting on the system and the energy of the system.
- */
-class CalcATMForceKernel : public KernelImpl {
-public:
-    static std::string Name() {
-        return "CalcATMForce";
-    }
-    CalcATMForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
-    }
-    /**
-     * Initialize the kernel.
-     * 
-     * @param system     the System this kernel will be applied to
-     * @param force      the ATMForce this kernel will be used for
-     */
-    virtual void initialize(const System& system, const ATMForce& force) = 0;
-    /**
-     * Scale the forces from the inner contexts and apply them to the main context.
-     *
-     * @param context        the context in which to execute this kernel
-     * @param innerContext0  the first inner context
-     * @param innerContext1  the second inner context
-     * @param dEdu0          the derivative of the final energy with respect to the first inner context's energy
-     * @param dEdu1          the derivative of the final energy with respect to the second inner context's energy
-     * @param energyParamDerivs  derivatives of the final energy with respect to global parameters
-     */
-    virtual void applyForces(ContextImpl& context, ContextImpl& innerContext0, ContextImpl& innerContext1,
-                             double dEdu0, double dEdu1, const std::map<std::string, double>& energyParamDerivs) = 0;
-    /**
-     * Copy changed parameters over to a context.
-     *
-     * @param context    the context to copy parameters to
-     * @param force      the ATMForce to copy the parameters from
-     */
-    virtual void copyParametersToContext(ContextImpl& context, const ATMForce& force) = 0;
-    /**
-     * Copy state information to the inner contexts.
-     *
-     * @param context        the context in which to execute this kernel
-     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
-     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
-     */
-    virtual void copyState(ContextImpl& context, ContextImpl& innerContext0, ContextImpl& innerContext1) = 0;
-};
-
-/**
- * This kernel is invoked by CustomCPPForce to calculate the forces acting on the system and the energy of the system.
- */
-class CalcCustomCPPForceKernel : public KernelImpl {
-public:
-    static std::string Name() {
-        return "CalcCustomCPPForce";
-    }
-    CalcCustomCPPForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
     }
     /**
      * Initialize the kernel.
      *
      * @param system     the System this kernel will be applied to
-<<<<<<< HEAD
      * @param integrator the DampedReconstructionIntegrator this kernel will be used for
      */
     virtual void initialize(const System& system, const DampedReconstructionIntegrator& integrator) = 0;
@@ -1861,7 +2069,92 @@ protected:
     double lambda, gamma;
     ReactionCoordinate *reactionCoordinate;
     std::vector<Vec3> macroscopicVariable;
-=======
+};
+
+/**
+ * This kernel is invoked by ATMForce to calculate the forces acting on the system and the energy of the system.
+ */
+class CalcATMForceKernel : public KernelImpl {
+public:
+    static std::string Name() {
+        return "CalcATMForce";
+    }
+    CalcATMForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the ATMForce this kernel will be used for
+     */
+    virtual void initialize(const System& system, const ATMForce& force) = 0;
+    /**
+     * Scale the forces from the inner contexts and apply them to the main context.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param innerContext0  the first inner context
+     * @param innerContext1  the second inner context
+     * @param dEdu0          the derivative of the final energy with respect to the first inner context's energy
+     * @param dEdu1          the derivative of the final energy with respect to the second inner context's energy
+     * @param energyParamDerivs  derivatives of the final energy with respect to global parameters
+     */
+    virtual void applyForces(ContextImpl& context, ContextImpl& innerContext0, ContextImpl& innerContext1,
+                             double dEdu0, double dEdu1, const std::map<std::string, double>& energyParamDerivs) = 0;
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the ATMForce to copy the parameters from
+     */
+    virtual void copyParametersToContext(ContextImpl& context, const ATMForce& force) = 0;
+    /**
+     * Copy state information to the inner contexts.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
+     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
+     */
+    virtual void copyState(ContextImpl& context, ContextImpl& innerContext0, ContextImpl& innerContext1) = 0;
+    /**
+     * Compute the energies of the two inner contexts, and optionally their forces.
+     *
+     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
+     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
+     * @param includeForces  true if forces should be computed
+     * @param energy0        on exit, the potential energy of the first inner context
+     * @param energy1        on exit, the potential energy of the second inner context
+     */
+    virtual void calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+                                            double& energy0, double& energy1) = 0;
+    /**
+     * Create one of the inner contexts.  This allows a platform to configure the inner contexts differently
+     * from the main one.  It is called after initialize().
+     *
+     * @param context          the context in which to execute this kernel
+     * @param innerSystem      the System for the inner context
+     * @param innerIntegrator  the Integrator for the inner context
+     * @param index            the index of the inner context to create (0 or 1)
+     * @return the newly created Context, or NULL to use a context linked to the main one
+     */
+    virtual Context* createInnerContext(ContextImpl& context, const System& innerSystem, Integrator& innerIntegrator, int index) {
+        return NULL;
+    }
+};
+
+/**
+ * This kernel is invoked by CustomCPPForce to calculate the forces acting on the system and the energy of the system.
+ */
+class CalcCustomCPPForceKernel : public KernelImpl {
+public:
+    static std::string Name() {
+        return "CalcCustomCPPForce";
+    }
+    CalcCustomCPPForceKernel(std::string name, const Platform& platform) : KernelImpl(name, platform) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
      * @param force      the CustomCPPForceImpl this kernel will be used for
      */
     virtual void initialize(const System& system, CustomCPPForceImpl& force) = 0;
@@ -1874,7 +2167,6 @@ protected:
      * @return the potential energy due to the force
      */
     virtual double execute(ContextImpl& context, bool includeForces, bool includeEnergy) = 0;
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
 };
 
 } // namespace OpenMM
@@ -49,6 +49,7 @@
 #include "openmm/CustomIntegrator.h"
 #include "openmm/CustomManyParticleForce.h"
 #include "openmm/CustomNonbondedForce.h"
+#include "openmm/CustomReactionCoordinate.h"
 #include "openmm/DampedReconstructionIntegrator.h"
 #include "openmm/Force.h"
 #include "openmm/GayBerneForce.h"
@@ -68,6 +69,7 @@
 #include "openmm/Context.h"
 #include "openmm/OpenMMException.h"
 #include "openmm/PeriodicTorsionForce.h"
+#include "openmm/RandomWalkEnsembleIntegrator.h"
 #include "openmm/RandomWalkIntegrator.h"
 #include "openmm/RBTorsionForce.h"
 #include "openmm/ReactionCoordinate.h"
@@ -85,6 +87,7 @@
 #include "openmm/VirtualSite.h"
 #include "openmm/Platform.h"
 #include "openmm/serialization/XmlSerializer.h"
+#include "openmm/serialization/BinarySerializer.h"
 #include "openmm/ATMForce.h"
 
 #endif /*OPENMM_H_*/
@@ -284,10 +284,56 @@ public:
      * belong to exactly one molecule.
      */
     const std::vector<std::vector<int> >& getMolecules() const;
+    /**
+     * Get whether profiling is enabled for this Context.
+     */
+    bool getProfilingEnabled() const;
+    /**
+     * Enable or disable profiling.  When profiling is enabled, the Context records how much wall clock time is
+     * spent in each stage of computing forces and energies, which can be retrieved with getProfile().  Enabling
+     * or disabling it discards any information recorded previously.
+     *
+     * Profiling changes how forces are computed, so it affects performance.  While it is enabled, forces
+     * are always computed one at a time so each one can be timed.  On the CPU Platform this means Forces
+     * that use single threaded kernels are no longer evaluated concurrently with the others.  On GPU
+     * Platforms, the Context waits for the device to finish each stage before timing it, which removes the
+     * overlap between the host and the device.  Also note that GPU Platforms compute some interactions,
+     * such as bonded and nonbonded ones, together in a single batch.  That time is reported under "Finish
+     * computation" rather than under the Forces it belongs to.  Profiled times therefore identify where
+     * time is spent, but their total is not a measure of the normal speed of a simulation.
+     */
+    void setProfilingEnabled(bool enabled);
+    /**
+     * Get the timing information that has been recorded since profiling was enabled or resetProfile() was
+     * last called.  The keys are the names of the entries, and the values are the total time (in seconds)
+     * spent in each one.  The entries include
+     *
+     * <ul>
+     * <li>"Force i (name)": the time spent computing the i'th Force in the System</li>
+     * <li>"Force group i": the total time spent computing all Forces in group i</li>
+     * <li>"Begin computation" and "Finish computation": work the Platform does before and after computing
+     * the individual Forces, such as building neighbor lists and summing forces</li>
+     * </ul>
+     *
+     * Platforms may add other entries.  For example, the CPU Platform adds "Neighbor list build" for the time
+     * spent building the neighbor list, and "Thread imbalance" for the average time threads spent waiting for
+     * other threads to finish while computing forces.
+     */
+    std::map<std::string, double> getProfile() const;
+    /**
+     * Get the number of times each entry returned by getProfile() has been recorded.  For example, the count
+     * for "Neighbor list build" is the number of times the neighbor list has been built.
+     */
+    std::map<std::string, int> getProfileCounts() const;
+    /**
+     * Discard all profiling information recorded so far.
+     */
+    void resetProfile();
 private:
     friend class ContextImpl;
     friend class Force;
     friend class ForceImpl;
+    friend class LocalEnergyMinimizer;
     friend class Platform;
     Context(const System& system, Integrator& integrator, ContextImpl& linked);
     ContextImpl& getImpl();
@@ -0,0 +1,172 @@
+#ifndef OPENMM_CUSTOMREACTIONCOORDINATE_H_
+#define OPENMM_CUSTOMREACTIONCOORDINATE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "ReactionCoordinate.h"
+#include "internal/windowsExport.h"
+#include <string>
+#include <vector>
+
+namespace Lepton {
+class CompiledExpression;
+}
+
+namespace OpenMM {
+
+/**
+ * This is a ReactionCoordinate defined by a mathematical expression of particle coordinates.  The
+ * expression is applied to any number of groups of particles, and each group produces one scalar
+ * component of the reaction coordinate.  The expression may depend on the variables x1, y1, z1, x2,
+ * y2, z2, etc., which are the coordinates of the particles in the group.  For example, the following
+ * computes the distance between two particles:
+ *
+ * <tt>CustomReactionCoordinate* rc = new CustomReactionCoordinate(2, "sqrt((x2-x1)^2+(y2-y1)^2+(z2-z1)^2)");</tt>
+ *
+ * The value returned by value() packs the scalar components three to an element: component i is
+ * stored in element i/3, at index i%3.  Unused slots in the last element are zero.
+ *
+ * The expression and its derivatives are compiled once, when the CustomReactionCoordinate is created,
+ * and are evaluated in double precision.  Evaluating a CustomReactionCoordinate is not thread safe.
+ *
+ * Expressions may involve the operators + (add), - (subtract), * (multiply), / (divide), and ^ (power), and the following
+ * functions: sqrt, exp, log, sin, cos, sec, csc, tan, cot, asin, acos, atan, atan2, sinh, cosh, tanh, erf, erfc, min, max, abs, floor, ceil, step, delta, select.  All trigonometric functions
+ * are defined in radians, and log is the natural logarithm.  step(x) = 0 if x is less than 0, 1 otherwise.  delta(x) = 1 if x is 0, 0 otherwise.
+ * select(x,y,z) = z if x = 0, y otherwise.
+ */
+class OPENMM_EXPORT CustomReactionCoordinate : public ReactionCoordinate {
+public:
+    /**
+     * Create a CustomReactionCoordinate.
+     *
+     * @param numParticles  the number of particles in each group
+     * @param expression    an algebraic expression giving one component of the reaction coordinate
+     *                      as a function of the coordinates of the particles in a group
+     */
+    CustomReactionCoordinate(int numParticles, const std::string& expression);
+    ~CustomReactionCoordinate();
+    /**
+     * Get the number of particles in each group.
+     */
+    int getNumParticlesPerGroup() const {
+        return numParticlesPerGroup;
+    }
+    /**
+     * Get the number of groups, which equals the number of scalar components of the reaction coordinate.
+     */
+    int getNumGroups() const {
+        return particles.size()/numParticlesPerGroup;
+    }
+    /**
+     * Get the algebraic expression that gives each component of the reaction coordinate.
+     */
+    const std::string& getExpression() const {
+        return expression;
+    }
+    /**
+     * Add a group of particles.
+     *
+     * @param groupParticles   the indices of the particles in the group.  The length must equal the value
+     *                         passed to the constructor.
+     * @return the index of the group that was added
+     */
+    int addGroup(const std::vector<int>& groupParticles);
+    /**
+     * Get the particles in a group.
+     *
+     * @param index            the index of the group
+     * @param[out] groupParticles  the indices of the particles in the group
+     */
+    void getGroupParameters(int index, std::vector<int>& groupParticles) const;
+    /**
+     * Compute the value of the reaction coordinate.
+     *
+     * @param x       the particle positions
+     * @return the scalar components of the reaction coordinate, packed three to an element
+     */
+    std::vector<Vec3> value(const std::vector<Vec3>& x);
+    /**
+     * Multiply the transpose of the Jacobian of the reaction coordinate by z.
+     *
+     * @param x       the particle positions
+     * @param z       the vector to multiply by, packed the same way as the value of the reaction coordinate
+     * @return one element for each particle, the sum over components of z times the gradient of that component
+     */
+    std::vector<Vec3> gradMatMul(const std::vector<Vec3>& x, const std::vector<Vec3>& z);
+    /**
+     * Get the energy 0.5*|value(x)-z|^2 of the harmonic bias that restrains the reaction coordinate to z.
+     */
+    double getBiasedEnergy(const std::vector<Vec3>& x, const std::vector<Vec3>& z);
+    /**
+     * Compute the value of the reaction coordinate, storing it in a buffer provided by the caller.
+     * The buffer is resized to hold (getNumGroups()+2)/3 elements.
+     *
+     * @param x       the particle positions
+     * @param result  on exit, contains the value of the reaction coordinate
+     */
+    void computeValue(const std::vector<Vec3>& x, std::vector<Vec3>& result);
+    /**
+     * Compute the difference between the value of the reaction coordinate and a target value z,
+     * storing it in a buffer provided by the caller.  z is subtracted as each group is evaluated, and
+     * only from the components it has values for.
+     *
+     * @param x       the particle positions
+     * @param z       the target value of the reaction coordinate
+     * @param result  on exit, contains the residual
+     */
+    void computeResidual(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result);
+    /**
+     * Multiply the transpose of the Jacobian of the reaction coordinate by z, storing the result in a
+     * buffer provided by the caller.  Only the components for which z has a value contribute.
+     *
+     * @param x       the particle positions
+     * @param z       the vector to multiply by
+     * @param result  on exit, contains one element for each particle
+     */
+    void computeGradMatMul(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result);
+private:
+    CustomReactionCoordinate(const CustomReactionCoordinate&);
+    CustomReactionCoordinate& operator=(const CustomReactionCoordinate&);
+    void loadCoordinates(const std::vector<Vec3>& x, int group);
+    void evaluateComponents(const std::vector<Vec3>& x, const std::vector<Vec3>* z, std::vector<Vec3>& result);
+    int numParticlesPerGroup, maxParticle;
+    std::string expression;
+    std::vector<int> particles;
+    std::vector<double> coordinates;
+    Lepton::CompiledExpression* valueExpression;
+    std::vector<Lepton::CompiledExpression*> derivExpressions;
+    std::vector<int> derivIndex;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_CUSTOMREACTIONCOORDINATE_H_*/
@@ -144,7 +144,8 @@ protected:
 private:
     double temperature, lambda, beta, gamma;
     int randomNumberSeed;
-    State prev_state;
+    double lastEnergy;
+    bool needsSnapshot;
     Kernel kernel;
     ReactionCoordinate* reactionCoordinate;
     std::vector<OpenMM::Vec3> macroVariable;
@@ -114,12 +114,6 @@ public:
 	 * @param acc     true if the proposal move was accepted, false if not
 	 */
 	void accepted(bool acc);
-	/**
-	 * Get the previous state.
-	 */
-//	State getPreviousState() const {
-//		return prev_state;
-//	}
 	/**
 	 * Advance a simulation through time by taking a series of time steps.
 	 *
@@ -155,7 +149,8 @@ protected:
 private:
     double temperature, lambda, beta;
     int randomNumberSeed;
-    State prev_state;
+    double lastEnergy;
+    bool needsSnapshot;
     Kernel kernel;
     ReactionCoordinate* reactionCoordinate;
     std::vector<OpenMM::Vec3> macroVariable;
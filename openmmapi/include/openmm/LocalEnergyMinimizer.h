@@ -136,6 +136,28 @@ public:
      *                       to monitor the progress of minimization or to stop minimization early.
      */
     static void minimize(Context& context, double tolerance = 10, int maxIterations = 0, MinimizationReporter* reporter = NULL);
+    /**
+     * Minimize many conformations of the same System, such as different poses of a ligand.  Each conformation
+     * is minimized independently, exactly as if its positions had been set on the Context and minimize() had
+     * been called, and stops as soon as it has converged or reached maxIterations.  Platforms may process
+     * several conformations at once.  The CPU platform, for example, minimizes a different conformation on
+     * each of its threads.
+     *
+     * @param context        a Context specifying the System to minimize.  On exit, it will have been updated
+     *                       with the minimized positions of the last conformation.
+     * @param positions      on input, the initial particle positions of each conformation.  On exit, the
+     *                       minimized positions of each conformation.
+     * @param energies       on exit, the potential energy of each minimized conformation, computed with the
+     *                       force groups defined by the Integrator
+     * @param tolerance      this specifies how precisely the energy minimum must be located.  Minimization
+     *                       of a conformation will be halted once the root-mean-square value of all force
+     *                       components reaches this tolerance (in kJ/mol/nm).  The default value is 10.
+     * @param maxIterations  the maximum number of iterations to perform for each conformation.  If this is 0,
+     *                       minimation is continued until the results converge without regard to how many
+     *                       iterations it takes.  The default value is 0.
+     */
+    static void minimizeBatch(Context& context, std::vector<std::vector<Vec3> >& positions, std::vector<double>& energies,
+            double tolerance = 10, int maxIterations = 0);
 };
 
 } // namespace OpenMM
@@ -316,6 +316,23 @@ public:
      * @param[out] nz      the number of grid points along the Z axis
      */
     void getLJPMEParametersInContext(const Context& context, double& alpha, int& nx, int& ny, int& nz) const;
+    /**
+     * Get the order of the B-spline interpolation used to spread charges onto the grid and interpolate forces
+     * for PME and LJPME.  The default value is 5.
+     */
+    int getPMEInterpolationOrder() const;
+    /**
+     * Set the order of the B-spline interpolation used to spread charges onto the grid and interpolate forces
+     * for PME and LJPME.  Allowed values are 4, 5, 6, and 8.  A higher order is more accurate for a given grid
+     * size but requires more work for each particle.  When the grid size is selected automatically based on the
+     * Ewald error tolerance, a higher order leads to a coarser grid.
+     *
+     * The Reference and CPU platforms support all allowed values.  Other platforms only support the default
+     * order of 5, and throw an exception if a different one is requested.
+     *
+     * @param order    the interpolation order
+     */
+    void setPMEInterpolationOrder(int order);
     /**
      * Add the nonbonded force parameters for a particle.  This should be called once for each particle
      * in the System.  When it is called for the i'th time, it specifies the parameters for the i'th particle.
@@ -630,7 +647,7 @@ private:
     NonbondedMethod nonbondedMethod;
     double cutoffDistance, switchingDistance, rfDielectric, ewaldErrorTol, alpha, dalpha;
     bool useSwitchingFunction, useDispersionCorrection, exceptionsUsePeriodic, includeDirectSpace;
-    int recipForceGroup, nx, ny, nz, dnx, dny, dnz;
+    int recipForceGroup, nx, ny, nz, dnx, dny, dnz, pmeOrder;
     void addExclusionsToSet(const std::vector<std::set<int> >& bonded12, std::set<int>& exclusions, int baseParticle, int fromParticle, int currentLevel) const;
     int getGlobalParameterIndex(const std::string& parameter) const;
     std::vector<ParticleInfo> particles;
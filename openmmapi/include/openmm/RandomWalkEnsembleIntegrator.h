@@ -0,0 +1,198 @@
+#ifndef OPENMM_RANDOMWALKENSEMBLEINTEGRATOR_H_
+#define OPENMM_RANDOMWALKENSEMBLEINTEGRATOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "Integrator.h"
+#include "openmm/Kernel.h"
+#include "openmm/Vec3.h"
+#include "internal/windowsExport.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This is an Integrator that runs many independent Metropolis Monte Carlo chains of the same System
+ * inside a single Context.  Each step makes a random walk proposal for every chain (the same proposal
+ * RandomWalkIntegrator makes), evaluates the energies of all proposals, and accepts or rejects each one
+ * with the Metropolis criterion.  This replaces creating one Context and RandomWalkIntegrator per chain
+ * and making the accept/reject decision in client code.
+ *
+ * The positions of each chain are stored by the integrator, separately from the positions of the Context.
+ * Chains whose positions have not been set with setChainPositions() start from the positions of the Context
+ * at the first call to step().  When step() returns, the Context holds the current positions of chain 0.
+ */
+class OPENMM_EXPORT RandomWalkEnsembleIntegrator : public Integrator {
+public:
+    /**
+     * Create a RandomWalkEnsembleIntegrator.
+     *
+     * @param numChains      the number of independent chains to run
+     * @param temperature    the temperature used in the acceptance criterion (in Kelvin)
+     * @param stepSize       the step size of the random walk proposals (in picoseconds)
+     * @param period         if positive, coordinates are wrapped into the interval [-period, period]
+     */
+    RandomWalkEnsembleIntegrator(int numChains, double temperature, double stepSize, double period=-1.0);
+    /**
+     * Get the number of chains.
+     */
+    int getNumChains() const {
+        return numChains;
+    }
+    /**
+     * Get the temperature used in the acceptance criterion (in Kelvin).
+     */
+    double getTemperature() const {
+        return temperature;
+    }
+    /**
+     * Set the temperature used in the acceptance criterion (in Kelvin).
+     */
+    void setTemperature(double temp) {
+        temperature = temp;
+    }
+    /**
+     * Get the period coordinates are wrapped to.  If it is not positive, no wrapping is done.
+     */
+    double getPeriod() const {
+        return period;
+    }
+    /**
+     * Get the random number seed.  See setRandomNumberSeed() for details.
+     */
+    int getRandomNumberSeed() const {
+        return randomNumberSeed;
+    }
+    /**
+     * Set the random number seed.  The precise meaning of this parameter is undefined, and is left up
+     * to each Platform to interpret in an appropriate way.  It is guaranteed that if two simulations
+     * are run with different random number seeds, the sequence of random proposals will be different.  On
+     * the other hand, no guarantees are made about the behavior of simulations that use the same seed.
+     * In particular, Platforms are permitted to use non-deterministic algorithms which produce different
+     * results on successive runs, even if those runs were initialized identically.
+     *
+     * If seed is set to 0 (which is the default value assigned), a unique seed is chosen when a Context
+     * is created from this Force. This is done to ensure that each Context receives unique random seeds
+     * without you needing to set them explicitly.
+     */
+    void setRandomNumberSeed(int seed) {
+        randomNumberSeed = seed;
+    }
+    /**
+     * Set the current positions of one chain.
+     *
+     * @param chain       the index of the chain
+     * @param positions   the positions of all particles in the chain
+     */
+    void setChainPositions(int chain, const std::vector<Vec3>& positions);
+    /**
+     * Get the current positions of one chain.
+     *
+     * @param chain       the index of the chain
+     * @param positions   on exit, contains the positions of all particles in the chain
+     */
+    void getChainPositions(int chain, std::vector<Vec3>& positions);
+    /**
+     * Get the potential energy of the current positions of one chain.  This is only valid after step()
+     * has been called.
+     *
+     * @param chain       the index of the chain
+     */
+    double getChainEnergy(int chain);
+    /**
+     * Get the number of proposals that have been made for each chain since the statistics were last reset.
+     */
+    long long getNumProposed();
+    /**
+     * Get the number of proposals that have been accepted for one chain since the statistics were last reset.
+     *
+     * @param chain       the index of the chain
+     */
+    long long getNumAccepted(int chain);
+    /**
+     * Get the fraction of proposals that have been accepted for one chain since the statistics were last reset.
+     *
+     * @param chain       the index of the chain
+     */
+    double getAcceptanceRate(int chain);
+    /**
+     * Reset the acceptance statistics of all chains to zero.
+     */
+    void resetStatistics();
+    /**
+     * Advance every chain by a series of Monte Carlo steps.
+     *
+     * @param steps   the number of steps to take
+     */
+    void step(int steps);
+protected:
+    /**
+     * This will be called by the Context when it is created.  It informs the Integrator
+     * of what context it will be integrating, and gives it a chance to do any necessary initialization.
+     * It will also get called again if the application calls reinitialize() on the Context.
+     */
+    void initialize(ContextImpl& context);
+    /**
+     * This will be called by the Context when it is destroyed to let the Integrator do any necessary
+     * cleanup.  It will also get called again if the application calls reinitialize() on the Context.
+     */
+    void cleanup();
+    /**
+     * When the user modifies the state, we need to mark that the chain energies are no longer valid.
+     */
+    void stateChanged(State::DataType changed);
+    /**
+     * Get the names of all Kernels used by this Integrator.
+     */
+    std::vector<std::string> getKernelNames();
+    /**
+     * Compute the kinetic energy of the system at the current time.
+     */
+    double computeKineticEnergy();
+    /**
+     * Computing kinetic energy for this integrator does not require forces.
+     */
+    bool kineticEnergyRequiresForce() const;
+private:
+    void checkChain(int chain) const;
+    void calcChainEnergies(bool proposal);
+    int numChains;
+    double temperature, period;
+    int randomNumberSeed;
+    bool energiesValid;
+    std::vector<double> proposalEnergies;
+    Kernel kernel;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_RANDOMWALKENSEMBLEINTEGRATOR_H_*/
@@ -76,12 +76,6 @@ public:
 	 */
 	void accepted(bool acc);
 
-	/**
-	 * Get the previous state.
-	 */
-//	State getPreviousState() const {
-//		return prev_state;
-//	}
 
 	/**
 	 * Advance a simulation through time by taking a series of time steps.
@@ -117,7 +111,8 @@ private:
     double _period;
     double temperature;
     int randomNumberSeed;
-    State prev_state;
+    double lastEnergy;
+    bool needsSnapshot;
     Kernel kernel;
 };
 
@@ -27,6 +27,35 @@ public:
     
     virtual double getBiasedEnergy(const std::vector<OpenMM::Vec3> &x,
                                    const std::vector<OpenMM::Vec3> &z) = 0;
+
+    /**
+     * Compute the value of the reaction coordinate, storing it in a buffer provided by the caller.
+     * The default implementation calls value().  Subclasses can override it to avoid allocating
+     * memory on every call.
+     *
+     * @param x       the particle positions
+     * @param result  on exit, contains the value of the reaction coordinate
+     */
+    virtual void computeValue(const std::vector<Vec3>& x, std::vector<Vec3>& result);
+    /**
+     * Compute the difference between the value of the reaction coordinate and a target value z,
+     * storing it in a buffer provided by the caller.  Only the first z.size() elements have z
+     * subtracted from them.  The default implementation calls computeValue() and then subtracts z.
+     *
+     * @param x       the particle positions
+     * @param z       the target value of the reaction coordinate
+     * @param result  on exit, contains the residual
+     */
+    virtual void computeResidual(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result);
+    /**
+     * Multiply the transpose of the Jacobian of the reaction coordinate by z, storing the result in a
+     * buffer provided by the caller.  The default implementation calls gradMatMul().
+     *
+     * @param x       the particle positions
+     * @param z       the vector to multiply by
+     * @param result  on exit, contains one element for each particle
+     */
+    virtual void computeGradMatMul(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result);
 };
 
 } // namespace OpenMM
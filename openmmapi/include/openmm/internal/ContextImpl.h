@@ -213,6 +213,36 @@ public:
      * doing that!  Only do it if you're also modifying forces stored inside the context.
      */
     int& getLastForceGroups();
+    /**
+     * Get whether profiling is enabled.  Platforms may check this to decide whether to record timing
+     * information with recordProfileTime().
+     */
+    bool getProfilingEnabled() const {
+        return profilingEnabled;
+    }
+    /**
+     * Enable or disable profiling.  Enabling it discards any information that was previously recorded.
+     */
+    void setProfilingEnabled(bool enabled);
+    /**
+     * Add an entry to the profile.  This should only be called when profiling is enabled.
+     *
+     * @param name   the name of the entry to add to
+     * @param time   the time (in seconds) to add to it.  The number of calls for the entry is incremented by one.
+     */
+    void recordProfileTime(const std::string& name, double time);
+    /**
+     * Get the total time (in seconds) recorded for each profile entry.
+     */
+    const std::map<std::string, double>& getProfileTimes() const;
+    /**
+     * Get the number of times each profile entry has been recorded.
+     */
+    const std::map<std::string, int>& getProfileCounts() const;
+    /**
+     * Discard all profiling information recorded so far.
+     */
+    void resetProfile();
     /**
      * Calculate the kinetic energy of the system (in kJ/mol).
      */
@@ -270,6 +300,23 @@ public:
      * @param stream    an input stream the checkpoint data should be read from
      */
     void loadCheckpoint(std::istream& stream);
+    /**
+     * Save the current positions, velocities, forces, time, and periodic box vectors so they can later be
+     * restored with restoreSnapshot().
+     * The data stays inside the Platform, so this is much cheaper than getState() and setState().  It is
+     * intended for integrators that need to undo rejected Monte Carlo proposals.
+     *
+     * @param energy    the potential energy corresponding to the current positions
+     */
+    void saveSnapshot(double energy);
+    /**
+     * Restore the positions, velocities, forces, time, and periodic box vectors saved by the most recent
+     * call to saveSnapshot().  The Platform may do this by exchanging buffers rather than copying them,
+     * which consumes the snapshot, so saveSnapshot() must be called again before it can next be restored.
+     *
+     * @return the potential energy that was passed to saveSnapshot()
+     */
+    double restoreSnapshot();
     /**
      * This is invoked by the Integrator when it is deleted.  This is needed to ensure the cleanup process
      * is done correctly, since we don't know whether the Integrator or Context will be deleted first.
@@ -281,6 +328,14 @@ public:
      * Notify the integrator that some aspect of the system has changed, and cached information should be discarded.
      */
     void systemChanged();
+    /**
+     * Get the number of times systemChanged() has been called.  Kernels that keep objects derived from the
+     * parameters of the System's Forces can compare it to the value when they were created to tell whether
+     * they are out of date.
+     */
+    int getSystemChangeCount() const {
+        return systemChangeCount;
+    }
     /**
      * This is the routine that actually computes the list of molecules returned by getMolecules().  Normally
      * you should never call it.  It is exposed here because the same logic is useful to other classes too.
@@ -298,16 +353,19 @@ public:
 private:
     friend class Context;
     void initialize();
+    double calcForcesAndEnergyWithProfiling(bool includeForces, bool includeEnergy, int groups);
     Context& owner;
     const System& system;
     Integrator& integrator;
     std::vector<ForceImpl*> forceImpls;
     std::map<std::string, double> parameters;
     mutable std::vector<std::vector<int> > molecules;
-    bool hasInitializedForces, hasSetPositions, integratorIsDeleted;
-    int lastForceGroups;
+    bool hasInitializedForces, hasSetPositions, integratorIsDeleted, useScheduleForcesKernel, profilingEnabled;
+    std::map<std::string, double> profileTimes;
+    std::map<std::string, int> profileCounts;
+    int lastForceGroups, systemChangeCount;
     Platform* platform;
-    Kernel initializeForcesKernel, updateStateDataKernel, applyConstraintsKernel, virtualSitesKernel;
+    Kernel initializeForcesKernel, updateStateDataKernel, applyConstraintsKernel, virtualSitesKernel, scheduleForcesKernel;
     void* platformData;
 };
 
@@ -71,7 +71,7 @@ public:
     static void calcEwaldParameters(const System& system, const NonbondedForce& force, double& alpha, int& kmaxx, int& kmaxy, int& kmaxz);
     /**
      * This is a utility routine that calculates the values to use for alpha and grid size when using
-     * Particle Mesh Ewald.
+     * Particle Mesh Ewald.  The grid size depends on the force's interpolation order.
      */
     static void calcPMEParameters(const System& system, const NonbondedForce& force, double& alpha, int& xsize, int& ysize, int& zsize, bool lj);
     /**
@@ -34,6 +34,7 @@
 
 #define NOMINMAX
 #include "windowsExport.h"
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -51,6 +52,12 @@ namespace OpenMM {
  * next syncThreads(), and the final call waits until they exit from the Task's execute() method.
  * After calling waitForThreads() to block at a synchronization point, the parent thread should
  * call resumeThreads() to instruct the worker threads to resume.
+ *
+ * For loops whose iterations are independent, parallelFor() divides the iterations between the
+ * threads and balances the load by letting threads that finish early steal work from the others.
+ *
+ * When there are no more threads than processors, waiting threads spin briefly before blocking,
+ * which reduces the latency of starting and finishing short tasks.
  */
 class OPENMM_EXPORT ThreadPool {
 public:
@@ -61,8 +68,10 @@ public:
      *
      * @param numThreads  the number of worker threads to create.  If this is 0 (the default), the
      *                    number of threads is set equal to the number of logical CPU cores available
+     * @param pinThreads  if true, each worker thread is bound to a single logical CPU core.  This is
+     *                    currently only supported on Linux, and is ignored on other operating systems.
      */
-    ThreadPool(int numThreads=0);
+    ThreadPool(int numThreads=0, bool pinThreads=false);
     ~ThreadPool();
     /**
      * Get the number of worker threads in the pool.
@@ -76,6 +85,19 @@ public:
      * Execute a function in parallel on the worker threads.
      */
     void execute(std::function<void (ThreadPool&, int)> task);
+    /**
+     * Execute a loop in parallel on the worker threads, and block until it is complete.  The range of
+     * indices is initially split evenly between the threads, which process their shares in chunks.  When
+     * a thread finishes its own share, it takes chunks from the shares of other threads.  This must not be
+     * called from inside another task executing on the same ThreadPool.
+     *
+     * @param start      the first index in the loop
+     * @param end        one past the last index in the loop
+     * @param grainSize  the number of indices to process at a time
+     * @param task       the function to invoke on each chunk.  It is passed the ThreadPool, the index of
+     *                   the thread invoking it, and the first and one past the last index of the chunk.
+     */
+    void parallelFor(int start, int end, int grainSize, std::function<void (ThreadPool&, int, int, int)> task);
     /**
      * This is called by the worker threads to block until all threads have reached the same point
      * and the master thread instructs them to continue by calling resumeThreads().
@@ -90,9 +112,24 @@ public:
      * Instruct the threads to resume running after blocking at a synchronization point.
      */
     void resumeThreads();
+    /**
+     * Enable or disable measuring load imbalance between threads.  When it is enabled, each time the
+     * threads reach a synchronization point (including the end of a task), the difference between the
+     * time the last thread arrived and the average arrival time is added to the total returned by
+     * getImbalanceTime().  Calling this resets that total to 0.
+     */
+    void setImbalanceTimingEnabled(bool enabled);
+    /**
+     * Get the total time (in seconds) that threads have spent waiting for other threads at synchronization
+     * points, averaged over threads, since setImbalanceTimingEnabled() was last called.
+     */
+    double getImbalanceTime() const;
 private:
-    bool isDeleted;
-    int numThreads, waitCount;
+    bool isDeleted, useSpinWait, measureImbalance;
+    double lastArrivalTime, sumArrivalTime, imbalanceTime;
+    int numThreads;
+    std::atomic<int> waitCount;
+    std::atomic<unsigned int> generation;
     std::vector<std::thread> threads;
     std::vector<ThreadData*> threadData;
     std::condition_variable startCondition, endCondition;
@@ -112,15 +112,19 @@ void ATMForceImpl::initialize(ContextImpl& context) {
     copySystem(context, system, innerSystem0);
     copySystem(context, system, innerSystem1);
 
-    // Create the inner context.
-
-    innerContext0 = context.createLinkedContext(innerSystem0, innerIntegrator0);
-    innerContext1 = context.createLinkedContext(innerSystem1, innerIntegrator1);
-
     // Create the kernel.
 
     kernel = context.getPlatform().createKernel(CalcATMForceKernel::Name(), context);
     kernel.getAs<CalcATMForceKernel>().initialize(context.getSystem(), owner);
+
+    // Create the inner contexts.  The platform may choose how they are configured.
+
+    innerContext0 = kernel.getAs<CalcATMForceKernel>().createInnerContext(context, innerSystem0, innerIntegrator0, 0);
+    if (innerContext0 == NULL)
+        innerContext0 = context.createLinkedContext(innerSystem0, innerIntegrator0);
+    innerContext1 = kernel.getAs<CalcATMForceKernel>().createInnerContext(context, innerSystem1, innerIntegrator1, 1);
+    if (innerContext1 == NULL)
+        innerContext1 = context.createLinkedContext(innerSystem1, innerIntegrator1);
 }
 
 double ATMForceImpl::calcForcesAndEnergy(ContextImpl& context, bool includeForces, bool includeEnergy, int groups) {
@@ -136,8 +140,7 @@ double ATMForceImpl::calcForcesAndEnergy(ContextImpl& context, bool includeForce
 
     // Evaluate energy and forces for the two systems
 
-    state0Energy = innerContextImpl0.calcForcesAndEnergy(includeForces, true);
-    state1Energy = innerContextImpl1.calcForcesAndEnergy(includeForces, true);
+    kernel.getAs<CalcATMForceKernel>().calcInnerForcesAndEnergies(innerContextImpl0, innerContextImpl1, includeForces, state0Energy, state1Energy);
 
     // set global parameters for energy expression
 
@@ -253,10 +253,12 @@ void Context::reinitialize(bool preserveState) {
     if (preserveState)
         createCheckpoint(checkpoint);
     bool hasSetPositions = impl->hasSetPositions;
+    bool profilingEnabled = impl->getProfilingEnabled();
     integrator.cleanup();
     delete impl;
     impl = new ContextImpl(*this, system, integrator, &platform, properties);
     impl->initialize();
+    impl->setProfilingEnabled(profilingEnabled);
     if (preserveState) {
         loadCheckpoint(checkpoint);
         impl->hasSetPositions = hasSetPositions;
@@ -282,3 +284,23 @@ const ContextImpl& Context::getImpl() const {
 const vector<vector<int> >& Context::getMolecules() const {
     return impl->getMolecules();
 }
+
+bool Context::getProfilingEnabled() const {
+    return impl->getProfilingEnabled();
+}
+
+void Context::setProfilingEnabled(bool enabled) {
+    impl->setProfilingEnabled(enabled);
+}
+
+map<string, double> Context::getProfile() const {
+    return impl->getProfileTimes();
+}
+
+map<string, int> Context::getProfileCounts() const {
+    return impl->getProfileCounts();
+}
+
+void Context::resetProfile() {
+    impl->resetProfile();
+}
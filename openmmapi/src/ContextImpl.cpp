@@ -36,6 +36,7 @@
 #include "openmm/kernels.h"
 #include "openmm/internal/ForceImpl.h"
 #include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/timer.h"
 #include "openmm/State.h"
 #include "openmm/VirtualSite.h"
 #include "openmm/Context.h"
@@ -54,8 +55,9 @@ const static char CHECKPOINT_MAGIC_BYTES[] = "OpenMM Binary Checkpoint\n";
 
 
 ContextImpl::ContextImpl(Context& owner, const System& system, Integrator& integrator, Platform* platform, const map<string, string>& properties, ContextImpl* originalContext) :
-        owner(owner), system(system), integrator(integrator), hasInitializedForces(false), hasSetPositions(false), integratorIsDeleted(false),
-        lastForceGroups(-1), platform(platform), platformData(NULL) {
+        owner(owner), system(system), integrator(integrator), hasInitializedForces(false), hasSetPositions(false), integratorIsDeleted(false), useScheduleForcesKernel(false),
+        profilingEnabled(false),
+        lastForceGroups(-1), systemChangeCount(0), platform(platform), platformData(NULL) {
     int numParticles = system.getNumParticles();
     if (numParticles == 0)
         throw OpenMMException("Cannot create a Context for a System with no particles");
@@ -175,6 +177,11 @@ void ContextImpl::initialize() {
     applyConstraintsKernel.getAs<ApplyConstraintsKernel>().initialize(system);
     virtualSitesKernel = platform->createKernel(VirtualSitesKernel::Name(), *this);
     virtualSitesKernel.getAs<VirtualSitesKernel>().initialize(system);
+    if (platform->supportsKernels({ScheduleForcesKernel::Name()})) {
+        scheduleForcesKernel = platform->createKernel(ScheduleForcesKernel::Name(), *this);
+        scheduleForcesKernel.getAs<ScheduleForcesKernel>().initialize(system);
+        useScheduleForcesKernel = true;
+    }
     Vec3 periodicBoxVectors[3];
     system.getDefaultPeriodicBoxVectors(periodicBoxVectors[0], periodicBoxVectors[1], periodicBoxVectors[2]);
     updateStateDataKernel.getAs<UpdateStateDataKernel>().setPeriodicBoxVectors(*this, periodicBoxVectors[0], periodicBoxVectors[1], periodicBoxVectors[2]);
@@ -200,6 +207,7 @@ ContextImpl::~ContextImpl() {
     updateStateDataKernel = Kernel();
     applyConstraintsKernel = Kernel();
     virtualSitesKernel = Kernel();
+    scheduleForcesKernel = Kernel();
     if (!integratorIsDeleted) {
         // The Context is being deleted before the Integrator, so call cleanup() on it now.
         
@@ -304,11 +312,16 @@ double ContextImpl::calcForcesAndEnergy(bool includeForces, bool includeEnergy,
         throw OpenMMException("Particle positions have not been set");
     lastForceGroups = groups;
     CalcForcesAndEnergyKernel& kernel = initializeForcesKernel.getAs<CalcForcesAndEnergyKernel>();
+    if (profilingEnabled)
+        return calcForcesAndEnergyWithProfiling(includeForces, includeEnergy, groups);
     while (true) {
         double energy = 0.0;
         kernel.beginComputation(*this, includeForces, includeEnergy, groups);
-        for (auto force : forceImpls)
-            energy += force->calcForcesAndEnergy(*this, includeForces, includeEnergy, groups);
+        if (useScheduleForcesKernel)
+            energy += scheduleForcesKernel.getAs<ScheduleForcesKernel>().execute(*this, forceImpls, includeForces, includeEnergy, groups);
+        else
+            for (auto force : forceImpls)
+                energy += force->calcForcesAndEnergy(*this, includeForces, includeEnergy, groups);
         bool valid = true;
         energy += kernel.finishComputation(*this, includeForces, includeEnergy, groups, valid);
         if (valid)
@@ -316,6 +329,65 @@ double ContextImpl::calcForcesAndEnergy(bool includeForces, bool includeEnergy,
     }
 }
 
+double ContextImpl::calcForcesAndEnergyWithProfiling(bool includeForces, bool includeEnergy, int groups) {
+    // This is the same as calcForcesAndEnergy(), but it times each stage.  The forces are computed one
+    // at a time so the time spent in each one can be measured.  On platforms that execute asynchronously,
+    // the kernel waits for each stage to finish before it is timed.
+
+    CalcForcesAndEnergyKernel& kernel = initializeForcesKernel.getAs<CalcForcesAndEnergyKernel>();
+    while (true) {
+        double energy = 0.0;
+        kernel.synchronize(*this);
+        double startTime = getCurrentTime();
+        kernel.beginComputation(*this, includeForces, includeEnergy, groups);
+        kernel.synchronize(*this);
+        double endTime = getCurrentTime();
+        recordProfileTime("Begin computation", endTime-startTime);
+        map<int, double> groupTime;
+        for (int i = 0; i < forceImpls.size(); i++) {
+            const Force& force = forceImpls[i]->getOwner();
+            startTime = endTime;
+            energy += forceImpls[i]->calcForcesAndEnergy(*this, includeForces, includeEnergy, groups);
+            kernel.synchronize(*this);
+            endTime = getCurrentTime();
+            recordProfileTime("Force "+to_string(i)+" ("+force.getName()+")", endTime-startTime);
+            groupTime[force.getForceGroup()] += endTime-startTime;
+        }
+        for (auto& group : groupTime)
+            recordProfileTime("Force group "+to_string(group.first), group.second);
+        bool valid = true;
+        startTime = endTime;
+        energy += kernel.finishComputation(*this, includeForces, includeEnergy, groups, valid);
+        kernel.synchronize(*this);
+        recordProfileTime("Finish computation", getCurrentTime()-startTime);
+        if (valid)
+            return energy;
+    }
+}
+
+void ContextImpl::setProfilingEnabled(bool enabled) {
+    profilingEnabled = enabled;
+    resetProfile();
+}
+
+void ContextImpl::recordProfileTime(const string& name, double time) {
+    profileTimes[name] += time;
+    profileCounts[name]++;
+}
+
+const map<string, double>& ContextImpl::getProfileTimes() const {
+    return profileTimes;
+}
+
+const map<string, int>& ContextImpl::getProfileCounts() const {
+    return profileCounts;
+}
+
+void ContextImpl::resetProfile() {
+    profileTimes.clear();
+    profileCounts.clear();
+}
+
 int& ContextImpl::getLastForceGroups() {
     return lastForceGroups;
 }
@@ -502,7 +574,19 @@ void ContextImpl::loadCheckpoint(istream& stream) {
     integrator.stateChanged(State::Energy);
 }
 
+void ContextImpl::saveSnapshot(double energy) {
+    updateStateDataKernel.getAs<UpdateStateDataKernel>().saveSnapshot(*this, energy);
+}
+
+double ContextImpl::restoreSnapshot() {
+    double energy = updateStateDataKernel.getAs<UpdateStateDataKernel>().restoreSnapshot(*this);
+    integrator.stateChanged(State::Positions);
+    integrator.stateChanged(State::Velocities);
+    return energy;
+}
+
 void ContextImpl::systemChanged() {
+    systemChangeCount++;
     integrator.stateChanged(State::Energy);
 }
 
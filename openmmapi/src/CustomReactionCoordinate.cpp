@@ -0,0 +1,175 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/CustomReactionCoordinate.h"
+#include "openmm/OpenMMException.h"
+#include "lepton/CompiledExpression.h"
+#include "lepton/Operation.h"
+#include "lepton/ParsedExpression.h"
+#include "lepton/Parser.h"
+#include <algorithm>
+#include <sstream>
+
+using namespace Lepton;
+using namespace OpenMM;
+using namespace std;
+
+CustomReactionCoordinate::CustomReactionCoordinate(int numParticles, const string& expression) :
+        numParticlesPerGroup(numParticles), maxParticle(-1), expression(expression) {
+    if (numParticles < 1)
+        throw OpenMMException("CustomReactionCoordinate: numParticles must be at least 1");
+    ParsedExpression parsed = Parser::parse(expression).optimize();
+
+    // All expressions read the coordinates of the current group from the same array.
+
+    coordinates.resize(3*numParticles);
+    map<string, double*> variableLocations;
+    for (int i = 0; i < numParticles; i++) {
+        stringstream index;
+        index << (i+1);
+        variableLocations["x"+index.str()] = &coordinates[3*i];
+        variableLocations["y"+index.str()] = &coordinates[3*i+1];
+        variableLocations["z"+index.str()] = &coordinates[3*i+2];
+    }
+    valueExpression = new CompiledExpression(parsed.createCompiledExpression());
+    valueExpression->setVariableLocations(variableLocations);
+
+    // Derivatives that are identically zero are skipped when computing gradients.
+
+    const string axes[] = {"x", "y", "z"};
+    for (int i = 0; i < numParticles; i++) {
+        stringstream index;
+        index << (i+1);
+        for (int j = 0; j < 3; j++) {
+            ParsedExpression deriv = parsed.differentiate(axes[j]+index.str()).optimize();
+            const Operation& op = deriv.getRootNode().getOperation();
+            if (op.getId() == Operation::CONSTANT && dynamic_cast<const Operation::Constant&>(op).getValue() == 0.0)
+                continue;
+            CompiledExpression* compiled = new CompiledExpression(deriv.createCompiledExpression());
+            compiled->setVariableLocations(variableLocations);
+            derivExpressions.push_back(compiled);
+            derivIndex.push_back(3*i+j);
+        }
+    }
+}
+
+CustomReactionCoordinate::~CustomReactionCoordinate() {
+    delete valueExpression;
+    for (CompiledExpression* deriv : derivExpressions)
+        delete deriv;
+}
+
+int CustomReactionCoordinate::addGroup(const vector<int>& groupParticles) {
+    if (groupParticles.size() != numParticlesPerGroup)
+        throw OpenMMException("CustomReactionCoordinate: wrong number of particles in group");
+    for (int particle : groupParticles) {
+        if (particle < 0)
+            throw OpenMMException("CustomReactionCoordinate: Illegal particle index");
+        maxParticle = max(maxParticle, particle);
+        particles.push_back(particle);
+    }
+    return getNumGroups()-1;
+}
+
+void CustomReactionCoordinate::getGroupParameters(int index, vector<int>& groupParticles) const {
+    if (index < 0 || index >= getNumGroups())
+        throw OpenMMException("CustomReactionCoordinate: Illegal group index");
+    groupParticles.assign(particles.begin()+index*numParticlesPerGroup, particles.begin()+(index+1)*numParticlesPerGroup);
+}
+
+void CustomReactionCoordinate::loadCoordinates(const vector<Vec3>& x, int group) {
+    const int* groupParticles = &particles[group*numParticlesPerGroup];
+    for (int i = 0; i < numParticlesPerGroup; i++) {
+        const Vec3& pos = x[groupParticles[i]];
+        coordinates[3*i] = pos[0];
+        coordinates[3*i+1] = pos[1];
+        coordinates[3*i+2] = pos[2];
+    }
+}
+
+void CustomReactionCoordinate::evaluateComponents(const vector<Vec3>& x, const vector<Vec3>* z, vector<Vec3>& result) {
+    if (maxParticle >= (int) x.size())
+        throw OpenMMException("CustomReactionCoordinate: A group contains a particle index larger than the number of positions");
+    int numGroups = getNumGroups();
+    result.assign((numGroups+2)/3, Vec3());
+    int numTargets = (z == NULL ? 0 : 3*z->size());
+    for (int component = 0; component < numGroups; component++) {
+        loadCoordinates(x, component);
+        double value = valueExpression->evaluate();
+        if (component < numTargets)
+            value -= (*z)[component/3][component%3];
+        result[component/3][component%3] = value;
+    }
+}
+
+void CustomReactionCoordinate::computeValue(const vector<Vec3>& x, vector<Vec3>& result) {
+    evaluateComponents(x, NULL, result);
+}
+
+void CustomReactionCoordinate::computeResidual(const vector<Vec3>& x, const vector<Vec3>& z, vector<Vec3>& result) {
+    evaluateComponents(x, &z, result);
+}
+
+void CustomReactionCoordinate::computeGradMatMul(const vector<Vec3>& x, const vector<Vec3>& z, vector<Vec3>& result) {
+    if (maxParticle >= (int) x.size())
+        throw OpenMMException("CustomReactionCoordinate: A group contains a particle index larger than the number of positions");
+    result.assign(x.size(), Vec3());
+    int numGroups = min(getNumGroups(), (int) (3*z.size()));
+    for (int component = 0; component < numGroups; component++) {
+        loadCoordinates(x, component);
+        double scale = z[component/3][component%3];
+        for (int i = 0; i < derivExpressions.size(); i++) {
+            int particle = particles[component*numParticlesPerGroup+derivIndex[i]/3];
+            result[particle][derivIndex[i]%3] += derivExpressions[i]->evaluate()*scale;
+        }
+    }
+}
+
+vector<Vec3> CustomReactionCoordinate::value(const vector<Vec3>& x) {
+    vector<Vec3> result;
+    computeValue(x, result);
+    return result;
+}
+
+vector<Vec3> CustomReactionCoordinate::gradMatMul(const vector<Vec3>& x, const vector<Vec3>& z) {
+    vector<Vec3> result;
+    computeGradMatMul(x, z, result);
+    return result;
+}
+
+double CustomReactionCoordinate::getBiasedEnergy(const vector<Vec3>& x, const vector<Vec3>& z) {
+    vector<Vec3> residual;
+    computeResidual(x, z, residual);
+    double energy = 0.0;
+    for (const Vec3& r : residual)
+        energy += 0.5*r.dot(r);
+    return energy;
+}
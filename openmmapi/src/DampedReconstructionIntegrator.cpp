@@ -27,6 +27,8 @@ DampedReconstructionIntegrator::DampedReconstructionIntegrator(double temperatur
     setGamma(gamma);
     setConstraintTolerance(1e-5);
     setRandomNumberSeed(0);
+    lastEnergy = 0.0;
+    needsSnapshot = false;
     setReactionCoordinate(rc);
     beta =  1./(8.3145*temperature/1000.);
 }
@@ -68,29 +70,34 @@ void DampedReconstructionIntegrator::setMacroscopicVariable(std::vector<Vec3> z)
 
 void DampedReconstructionIntegrator::setupSampler() {
 	context->updateContextState();
-	context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
-	prev_state = owner->getState(State::Positions | State::Forces | State::Energy);
+	lastEnergy = context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
+	context->saveSnapshot(lastEnergy);
+	needsSnapshot = false;
     std::srand( (unsigned)time( NULL ) );
 }
 
 void DampedReconstructionIntegrator::accepted(bool acc) {
-	if (acc) {
-		prev_state = owner->getState(State::Positions | State::Forces | State::Energy);
-	} else {
-		owner->setState(prev_state);
-		context->updateContextState();
-	}
+	// Accepting keeps the current state.  Restoring the snapshot may consume it, so either way
+	// step() saves a new one before the next proposal.
+
+	if (!acc && !needsSnapshot)
+		lastEnergy = context->restoreSnapshot();
+	needsSnapshot = true;
 }
 
 void DampedReconstructionIntegrator::step(int steps) {
 	if (context == NULL)
 	    throw OpenMMException("This Integrator is not bound to a context!");
+	if (needsSnapshot) {
+		context->saveSnapshot(lastEnergy);
+		needsSnapshot = false;
+	}
 
 	context->updateContextState();
     context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
 	for (int i = 0; i < steps; ++i) {
 	    kernel.getAs<IntegrateDampedReconstructionStepKernel>().execute(*context, *this);
         context->updateContextState();
-	    context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
+	    lastEnergy = context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
     }
 }
@@ -33,6 +33,8 @@
 #include "openmm/OpenMMException.h"
 #include "openmm/Platform.h"
 #include "openmm/VerletIntegrator.h"
+#include "openmm/kernels.h"
+#include "openmm/internal/ContextImpl.h"
 #include "lbfgs.h"
 #include <cmath>
 #include <sstream>
@@ -198,6 +200,16 @@ static int report(void *instance, const lbfgsfloatval_t *x, const lbfgsfloatval_
 void LocalEnergyMinimizer::minimize(Context& context, double tolerance, int maxIterations, MinimizationReporter* reporter) {
     const System& system = context.getSystem();
     int numParticles = system.getNumParticles();
+
+    // If the Platform provides its own implementation, use it.
+
+    const Platform& platform = context.getPlatform();
+    if (platform.supportsKernels({MinimizeKernel::Name()})) {
+        Kernel kernel = platform.createKernel(MinimizeKernel::Name(), context.getImpl());
+        kernel.getAs<MinimizeKernel>().initialize(system);
+        kernel.getAs<MinimizeKernel>().execute(context.getImpl(), tolerance, maxIterations, reporter);
+        return;
+    }
     double constraintTol = context.getIntegrator().getConstraintTolerance();
     double workingConstraintTol = std::max(1e-4, constraintTol);
     double k = 100/workingConstraintTol;
@@ -291,3 +303,29 @@ void LocalEnergyMinimizer::minimize(Context& context, double tolerance, int maxI
         context.applyConstraints(workingConstraintTol);
 }
 
+void LocalEnergyMinimizer::minimizeBatch(Context& context, vector<vector<Vec3> >& positions, vector<double>& energies, double tolerance, int maxIterations) {
+    energies.resize(positions.size());
+    if (positions.size() == 0)
+        return;
+
+    // If the Platform provides its own implementation, use it.
+
+    const Platform& platform = context.getPlatform();
+    if (platform.supportsKernels({MinimizeKernel::Name()})) {
+        Kernel kernel = platform.createKernel(MinimizeKernel::Name(), context.getImpl());
+        kernel.getAs<MinimizeKernel>().initialize(context.getSystem());
+        kernel.getAs<MinimizeKernel>().executeBatch(context.getImpl(), positions, energies, tolerance, maxIterations);
+        return;
+    }
+
+    // Minimize the conformations one at a time.
+
+    int groups = context.getIntegrator().getIntegrationForceGroups();
+    for (int i = 0; i < positions.size(); i++) {
+        context.setPositions(positions[i]);
+        minimize(context, tolerance, maxIterations);
+        State state = context.getState(State::Positions | State::Energy, false, groups);
+        positions[i] = state.getPositions();
+        energies[i] = state.getPotentialEnergy();
+    }
+}
@@ -44,7 +44,7 @@ using namespace std;
 
 NonbondedForce::NonbondedForce() : nonbondedMethod(NoCutoff), cutoffDistance(1.0), switchingDistance(-1.0), rfDielectric(78.3),
         ewaldErrorTol(5e-4), alpha(0.0), dalpha(0.0), useSwitchingFunction(false), useDispersionCorrection(true), exceptionsUsePeriodic(false), recipForceGroup(-1),
-        includeDirectSpace(true), nx(0), ny(0), nz(0), dnx(0), dny(0), dnz(0), numContexts(0) {
+        includeDirectSpace(true), nx(0), ny(0), nz(0), dnx(0), dny(0), dnz(0), pmeOrder(5), numContexts(0) {
 }
 
 NonbondedForce::NonbondedMethod NonbondedForce::getNonbondedMethod() const {
@@ -125,6 +125,16 @@ void NonbondedForce::setLJPMEParameters(double alpha, int nx, int ny, int nz) {
     this->dnz = nz;
 }
 
+int NonbondedForce::getPMEInterpolationOrder() const {
+    return pmeOrder;
+}
+
+void NonbondedForce::setPMEInterpolationOrder(int order) {
+    if (order != 4 && order != 5 && order != 6 && order != 8)
+        throw OpenMMException("NonbondedForce: PME interpolation order must be 4, 5, 6, or 8");
+    pmeOrder = order;
+}
+
 void NonbondedForce::getPMEParametersInContext(const Context& context, double& alpha, int& nx, int& ny, int& nz) const {
     dynamic_cast<const NonbondedForceImpl&>(getImplInContext(context)).getPMEParameters(alpha, nx, ny, nz);
 }
@@ -203,19 +203,25 @@ void NonbondedForceImpl::calcPMEParameters(const System& system, const Nonbonded
         system.getDefaultPeriodicBoxVectors(boxVectors[0], boxVectors[1], boxVectors[2]);
         double tol = force.getEwaldErrorTolerance();
         alpha = (1.0/force.getCutoffDistance())*std::sqrt(-log(2.0*tol));
+
+        // The interpolation error decreases as the grid spacing to the power of the interpolation order,
+        // so higher orders can use a coarser grid.
+
+        double spacingFactor = 3*pow(tol, 1.0/force.getPMEInterpolationOrder());
         if (lj) {
-            xsize = (int) ceil(alpha*boxVectors[0][0]/(3*pow(tol, 0.2)));
-            ysize = (int) ceil(alpha*boxVectors[1][1]/(3*pow(tol, 0.2)));
-            zsize = (int) ceil(alpha*boxVectors[2][2]/(3*pow(tol, 0.2)));
+            xsize = (int) ceil(alpha*boxVectors[0][0]/spacingFactor);
+            ysize = (int) ceil(alpha*boxVectors[1][1]/spacingFactor);
+            zsize = (int) ceil(alpha*boxVectors[2][2]/spacingFactor);
         }
         else {
-            xsize = (int) ceil(2*alpha*boxVectors[0][0]/(3*pow(tol, 0.2)));
-            ysize = (int) ceil(2*alpha*boxVectors[1][1]/(3*pow(tol, 0.2)));
-            zsize = (int) ceil(2*alpha*boxVectors[2][2]/(3*pow(tol, 0.2)));
+            xsize = (int) ceil(2*alpha*boxVectors[0][0]/spacingFactor);
+            ysize = (int) ceil(2*alpha*boxVectors[1][1]/spacingFactor);
+            zsize = (int) ceil(2*alpha*boxVectors[2][2]/spacingFactor);
         }
-        xsize = max(xsize, 6);
-        ysize = max(ysize, 6);
-        zsize = max(zsize, 6);
+        int minSize = max(6, force.getPMEInterpolationOrder()+1);
+        xsize = max(xsize, minSize);
+        ysize = max(ysize, minSize);
+        zsize = max(zsize, minSize);
     }
 }
 
@@ -0,0 +1,168 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/RandomWalkEnsembleIntegrator.h"
+#include "openmm/Context.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/ContextImpl.h"
+#include "openmm/kernels.h"
+#include <string>
+
+using namespace OpenMM;
+using std::string;
+using std::vector;
+
+RandomWalkEnsembleIntegrator::RandomWalkEnsembleIntegrator(int numChains, double temperature, double stepSize, double period) :
+        numChains(numChains), period(period), energiesValid(false) {
+    if (numChains < 1)
+        throw OpenMMException("RandomWalkEnsembleIntegrator: numChains must be at least 1");
+    setTemperature(temperature);
+    setStepSize(stepSize);
+    setConstraintTolerance(1e-5);
+    setRandomNumberSeed(0);
+}
+
+void RandomWalkEnsembleIntegrator::initialize(ContextImpl& contextRef) {
+    if (owner != NULL && &contextRef.getOwner() != owner)
+        throw OpenMMException("This Integrator is already bound to a context");
+    if (contextRef.getSystem().getNumConstraints() > 0)
+        throw OpenMMException("RandomWalkEnsembleIntegrator does not support systems with constraints");
+    context = &contextRef;
+    owner = &contextRef.getOwner();
+    kernel = context->getPlatform().createKernel(IntegrateRandomWalkEnsembleStepKernel::Name(), contextRef);
+    kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().initialize(contextRef.getSystem(), *this);
+    proposalEnergies.resize(numChains);
+    energiesValid = false;
+}
+
+void RandomWalkEnsembleIntegrator::cleanup() {
+    kernel = Kernel();
+}
+
+void RandomWalkEnsembleIntegrator::stateChanged(State::DataType changed) {
+    // The chains keep their own positions, so only changes that affect the energy function matter.
+
+    if (changed != State::Positions && changed != State::Velocities)
+        energiesValid = false;
+}
+
+vector<string> RandomWalkEnsembleIntegrator::getKernelNames() {
+    std::vector<std::string> names;
+    names.push_back(IntegrateRandomWalkEnsembleStepKernel::Name());
+    return names;
+}
+
+double RandomWalkEnsembleIntegrator::computeKineticEnergy() {
+    return kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().computeKineticEnergy(*context, *this);
+}
+
+bool RandomWalkEnsembleIntegrator::kineticEnergyRequiresForce() const {
+    return false;
+}
+
+void RandomWalkEnsembleIntegrator::checkChain(int chain) const {
+    if (context == NULL)
+        throw OpenMMException("This Integrator is not bound to a context!");
+    if (chain < 0 || chain >= numChains)
+        throw OpenMMException("RandomWalkEnsembleIntegrator: Illegal chain index");
+}
+
+void RandomWalkEnsembleIntegrator::setChainPositions(int chain, const vector<Vec3>& positions) {
+    checkChain(chain);
+    if (positions.size() != context->getSystem().getNumParticles())
+        throw OpenMMException("RandomWalkEnsembleIntegrator: The number of positions does not match the number of particles");
+    kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().setChainPositions(*context, chain, positions);
+    energiesValid = false;
+}
+
+void RandomWalkEnsembleIntegrator::getChainPositions(int chain, vector<Vec3>& positions) {
+    checkChain(chain);
+    kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().getChainPositions(*context, chain, positions);
+}
+
+double RandomWalkEnsembleIntegrator::getChainEnergy(int chain) {
+    checkChain(chain);
+    return kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().getChainEnergy(chain);
+}
+
+long long RandomWalkEnsembleIntegrator::getNumProposed() {
+    if (context == NULL)
+        throw OpenMMException("This Integrator is not bound to a context!");
+    return kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().getNumProposed();
+}
+
+long long RandomWalkEnsembleIntegrator::getNumAccepted(int chain) {
+    checkChain(chain);
+    return kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().getNumAccepted(chain);
+}
+
+double RandomWalkEnsembleIntegrator::getAcceptanceRate(int chain) {
+    long long proposed = getNumProposed();
+    if (proposed == 0)
+        return 0.0;
+    return getNumAccepted(chain)/(double) proposed;
+}
+
+void RandomWalkEnsembleIntegrator::resetStatistics() {
+    if (context == NULL)
+        throw OpenMMException("This Integrator is not bound to a context!");
+    kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>().resetStatistics();
+}
+
+void RandomWalkEnsembleIntegrator::calcChainEnergies(bool proposal) {
+    // Load each chain into the Context in turn and evaluate it with the platform's own force kernels.
+    // Only the energy is computed, and the Context's forces are left unchanged.
+
+    IntegrateRandomWalkEnsembleStepKernel& ensembleKernel = kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>();
+    for (int chain = 0; chain < numChains; chain++) {
+        ensembleKernel.loadChain(*context, chain, proposal);
+        proposalEnergies[chain] = context->calcForcesAndEnergy(false, true, getIntegrationForceGroups());
+    }
+}
+
+void RandomWalkEnsembleIntegrator::step(int steps) {
+    if (context == NULL)
+        throw OpenMMException("This Integrator is not bound to a context!");
+    IntegrateRandomWalkEnsembleStepKernel& ensembleKernel = kernel.getAs<IntegrateRandomWalkEnsembleStepKernel>();
+    context->updateContextState();
+    ensembleKernel.initializeChains(*context);
+    if (!energiesValid) {
+        calcChainEnergies(false);
+        ensembleKernel.setChainEnergies(proposalEnergies);
+        energiesValid = true;
+    }
+    for (int i = 0; i < steps; ++i) {
+        ensembleKernel.propose(*context, *this);
+        calcChainEnergies(true);
+        ensembleKernel.acceptOrReject(*context, *this, proposalEnergies);
+    }
+    ensembleKernel.loadChain(*context, 0, false);
+}
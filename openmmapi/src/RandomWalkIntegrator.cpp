@@ -22,6 +22,8 @@ RandomWalkIntegrator::RandomWalkIntegrator(double temperature, double stepSize,
     setStepSize(stepSize);
     setConstraintTolerance(1e-5);
     setRandomNumberSeed(0);
+    lastEnergy = 0.0;
+    needsSnapshot = false;
     _period = period;
 }
 
@@ -55,22 +57,32 @@ bool RandomWalkIntegrator::kineticEnergyRequiresForce() const {
 
 void RandomWalkIntegrator::setupSampler() {
 	context->updateContextState();
-	double energy = context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
-	prev_state = owner->getState(State::Positions | State::Energy);
+	lastEnergy = context->calcForcesAndEnergy(true, true, getIntegrationForceGroups());
+	context->saveSnapshot(lastEnergy);
+	needsSnapshot = false;
 }
 
 void RandomWalkIntegrator::accepted(bool acc) {
-	if (acc) {
-		prev_state = owner->getState(State::Positions | State::Energy);
-	} else {
-		owner->setState(prev_state);
-		context->updateContextState();
-	}
+	// The snapshot is kept inside the Platform, so neither case needs to build a State or
+	// transfer the coordinates through the public API.  Accepting keeps the current state, and
+	// rejecting restores the snapshot, including the time and periodic box vectors.  Platforms
+	// may restore it by exchanging buffers instead of copying them, which consumes it, so in
+	// either case the next call to step() saves a new one.  Until then the current state is the
+	// accepted one, so a further rejection has nothing to undo.  step() also calls
+	// updateContextState() before every step, so there is no need to call it here.
+
+	if (!acc && !needsSnapshot)
+		lastEnergy = context->restoreSnapshot();
+	needsSnapshot = true;
 }
 
 void RandomWalkIntegrator::step(int steps) {
 	if (context == NULL)
 	    throw OpenMMException("This Integrator is not bound to a context!");
+	if (needsSnapshot) {
+		context->saveSnapshot(lastEnergy);
+		needsSnapshot = false;
+	}
 
 	for (int i = 0; i < steps; ++i) {
 	    context->updateContextState();
@@ -78,7 +90,7 @@ void RandomWalkIntegrator::step(int steps) {
 	}
 
 	context->updateContextState();
-    context->calcForcesAndEnergy(false, true, getIntegrationForceGroups());
+    lastEnergy = context->calcForcesAndEnergy(false, true, getIntegrationForceGroups());
 }
 
 
@@ -7,6 +7,7 @@
 
 
 #include "openmm/ReactionCoordinate.h"
+#include <algorithm>
 
 using namespace OpenMM;
 
@@ -16,3 +17,17 @@ ReactionCoordinate::ReactionCoordinate() {
 ReactionCoordinate::~ReactionCoordinate() {
 }
 
+void ReactionCoordinate::computeValue(const std::vector<Vec3>& x, std::vector<Vec3>& result) {
+    result = value(x);
+}
+
+void ReactionCoordinate::computeResidual(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result) {
+    computeValue(x, result);
+    int size = std::min(result.size(), z.size());
+    for (int i = 0; i < size; i++)
+        result[i] -= z[i];
+}
+
+void ReactionCoordinate::computeGradMatMul(const std::vector<Vec3>& x, const std::vector<Vec3>& z, std::vector<Vec3>& result) {
+    result = gradMatMul(x, z);
+}
@@ -31,11 +31,22 @@
 
 #include "openmm/internal/ThreadPool.h"
 #include "openmm/internal/hardware.h"
+#include "openmm/internal/timer.h"
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace std;
 
 namespace OpenMM {
 
+/**
+ * The number of times a waiting thread checks whether it can continue before it blocks.
+ */
+static const int SPIN_COUNT = 1000;
+
 class ThreadPool::ThreadData {
 public:
     ThreadData(ThreadPool& owner, int index) : owner(owner), index(index), isDeleted(false) {
@@ -51,6 +62,12 @@ public:
     bool isDeleted;
     Task* currentTask;
     function<void (ThreadPool& pool, int)> currentFunction;
+    // The part of the range in parallelFor() that was assigned to this thread and has not yet been taken.
+    // It is padded to keep it on its own cache line, since other threads modify it when stealing work.
+    char padding1[64];
+    atomic<int> nextIndex;
+    int endIndex;
+    char padding2[64];
 };
 
 static void* threadBody(void* args) {
@@ -67,17 +84,43 @@ static void* threadBody(void* args) {
     return 0;
 }
 
-ThreadPool::ThreadPool(int numThreads) : currentTask(NULL) {
+#ifdef __linux__
+static void pinThread(thread& t, int index) {
+    // Bind the thread to one of the cores this process is allowed to run on.
+
+    cpu_set_t available;
+    if (sched_getaffinity(0, sizeof(available), &available) != 0)
+        return;
+    vector<int> cores;
+    for (int i = 0; i < CPU_SETSIZE; i++)
+        if (CPU_ISSET(i, &available))
+            cores.push_back(i);
+    if (cores.size() == 0)
+        return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cores[index%cores.size()], &cpus);
+    pthread_setaffinity_np(t.native_handle(), sizeof(cpus), &cpus);
+}
+#else
+static void pinThread(thread& t, int index) {
+}
+#endif
+
+ThreadPool::ThreadPool(int numThreads, bool pinThreads) : measureImbalance(false), lastArrivalTime(0.0), sumArrivalTime(0.0),
+        imbalanceTime(0.0), waitCount(0), generation(0), currentTask(NULL) {
     if (numThreads <= 0)
         numThreads = getNumProcessors();
     this->numThreads = numThreads;
+    useSpinWait = (numThreads <= getNumProcessors());
     unique_lock<mutex> ul(lock);
-    waitCount = 0;
     for (int i = 0; i < numThreads; i++) {
         ThreadData* data = new ThreadData(*this, i);
         data->isDeleted = false;
         threadData.push_back(data);
         threads.push_back(thread(threadBody, data));
+        if (pinThreads)
+            pinThread(threads[i], i);
     }
     while (waitCount < numThreads)
         endCondition.wait(ul);
@@ -87,6 +130,7 @@ ThreadPool::~ThreadPool() {
     for (auto data : threadData)
         data->isDeleted = true;
     lock.lock();
+    generation++;
     startCondition.notify_all();
     lock.unlock();
     for (auto &t : threads)
@@ -108,23 +152,84 @@ void ThreadPool::execute(function<void (ThreadPool&, int)> task) {
     resumeThreads();
 }
 
+void ThreadPool::parallelFor(int start, int end, int grainSize, function<void (ThreadPool&, int, int, int)> task) {
+    if (end <= start)
+        return;
+    grainSize = max(grainSize, 1);
+    long long total = end-start;
+    for (int i = 0; i < numThreads; i++) {
+        threadData[i]->nextIndex = start+(int) (total*i/numThreads);
+        threadData[i]->endIndex = start+(int) (total*(i+1)/numThreads);
+    }
+    execute([&] (ThreadPool& pool, int threadIndex) {
+        // Process this thread's own share first, then visit the other threads in turn and take
+        // whatever they have not started yet.
+
+        for (int i = 0; i < numThreads; i++) {
+            ThreadData& owner = *threadData[(threadIndex+i)%numThreads];
+            while (true) {
+                int chunkStart = owner.nextIndex.fetch_add(grainSize);
+                if (chunkStart >= owner.endIndex)
+                    break;
+                task(pool, threadIndex, chunkStart, min(chunkStart+grainSize, owner.endIndex));
+            }
+        }
+    });
+    waitForThreads();
+}
+
 void ThreadPool::syncThreads() {
-    unique_lock<mutex> ul(lock);
-    waitCount++;
-    endCondition.notify_one();
-    startCondition.wait(ul);
+    unsigned int currentGeneration;
+    {
+        unique_lock<mutex> ul(lock);
+        currentGeneration = generation;
+        if (measureImbalance) {
+            lastArrivalTime = getCurrentTime();
+            sumArrivalTime += lastArrivalTime;
+        }
+        waitCount++;
+        endCondition.notify_one();
+    }
+    if (useSpinWait)
+        for (int i = 0; i < SPIN_COUNT && generation == currentGeneration; i++)
+            this_thread::yield();
+    if (generation == currentGeneration) {
+        unique_lock<mutex> ul(lock);
+        while (generation == currentGeneration)
+            startCondition.wait(ul);
+    }
 }
 
 void ThreadPool::waitForThreads() {
-    unique_lock<mutex> ul(lock);
-    while (waitCount < numThreads)
-        endCondition.wait(ul);
+    if (useSpinWait)
+        for (int i = 0; i < SPIN_COUNT && waitCount < numThreads; i++)
+            this_thread::yield();
+    if (waitCount < numThreads) {
+        unique_lock<mutex> ul(lock);
+        while (waitCount < numThreads)
+            endCondition.wait(ul);
+    }
+    if (measureImbalance && sumArrivalTime > 0.0) {
+        imbalanceTime += lastArrivalTime-sumArrivalTime/numThreads;
+        sumArrivalTime = 0.0;
+    }
 }
 
 void ThreadPool::resumeThreads() {
     unique_lock<mutex> ul(lock);
     waitCount = 0;
+    generation++;
     startCondition.notify_all();
 }
 
+void ThreadPool::setImbalanceTimingEnabled(bool enabled) {
+    measureImbalance = enabled;
+    sumArrivalTime = 0.0;
+    imbalanceTime = 0.0;
+}
+
+double ThreadPool::getImbalanceTime() const {
+    return imbalanceTime;
+}
+
 } // namespace OpenMM
@@ -47,7 +47,7 @@ namespace OpenMM {
  */
 class CommonUpdateStateDataKernel : public UpdateStateDataKernel {
 public:
-    CommonUpdateStateDataKernel(std::string name, const Platform& platform, ComputeContext& cc) : UpdateStateDataKernel(name, platform), cc(cc) {
+    CommonUpdateStateDataKernel(std::string name, const Platform& platform, ComputeContext& cc) : UpdateStateDataKernel(name, platform), cc(cc), hasSnapshot(false) {
     }
     /**
      * Initialize the kernel.
@@ -152,8 +152,29 @@ public:
      * @param stream    an input stream the checkpoint data should be read from
      */
     void loadCheckpoint(ContextImpl& context, std::istream& stream);
+    /**
+     * Save the current positions, velocities, forces, time, and periodic box vectors so they can later be
+     * restored with restoreSnapshot().
+     *
+     * @param energy     the potential energy corresponding to the current positions
+     */
+    void saveSnapshot(ContextImpl& context, double energy);
+    /**
+     * Restore the positions, velocities, forces, time, and periodic box vectors saved by the most recent
+     * call to saveSnapshot().  The saved arrays are copied back on the
+     * device, and the snapshot is then considered consumed.
+     *
+     * @return the potential energy that was passed to saveSnapshot()
+     */
+    double restoreSnapshot(ContextImpl& context);
 private:
     ComputeContext& cc;
+    ComputeArray snapshotPositions, snapshotPositionCorrections, snapshotVelocities, snapshotLongForces, snapshotFloatForces;
+    std::vector<mm_int4> snapshotPosCellOffsets;
+    std::vector<int> snapshotAtomOrder;
+    Vec3 snapshotBoxVectors[3];
+    double snapshotEnergy, snapshotTime;
+    bool hasSnapshot;
 };
 
 /**
@@ -1259,6 +1280,17 @@ public:
      * @param innerContext2  the second context created by the ATMForce for computing displaced energy
      */
     void copyState(ContextImpl& context, ContextImpl& innerContext1, ContextImpl& innerContext2);
+    /**
+     * Compute the energies of the two inner contexts, and optionally their forces.
+     *
+     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
+     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
+     * @param includeForces  true if forces should be computed
+     * @param energy0        on exit, the potential energy of the first inner context
+     * @param energy1        on exit, the potential energy of the second inner context
+     */
+    void calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+                                    double& energy0, double& energy1);
     /**
      * Get the ComputeContext corresponding to the inner Context.
      */
@@ -393,6 +393,70 @@ void CommonUpdateStateDataKernel::loadCheckpoint(ContextImpl& context, istream&
     cc.validateAtomOrder();
 }
 
+void CommonUpdateStateDataKernel::saveSnapshot(ContextImpl& context, double energy) {
+    ContextSelector selector(cc);
+    if (!snapshotPositions.isInitialized()) {
+        snapshotPositions.initialize(cc, cc.getPaddedNumAtoms(), cc.getPosq().getElementSize(), "snapshotPositions");
+        if (cc.getUseMixedPrecision())
+            snapshotPositionCorrections.initialize(cc, cc.getPaddedNumAtoms(), cc.getPosqCorrection().getElementSize(), "snapshotPositionCorrections");
+        snapshotVelocities.initialize(cc, cc.getPaddedNumAtoms(), cc.getVelm().getElementSize(), "snapshotVelocities");
+        snapshotLongForces.initialize<long long>(cc, cc.getPaddedNumAtoms()*3, "snapshotLongForces");
+        try {
+            cc.getFloatForceBuffer(); // This will throw an exception on the CUDA platform.
+            snapshotFloatForces.initialize(cc, cc.getPaddedNumAtoms(), cc.getUseDoublePrecision() ? sizeof(mm_double4) : sizeof(mm_float4), "snapshotForces");
+        }
+        catch (...) {
+            // The CUDA platform doesn't have a floating point force buffer, so we don't need to copy it.
+        }
+    }
+    cc.getPosq().copyTo(snapshotPositions);
+    if (snapshotPositionCorrections.isInitialized())
+        cc.getPosqCorrection().copyTo(snapshotPositionCorrections);
+    cc.getVelm().copyTo(snapshotVelocities);
+    cc.getLongForceBuffer().copyTo(snapshotLongForces);
+    if (snapshotFloatForces.isInitialized())
+        cc.getFloatForceBuffer().copyTo(snapshotFloatForces);
+    snapshotPosCellOffsets = cc.getPosCellOffsets();
+    snapshotAtomOrder = cc.getAtomIndex();
+    cc.getPeriodicBoxVectors(snapshotBoxVectors[0], snapshotBoxVectors[1], snapshotBoxVectors[2]);
+    snapshotTime = cc.getTime();
+    snapshotEnergy = energy;
+    hasSnapshot = true;
+}
+
+double CommonUpdateStateDataKernel::restoreSnapshot(ContextImpl& context) {
+    if (!hasSnapshot)
+        throw OpenMMException("restoreSnapshot() was called without a saved snapshot");
+    hasSnapshot = false;
+    ContextSelector selector(cc);
+
+    // The context's arrays are bound as arguments to many kernels, so they cannot be exchanged with
+    // the saved ones.  The data is copied on the device instead.
+
+    snapshotPositions.copyTo(cc.getPosq());
+    if (snapshotPositionCorrections.isInitialized())
+        snapshotPositionCorrections.copyTo(cc.getPosqCorrection());
+    snapshotVelocities.copyTo(cc.getVelm());
+    snapshotLongForces.copyTo(cc.getLongForceBuffer());
+    if (snapshotFloatForces.isInitialized())
+        snapshotFloatForces.copyTo(cc.getFloatForceBuffer());
+    cc.setPosCellOffsets(snapshotPosCellOffsets);
+
+    // The saved positions and cell offsets already match the saved box, so the vectors are set
+    // directly instead of going through setPeriodicBoxVectors(), which would rewrap the positions.
+
+    for (auto ctx : cc.getAllContexts()) {
+        ctx->setPeriodicBoxVectors(snapshotBoxVectors[0], snapshotBoxVectors[1], snapshotBoxVectors[2]);
+        ctx->setTime(snapshotTime);
+    }
+
+    // The saved arrays are in the atom order that was current when the snapshot was taken.
+
+    if (cc.getAtomIndex() != snapshotAtomOrder)
+        cc.setAtomIndex(snapshotAtomOrder);
+    return snapshotEnergy;
+}
+
 void CommonApplyConstraintsKernel::initialize(const System& system) {
 }
 
@@ -3797,6 +3861,12 @@ void CommonCalcATMForceKernel::copyState(ContextImpl& context,
         innerContext1.setParameter(param.first, context.getParameter(param.first));
 }
 
+void CommonCalcATMForceKernel::calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+        double& energy0, double& energy1) {
+    energy0 = innerContext0.calcForcesAndEnergy(includeForces, true);
+    energy1 = innerContext1.calcForcesAndEnergy(includeForces, true);
+}
+
 void CommonCalcATMForceKernel::copyParametersToContext(ContextImpl& context, const ATMForce& force) {
     ContextSelector selector(cc);
     if (force.getNumParticles() != numParticles)
@@ -56,11 +56,22 @@ public:
      */
     void calculateForce(std::vector<OpenMM::Vec3>& atomCoordinates, std::vector<std::vector<double> >& parameters, std::vector<OpenMM::Vec3>& forces, 
             double* totalEnergy, ReferenceBondIxn& referenceBondIxn);
+    /**
+     * Compute the forces from all bonds, giving each thread its own interaction object.  This is needed
+     * when the interaction holds mutable state, such as the variables of compiled expressions, that
+     * cannot be shared between threads.
+     *
+     * @param threadBondIxn      one interaction object for each thread
+     * @param energyParamDerivs  if not NULL, derivatives of the energy with respect to global parameters are added to this
+     * @param numDerivs          the number of elements in energyParamDerivs
+     */
+    void calculateForce(std::vector<OpenMM::Vec3>& atomCoordinates, std::vector<std::vector<double> >& parameters, std::vector<OpenMM::Vec3>& forces,
+            double* totalEnergy, std::vector<ReferenceBondIxn*>& threadBondIxn, double* energyParamDerivs, int numDerivs);
     /**
      * This routine contains the code executed by each thread.
      */
     void threadComputeForce(ThreadPool& threads, int threadIndex, std::vector<OpenMM::Vec3>& atomCoordinates, std::vector<std::vector<double> >& parameters,
-            std::vector<OpenMM::Vec3>& forces, double* totalEnergy, ReferenceBondIxn& referenceBondIxn);
+            std::vector<OpenMM::Vec3>& forces, double* totalEnergy, ReferenceBondIxn& referenceBondIxn, double* energyParamDerivs=NULL);
 private:
     bool canAssignBond(int bond, int thread, std::vector<int>& atomThread);
     void assignBond(int bond, int thread, std::vector<int>& atomThread, std::vector<int>& bondThread, std::vector<std::set<int> >& atomBonds, std::list<int>& candidateBonds);
@@ -0,0 +1,158 @@
+#ifndef OPENMM_CPUCUSTOMBONDEDFORCE_H_
+#define OPENMM_CPUCUSTOMBONDEDFORCE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "CpuBondForce.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/ContextImpl.h"
+#include "lepton/CompiledExpression.h"
+#include "lepton/ParsedExpression.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class holds the data shared by the CPU kernels for CustomBondForce, CustomAngleForce, and
+ * CustomTorsionForce, and computes their forces with CpuBondForce.  The template argument is the
+ * Reference class that evaluates a single interaction.  Each thread gets its own instance of it,
+ * since compiled expressions cannot be shared between threads.
+ */
+template <class IXN>
+class CpuCustomBondedForce {
+public:
+    /**
+     * A function that retrieves the particles and per-bond parameters of one bond from a Force.
+     */
+    typedef std::function<void (int, std::vector<int>&, std::vector<double>&)> ParameterFunction;
+    ~CpuCustomBondedForce() {
+        for (auto ixn : threadIxn)
+            delete ixn;
+    }
+    /**
+     * Build the arrays of particles and parameters, and create the interaction objects.
+     *
+     * @param numAtoms               the number of particles in the System
+     * @param numBonds               the number of bonds
+     * @param numAtomsPerBond        the number of particles in each bond
+     * @param getParameters          retrieves the particles and parameters of a bond
+     * @param expression             the energy expression.  Its variables must already have been validated.
+     * @param variable               the variable the force is computed with respect to, such as "r" or "theta"
+     * @param parameterNames         the names of the per-bond parameters
+     * @param globalParameterNames   the names of the global parameters
+     * @param energyParamDerivNames  the names of the global parameters to compute energy derivatives for
+     * @param usePeriodic            whether to apply periodic boundary conditions
+     * @param threads                the thread pool to compute forces with
+     */
+    void initialize(int numAtoms, int numBonds, int numAtomsPerBond, ParameterFunction getParameters, const Lepton::ParsedExpression& expression,
+            const std::string& variable, const std::vector<std::string>& parameterNames, const std::vector<std::string>& globalParameterNames,
+            const std::vector<std::string>& energyParamDerivNames, bool usePeriodic, ThreadPool& threads) {
+        this->globalParameterNames = globalParameterNames;
+        this->energyParamDerivNames = energyParamDerivNames;
+        this->usePeriodic = usePeriodic;
+        bondIndexArray.resize(numBonds, std::vector<int>(numAtomsPerBond));
+        bondParamArray.resize(numBonds, std::vector<double>(parameterNames.size()));
+        for (int i = 0; i < numBonds; i++)
+            getParameters(i, bondIndexArray[i], bondParamArray[i]);
+        bondForce.initialize(numAtoms, numBonds, numAtomsPerBond, bondIndexArray, threads);
+        Lepton::CompiledExpression energyExpression = expression.createCompiledExpression();
+        Lepton::CompiledExpression forceExpression = expression.differentiate(variable).createCompiledExpression();
+        std::vector<Lepton::CompiledExpression> energyParamDerivExpressions;
+        for (auto& param : energyParamDerivNames)
+            energyParamDerivExpressions.push_back(expression.differentiate(param).createCompiledExpression());
+        for (int i = 0; i < threads.getNumThreads(); i++)
+            threadIxn.push_back(new IXN(energyExpression, forceExpression, parameterNames, energyParamDerivExpressions));
+    }
+    /**
+     * Compute the forces from all bonds, and add the energy derivatives to the context's.
+     *
+     * @param context            the context to get global parameter values from
+     * @param positions          the particle positions
+     * @param forces             the forces are added to this
+     * @param boxVectors         the periodic box vectors
+     * @param energyParamDerivs  the derivatives of the energy with respect to global parameters are added to this
+     * @param includeEnergy      whether to compute the energy
+     * @return the energy, or 0 if includeEnergy is false
+     */
+    double calculateForce(ContextImpl& context, std::vector<Vec3>& positions, std::vector<Vec3>& forces, Vec3* boxVectors,
+            std::map<std::string, double>& energyParamDerivs, bool includeEnergy) {
+        std::map<std::string, double> globalParameters;
+        for (auto& name : globalParameterNames)
+            globalParameters[name] = context.getParameter(name);
+        for (auto ixn : threadIxn) {
+            ixn->setGlobalParameters(globalParameters);
+            if (usePeriodic)
+                ixn->setPeriodic(boxVectors);
+        }
+        double energy = 0;
+        std::vector<ReferenceBondIxn*> ixns(threadIxn.begin(), threadIxn.end());
+        std::vector<double> energyParamDerivValues(energyParamDerivNames.size(), 0.0);
+        bondForce.calculateForce(positions, bondParamArray, forces, includeEnergy ? &energy : NULL, ixns, energyParamDerivValues.data(), energyParamDerivNames.size());
+        for (int i = 0; i < energyParamDerivNames.size(); i++)
+            energyParamDerivs[energyParamDerivNames[i]] += energyParamDerivValues[i];
+        return energy;
+    }
+    /**
+     * Copy changed per-bond parameters from a Force.  The particles in each bond must not have changed.
+     *
+     * @param firstBond      the index of the first bond to copy
+     * @param lastBond       the index of the last bond to copy
+     * @param getParameters  retrieves the particles and parameters of a bond
+     * @param bondName       the description of a bond in error messages, such as "a bond" or "an angle"
+     */
+    void copyParameters(int firstBond, int lastBond, ParameterFunction getParameters, const std::string& bondName) {
+        std::vector<int> atoms;
+        std::vector<double> params;
+        for (int i = firstBond; i <= lastBond; ++i) {
+            atoms.resize(bondIndexArray[i].size());
+            getParameters(i, atoms, params);
+            if (atoms != bondIndexArray[i])
+                throw OpenMMException("updateParametersInContext: The set of particles in "+bondName+" has changed");
+            bondParamArray[i] = params;
+        }
+    }
+private:
+    std::vector<std::vector<int> > bondIndexArray;
+    std::vector<std::vector<double> > bondParamArray;
+    CpuBondForce bondForce;
+    std::vector<IXN*> threadIxn;
+    std::vector<std::string> globalParameterNames, energyParamDerivNames;
+    bool usePeriodic;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_CPUCUSTOMBONDEDFORCE_H_*/
@@ -50,8 +50,13 @@ protected:
      */
     void calculateBlockIxn(ThreadData& data, int blockIndex, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize);
 
+    /**
+     * Calculate all the interactions for a group of BLOCK_SIZE atoms within one block of the neighbor list.
+     * 
+     * @param firstAtom       the index within the neighbor list block of the first atom in the group
+     */
     template <int PERIODIC_TYPE>
-    void calculateBlockIxnImpl(ThreadData& data, int blockIndex, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
+    void calculateBlockIxnImpl(ThreadData& data, int blockIndex, int firstAtom, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter);
 
     /**
      * Compute the displacement and squared distance between a collection of points, optionally using
@@ -63,62 +68,68 @@ protected:
 
 template<typename FVEC, int BLOCK_SIZE>
 void CpuCustomNonbondedForceFvec<FVEC, BLOCK_SIZE>::calculateBlockIxn(ThreadData& data, int blockIndex, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize) {
-    // Determine whether we need to apply periodic boundary conditions.
+    // The neighbor list may use larger blocks than the vector width, since it is shared with other forces.
+    // In that case, process each block as several groups of BLOCK_SIZE atoms.
 
-    PeriodicType periodicType;
-    fvec4 blockCenter;
-    if (!periodic) {
-        periodicType = NoPeriodic;
-        blockCenter = 0.0f;
-    }
-    else {
-        const int32_t* blockAtom = &neighborList->getSortedAtoms()[BLOCK_SIZE*blockIndex];
-        float minx, maxx, miny, maxy, minz, maxz;
-        minx = maxx = posq[4*blockAtom[0]];
-        miny = maxy = posq[4*blockAtom[0]+1];
-        minz = maxz = posq[4*blockAtom[0]+2];
-        for (int i = 1; i < BLOCK_SIZE; i++) {
-            minx = std::min(minx, posq[4*blockAtom[i]]);
-            maxx = std::max(maxx, posq[4*blockAtom[i]]);
-            miny = std::min(miny, posq[4*blockAtom[i]+1]);
-            maxy = std::max(maxy, posq[4*blockAtom[i]+1]);
-            minz = std::min(minz, posq[4*blockAtom[i]+2]);
-            maxz = std::max(maxz, posq[4*blockAtom[i]+2]);
-        }
-        blockCenter = fvec4(0.5f*(minx+maxx), 0.5f*(miny+maxy), 0.5f*(minz+maxz), 0.0f);
-        if (!(minx < cutoffDistance || miny < cutoffDistance || minz < cutoffDistance ||
-                maxx > boxSize[0]-cutoffDistance || maxy > boxSize[1]-cutoffDistance || maxz > boxSize[2]-cutoffDistance))
+    const int neighborBlockSize = neighborList->getBlockSize();
+    for (int firstAtom = 0; firstAtom < neighborBlockSize; firstAtom += BLOCK_SIZE) {
+        // Determine whether we need to apply periodic boundary conditions.
+
+        PeriodicType periodicType;
+        fvec4 blockCenter;
+        if (!periodic) {
             periodicType = NoPeriodic;
-        else if (triclinic)
-            periodicType = PeriodicTriclinic;
-        else if (0.5f*(boxSize[0]-(maxx-minx)) >= cutoffDistance &&
-                 0.5f*(boxSize[1]-(maxy-miny)) >= cutoffDistance &&
-                 0.5f*(boxSize[2]-(maxz-minz)) >= cutoffDistance)
-            periodicType = PeriodicPerAtom;
-        else
-            periodicType = PeriodicPerInteraction;
-    }
+            blockCenter = 0.0f;
+        }
+        else {
+            const int32_t* blockAtom = &neighborList->getSortedAtoms()[neighborBlockSize*blockIndex+firstAtom];
+            float minx, maxx, miny, maxy, minz, maxz;
+            minx = maxx = posq[4*blockAtom[0]];
+            miny = maxy = posq[4*blockAtom[0]+1];
+            minz = maxz = posq[4*blockAtom[0]+2];
+            for (int i = 1; i < BLOCK_SIZE; i++) {
+                minx = std::min(minx, posq[4*blockAtom[i]]);
+                maxx = std::max(maxx, posq[4*blockAtom[i]]);
+                miny = std::min(miny, posq[4*blockAtom[i]+1]);
+                maxy = std::max(maxy, posq[4*blockAtom[i]+1]);
+                minz = std::min(minz, posq[4*blockAtom[i]+2]);
+                maxz = std::max(maxz, posq[4*blockAtom[i]+2]);
+            }
+            blockCenter = fvec4(0.5f*(minx+maxx), 0.5f*(miny+maxy), 0.5f*(minz+maxz), 0.0f);
+            if (!(minx < cutoffDistance || miny < cutoffDistance || minz < cutoffDistance ||
+                    maxx > boxSize[0]-cutoffDistance || maxy > boxSize[1]-cutoffDistance || maxz > boxSize[2]-cutoffDistance))
+                periodicType = NoPeriodic;
+            else if (triclinic)
+                periodicType = PeriodicTriclinic;
+            else if (0.5f*(boxSize[0]-(maxx-minx)) >= cutoffDistance &&
+                     0.5f*(boxSize[1]-(maxy-miny)) >= cutoffDistance &&
+                     0.5f*(boxSize[2]-(maxz-minz)) >= cutoffDistance)
+                periodicType = PeriodicPerAtom;
+            else
+                periodicType = PeriodicPerInteraction;
+        }
 
-    // Call the appropriate version depending on what calculation is required for periodic boundary conditions.
-
-    if (!cutoff)
-        calculateBlockIxnImpl<NoCutoff>(data, blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
-    else if (periodicType == NoPeriodic)
-        calculateBlockIxnImpl<NoPeriodic>(data, blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
-    else if (periodicType == PeriodicPerAtom)
-        calculateBlockIxnImpl<PeriodicPerAtom>(data, blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
-    else if (periodicType == PeriodicPerInteraction)
-        calculateBlockIxnImpl<PeriodicPerInteraction>(data, blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
-    else if (periodicType == PeriodicTriclinic)
-        calculateBlockIxnImpl<PeriodicTriclinic>(data, blockIndex, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+        // Call the appropriate version depending on what calculation is required for periodic boundary conditions.
+
+        if (!cutoff)
+            calculateBlockIxnImpl<NoCutoff>(data, blockIndex, firstAtom, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+        else if (periodicType == NoPeriodic)
+            calculateBlockIxnImpl<NoPeriodic>(data, blockIndex, firstAtom, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+        else if (periodicType == PeriodicPerAtom)
+            calculateBlockIxnImpl<PeriodicPerAtom>(data, blockIndex, firstAtom, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+        else if (periodicType == PeriodicPerInteraction)
+            calculateBlockIxnImpl<PeriodicPerInteraction>(data, blockIndex, firstAtom, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+        else if (periodicType == PeriodicTriclinic)
+            calculateBlockIxnImpl<PeriodicTriclinic>(data, blockIndex, firstAtom, forces, totalEnergy, boxSize, invBoxSize, blockCenter);
+    }
 }
 
 template<typename FVEC, int BLOCK_SIZE>
 template <int PERIODIC_TYPE>
-void CpuCustomNonbondedForceFvec<FVEC, BLOCK_SIZE>::calculateBlockIxnImpl(ThreadData& data, int blockIndex, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
+void CpuCustomNonbondedForceFvec<FVEC, BLOCK_SIZE>::calculateBlockIxnImpl(ThreadData& data, int blockIndex, int firstAtom, float* forces, double& totalEnergy, const fvec4& boxSize, const fvec4& invBoxSize, const fvec4& blockCenter) {
     // Load the positions and parameters of the atoms in the block.
 
-    const int32_t* blockAtom = &neighborList->getSortedAtoms()[BLOCK_SIZE*blockIndex];
+    const int32_t* blockAtom = &neighborList->getSortedAtoms()[neighborList->getBlockSize()*blockIndex+firstAtom];
     fvec4 blockAtomPosq[BLOCK_SIZE];
     FVEC blockAtomForceX(0.0f), blockAtomForceY(0.0f), blockAtomForceZ(0.0f);
     FVEC blockAtomX, blockAtomY, blockAtomZ, blockAtomCharge;
@@ -159,7 +170,7 @@ void CpuCustomNonbondedForceFvec<FVEC, BLOCK_SIZE>::calculateBlockIxnImpl(Thread
         if (PERIODIC_TYPE == PeriodicPerAtom)
             atomPos -= floor((atomPos-blockCenter)*invBoxSize+0.5f)*boxSize;
         getDeltaR<PERIODIC_TYPE>(atomPos, blockAtomX, blockAtomY, blockAtomZ, dx, dy, dz, r2, boxSize, invBoxSize);
-        auto include = FVEC::expandBitsToMask(~neighbors.getExclusions());
+        auto include = FVEC::expandBitsToMask(~(neighbors.getExclusions()>>firstAtom));
         if (PERIODIC_TYPE != NoCutoff)
             include = blendZero(r2 < cutoffDistanceSquared, include);
         if (!any(include))
@@ -0,0 +1,78 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CPU_DAMPED_RECONSTRUCTION_DYNAMICS_H__
+#define __CPU_DAMPED_RECONSTRUCTION_DYNAMICS_H__
+
+#include "ReferenceDampedReconstructionDynamics.h"
+#include "CpuOverdampedUpdater.h"
+
+namespace OpenMM {
+
+/**
+ * This class performs the damped, biased Brownian update of DampedReconstructionIntegrator,
+ * dividing the particles between the threads of a ThreadPool.
+ */
+class CpuDampedReconstructionDynamics : public ReferenceDampedReconstructionDynamics {
+public:
+    /**
+     * Constructor.
+     *
+     * @param numberOfAtoms  number of atoms
+     * @param deltaT         delta t for dynamics
+     * @param temperature    temperature
+     * @param rc             the reaction coordinate
+     * @param lambda         strength of the biasing potential
+     * @param gamma          the damping coefficient
+     * @param threads        thread pool for parallelizing computation
+     * @param random         random number generator
+     */
+    CpuDampedReconstructionDynamics(int numberOfAtoms, double deltaT, double temperature, ReactionCoordinate* rc, double lambda, double gamma,
+                                    OpenMM::ThreadPool& threads, OpenMM::CpuRandom& random);
+
+    /**
+     * Destructor.
+     */
+    ~CpuDampedReconstructionDynamics();
+
+    /**
+     * Perform one step of damped, biased Brownian dynamics.
+     *
+     * @param system              the System to be integrated
+     * @param atomCoordinates     atom coordinates
+     * @param velocities          velocities
+     * @param forces              forces
+     * @param masses              atom masses
+     * @param tolerance           the constraint tolerance
+     */
+    void update(const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
+                std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance);
+
+private:
+    CpuOverdampedUpdater updater;
+};
+
+} // namespace OpenMM
+
+#endif // __CPU_DAMPED_RECONSTRUCTION_DYNAMICS_H__
@@ -0,0 +1,77 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CPU_INDIRECT_RECONSTRUCTION_DYNAMICS_H__
+#define __CPU_INDIRECT_RECONSTRUCTION_DYNAMICS_H__
+
+#include "ReferenceIndirectReconstructionDynamics.h"
+#include "CpuOverdampedUpdater.h"
+
+namespace OpenMM {
+
+/**
+ * This class performs the biased Brownian update of IndirectReconstructionIntegrator,
+ * dividing the particles between the threads of a ThreadPool.
+ */
+class CpuIndirectReconstructionDynamics : public ReferenceIndirectReconstructionDynamics {
+public:
+    /**
+     * Constructor.
+     *
+     * @param numberOfAtoms  number of atoms
+     * @param deltaT         delta t for dynamics
+     * @param temperature    temperature
+     * @param rc             the reaction coordinate
+     * @param lambda         strength of the biasing potential
+     * @param threads        thread pool for parallelizing computation
+     * @param random         random number generator
+     */
+    CpuIndirectReconstructionDynamics(int numberOfAtoms, double deltaT, double temperature, ReactionCoordinate* rc, double lambda,
+                                      OpenMM::ThreadPool& threads, OpenMM::CpuRandom& random);
+
+    /**
+     * Destructor.
+     */
+    ~CpuIndirectReconstructionDynamics();
+
+    /**
+     * Perform one step of biased Brownian dynamics.
+     *
+     * @param system              the System to be integrated
+     * @param atomCoordinates     atom coordinates
+     * @param velocities          velocities
+     * @param forces              forces
+     * @param masses              atom masses
+     * @param tolerance           the constraint tolerance
+     */
+    void update(const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
+                std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance);
+
+private:
+    CpuOverdampedUpdater updater;
+};
+
+} // namespace OpenMM
+
+#endif // __CPU_INDIRECT_RECONSTRUCTION_DYNAMICS_H__
@@ -33,20 +33,36 @@
  * -------------------------------------------------------------------------- */
 
 #include "CpuBondForce.h"
+#include "CpuBrownianDynamics.h"
+#include "CpuCustomBondedForce.h"
+#include "CpuCustomDynamics.h"
 #include "CpuCustomGBForce.h"
 #include "CpuCustomManyParticleForce.h"
 #include "CpuCustomNonbondedForce.h"
+#include "CpuDampedReconstructionDynamics.h"
 #include "CpuGayBerneForce.h"
 #include "CpuGBSAOBCForce.h"
+#include "CpuIndirectReconstructionDynamics.h"
 #include "CpuLangevinMiddleDynamics.h"
+#include "CpuMinimizer.h"
 #include "CpuNeighborList.h"
+#include "CpuNoseHooverDynamics.h"
 #include "CpuNonbondedForce.h"
 #include "CpuPlatform.h"
+#include "CpuRandomWalkDynamics.h"
+#include "CpuVariableStochasticDynamics.h"
+#include "CpuVariableVerletDynamics.h"
+#include "CpuVerletDynamics.h"
+#include "ReferenceCMAPTorsionIxn.h"
+#include "ReferenceCustomAngleIxn.h"
+#include "ReferenceCustomBondIxn.h"
+#include "ReferenceCustomTorsionIxn.h"
 #include "ReferenceKernels.h"
 #include "openmm/kernels.h"
 #include "openmm/System.h"
 #include "openmm/internal/CustomNonbondedForceImpl.h"
 #include <array>
+#include <set>
 #include <tuple>
 
 namespace OpenMM {
@@ -93,7 +109,6 @@ public:
 private:
     CpuPlatform::PlatformData& data;
     Kernel referenceKernel;
-    std::vector<Vec3> lastPositions;
 };
 
 /**
@@ -121,6 +136,164 @@ private:
     CpuPlatform::PlatformData& data;
 };
 
+/**
+ * This kernel computes the forces in a Context.  Forces that are computed by single threaded reference kernels
+ * are evaluated on a separate thread, concurrently with the forces whose CPU kernels use the main thread pool.
+ */
+class CpuScheduleForcesKernel : public ScheduleForcesKernel {
+public:
+    CpuScheduleForcesKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : ScheduleForcesKernel(name, platform),
+            data(data), helperThread(NULL) {
+    }
+    ~CpuScheduleForcesKernel();
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     */
+    void initialize(const System& system);
+    /**
+     * Compute the forces and energies of a set of ForceImpls.
+     *
+     * @param context       the context in which to execute this kernel
+     * @param forceImpls    the ForceImpls to compute
+     * @param includeForce  true if forces should be computed
+     * @param includeEnergy true if potential energy should be computed
+     * @param groups        a set of bit flags for which force groups to include
+     * @return the sum of the energies returned by the ForceImpls
+     */
+    double execute(ContextImpl& context, const std::vector<ForceImpl*>& forceImpls, bool includeForce, bool includeEnergy, int groups);
+private:
+    CpuPlatform::PlatformData& data;
+    std::set<std::string> serialKernels, threadedKernels;
+    ThreadPool* helperThread;
+    std::vector<Vec3> helperForces;
+    std::map<std::string, double> helperParamDerivs;
+};
+
+/**
+ * This kernel performs local energy minimization directly on the Context's position and force arrays.
+ */
+class CpuMinimizeKernel : public MinimizeKernel {
+public:
+    CpuMinimizeKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : MinimizeKernel(name, platform),
+            data(data), minimizer(NULL) {
+    }
+    ~CpuMinimizeKernel();
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     */
+    void initialize(const System& system);
+    /**
+     * Search for a new set of particle positions that represent a local potential energy minimum.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param tolerance      the RMS force (in kJ/mol/nm) at which to halt minimization
+     * @param maxIterations  the maximum number of iterations to perform, or 0 for no limit
+     * @param reporter       an optional MinimizationReporter to invoke after each iteration
+     */
+    void execute(ContextImpl& context, double tolerance, int maxIterations, MinimizationReporter* reporter);
+    /**
+     * Minimize a batch of conformations of the System.  Each thread minimizes different conformations
+     * in its own single threaded Context.  These are obtained from PlatformData::getWorkerContexts(),
+     * so they are reused by later calls.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param positions      on input, the initial positions of each conformation.  On exit, the minimized positions.
+     * @param energies       on exit, the potential energy of each minimized conformation
+     * @param tolerance      the RMS force (in kJ/mol/nm) at which to halt minimization
+     * @param maxIterations  the maximum number of iterations to perform for each conformation, or 0 for no limit
+     */
+    void executeBatch(ContextImpl& context, std::vector<std::vector<Vec3> >& positions, std::vector<double>& energies, double tolerance, int maxIterations);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuMinimizer* minimizer;
+};
+
+/**
+ * This kernel is invoked by HarmonicBondForce to calculate the forces acting on the system and the energy of the system.
+ */
+class CpuCalcHarmonicBondForceKernel : public CalcHarmonicBondForceKernel {
+public:
+    CpuCalcHarmonicBondForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcHarmonicBondForceKernel(name, platform), data(data), usePeriodic(false) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the HarmonicBondForce this kernel will be used for
+     */
+    void initialize(const System& system, const HarmonicBondForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the HarmonicBondForce to copy the parameters from
+     * @param firstBond the index of the first bond whose parameters might have changed
+     * @param lastBond  the index of the last bond whose parameters might have changed
+     */
+    void copyParametersToContext(ContextImpl& context, const HarmonicBondForce& force, int firstBond, int lastBond);
+private:
+    CpuPlatform::PlatformData& data;
+    int numBonds;
+    std::vector<std::vector<int> > bondIndexArray;
+    std::vector<std::vector<double> > bondParamArray;
+    CpuBondForce bondForce;
+    bool usePeriodic;
+};
+
+/**
+ * This kernel is invoked by CustomBondForce to calculate the forces acting on the system and the energy of the system.
+ * Each thread evaluates its share of the bonds with its own copy of the compiled expressions.
+ */
+class CpuCalcCustomBondForceKernel : public CalcCustomBondForceKernel {
+public:
+    CpuCalcCustomBondForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCustomBondForceKernel(name, platform), data(data) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CustomBondForce this kernel will be used for
+     */
+    void initialize(const System& system, const CustomBondForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CustomBondForce to copy the parameters from
+     * @param firstBond the index of the first bond whose parameters might have changed
+     * @param lastBond  the index of the last bond whose parameters might have changed
+     */
+    void copyParametersToContext(ContextImpl& context, const CustomBondForce& force, int firstBond, int lastBond);
+private:
+    CpuPlatform::PlatformData& data;
+    int numBonds;
+    CpuCustomBondedForce<ReferenceCustomBondIxn> bondForce;
+};
+
 /**
  * This kernel is invoked by HarmonicAngleForce to calculate the forces acting on the system and the energy of the system.
  */
@@ -161,6 +334,46 @@ private:
     bool usePeriodic;
 };
 
+/**
+ * This kernel is invoked by CustomAngleForce to calculate the forces acting on the system and the energy of the system.
+ * Each thread evaluates its share of the angles with its own copy of the compiled expressions.
+ */
+class CpuCalcCustomAngleForceKernel : public CalcCustomAngleForceKernel {
+public:
+    CpuCalcCustomAngleForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCustomAngleForceKernel(name, platform), data(data) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CustomAngleForce this kernel will be used for
+     */
+    void initialize(const System& system, const CustomAngleForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CustomAngleForce to copy the parameters from
+     * @param firstAngle the index of the first angle whose parameters might have changed
+     * @param lastAngle  the index of the last angle whose parameters might have changed
+     */
+    void copyParametersToContext(ContextImpl& context, const CustomAngleForce& force, int firstAngle, int lastAngle);
+private:
+    CpuPlatform::PlatformData& data;
+    int numAngles;
+    CpuCustomBondedForce<ReferenceCustomAngleIxn> angleForce;
+};
+
 /**
  * This kernel is invoked by PeriodicTorsionForce to calculate the forces acting on the system and the energy of the system.
  */
@@ -243,6 +456,89 @@ private:
     bool usePeriodic;
 };
 
+/**
+ * This kernel is invoked by CMAPTorsionForce to calculate the forces acting on the system and the energy of the system.
+ */
+class CpuCalcCMAPTorsionForceKernel : public CalcCMAPTorsionForceKernel {
+public:
+    CpuCalcCMAPTorsionForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCMAPTorsionForceKernel(name, platform), data(data), ixn(NULL), usePeriodic(false) {
+    }
+    ~CpuCalcCMAPTorsionForceKernel();
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CMAPTorsionForce this kernel will be used for
+     */
+    void initialize(const System& system, const CMAPTorsionForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CMAPTorsionForce to copy the parameters from
+     */
+    void copyParametersToContext(ContextImpl& context, const CMAPTorsionForce& force);
+private:
+    CpuPlatform::PlatformData& data;
+    std::vector<std::vector<std::vector<double> > > coeff;
+    std::vector<int> torsionMaps;
+    std::vector<std::vector<int> > torsionIndices;
+    std::vector<std::vector<double> > torsionParamArray;
+    CpuBondForce bondForce;
+    ReferenceCMAPTorsionIxn* ixn;
+    bool usePeriodic;
+};
+
+/**
+ * This kernel is invoked by CustomTorsionForce to calculate the forces acting on the system and the energy of the system.
+ * Each thread evaluates its share of the torsions with its own copy of the compiled expressions.
+ */
+class CpuCalcCustomTorsionForceKernel : public CalcCustomTorsionForceKernel {
+public:
+    CpuCalcCustomTorsionForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCustomTorsionForceKernel(name, platform), data(data) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CustomTorsionForce this kernel will be used for
+     */
+    void initialize(const System& system, const CustomTorsionForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CustomTorsionForce to copy the parameters from
+     * @param firstTorsion the index of the first torsion whose parameters might have changed
+     * @param lastTorsion  the index of the last torsion whose parameters might have changed
+     */
+    void copyParametersToContext(ContextImpl& context, const CustomTorsionForce& force, int firstTorsion, int lastTorsion);
+private:
+    CpuPlatform::PlatformData& data;
+    int numTorsions;
+    CpuCustomBondedForce<ReferenceCustomTorsionIxn> torsionForce;
+};
+
 /**
  * This kernel is invoked by NonbondedForce to calculate the forces acting on the system.
  */
@@ -306,7 +602,7 @@ private:
     std::vector<std::vector<double> > bonded14ParamArray;
     std::map<int, int> nb14Index;
     double nonbondedCutoff, switchingDistance, rfDielectric, ewaldAlpha, ewaldDispersionAlpha, ewaldSelfEnergy, dispersionCoefficient;
-    int kmax[3], gridSize[3], dispersionGridSize[3];
+    int kmax[3], gridSize[3], dispersionGridSize[3], pmeOrder;
     bool useSwitchingFunction, exceptionsArePeriodic, useOptimizedPme, hasInitializedPme, hasInitializedDispersionPme, hasParticleOffsets, hasExceptionOffsets;
     std::vector<std::set<int> > exclusions;
     std::vector<std::pair<float, float> > particleParams;
@@ -505,6 +801,107 @@ private:
     NonbondedMethod nonbondedMethod;
 };
 
+/**
+ * This kernel is invoked by CustomCentroidBondForce to calculate the forces acting on the system and the energy of the system.
+ * Group centers are computed in parallel, the bonds are divided between threads with the groups playing
+ * the role of atoms, and the resulting group forces are distributed back to atoms in parallel.
+ */
+class CpuCalcCustomCentroidBondForceKernel : public CalcCustomCentroidBondForceKernel {
+public:
+    CpuCalcCustomCentroidBondForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCustomCentroidBondForceKernel(name, platform), data(data), usePeriodic(false), boxVectors(NULL) {
+    }
+    ~CpuCalcCustomCentroidBondForceKernel();
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CustomCentroidBondForce this kernel will be used for
+     */
+    void initialize(const System& system, const CustomCentroidBondForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CustomCentroidBondForce to copy the parameters from
+     */
+    void copyParametersToContext(ContextImpl& context, const CustomCentroidBondForce& force);
+private:
+    void createInteraction(const CustomCentroidBondForce& force);
+    void deleteInteraction();
+    CpuPlatform::PlatformData& data;
+    int numBonds;
+    std::vector<std::vector<int> > groupAtoms;
+    std::vector<std::vector<double> > normalizedWeights;
+    std::vector<std::vector<int> > bondGroups;
+    std::vector<std::vector<double> > bondParamArray;
+    std::vector<int> groupedAtoms;
+    std::vector<std::vector<std::pair<int, double> > > atomGroupWeights;
+    std::vector<Vec3> groupCenters, groupForces;
+    CpuBondForce bondForce;
+    std::vector<ReferenceCustomCentroidBondIxn*> threadIxn;
+    std::vector<std::string> globalParameterNames, energyParamDerivNames;
+    std::map<std::string, int> tabulatedFunctionUpdateCount;
+    bool usePeriodic;
+    Vec3* boxVectors;
+};
+
+/**
+ * This kernel is invoked by CustomCompoundBondForce to calculate the forces acting on the system and the energy of the system.
+ */
+class CpuCalcCustomCompoundBondForceKernel : public CalcCustomCompoundBondForceKernel {
+public:
+    CpuCalcCustomCompoundBondForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) :
+            CalcCustomCompoundBondForceKernel(name, platform), data(data), usePeriodic(false), boxVectors(NULL) {
+    }
+    ~CpuCalcCustomCompoundBondForceKernel();
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param force      the CustomCompoundBondForce this kernel will be used for
+     */
+    void initialize(const System& system, const CustomCompoundBondForce& force);
+    /**
+     * Execute the kernel to calculate the forces and/or energy.
+     *
+     * @param context        the context in which to execute this kernel
+     * @param includeForces  true if forces should be calculated
+     * @param includeEnergy  true if the energy should be calculated
+     * @return the potential energy due to the force
+     */
+    double execute(ContextImpl& context, bool includeForces, bool includeEnergy);
+    /**
+     * Copy changed parameters over to a context.
+     *
+     * @param context    the context to copy parameters to
+     * @param force      the CustomCompoundBondForce to copy the parameters from
+     */
+    void copyParametersToContext(ContextImpl& context, const CustomCompoundBondForce& force);
+private:
+    void createInteraction(const CustomCompoundBondForce& force);
+    void deleteInteraction();
+    CpuPlatform::PlatformData& data;
+    int numBonds;
+    std::vector<std::vector<int> > bondParticles;
+    std::vector<std::vector<double> > bondParamArray;
+    CpuBondForce bondForce;
+    std::vector<ReferenceCustomCompoundBondIxn*> threadIxn;
+    std::vector<std::string> globalParameterNames, energyParamDerivNames;
+    std::map<std::string, int> tabulatedFunctionUpdateCount;
+    bool usePeriodic;
+    Vec3* boxVectors;
+};
+
 /**
  * This kernel is invoked by GayBerneForce to calculate the forces acting on the system.
  */
@@ -541,6 +938,287 @@ private:
     CpuGayBerneForce* ixn;
 };
 
+/**
+ * This kernel is invoked by ATMForce to calculate the forces acting on the system and the energy of the system.
+ * The threads are divided between the two inner contexts, which are evaluated concurrently.  When threads are
+ * pinned to cores, both halves would be pinned to the same cores, so each inner context instead gets all the
+ * threads and they are evaluated one after the other.
+ */
+class CpuCalcATMForceKernel : public ReferenceCalcATMForceKernel {
+public:
+    CpuCalcATMForceKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : ReferenceCalcATMForceKernel(name, platform),
+            data(data), threads(2), concurrent(false) {
+    }
+    /**
+     * Compute the energies of the two inner contexts, and optionally their forces.
+     *
+     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
+     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
+     * @param includeForces  true if forces should be computed
+     * @param energy0        on exit, the potential energy of the first inner context
+     * @param energy1        on exit, the potential energy of the second inner context
+     */
+    void calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+                                    double& energy0, double& energy1);
+    /**
+     * Create one of the inner contexts.
+     *
+     * @param context          the context in which to execute this kernel
+     * @param innerSystem      the System for the inner context
+     * @param innerIntegrator  the Integrator for the inner context
+     * @param index            the index of the inner context to create (0 or 1)
+     * @return the newly created Context, or NULL to use a context linked to the main one
+     */
+    Context* createInnerContext(ContextImpl& context, const System& innerSystem, Integrator& innerIntegrator, int index);
+private:
+    CpuPlatform::PlatformData& data;
+    ThreadPool threads;
+    bool concurrent;
+};
+
+/**
+ * This kernel is invoked by MonteCarloBarostat and related barostats to adjust the periodic box volume.
+ * Molecules are scaled in parallel, the same displacements are applied to the positions the neighbor
+ * list was built from so small volume changes do not force it to be rebuilt, and rejected steps are
+ * undone by swapping buffers rather than copying.
+ */
+class CpuApplyMonteCarloBarostatKernel : public ApplyMonteCarloBarostatKernel {
+public:
+    CpuApplyMonteCarloBarostatKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : ApplyMonteCarloBarostatKernel(name, platform),
+            data(data), hasInitializedMolecules(false) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param barostat   the MonteCarloBarostat this kernel will be used for
+     * @param rigidMolecules  whether molecules should be kept rigid while scaling coordinates
+     */
+    void initialize(const System& system, const Force& barostat, bool rigidMolecules=true);
+    /**
+     * Save the coordinates before attempting a Monte Carlo step.  This allows us to restore them
+     * if the step is rejected.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    void saveCoordinates(ContextImpl& context);
+    /**
+     * Attempt a Monte Carlo step, scaling particle positions (or cluster centers) by a specified value.
+     * This version scales the x, y, and z positions independently.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param scaleX     the scale factor by which to multiply particle x-coordinate
+     * @param scaleY     the scale factor by which to multiply particle y-coordinate
+     * @param scaleZ     the scale factor by which to multiply particle z-coordinate
+     */
+    void scaleCoordinates(ContextImpl& context, double scaleX, double scaleY, double scaleZ);
+    /**
+     * Reject the most recent Monte Carlo step, restoring the particle positions to where they were when
+     * saveCoordinates() was last called.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    void restoreCoordinates(ContextImpl& context);
+private:
+    CpuPlatform::PlatformData& data;
+    bool rigidMolecules, hasInitializedMolecules;
+    std::vector<std::vector<int> > molecules;
+    std::vector<Vec3> savedPositions, moleculeOffsets;
+    Vec3 savedBoxVectors[3];
+    double savedDrift, inverseDrift;
+    int savedNumBuilds;
+};
+
+/**
+ * This kernel is invoked by VerletIntegrator to take one time step.
+ */
+class CpuIntegrateVerletStepKernel : public IntegrateVerletStepKernel {
+public:
+    CpuIntegrateVerletStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateVerletStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateVerletStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the VerletIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const VerletIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VerletIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const VerletIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VerletIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const VerletIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuVerletDynamics* dynamics;
+    std::vector<double> masses;
+    double prevStepSize;
+};
+
+/**
+ * This kernel is invoked by NoseHooverIntegrator to take one time step.  The chain propagation is
+ * inherited from the reference implementation, while the particle updates are divided between threads.
+ */
+class CpuIntegrateNoseHooverStepKernel : public ReferenceIntegrateNoseHooverStepKernel {
+public:
+    CpuIntegrateNoseHooverStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, ReferencePlatform::PlatformData& refData) :
+            ReferenceIntegrateNoseHooverStepKernel(name, platform, refData), cpuData(data) {
+    }
+protected:
+    ReferenceNoseHooverDynamics* createDynamics(ContextImpl& context, double stepSize);
+private:
+    CpuPlatform::PlatformData& cpuData;
+};
+
+/**
+ * This kernel is invoked by BrownianIntegrator to take one time step.
+ */
+class CpuIntegrateBrownianStepKernel : public IntegrateBrownianStepKernel {
+public:
+    CpuIntegrateBrownianStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateBrownianStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateBrownianStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the BrownianIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const BrownianIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the BrownianIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const BrownianIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the BrownianIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const BrownianIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuBrownianDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevFriction, prevStepSize;
+};
+
+/**
+ * This kernel is invoked by VariableVerletIntegrator to take one time step.
+ */
+class CpuIntegrateVariableVerletStepKernel : public IntegrateVariableVerletStepKernel {
+public:
+    CpuIntegrateVariableVerletStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateVariableVerletStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateVariableVerletStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the VariableVerletIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const VariableVerletIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VariableVerletIntegrator this kernel is being used for
+     * @param maxTime    the maximum time beyond which the simulation should not be advanced
+     * @return the size of the step that was taken
+     */
+    double execute(ContextImpl& context, const VariableVerletIntegrator& integrator, double maxTime);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VariableVerletIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const VariableVerletIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuVariableVerletDynamics* dynamics;
+    std::vector<double> masses;
+    double prevErrorTol;
+};
+
+/**
+ * This kernel is invoked by VariableLangevinIntegrator to take one time step.
+ */
+class CpuIntegrateVariableLangevinStepKernel : public IntegrateVariableLangevinStepKernel {
+public:
+    CpuIntegrateVariableLangevinStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateVariableLangevinStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateVariableLangevinStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the VariableLangevinIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const VariableLangevinIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VariableLangevinIntegrator this kernel is being used for
+     * @param maxTime    the maximum time beyond which the simulation should not be advanced
+     * @return the size of the step that was taken
+     */
+    double execute(ContextImpl& context, const VariableLangevinIntegrator& integrator, double maxTime);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the VariableLangevinIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const VariableLangevinIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuVariableStochasticDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevFriction, prevErrorTol;
+};
+
+/**
+ * This kernel is invoked by CustomIntegrator to take one time step.  Bookkeeping of global and per-DOF
+ * variables is inherited from the reference implementation, while the per-DOF computations are divided
+ * between threads.
+ */
+class CpuIntegrateCustomStepKernel : public ReferenceIntegrateCustomStepKernel {
+public:
+    CpuIntegrateCustomStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, ReferencePlatform::PlatformData& refData) :
+            ReferenceIntegrateCustomStepKernel(name, platform, refData), cpuData(data) {
+    }
+    /**
+     * Initialize the kernel.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the CustomIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const CustomIntegrator& integrator);
+protected:
+    ReferenceCustomDynamics* createDynamics(const System& system, const CustomIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& cpuData;
+};
+
 /**
  * This kernel is invoked by LangevinMiddleIntegrator to take one time step.
  */
@@ -578,6 +1256,156 @@ private:
     double prevTemp, prevFriction, prevStepSize;
 };
 
+/**
+ * This kernel is invoked by IndirectReconstructionIntegrator to take one time step.
+ */
+class CpuIntegrateIndirectReconstructionStepKernel : public IntegrateIndirectReconstructionStepKernel {
+public:
+    CpuIntegrateIndirectReconstructionStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateIndirectReconstructionStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateIndirectReconstructionStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the IndirectReconstructionIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const IndirectReconstructionIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the IndirectReconstructionIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const IndirectReconstructionIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the IndirectReconstructionIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const IndirectReconstructionIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuIndirectReconstructionDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevStepSize, prevLambda;
+    ReactionCoordinate* prevReactionCoordinate;
+};
+
+/**
+ * This kernel is invoked by DampedReconstructionIntegrator to take one time step.
+ */
+class CpuIntegrateDampedReconstructionStepKernel : public IntegrateDampedReconstructionStepKernel {
+public:
+    CpuIntegrateDampedReconstructionStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateDampedReconstructionStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateDampedReconstructionStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the DampedReconstructionIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const DampedReconstructionIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuDampedReconstructionDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevStepSize, prevLambda, prevGamma;
+    ReactionCoordinate* prevReactionCoordinate;
+};
+
+/**
+ * This kernel is invoked by RandomWalkIntegrator to take one time step.
+ */
+class CpuIntegrateRandomWalkStepKernel : public IntegrateRandomWalkStepKernel {
+public:
+    CpuIntegrateRandomWalkStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data) : IntegrateRandomWalkStepKernel(name, platform),
+            data(data), dynamics(0) {
+    }
+    ~CpuIntegrateRandomWalkStepKernel();
+    /**
+     * Initialize the kernel, setting up the particle masses.
+     * 
+     * @param system     the System this kernel will be applied to
+     * @param integrator the RandomWalkIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const RandomWalkIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const RandomWalkIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     * 
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const RandomWalkIntegrator& integrator);
+private:
+    CpuPlatform::PlatformData& data;
+    CpuRandomWalkDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevStepSize, prevPeriod;
+};
+
+/**
+ * This kernel is invoked by RandomWalkEnsembleIntegrator.  It divides the chains between threads when
+ * making proposals and applying the Metropolis criterion.  The energy of each chain is computed by
+ * the Context's own force kernels, which divide the work between threads.
+ */
+class CpuIntegrateRandomWalkEnsembleStepKernel : public ReferenceIntegrateRandomWalkEnsembleStepKernel {
+public:
+    CpuIntegrateRandomWalkEnsembleStepKernel(std::string name, const Platform& platform, CpuPlatform::PlatformData& data, ReferencePlatform::PlatformData& refdata) :
+            ReferenceIntegrateRandomWalkEnsembleStepKernel(name, platform, refdata), data(data) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const RandomWalkEnsembleIntegrator& integrator);
+    /**
+     * Make a new proposal for every chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     */
+    void propose(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator);
+    /**
+     * Accept or reject the proposal of every chain with the Metropolis criterion.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     * @param energies   the energy of each chain's proposal
+     */
+    void acceptOrReject(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator, const std::vector<double>& energies);
+private:
+    CpuPlatform::PlatformData& data;
+    std::vector<std::vector<float> > threadNoise;
+};
+
 } // namespace OpenMM
 
 #endif /*OPENMM_CPUKERNELS_H_*/
@@ -0,0 +1,109 @@
+#ifndef OPENMM_CPUMINIMIZER_H_
+#define OPENMM_CPUMINIMIZER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/LocalEnergyMinimizer.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/ThreadPool.h"
+#include "windowsExportCpu.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class performs local energy minimization with the L-BFGS algorithm.  It drives the same lbfgs
+ * library as LocalEnergyMinimizer, with the same parameters and the same handling of constraints and
+ * failures, but it works directly with the position and force arrays stored in the ContextImpl rather
+ * than creating a State for every evaluation.  Copying between the library's coordinate array and the
+ * Context is divided between threads.
+ */
+class OPENMM_EXPORT_CPU CpuMinimizer {
+public:
+    /**
+     * Create a CpuMinimizer.
+     *
+     * @param system    the System to minimize
+     * @param threads   thread pool for parallelizing computation
+     */
+    CpuMinimizer(const System& system, ThreadPool& threads);
+    ~CpuMinimizer();
+    /**
+     * Search for a new set of particle positions that represent a local potential energy minimum.
+     * The arguments have the same meaning as for LocalEnergyMinimizer::minimize().
+     *
+     * @param context        the context whose positions should be minimized
+     * @param tolerance      the RMS force (in kJ/mol/nm) at which to halt minimization
+     * @param maxIterations  the maximum number of iterations to perform, or 0 for no limit
+     * @param reporter       an optional MinimizationReporter to invoke after each iteration
+     */
+    void minimize(ContextImpl& context, double tolerance, int maxIterations, MinimizationReporter* reporter);
+private:
+    /**
+     * The callbacks invoked by the lbfgs library.  instance is the CpuMinimizer.
+     */
+    static double evaluateCallback(void* instance, const double* coords, double* grad, const int n, const double step);
+    static int reportCallback(void* instance, const double* coords, const double* grad, const double fx, const double xnorm,
+            const double gnorm, const double step, int n, int iteration, int ls);
+    /**
+     * Set the positions in the context from a flattened coordinate array, and compute the objective
+     * function and its gradient.
+     */
+    double evaluate(const double* coords, double* grad);
+    /**
+     * Recompute the energy and gradient for the current positions on the Reference platform.  This is
+     * used when single precision forces overflow, which can happen when particles are nearly on top of
+     * each other.
+     */
+    double evaluateInDoublePrecision(double* grad);
+    bool report(int iteration, const double* coords, const double* grad, double objective);
+    template <class F>
+    void forEachRange(F function);
+    const System& system;
+    ThreadPool& threads;
+    ContextImpl* context;
+    MinimizationReporter* reporter;
+    int numParticles;
+    double k;
+    double* x;
+    std::vector<char> isMassless;
+    std::vector<char> threadNonfinite;
+    std::vector<double> reportX, reportGrad;
+    VerletIntegrator doubleIntegrator;
+    Context* doubleContext;
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_CPUMINIMIZER_H_*/
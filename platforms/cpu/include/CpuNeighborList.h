@@ -104,7 +104,7 @@ private:
     const float* atomLocations;
     Vec3 periodicBoxVectors[3];
     int numAtoms;
-    bool usePeriodic, dense;
+    bool usePeriodic, dense, hasSortedOrder, reuseSortedOrder;
     float maxDistance;
     std::atomic<int> atomicCounter;
 };
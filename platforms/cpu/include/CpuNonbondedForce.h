@@ -126,6 +126,16 @@ class CpuNonbondedForce {
 
       void setUseLJPME(float alpha, int meshSize[3]);
 
+      /**---------------------------------------------------------------------------------------
+
+         Set the B-spline interpolation order to use for PME and LJPME.
+
+         @param order    the interpolation order
+
+         --------------------------------------------------------------------------------------- */
+
+      void setPMEInterpolationOrder(int order);
+
       /**---------------------------------------------------------------------------------------
 
          Set whether exceptions use periodic boundary conditions.
@@ -194,7 +204,7 @@ protected:
         float krf, crf;
         float alphaEwald, alphaDispersionEwald;
         int numRx, numRy, numRz;
-        int meshDim[3], dispersionMeshDim[3];
+        int meshDim[3], dispersionMeshDim[3], pmeOrder;
         std::vector<float> erfcTable, ewaldScaleTable;
         std::vector<float> exptermsTable, dExptermsTable;
         float ewaldDX, ewaldDXInv, erfcDXInv, exptermsDX, exptermsDXInv;
@@ -275,6 +285,12 @@ protected:
       float dExptermsApprox(float R);
 };
 
+/**
+ * Get the number of atoms in each block of the neighbor list, as required by the vectorized
+ * implementation that is selected for the current CPU.
+ */
+int getCpuNonbondedForceBlockSize();
+
 } // namespace OpenMM
 
 // ---------------------------------------------------------------------------------------
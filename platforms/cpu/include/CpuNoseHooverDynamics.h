@@ -0,0 +1,74 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CPU_NOSE_HOOVER_DYNAMICS_H__
+#define __CPU_NOSE_HOOVER_DYNAMICS_H__
+
+#include "ReferenceNoseHooverDynamics.h"
+#include "openmm/internal/ThreadPool.h"
+
+namespace OpenMM {
+
+/**
+ * This class performs the leapfrog LF-Middle update of NoseHooverIntegrator, dividing the
+ * particles between the threads of a ThreadPool.  Drude-like pairs and the hard wall constraint
+ * involve only a small number of particles and are processed serially.
+ */
+class CpuNoseHooverDynamics : public ReferenceNoseHooverDynamics {
+public:
+    /**
+     * Constructor.
+     *
+     * @param numberOfAtoms  number of atoms
+     * @param deltaT         delta t for dynamics
+     * @param threads        thread pool for parallelizing computation
+     */
+    CpuNoseHooverDynamics(int numberOfAtoms, double deltaT, OpenMM::ThreadPool& threads);
+
+    /**
+     * Destructor.
+     */
+    ~CpuNoseHooverDynamics();
+
+    /**
+     * Perform the first half of a step.
+     */
+    void step1(OpenMM::ContextImpl& context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
+               std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance,
+               const std::vector<int>& allAtoms, const std::vector<std::tuple<int, int, double> >& allPairs, double maxPairDistance);
+
+    /**
+     * Perform the second half of a step.
+     */
+    void step2(OpenMM::ContextImpl& context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
+               std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance,
+               const std::vector<int>& allAtoms, const std::vector<std::tuple<int, int, double> >& allPairs, double maxPairDistance);
+
+private:
+    OpenMM::ThreadPool& threads;
+};
+
+} // namespace OpenMM
+
+#endif // __CPU_NOSE_HOOVER_DYNAMICS_H__
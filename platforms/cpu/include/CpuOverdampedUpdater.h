@@ -0,0 +1,90 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CPU_OVERDAMPED_UPDATER_H__
+#define __CPU_OVERDAMPED_UPDATER_H__
+
+#include "CpuRandom.h"
+#include "openmm/Vec3.h"
+#include "openmm/internal/ThreadPool.h"
+#include <vector>
+
+namespace OpenMM {
+
+/**
+ * This class performs the position and velocity update shared by the overdamped integrators
+ * (IndirectReconstructionIntegrator, DampedReconstructionIntegrator and RandomWalkIntegrator).
+ * Each particle with nonzero mass is moved by
+ *
+ * x' = x + driftScale*drift + biasScale*bias + noiseScale*noise
+ *
+ * where noise is drawn from a standard normal distribution, and its velocity is set to (x'-x)/dt.
+ * The particles are divided between the threads of a ThreadPool, and each thread generates its
+ * Gaussian random numbers in a single block from its own CpuRandom stream.
+ */
+class CpuOverdampedUpdater {
+public:
+    /**
+     * Constructor.
+     *
+     * @param threads        thread pool for parallelizing computation
+     * @param random         random number generator
+     */
+    CpuOverdampedUpdater(OpenMM::ThreadPool& threads, OpenMM::CpuRandom& random);
+    /**
+     * Update the positions and velocities.
+     *
+     * @param numberOfAtoms     the number of atoms
+     * @param atomCoordinates   atom coordinates
+     * @param velocities        velocities
+     * @param masses            atom masses.  Atoms with zero mass are not moved.
+     * @param deltaT            the step size
+     * @param noiseScale        the standard deviation of the random displacement along each axis
+     * @param drift             the drift term (usually the forces).  This may be NULL.
+     * @param driftScale        the factor by which to multiply the drift term
+     * @param bias              the bias term (usually a reaction coordinate gradient).  This may be NULL.
+     * @param biasScale         the factor by which to multiply the bias term
+     * @param period            if this is greater than 0, each coordinate of the new positions is wrapped
+     *                          into the interval [-period, period]
+     */
+    void update(int numberOfAtoms, std::vector<OpenMM::Vec3>& atomCoordinates, std::vector<OpenMM::Vec3>& velocities, const std::vector<double>& masses,
+                double deltaT, double noiseScale, const OpenMM::Vec3* drift, double driftScale, const OpenMM::Vec3* bias, double biasScale, double period=0.0);
+private:
+    void threadUpdate(int threadIndex);
+    OpenMM::ThreadPool& threads;
+    OpenMM::CpuRandom& random;
+    std::vector<std::vector<float> > threadNoise;
+    // The following variables are used to make information accessible to the individual threads.
+    int numberOfAtoms;
+    OpenMM::Vec3* atomCoordinates;
+    OpenMM::Vec3* velocities;
+    const double* masses;
+    const OpenMM::Vec3* drift;
+    const OpenMM::Vec3* bias;
+    double deltaT, noiseScale, driftScale, biasScale, period;
+};
+
+} // namespace OpenMM
+
+#endif // __CPU_OVERDAMPED_UPDATER_H__
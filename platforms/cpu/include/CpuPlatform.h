@@ -36,6 +36,7 @@
 #include "CpuRandom.h"
 #include "CpuNeighborList.h"
 #include "ReferencePlatform.h"
+#include "openmm/VerletIntegrator.h"
 #include "openmm/internal/ContextImpl.h"
 #include "openmm/internal/ThreadPool.h"
 #include "windowsExportCpu.h"
@@ -50,6 +51,7 @@ namespace OpenMM {
 class OPENMM_EXPORT_CPU CpuPlatform : public ReferencePlatform {
 public:
     class PlatformData;
+    struct NeighborListStatistics;
     CpuPlatform();
     const std::string& getName() const {
         static const std::string name = "CPU";
@@ -77,6 +79,41 @@ public:
         static const std::string key = "DeterministicForces";
         return key;
     }
+    /**
+     * This is the name of the parameter for selecting how the padding added to the nonbonded cutoff is chosen
+     * when building neighbor lists.  If this is "fixed" (the default), a fixed padding requested by each Force
+     * is used.  If it is "adaptive", the padding is tuned while the simulation runs to balance the cost of
+     * rebuilding the neighbor list against the cost of evaluating the extra pairs it contains.
+     */
+    static const std::string& CpuNeighborListPadding() {
+        static const std::string key = "NeighborListPadding";
+        return key;
+    }
+    /**
+     * This is the name of the parameter for selecting what numerical precision to use.  If this is "single"
+     * (the default), nonbonded interactions are computed in single precision, and each thread accumulates
+     * its forces in single precision over all Forces.  If it is "mixed", interactions are still computed in
+     * single precision, and each thread still accumulates the forces within one Force in single precision,
+     * but the contributions of different threads and different Forces are summed in double precision.
+     */
+    static const std::string& CpuPrecision() {
+        static const std::string key = "Precision";
+        return key;
+    }
+    /**
+     * This is the name of the parameter for requesting that each worker thread be bound to a single CPU core.
+     * If this is "true", the threads are pinned to the cores the process is allowed to run on.  This is only
+     * supported on Linux.  The default is "false".
+     */
+    static const std::string& CpuPinThreads() {
+        static const std::string key = "PinThreads";
+        return key;
+    }
+    /**
+     * Get statistics about how the neighbor list for a Context has been maintained.  This can be used to
+     * monitor the padding selected when CpuNeighborListPadding() is "adaptive".
+     */
+    NeighborListStatistics getNeighborListStatistics(const Context& context) const;
     /**
      * We cannot use the standard mechanism for platform data, because that is already used by the superclass.
      * Instead, we maintain a table of ContextImpls to PlatformDatas.
@@ -87,9 +124,35 @@ private:
     static std::map<const ContextImpl*, PlatformData*> contextData;
 };
 
+/**
+ * This structure records how the neighbor list for a Context has been maintained.  All times are in seconds.
+ */
+struct CpuPlatform::NeighborListStatistics {
+    /**
+     * The padding (in nm) that was added to the cutoff when the neighbor list was most recently built
+     */
+    double padding;
+    /**
+     * The number of times the neighbor list has been built
+     */
+    int numBuilds;
+    /**
+     * The number of force evaluations that have been performed
+     */
+    int numEvaluations;
+    /**
+     * The total time spent building the neighbor list
+     */
+    double buildTime;
+    /**
+     * The total time spent computing nonbonded pair interactions from the neighbor list
+     */
+    double pairTime;
+};
+
 class CpuPlatform::PlatformData {
 public:
-    PlatformData(int numParticles, int numThreads, bool deterministicForces);
+    PlatformData(int numParticles, int numThreads, bool deterministicForces, bool adaptivePadding, const std::string& precision, bool pinThreads=false);
     ~PlatformData();
     /**
      * Request that a neighbor list be built and maintained.
@@ -104,6 +167,45 @@ public:
      *                        particles with which particle i should not interact
      */
     void requestNeighborList(double cutoffDistance, double padding, bool useExclusions, const std::vector<std::set<int> >& exclusionList);
+    /**
+     * Choose the padding to use for the next neighbor list build, based on how long it took to build the
+     * previous one, how many evaluations it survived, and the time spent on pair interactions since then.
+     * This is called just before the neighbor list is rebuilt when adaptive padding is enabled.
+     */
+    void updateNeighborListPadding();
+    /**
+     * Record time spent computing pair interactions from the neighbor list.
+     */
+    void recordPairTime(double time);
+    /**
+     * Add the forces that have been accumulated in threadForce to a double precision array, summing over
+     * threads in double precision, then clear threadForce.  When using mixed precision, this is called after
+     * each Force that uses threadForce so single precision sums never span more than one Force.
+     */
+    void accumulateThreadForces(std::vector<Vec3>& forces);
+    /**
+     * Create a Context on this Platform that uses the same property values as the Context this data
+     * belongs to, except that it has the specified number of threads and does not pin them.  Kernels use
+     * this to create Contexts that run on this Context's threads.
+     *
+     * @param context     the Context this data belongs to
+     * @param system      the System to create the Context for
+     * @param integrator  the Integrator to create the Context for
+     * @param numThreads  the number of threads the new Context should use
+     */
+    Context* createWorkerContext(ContextImpl& context, const System& system, Integrator& integrator, int numThreads);
+    /**
+     * Get single threaded Contexts for the same System as the Context this data belongs to, so that
+     * independent configurations can be evaluated concurrently, one per thread.  They are created when
+     * first needed and kept until the parameters of the System's Forces change.  Each call copies the
+     * global parameters, periodic box vectors, integration force groups, and constraint tolerance of
+     * context into them.  Their positions are whatever they were last set to.
+     *
+     * @param context     the Context this data belongs to
+     * @param numWorkers  the minimum number of Contexts to return.  More may be returned if they were
+     *                    created by an earlier call.
+     */
+    const std::vector<Context*>& getWorkerContexts(ContextImpl& context, int numWorkers);
     int requestPosqIndex();
     AlignedArray<float> posq;
     std::vector<AlignedArray<float> > threadForce;
@@ -114,9 +216,35 @@ public:
     int numParticles;
     CpuNeighborList* neighborList;
     double cutoff, paddedCutoff;
-    bool anyExclusions, deterministicForces;
+    bool anyExclusions, deterministicForces, adaptivePadding, useMixedPrecision;
+    NeighborListStatistics neighborListStats;
+    int evaluationsSinceBuild;
+    double lastBuildTime, pairTimeSinceBuild;
     int currentPosqIndex, nextPosqIndex;
     std::vector<std::set<int> > exclusions;
+    /**
+     * The particle positions the neighbor list was last built from.  Code that moves particles in a way
+     * that is known not to invalidate the neighbor list may apply the same displacements here.
+     */
+    std::vector<Vec3> neighborListPositions;
+    /**
+     * An upper bound on how much the distance between any two particles in the neighbor list may have
+     * changed, beyond what is accounted for by neighborListPositions, since the list was built.
+     */
+    double neighborListDrift;
+    /**
+     * CPU kernels normally add their results to the force and energy parameter derivative arrays stored in
+     * the ReferencePlatform::PlatformData.  While CpuScheduleForcesKernel runs reference kernels concurrently
+     * with CPU kernels, it redirects those to private arrays and sets these to the ones the CPU kernels should
+     * use instead.  At all other times they are NULL.
+     */
+    std::vector<Vec3>* concurrentForces;
+    std::map<std::string, double>* concurrentEnergyParameterDerivatives;
+private:
+    void deleteWorkerContexts();
+    std::vector<Context*> workerContexts;
+    std::vector<VerletIntegrator*> workerIntegrators;
+    int workerSystemChangeCount;
 };
 
 } // namespace OpenMM
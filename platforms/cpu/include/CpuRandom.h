@@ -48,6 +48,15 @@ public:
     ~CpuRandom();
     void initialize(int seed, int numThreads);
     float getGaussianRandom(int threadIndex);
+    /**
+     * Generate a block of Gaussian random numbers.  This is faster than calling getGaussianRandom()
+     * repeatedly when many values are needed at once.
+     *
+     * @param threadIndex  the index of the thread whose random number stream to use
+     * @param values       on exit, contains the random numbers
+     * @param count        the number of random numbers to generate
+     */
+    void getGaussianRandom(int threadIndex, float* values, int count);
     float getUniformRandom(int threadIndex);
     void createCheckpoint(std::ostream& stream);
     void loadCheckpoint(std::istream& stream);
@@ -0,0 +1,87 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SimTKOpenMMUtilities.h"
+#include "CpuBrownianDynamics.h"
+#include "ReferenceVirtualSites.h"
+
+using namespace OpenMM;
+using namespace std;
+
+CpuBrownianDynamics::CpuBrownianDynamics(int numberOfAtoms, double deltaT, double friction, double temperature, ThreadPool& threads, CpuRandom& random) :
+           ReferenceBrownianDynamics(numberOfAtoms, deltaT, friction, temperature), threads(threads), random(random) {
+    threadNoise.resize(threads.getNumThreads());
+}
+
+CpuBrownianDynamics::~CpuBrownianDynamics() {
+}
+
+void CpuBrownianDynamics::update(const System& system, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                 vector<Vec3>& forces, vector<double>& masses, double tolerance) {
+    int numberOfAtoms = system.getNumParticles();
+    int numThreads = threads.getNumThreads();
+    if (getTimeStep() == 0) {
+        for (int i = 0; i < numberOfAtoms; i++)
+            inverseMasses[i] = (masses[i] == 0.0 ? 0.0 : 1.0/masses[i]);
+    }
+
+    // Compute the unconstrained positions.  Each thread generates all the random numbers it needs at once.
+
+    const double noiseAmplitude = sqrt(2.0*BOLTZ*getTemperature()*getDeltaT()/getFriction());
+    const double forceScale = getDeltaT()/getFriction();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        if (end <= start)
+            return;
+        vector<float>& noise = threadNoise[threadIndex];
+        noise.resize(3*(end-start));
+        random.getGaussianRandom(threadIndex, noise.data(), noise.size());
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0) {
+                const float* n = &noise[3*(i-start)];
+                xPrime[i] = atomCoordinates[i] + forceScale*inverseMasses[i]*forces[i] + (noiseAmplitude*sqrt(inverseMasses[i]))*Vec3(n[0], n[1], n[2]);
+            }
+    });
+    threads.waitForThreads();
+    ReferenceConstraintAlgorithm* referenceConstraintAlgorithm = getReferenceConstraintAlgorithm();
+    if (referenceConstraintAlgorithm)
+        referenceConstraintAlgorithm->apply(atomCoordinates, xPrime, inverseMasses, tolerance);
+
+    // Update the positions and velocities.
+
+    const double velocityScale = 1.0/getDeltaT();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0) {
+                velocities[i] = (xPrime[i]-atomCoordinates[i])*velocityScale;
+                atomCoordinates[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+    getVirtualSites().computePositions(system, atomCoordinates);
+    incrementTimeStep();
+}
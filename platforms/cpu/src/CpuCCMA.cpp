@@ -0,0 +1,223 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2013-2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuCCMA.h"
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * This class holds the constraints in one block, along with the rows of the inverse constraint matrix for
+ * them in compressed sparse row format.  All constraint indices stored in it are local to the block.
+ */
+class CpuCCMA::ConstraintBlock {
+public:
+    vector<int> atom1, atom2;
+    vector<double> distance, reducedMass;
+    vector<int> matrixRowStart, matrixColIndex;
+    vector<double> matrixValue;
+    vector<Vec3> r_ij;
+    vector<double> d_ij2, constraintDelta, tempDelta;
+};
+
+static int findCluster(vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+CpuCCMA::CpuCCMA(const ReferenceCCMAAlgorithm& ccma, ThreadPool& threads) : threads(threads), hasInitializedMasses(false) {
+    maxIterations = ccma.getMaximumNumberOfIterations();
+    int numConstraints = ccma.getNumberOfConstraints();
+    vector<int> atom1(numConstraints), atom2(numConstraints);
+    vector<double> distance(numConstraints);
+    int numAtoms = 0;
+    for (int i = 0; i < numConstraints; i++) {
+        ccma.getConstraintParameters(i, atom1[i], atom2[i], distance[i]);
+        numAtoms = max(numAtoms, max(atom1[i], atom2[i])+1);
+    }
+
+    // Identify clusters of constraints connected by shared atoms.
+
+    vector<int> parent(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+        parent[i] = i;
+    for (int i = 0; i < numConstraints; i++) {
+        int root1 = findCluster(parent, atom1[i]);
+        int root2 = findCluster(parent, atom2[i]);
+        if (root1 != root2)
+            parent[max(root1, root2)] = min(root1, root2);
+    }
+    vector<int> clusterIndex(numAtoms, -1);
+    vector<vector<int> > clusters;
+    for (int i = 0; i < numConstraints; i++) {
+        int root = findCluster(parent, atom1[i]);
+        if (clusterIndex[root] == -1) {
+            clusterIndex[root] = clusters.size();
+            clusters.push_back(vector<int>());
+        }
+        clusters[clusterIndex[root]].push_back(i);
+    }
+
+    // Group the clusters into blocks.  Use several blocks per thread to balance the load.
+
+    int numBlocks = 10*threads.getNumThreads();
+    int targetSize = max(1, (numConstraints+numBlocks-1)/numBlocks);
+    vector<vector<int> > blockConstraints;
+    for (auto& cluster : clusters) {
+        if (blockConstraints.size() == 0 || blockConstraints.back().size() >= targetSize)
+            blockConstraints.push_back(vector<int>());
+        blockConstraints.back().insert(blockConstraints.back().end(), cluster.begin(), cluster.end());
+    }
+
+    // Build the blocks, extracting the rows of the inverse matrix that belong to each one.
+
+    const vector<vector<pair<int, double> > >& matrix = ccma.getMatrix();
+    vector<int> constraintBlock(numConstraints), localIndex(numConstraints);
+    for (int i = 0; i < blockConstraints.size(); i++)
+        for (int j = 0; j < blockConstraints[i].size(); j++) {
+            constraintBlock[blockConstraints[i][j]] = i;
+            localIndex[blockConstraints[i][j]] = j;
+        }
+    for (int i = 0; i < blockConstraints.size(); i++) {
+        ConstraintBlock* block = new ConstraintBlock();
+        blocks.push_back(block);
+        int size = blockConstraints[i].size();
+        block->reducedMass.resize(size);
+        block->r_ij.resize(size);
+        block->d_ij2.resize(size);
+        block->constraintDelta.resize(size);
+        block->tempDelta.resize(size);
+        for (int index : blockConstraints[i]) {
+            block->atom1.push_back(atom1[index]);
+            block->atom2.push_back(atom2[index]);
+            block->distance.push_back(distance[index]);
+            block->matrixRowStart.push_back(block->matrixValue.size());
+            if (matrix.size() > 0)
+                for (auto& element : matrix[index])
+                    if (constraintBlock[element.first] == i) {
+                        block->matrixColIndex.push_back(localIndex[element.first]);
+                        block->matrixValue.push_back(element.second);
+                    }
+        }
+        block->matrixRowStart.push_back(block->matrixValue.size());
+    }
+}
+
+CpuCCMA::~CpuCCMA() {
+    for (auto block : blocks)
+        delete block;
+}
+
+void CpuCCMA::apply(vector<Vec3>& atomCoordinates, vector<Vec3>& atomCoordinatesP, vector<double>& inverseMasses, double tolerance) {
+    applyConstraints(atomCoordinates, atomCoordinatesP, inverseMasses, false, tolerance);
+}
+
+void CpuCCMA::applyToVelocities(vector<Vec3>& atomCoordinates, vector<Vec3>& velocities, vector<double>& inverseMasses, double tolerance) {
+    applyConstraints(atomCoordinates, velocities, inverseMasses, true, tolerance);
+}
+
+void CpuCCMA::applyConstraints(vector<Vec3>& atomCoordinates, vector<Vec3>& atomCoordinatesP, vector<double>& inverseMasses,
+            bool constrainingVelocities, double tolerance) {
+    if (!hasInitializedMasses) {
+        hasInitializedMasses = true;
+        for (auto block : blocks)
+            for (int i = 0; i < block->atom1.size(); i++)
+                block->reducedMass[i] = 0.5/(inverseMasses[block->atom1[i]]+inverseMasses[block->atom2[i]]);
+    }
+    threads.parallelFor(0, blocks.size(), 1, [&] (ThreadPool& threads, int threadIndex, int start, int end) {
+        for (int index = start; index < end; index++)
+            applyToBlock(*blocks[index], atomCoordinates, atomCoordinatesP, inverseMasses, constrainingVelocities, tolerance);
+    });
+}
+
+void CpuCCMA::applyToBlock(ConstraintBlock& block, vector<Vec3>& atomCoordinates, vector<Vec3>& atomCoordinatesP, vector<double>& inverseMasses,
+            bool constrainingVelocities, double tolerance) {
+    int numConstraints = block.atom1.size();
+    for (int i = 0; i < numConstraints; i++) {
+        block.r_ij[i] = atomCoordinates[block.atom1[i]]-atomCoordinates[block.atom2[i]];
+        block.d_ij2[i] = block.r_ij[i].dot(block.r_ij[i]);
+    }
+    double lowerTol = 1-2*tolerance+tolerance*tolerance;
+    double upperTol = 1+2*tolerance+tolerance*tolerance;
+    double* constraintDelta = block.constraintDelta.data();
+    double* tempDelta = block.tempDelta.data();
+    for (int iteration = 0; iteration < maxIterations; iteration++) {
+        // Compute the correction needed for each constraint and check for convergence.
+
+        int numberConverged = 0;
+        for (int i = 0; i < numConstraints; i++) {
+            Vec3 rp_ij = atomCoordinatesP[block.atom1[i]]-atomCoordinatesP[block.atom2[i]];
+            if (constrainingVelocities) {
+                double rrpr = rp_ij.dot(block.r_ij[i]);
+                constraintDelta[i] = -2*block.reducedMass[i]*rrpr/block.d_ij2[i];
+                if (fabs(constraintDelta[i]) <= tolerance)
+                    numberConverged++;
+            }
+            else {
+                double rp2 = rp_ij.dot(rp_ij);
+                double dist2 = block.distance[i]*block.distance[i];
+                double diff = dist2-rp2;
+                double rrpr = rp_ij.dot(block.r_ij[i]);
+                constraintDelta[i] = block.reducedMass[i]*diff/rrpr;
+                if (rp2 >= lowerTol*dist2 && rp2 <= upperTol*dist2)
+                    numberConverged++;
+            }
+        }
+        if (numberConverged == numConstraints)
+            break;
+
+        // Multiply by the inverse constraint matrix.
+
+        if (block.matrixValue.size() > 0) {
+            for (int i = 0; i < numConstraints; i++) {
+                double sum = 0.0;
+                for (int j = block.matrixRowStart[i]; j < block.matrixRowStart[i+1]; j++)
+                    sum += block.matrixValue[j]*constraintDelta[block.matrixColIndex[j]];
+                tempDelta[i] = sum;
+            }
+            swap(constraintDelta, tempDelta);
+        }
+
+        // Update the atoms.
+
+        for (int i = 0; i < numConstraints; i++) {
+            int atomI = block.atom1[i];
+            int atomJ = block.atom2[i];
+            Vec3 dr = block.r_ij[i]*constraintDelta[i];
+            atomCoordinatesP[atomI] += dr*inverseMasses[atomI];
+            atomCoordinatesP[atomJ] -= dr*inverseMasses[atomJ];
+        }
+    }
+}
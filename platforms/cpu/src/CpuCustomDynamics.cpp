@@ -0,0 +1,157 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CpuCustomDynamics.h"
+#include <sstream>
+
+using namespace OpenMM;
+using namespace Lepton;
+using namespace std;
+
+/**
+ * This class holds the variables and expression copies used by a single thread.
+ */
+class CpuCustomDynamics::ThreadData {
+public:
+    double x, v, m, f, uniform, gaussian;
+    vector<double> perDofVariable;
+    vector<CompiledExpression> expressions;
+};
+
+CpuCustomDynamics::CpuCustomDynamics(int numberOfAtoms, const CustomIntegrator& integrator, ThreadPool& threads, CpuRandom& random) :
+        ReferenceCustomDynamics(numberOfAtoms, integrator), threads(threads), random(random) {
+    threadSum.resize(threads.getNumThreads());
+}
+
+CpuCustomDynamics::~CpuCustomDynamics() {
+    for (auto data : threadData)
+        delete data;
+}
+
+void CpuCustomDynamics::initialize(ContextImpl& context, vector<double>& masses, map<string, double>& globals) {
+    ReferenceCustomDynamics::initialize(context, masses, globals);
+
+    // Find all the scalar expressions that are evaluated for every degree of freedom.
+
+    vector<const CompiledExpression*> perDofExpressions;
+    for (int i = 0; i < stepType.size(); i++)
+        if ((stepType[i] == CustomIntegrator::ComputePerDof || stepType[i] == CustomIntegrator::ComputeSum) && stepVectorExpressions[i].size() == 0)
+            perDofExpressions.push_back(&stepExpressions[i][0]);
+    perDofExpressions.push_back(&kineticEnergyExpression);
+    for (int i = 0; i < perDofExpressions.size(); i++) {
+        expressionIndex[perDofExpressions[i]] = i;
+        const set<string>& variables = perDofExpressions[i]->getVariables();
+        usesUniform.push_back(variables.find("uniform") != variables.end());
+        usesGaussian.push_back(variables.find("gaussian") != variables.end());
+    }
+
+    // Give each thread its own copies of the expressions, with the per-DOF variables pointing to its own storage.
+    // Global variables are internal to each copy and get updated through the expression set.
+
+    for (int i = 0; i < threads.getNumThreads(); i++) {
+        ThreadData* data = new ThreadData();
+        threadData.push_back(data);
+        map<string, double*> variableLocations;
+        variableLocations["x"] = &data->x;
+        variableLocations["v"] = &data->v;
+        variableLocations["m"] = &data->m;
+        variableLocations["f"] = &data->f;
+        variableLocations["energy"] = &energy;
+        variableLocations["uniform"] = &data->uniform;
+        variableLocations["gaussian"] = &data->gaussian;
+        data->perDofVariable.resize(integrator.getNumPerDofVariables());
+        for (int j = 0; j < integrator.getNumPerDofVariables(); j++)
+            variableLocations[integrator.getPerDofVariableName(j)] = &data->perDofVariable[j];
+        for (int j = 0; j < 32; j++) {
+            stringstream fname;
+            fname << "f" << j;
+            variableLocations[fname.str()] = &data->f;
+            stringstream ename;
+            ename << "energy" << j;
+            variableLocations[ename.str()] = &energy;
+        }
+        data->expressions.resize(perDofExpressions.size());
+        for (int j = 0; j < perDofExpressions.size(); j++) {
+            data->expressions[j] = *perDofExpressions[j];
+            data->expressions[j].setVariableLocations(variableLocations);
+            expressionSet.registerExpression(data->expressions[j]);
+        }
+    }
+}
+
+void CpuCustomDynamics::computePerDof(int numberOfAtoms, vector<Vec3>& results, const vector<Vec3>& atomCoordinates,
+              const vector<Vec3>& velocities, const vector<Vec3>& forces, const vector<double>& masses,
+              const vector<vector<Vec3> >& perDof, const CompiledExpression& expression) {
+    auto index = expressionIndex.find(&expression);
+    if (index == expressionIndex.end()) {
+        ReferenceCustomDynamics::computePerDof(numberOfAtoms, results, atomCoordinates, velocities, forces, masses, perDof, expression);
+        return;
+    }
+    int exprIndex = index->second;
+    bool needUniform = usesUniform[exprIndex];
+    bool needGaussian = usesGaussian[exprIndex];
+    int numThreads = threads.getNumThreads();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        ThreadData& data = *threadData[threadIndex];
+        const CompiledExpression& threadExpression = data.expressions[exprIndex];
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++) {
+            if (masses[i] != 0.0) {
+                data.m = masses[i];
+                for (int j = 0; j < 3; j++) {
+                    data.x = atomCoordinates[i][j];
+                    data.v = velocities[i][j];
+                    data.f = forces[i][j];
+                    if (needUniform)
+                        data.uniform = random.getUniformRandom(threadIndex);
+                    if (needGaussian)
+                        data.gaussian = random.getGaussianRandom(threadIndex);
+                    for (int k = 0; k < (int) perDof.size(); k++)
+                        data.perDofVariable[k] = perDof[k][i][j];
+                    results[i][j] = threadExpression.evaluate();
+                }
+            }
+        }
+    });
+    threads.waitForThreads();
+}
+
+double CpuCustomDynamics::sumOverDofs(int numberOfAtoms, const vector<Vec3>& values, const vector<double>& masses) {
+    int numThreads = threads.getNumThreads();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        double sum = 0.0;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0)
+                sum += values[i][0]+values[i][1]+values[i][2];
+        threadSum[threadIndex] = sum;
+    });
+    threads.waitForThreads();
+    double sum = 0.0;
+    for (int i = 0; i < numThreads; i++)
+        sum += threadSum[i];
+    return sum;
+}
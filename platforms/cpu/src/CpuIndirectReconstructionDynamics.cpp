@@ -0,0 +1,53 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SimTKOpenMMUtilities.h"
+#include "CpuIndirectReconstructionDynamics.h"
+
+using namespace OpenMM;
+using namespace std;
+
+CpuIndirectReconstructionDynamics::CpuIndirectReconstructionDynamics(int numberOfAtoms, double deltaT, double temperature, ReactionCoordinate* rc, double lambda,
+            ThreadPool& threads, CpuRandom& random) :
+           ReferenceIndirectReconstructionDynamics(numberOfAtoms, deltaT, temperature, rc, lambda), updater(threads, random) {
+}
+
+CpuIndirectReconstructionDynamics::~CpuIndirectReconstructionDynamics() {
+}
+
+void CpuIndirectReconstructionDynamics::update(const System& system, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                               vector<Vec3>& forces, vector<double>& masses, double tolerance) {
+    // Evaluate the reaction coordinate and subtract the macroscopic variable from it.
+
+    reactionCoordinate->computeResidual(atomCoordinates, macroVariable, residual);
+    reactionCoordinate->computeGradMatMul(atomCoordinates, residual, bias);
+
+    // Move the atoms.
+
+    double dt = getDeltaT();
+    double noiseScale = sqrt(2.0*BOLTZ*getTemperature()*dt);
+    updater.update(system.getNumParticles(), atomCoordinates, velocities, masses, dt, noiseScale, &forces[0], dt, &bias[0], -dt*getLambda());
+    getVirtualSites().computePositions(system, atomCoordinates);
+    incrementTimeStep();
+}
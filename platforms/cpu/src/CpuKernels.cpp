@@ -33,22 +33,35 @@
 #include "ReferenceAngleBondIxn.h"
 #include "ReferenceBondForce.h"
 #include "ReferenceConstraints.h"
+#include "ReferenceCustomAngleIxn.h"
+#include "ReferenceCustomBondIxn.h"
+#include "ReferenceCustomCentroidBondIxn.h"
+#include "ReferenceCustomCompoundBondIxn.h"
+#include "ReferenceCustomTorsionIxn.h"
+#include "ReferenceHarmonicBondIxn.h"
 #include "ReferenceKernelFactory.h"
 #include "ReferenceKernels.h"
 #include "ReferenceLJCoulomb14.h"
+#include "ReferencePointFunctions.h"
 #include "ReferenceProperDihedralBond.h"
 #include "ReferenceRbDihedralBond.h"
 #include "ReferenceTabulatedFunction.h"
 #include "openmm/Context.h"
 #include "openmm/OpenMMException.h"
 #include "openmm/Vec3.h"
+#include "openmm/internal/CMAPTorsionForceImpl.h"
 #include "openmm/internal/ContextImpl.h"
+#include "openmm/internal/CustomCentroidBondForceImpl.h"
+#include "openmm/internal/CustomCompoundBondForceImpl.h"
 #include "openmm/internal/NonbondedForceImpl.h"
+#include "openmm/internal/timer.h"
 #include "openmm/internal/vectorize.h"
 #include "lepton/CompiledExpression.h"
 #include "lepton/CustomFunction.h"
 #include "lepton/Operation.h"
 #include "lepton/Parser.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include "lepton/ParsedExpression.h"
 
@@ -66,6 +79,9 @@ static vector<Vec3>& extractVelocities(ContextImpl& context) {
 }
 
 static vector<Vec3>& extractForces(ContextImpl& context) {
+    CpuPlatform::PlatformData& cpuData = CpuPlatform::getPlatformData(context);
+    if (cpuData.concurrentForces != NULL)
+        return *cpuData.concurrentForces;
     ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
     return *data->forces;
 }
@@ -91,6 +107,9 @@ static const ReferenceVirtualSites& extractVirtualSites(ContextImpl& context) {
 }
 
 static map<string, double>& extractEnergyParameterDerivatives(ContextImpl& context) {
+    CpuPlatform::PlatformData& cpuData = CpuPlatform::getPlatformData(context);
+    if (cpuData.concurrentEnergyParameterDerivatives != NULL)
+        return *cpuData.concurrentEnergyParameterDerivatives;
     ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
     return *data->energyParameterDerivatives;
 }
@@ -106,6 +125,21 @@ static void validateVariables(const Lepton::ExpressionTreeNode& node, const set<
         validateVariables(child, variables);
 }
 
+/**
+ * Parse the energy expression of a custom bonded force, and make sure it only uses the variables
+ * that are defined for it.
+ */
+static Lepton::ParsedExpression parseCustomBondedExpression(const string& energyFunction, const string& variable, const vector<string>& parameterNames,
+        const vector<string>& globalParameterNames) {
+    Lepton::ParsedExpression expression = Lepton::Parser::parse(energyFunction).optimize();
+    set<string> variables;
+    variables.insert(variable);
+    variables.insert(parameterNames.begin(), parameterNames.end());
+    variables.insert(globalParameterNames.begin(), globalParameterNames.end());
+    validateVariables(expression.getRootNode(), variables);
+    return expression;
+}
+
 /**
  * Compute the kinetic energy of the system, possibly shifting the velocities in time to account
  * for a leapfrog integrator.
@@ -167,11 +201,11 @@ CpuCalcForcesAndEnergyKernel::CpuCalcForcesAndEnergyKernel(std::string name, con
 
 void CpuCalcForcesAndEnergyKernel::initialize(const System& system) {
     referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().initialize(system);
-    lastPositions.resize(system.getNumParticles(), Vec3(1e10, 1e10, 1e10));
 }
 
 void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool includeForce, bool includeEnergy, int groups) {
     referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().beginComputation(context, includeForce, includeEnergy, groups);
+    data.threads.setImbalanceTimingEnabled(context.getProfilingEnabled());
     
     // Convert positions to single precision and clear the forces.
 
@@ -238,14 +272,17 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
     // Determine whether we need to recompute the neighbor list.
         
     if (data.neighborList != NULL && data.cutoff > 0.0) {
-        double padding = data.paddedCutoff-data.cutoff;;
-        bool needRecompute = false;
+        // Coordinate scaling since the last build has used up part of the padding.
+
+        double padding = data.paddedCutoff-data.cutoff-data.neighborListDrift;
+        bool needRecompute = (padding <= 0.0);
+        vector<Vec3>& lastPositions = data.neighborListPositions;
         double closeCutoff2 = 0.25*padding*padding;
         double farCutoff2 = 0.5*padding*padding;
         int maxNumMoved = numParticles/10;
         vector<int> moved;
         vector<Vec3>& posData = extractPositions(context);
-        for (int i = 0; i < numParticles; i++) {
+        for (int i = 0; i < numParticles && !needRecompute; i++) {
             Vec3 delta = posData[i]-lastPositions[i];
             double dist2 = delta.dot(delta);
             if (dist2 > closeCutoff2) {
@@ -262,7 +299,7 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
 
             int numMoved = moved.size();
             double cutoff2 = data.cutoff*data.cutoff;
-            double paddedCutoff2 = data.paddedCutoff*data.paddedCutoff;
+            double paddedCutoff2 = (data.paddedCutoff-data.neighborListDrift)*(data.paddedCutoff-data.neighborListDrift);
             for (int i = 1; i < numMoved && !needRecompute; i++)
                 for (int j = 0; j < i; j++) {
                     Vec3 delta = posData[moved[i]]-posData[moved[j]];
@@ -278,15 +315,35 @@ void CpuCalcForcesAndEnergyKernel::beginComputation(ContextImpl& context, bool i
                 }
         }
         if (needRecompute) {
+            if (data.adaptivePadding && data.neighborListStats.numBuilds > 0)
+                data.updateNeighborListPadding();
+            double startTime = getCurrentTime();
             data.neighborList->computeNeighborList(numParticles, data.posq, data.exclusions, extractBoxVectors(context), data.isPeriodic, data.paddedCutoff, data.threads);
+            data.lastBuildTime = getCurrentTime()-startTime;
+            data.neighborListStats.buildTime += data.lastBuildTime;
+            data.neighborListStats.numBuilds++;
+            if (context.getProfilingEnabled())
+                context.recordProfileTime("Neighbor list build", data.lastBuildTime);
+            data.neighborListStats.padding = data.paddedCutoff-data.cutoff;
+            data.evaluationsSinceBuild = 0;
+            data.pairTimeSinceBuild = 0.0;
             lastPositions = posData;
+            data.neighborListDrift = 0.0;
         }
+        data.evaluationsSinceBuild++;
     }
+    data.neighborListStats.numEvaluations++;
 }
 
 double CpuCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context, bool includeForce, bool includeEnergy, int groups, bool& valid) {
-    // Sum the forces from all the threads.
-    
+    // Sum the forces from all the threads.  With mixed precision, each Force has already added its
+    // contribution to the double precision forces.
+
+    if (data.useMixedPrecision) {
+        if (context.getProfilingEnabled())
+            context.recordProfileTime("Thread imbalance", data.threads.getImbalanceTime());
+        return referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().finishComputation(context, includeForce, includeEnergy, groups, valid);
+    }
     data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
         // Sum the contributions to forces that have been calculated by different threads.
         
@@ -305,6 +362,8 @@ double CpuCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context, boo
         }
     });
     data.threads.waitForThreads();
+    if (context.getProfilingEnabled())
+        context.recordProfileTime("Thread imbalance", data.threads.getImbalanceTime());
     return referenceKernel.getAs<ReferenceCalcForcesAndEnergyKernel>().finishComputation(context, includeForce, includeEnergy, groups, valid);
 }
 
@@ -318,6 +377,241 @@ void CpuUpdateStateDataKernel::loadCheckpoint(ContextImpl& context, istream& str
     data.random.loadCheckpoint(stream);
 }
 
+CpuScheduleForcesKernel::~CpuScheduleForcesKernel() {
+    if (helperThread != NULL)
+        delete helperThread;
+}
+
+void CpuScheduleForcesKernel::initialize(const System& system) {
+    // These reference kernels are single threaded and only add to the force and energy parameter
+    // derivative arrays, so they can safely run at the same time as the CPU kernels.
+
+    serialKernels = {CalcCustomExternalForceKernel::Name(), CalcCustomHbondForceKernel::Name(), CalcRMSDForceKernel::Name()};
+
+    // These CPU kernels use the main thread pool, and only access the forces through the CPU platform data.
+
+    threadedKernels = {CalcHarmonicBondForceKernel::Name(), CalcCustomBondForceKernel::Name(), CalcHarmonicAngleForceKernel::Name(),
+        CalcCustomAngleForceKernel::Name(), CalcPeriodicTorsionForceKernel::Name(), CalcRBTorsionForceKernel::Name(),
+        CalcCMAPTorsionForceKernel::Name(), CalcCustomTorsionForceKernel::Name(), CalcCustomCentroidBondForceKernel::Name(),
+        CalcCustomCompoundBondForceKernel::Name(), CalcNonbondedForceKernel::Name(), CalcCustomNonbondedForceKernel::Name(),
+        CalcCustomManyParticleForceKernel::Name(), CalcGBSAOBCForceKernel::Name(), CalcCustomGBForceKernel::Name(),
+        CalcGayBerneForceKernel::Name()};
+}
+
+static bool usesOnlyKernels(ForceImpl* impl, const set<string>& kernels) {
+    for (const string& name : impl->getKernelNames())
+        if (kernels.find(name) == kernels.end())
+            return false;
+    return true;
+}
+
+double CpuScheduleForcesKernel::execute(ContextImpl& context, const vector<ForceImpl*>& forceImpls, bool includeForce, bool includeEnergy, int groups) {
+    vector<ForceImpl*> serial, threaded, remaining;
+    for (ForceImpl* impl : forceImpls) {
+        if (usesOnlyKernels(impl, serialKernels))
+            serial.push_back(impl);
+        else if (usesOnlyKernels(impl, threadedKernels))
+            threaded.push_back(impl);
+        else
+            remaining.push_back(impl);
+    }
+    double energy = 0.0;
+    if (serial.size() == 0 || threaded.size() == 0) {
+        for (ForceImpl* impl : forceImpls)
+            energy += impl->calcForcesAndEnergy(context, includeForce, includeEnergy, groups);
+        return energy;
+    }
+
+    // Redirect the reference platform's arrays to private ones, then compute the serial forces on the
+    // helper thread while the threaded ones are computed on this one.  Whatever arrays the reference
+    // platform was using (possibly ones a caller has redirected it to) are where all results belong,
+    // so the CPU kernels are told to use them, and they are restored afterward.
+
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    vector<Vec3>* forces = refData->forces;
+    map<string, double>* energyParamDerivs = refData->energyParameterDerivatives;
+    if (helperThread == NULL)
+        helperThread = new ThreadPool(1);
+    helperForces.resize(forces->size());
+    for (Vec3& f : helperForces)
+        f = Vec3();
+    helperParamDerivs = *energyParamDerivs;
+    for (auto& deriv : helperParamDerivs)
+        deriv.second = 0.0;
+    refData->forces = &helperForces;
+    refData->energyParameterDerivatives = &helperParamDerivs;
+    data.concurrentForces = forces;
+    data.concurrentEnergyParameterDerivatives = energyParamDerivs;
+    double helperEnergy = 0.0;
+    string helperError;
+    helperThread->execute([&] (ThreadPool& threads, int threadIndex) {
+        try {
+            for (ForceImpl* impl : serial)
+                helperEnergy += impl->calcForcesAndEnergy(context, includeForce, includeEnergy, groups);
+        }
+        catch (exception& ex) {
+            helperError = ex.what();
+        }
+    });
+    try {
+        for (ForceImpl* impl : threaded)
+            energy += impl->calcForcesAndEnergy(context, includeForce, includeEnergy, groups);
+    }
+    catch (...) {
+        helperThread->waitForThreads();
+        refData->forces = forces;
+        refData->energyParameterDerivatives = energyParamDerivs;
+        data.concurrentForces = NULL;
+        data.concurrentEnergyParameterDerivatives = NULL;
+        throw;
+    }
+    helperThread->waitForThreads();
+    refData->forces = forces;
+    refData->energyParameterDerivatives = energyParamDerivs;
+    data.concurrentForces = NULL;
+    data.concurrentEnergyParameterDerivatives = NULL;
+    if (helperError.size() > 0)
+        throw OpenMMException(helperError);
+    energy += helperEnergy;
+    if (includeForce)
+        for (int i = 0; i < forces->size(); i++)
+            (*forces)[i] += helperForces[i];
+    for (auto& deriv : helperParamDerivs)
+        (*energyParamDerivs)[deriv.first] += deriv.second;
+
+    // Any other forces are computed sequentially.
+
+    for (ForceImpl* impl : remaining)
+        energy += impl->calcForcesAndEnergy(context, includeForce, includeEnergy, groups);
+    return energy;
+}
+
+CpuMinimizeKernel::~CpuMinimizeKernel() {
+    if (minimizer != NULL)
+        delete minimizer;
+}
+
+void CpuMinimizeKernel::initialize(const System& system) {
+    minimizer = new CpuMinimizer(system, data.threads);
+}
+
+void CpuMinimizeKernel::execute(ContextImpl& context, double tolerance, int maxIterations, MinimizationReporter* reporter) {
+    minimizer->minimize(context, tolerance, maxIterations, reporter);
+}
+
+void CpuMinimizeKernel::executeBatch(ContextImpl& context, vector<vector<Vec3> >& positions, vector<double>& energies, double tolerance, int maxIterations) {
+    // Each thread has a single threaded Context with the same settings as this one.  The platform keeps
+    // them between calls.
+
+    int numConformations = positions.size();
+    int numWorkers = min(data.threads.getNumThreads(), numConformations);
+    int groups = context.getIntegrator().getIntegrationForceGroups();
+    const vector<Context*>& workers = data.getWorkerContexts(context, numWorkers);
+    vector<string> errors(numWorkers);
+
+    // Each thread repeatedly takes the next conformation and minimizes it until none are left.
+
+    atomic<int> nextConformation(0);
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        if (threadIndex >= numWorkers)
+            return;
+        Context& worker = *workers[threadIndex];
+        try {
+            while (true) {
+                int i = nextConformation++;
+                if (i >= numConformations)
+                    break;
+                worker.setPositions(positions[i]);
+                LocalEnergyMinimizer::minimize(worker, tolerance, maxIterations);
+                State state = worker.getState(State::Positions | State::Energy, false, groups);
+                positions[i] = state.getPositions();
+                energies[i] = state.getPotentialEnergy();
+            }
+        }
+        catch (exception& ex) {
+            errors[threadIndex] = ex.what();
+        }
+    });
+    data.threads.waitForThreads();
+    for (string& error : errors)
+        if (error.size() > 0)
+            throw OpenMMException(error);
+    context.setPositions(positions[numConformations-1]);
+}
+
+void CpuCalcHarmonicBondForceKernel::initialize(const System& system, const HarmonicBondForce& force) {
+    numBonds = force.getNumBonds();
+    bondIndexArray.resize(numBonds, vector<int>(2));
+    bondParamArray.resize(numBonds, vector<double>(2));
+    for (int i = 0; i < numBonds; ++i) {
+        int particle1, particle2;
+        double length, k;
+        force.getBondParameters(i, particle1, particle2, length, k);
+        bondIndexArray[i][0] = particle1;
+        bondIndexArray[i][1] = particle2;
+        bondParamArray[i][0] = length;
+        bondParamArray[i][1] = k;
+    }
+    bondForce.initialize(system.getNumParticles(), numBonds, 2, bondIndexArray, data.threads);
+    usePeriodic = force.usesPeriodicBoundaryConditions();
+}
+
+double CpuCalcHarmonicBondForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& forceData = extractForces(context);
+    double energy = 0;
+    ReferenceHarmonicBondIxn harmonicBond;
+    if (usePeriodic)
+        harmonicBond.setPeriodic(extractBoxVectors(context));
+    bondForce.calculateForce(posData, bondParamArray, forceData, includeEnergy ? &energy : NULL, harmonicBond);
+    return energy;
+}
+
+void CpuCalcHarmonicBondForceKernel::copyParametersToContext(ContextImpl& context, const HarmonicBondForce& force, int firstBond, int lastBond) {
+    if (numBonds != force.getNumBonds())
+        throw OpenMMException("updateParametersInContext: The number of bonds has changed");
+
+    // Record the values.
+
+    for (int i = firstBond; i <= lastBond; ++i) {
+        int particle1, particle2;
+        double length, k;
+        force.getBondParameters(i, particle1, particle2, length, k);
+        if (particle1 != bondIndexArray[i][0] || particle2 != bondIndexArray[i][1])
+            throw OpenMMException("updateParametersInContext: The set of particles in a bond has changed");
+        bondParamArray[i][0] = length;
+        bondParamArray[i][1] = k;
+    }
+}
+
+void CpuCalcCustomBondForceKernel::initialize(const System& system, const CustomBondForce& force) {
+    numBonds = force.getNumBonds();
+    vector<string> parameterNames, globalParameterNames, energyParamDerivNames;
+    for (int i = 0; i < force.getNumPerBondParameters(); i++)
+        parameterNames.push_back(force.getPerBondParameterName(i));
+    for (int i = 0; i < force.getNumGlobalParameters(); i++)
+        globalParameterNames.push_back(force.getGlobalParameterName(i));
+    for (int i = 0; i < force.getNumEnergyParameterDerivatives(); i++)
+        energyParamDerivNames.push_back(force.getEnergyParameterDerivativeName(i));
+    Lepton::ParsedExpression expression = parseCustomBondedExpression(force.getEnergyFunction(), "r", parameterNames, globalParameterNames);
+    bondForce.initialize(system.getNumParticles(), numBonds, 2, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getBondParameters(index, atoms[0], atoms[1], params);
+    }, expression, "r", parameterNames, globalParameterNames, energyParamDerivNames, force.usesPeriodicBoundaryConditions(), data.threads);
+}
+
+double CpuCalcCustomBondForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    return bondForce.calculateForce(context, extractPositions(context), extractForces(context), extractBoxVectors(context),
+            extractEnergyParameterDerivatives(context), includeEnergy);
+}
+
+void CpuCalcCustomBondForceKernel::copyParametersToContext(ContextImpl& context, const CustomBondForce& force, int firstBond, int lastBond) {
+    if (numBonds != force.getNumBonds())
+        throw OpenMMException("updateParametersInContext: The number of bonds has changed");
+    bondForce.copyParameters(firstBond, lastBond, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getBondParameters(index, atoms[0], atoms[1], params);
+    }, "a bond");
+}
+
 void CpuCalcHarmonicAngleForceKernel::initialize(const System& system, const HarmonicAngleForce& force) {
     numAngles = force.getNumAngles();
     angleIndexArray.resize(numAngles, vector<int>(3));
@@ -364,6 +658,34 @@ void CpuCalcHarmonicAngleForceKernel::copyParametersToContext(ContextImpl& conte
     }
 }
 
+void CpuCalcCustomAngleForceKernel::initialize(const System& system, const CustomAngleForce& force) {
+    numAngles = force.getNumAngles();
+    vector<string> parameterNames, globalParameterNames, energyParamDerivNames;
+    for (int i = 0; i < force.getNumPerAngleParameters(); i++)
+        parameterNames.push_back(force.getPerAngleParameterName(i));
+    for (int i = 0; i < force.getNumGlobalParameters(); i++)
+        globalParameterNames.push_back(force.getGlobalParameterName(i));
+    for (int i = 0; i < force.getNumEnergyParameterDerivatives(); i++)
+        energyParamDerivNames.push_back(force.getEnergyParameterDerivativeName(i));
+    Lepton::ParsedExpression expression = parseCustomBondedExpression(force.getEnergyFunction(), "theta", parameterNames, globalParameterNames);
+    angleForce.initialize(system.getNumParticles(), numAngles, 3, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getAngleParameters(index, atoms[0], atoms[1], atoms[2], params);
+    }, expression, "theta", parameterNames, globalParameterNames, energyParamDerivNames, force.usesPeriodicBoundaryConditions(), data.threads);
+}
+
+double CpuCalcCustomAngleForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    return angleForce.calculateForce(context, extractPositions(context), extractForces(context), extractBoxVectors(context),
+            extractEnergyParameterDerivatives(context), includeEnergy);
+}
+
+void CpuCalcCustomAngleForceKernel::copyParametersToContext(ContextImpl& context, const CustomAngleForce& force, int firstAngle, int lastAngle) {
+    if (numAngles != force.getNumAngles())
+        throw OpenMMException("updateParametersInContext: The number of angles has changed");
+    angleForce.copyParameters(firstAngle, lastAngle, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getAngleParameters(index, atoms[0], atoms[1], atoms[2], params);
+    }, "an angle");
+}
+
 void CpuCalcPeriodicTorsionForceKernel::initialize(const System& system, const PeriodicTorsionForce& force) {
     numTorsions = force.getNumTorsions();
     torsionIndexArray.resize(numTorsions, vector<int>(4));
@@ -490,6 +812,120 @@ private:
 
 CpuNonbondedForce* createCpuNonbondedForceVec(const CpuNeighborList& neighbors);
 
+CpuCalcCMAPTorsionForceKernel::~CpuCalcCMAPTorsionForceKernel() {
+    if (ixn != NULL)
+        delete ixn;
+}
+
+void CpuCalcCMAPTorsionForceKernel::initialize(const System& system, const CMAPTorsionForce& force) {
+    int numMaps = force.getNumMaps();
+    int numTorsions = force.getNumTorsions();
+    coeff.resize(numMaps);
+    vector<double> energy;
+    vector<vector<double> > c;
+    for (int i = 0; i < numMaps; i++) {
+        int size;
+        force.getMapParameters(i, size, energy);
+        CMAPTorsionForceImpl::calcMapDerivatives(size, energy, c);
+        coeff[i].resize(size*size);
+        for (int j = 0; j < size*size; j++) {
+            coeff[i][j].resize(16);
+            for (int k = 0; k < 16; k++)
+                coeff[i][j][k] = c[j][k];
+        }
+    }
+    torsionMaps.resize(numTorsions);
+    torsionIndices.resize(numTorsions);
+    torsionParamArray.resize(numTorsions, vector<double>(1));
+    for (int i = 0; i < numTorsions; i++) {
+        torsionIndices[i].resize(8);
+        force.getTorsionParameters(i, torsionMaps[i], torsionIndices[i][0], torsionIndices[i][1], torsionIndices[i][2],
+            torsionIndices[i][3], torsionIndices[i][4], torsionIndices[i][5], torsionIndices[i][6], torsionIndices[i][7]);
+        torsionParamArray[i][0] = torsionMaps[i];
+    }
+    bondForce.initialize(system.getNumParticles(), numTorsions, 8, torsionIndices, data.threads);
+    ixn = new ReferenceCMAPTorsionIxn(coeff, torsionMaps, torsionIndices);
+    usePeriodic = force.usesPeriodicBoundaryConditions();
+}
+
+double CpuCalcCMAPTorsionForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& forceData = extractForces(context);
+    double energy = 0;
+    if (usePeriodic)
+        ixn->setPeriodic(extractBoxVectors(context));
+    bondForce.calculateForce(posData, torsionParamArray, forceData, includeEnergy ? &energy : NULL, *ixn);
+    return energy;
+}
+
+void CpuCalcCMAPTorsionForceKernel::copyParametersToContext(ContextImpl& context, const CMAPTorsionForce& force) {
+    int numMaps = force.getNumMaps();
+    int numTorsions = force.getNumTorsions();
+    if (coeff.size() != numMaps)
+        throw OpenMMException("updateParametersInContext: The number of maps has changed");
+    if (torsionMaps.size() != numTorsions)
+        throw OpenMMException("updateParametersInContext: The number of CMAP torsions has changed");
+
+    // Update the maps.
+
+    vector<double> energy;
+    vector<vector<double> > c;
+    for (int i = 0; i < numMaps; i++) {
+        int size;
+        force.getMapParameters(i, size, energy);
+        if (coeff[i].size() != size*size)
+            throw OpenMMException("updateParametersInContext: The size of a map has changed");
+        CMAPTorsionForceImpl::calcMapDerivatives(size, energy, c);
+        for (int j = 0; j < size*size; j++)
+            for (int k = 0; k < 16; k++)
+                coeff[i][j][k] = c[j][k];
+    }
+
+    // Update the indices.
+
+    for (int i = 0; i < numTorsions; i++) {
+        int index[8];
+        force.getTorsionParameters(i, torsionMaps[i], index[0], index[1], index[2], index[3], index[4], index[5], index[6], index[7]);
+        for (int j = 0; j < 8; j++)
+            if (index[j] != torsionIndices[i][j])
+                throw OpenMMException("updateParametersInContext: The set of particles in a CMAP torsion has changed");
+        torsionParamArray[i][0] = torsionMaps[i];
+    }
+
+    // Rebuild the interaction with the new coefficients.
+
+    delete ixn;
+    ixn = new ReferenceCMAPTorsionIxn(coeff, torsionMaps, torsionIndices);
+}
+
+void CpuCalcCustomTorsionForceKernel::initialize(const System& system, const CustomTorsionForce& force) {
+    numTorsions = force.getNumTorsions();
+    vector<string> parameterNames, globalParameterNames, energyParamDerivNames;
+    for (int i = 0; i < force.getNumPerTorsionParameters(); i++)
+        parameterNames.push_back(force.getPerTorsionParameterName(i));
+    for (int i = 0; i < force.getNumGlobalParameters(); i++)
+        globalParameterNames.push_back(force.getGlobalParameterName(i));
+    for (int i = 0; i < force.getNumEnergyParameterDerivatives(); i++)
+        energyParamDerivNames.push_back(force.getEnergyParameterDerivativeName(i));
+    Lepton::ParsedExpression expression = parseCustomBondedExpression(force.getEnergyFunction(), "theta", parameterNames, globalParameterNames);
+    torsionForce.initialize(system.getNumParticles(), numTorsions, 4, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getTorsionParameters(index, atoms[0], atoms[1], atoms[2], atoms[3], params);
+    }, expression, "theta", parameterNames, globalParameterNames, energyParamDerivNames, force.usesPeriodicBoundaryConditions(), data.threads);
+}
+
+double CpuCalcCustomTorsionForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    return torsionForce.calculateForce(context, extractPositions(context), extractForces(context), extractBoxVectors(context),
+            extractEnergyParameterDerivatives(context), includeEnergy);
+}
+
+void CpuCalcCustomTorsionForceKernel::copyParametersToContext(ContextImpl& context, const CustomTorsionForce& force, int firstTorsion, int lastTorsion) {
+    if (numTorsions != force.getNumTorsions())
+        throw OpenMMException("updateParametersInContext: The number of torsions has changed");
+    torsionForce.copyParameters(firstTorsion, lastTorsion, [&] (int index, vector<int>& atoms, vector<double>& params) {
+        force.getTorsionParameters(index, atoms[0], atoms[1], atoms[2], atoms[3], params);
+    }, "a torsion");
+}
+
 CpuCalcNonbondedForceKernel::CpuCalcNonbondedForceKernel(string name, const Platform& platform, CpuPlatform::PlatformData& data) : CalcNonbondedForceKernel(name, platform),
         data(data), hasInitializedPme(false), hasInitializedDispersionPme(false), nonbonded(NULL) {
 }
@@ -602,6 +1038,7 @@ void CpuCalcNonbondedForceKernel::initialize(const System& system, const Nonbond
         useSwitchingFunction = force.getUseSwitchingFunction();
         switchingDistance = force.getSwitchingDistance();
     }
+    pmeOrder = force.getPMEInterpolationOrder();
     if (nonbondedMethod == Ewald) {
         double alpha;
         NonbondedForceImpl::calcEwaldParameters(system, force, alpha, kmax[0], kmax[1], kmax[2]);
@@ -646,7 +1083,7 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
             useOptimizedPme = getPlatform().supportsKernels(kernelNames);
             if (useOptimizedPme) {
                 optimizedPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), context);
-                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha, data.deterministicForces);
+                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha, data.deterministicForces, pmeOrder);
             }
         }
         if (nonbondedMethod == LJPME) {
@@ -658,10 +1095,10 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
             useOptimizedPme = getPlatform().supportsKernels(kernelNames);
             if (useOptimizedPme) {
                 optimizedPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), context);
-                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha, data.deterministicForces);
+                optimizedPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSize[0], gridSize[1], gridSize[2], numParticles, ewaldAlpha, data.deterministicForces, pmeOrder);
                 optimizedDispersionPme = getPlatform().createKernel(CalcDispersionPmeReciprocalForceKernel::Name(), context);
                 optimizedDispersionPme.getAs<CalcDispersionPmeReciprocalForceKernel>().initialize(dispersionGridSize[0], dispersionGridSize[1],
-                                                                                                  dispersionGridSize[2], numParticles, ewaldDispersionAlpha, data.deterministicForces);
+                                                                                                  dispersionGridSize[2], numParticles, ewaldDispersionAlpha, data.deterministicForces, pmeOrder);
             }
         }
     }
@@ -687,6 +1124,7 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
     }
     if (ewald)
         nonbonded->setUseEwald(ewaldAlpha, kmax[0], kmax[1], kmax[2]);
+    nonbonded->setPMEInterpolationOrder(pmeOrder);
     if (pme)
         nonbonded->setUsePME(ewaldAlpha, gridSize);
     if (useSwitchingFunction)
@@ -696,8 +1134,11 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
         nonbonded->setUseLJPME(ewaldDispersionAlpha, dispersionGridSize);
     }
     double nonbondedEnergy = 0;
-    if (includeDirect)
+    if (includeDirect) {
+        double startTime = getCurrentTime();
         nonbonded->calculateDirectIxn(numParticles, &posq[0], posData, particleParams, C6params, exclusions, data.threadForce, includeEnergy ? &nonbondedEnergy : NULL, data.threads);
+        data.recordPairTime(getCurrentTime()-startTime);
+    }
     if (includeReciprocal) {
         if (useOptimizedPme) {
             PmeIO io(&posq[0], &data.threadForce[0][0], numParticles);
@@ -714,6 +1155,8 @@ double CpuCalcNonbondedForceKernel::execute(ContextImpl& context, bool includeFo
             nonbonded->calculateReciprocalIxn(numParticles, &posq[0], posData, particleParams, C6params, exclusions, forceData, includeEnergy ? &nonbondedEnergy : NULL);
     }
     energy += nonbondedEnergy;
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(forceData);
     if (includeDirect) {
         ReferenceLJCoulomb14 nonbonded14;
         if (exceptionsArePeriodic) {
@@ -1042,7 +1485,11 @@ double CpuCalcCustomNonbondedForceKernel::execute(ContextImpl& context, bool inc
     if (useSwitchingFunction)
         nonbonded->setUseSwitchingFunction(switchingDistance);
     vector<double> energyParamDerivValues(energyParamDerivNames.size()+1, 0.0);
+    double startTime = getCurrentTime();
     nonbonded->calculatePairIxn(numParticles, &data.posq[0], posData, particleParamArray, globalParamValues, data.threadForce, includeForces, includeEnergy, energy, &energyParamDerivValues[0]);
+    data.recordPairTime(getCurrentTime()-startTime);
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(forceData);
     map<string, double>& energyParamDerivs = extractEnergyParameterDerivatives(context);
     for (int i = 0; i < energyParamDerivNames.size(); i++)
         energyParamDerivs[energyParamDerivNames[i]] += energyParamDerivValues[i];
@@ -1136,6 +1583,8 @@ double CpuCalcGBSAOBCForceKernel::execute(ContextImpl& context, bool includeForc
     }
     double energy = 0.0;
     obc.computeForce(data.posq, data.threadForce, includeEnergy ? &energy : NULL, data.threads);
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(extractForces(context));
     return energy;
 }
 
@@ -1331,6 +1780,8 @@ double CpuCalcCustomGBForceKernel::execute(ContextImpl& context, bool includeFor
         globalParameters[name] = context.getParameter(name);
     vector<double> energyParamDerivValues(energyParamDerivNames.size()+1, 0.0);
     ixn->calculateIxn(numParticles, &data.posq[0], particleParamArray, globalParameters, data.threadForce, includeForces, includeEnergy, energy, &energyParamDerivValues[0]);
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(forceData);
     map<string, double>& energyParamDerivs = extractEnergyParameterDerivatives(context);
     for (int i = 0; i < energyParamDerivNames.size(); i++)
         energyParamDerivs[energyParamDerivNames[i]] += energyParamDerivValues[i];
@@ -1413,6 +1864,8 @@ double CpuCalcCustomManyParticleForceKernel::execute(ContextImpl& context, bool
     }
     double energy = 0;
     ixn->calculateIxn(data.posq, particleParamArray, globalParameters, data.threadForce, includeForces, includeEnergy, energy);
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(extractForces(context));
     return energy;
 }
 
@@ -1449,67 +1902,894 @@ void CpuCalcCustomManyParticleForceKernel::copyParametersToContext(ContextImpl&
     }
 }
 
-CpuCalcGayBerneForceKernel::~CpuCalcGayBerneForceKernel() {
-    if (ixn != NULL)
-        delete ixn;
+CpuCalcCustomCentroidBondForceKernel::~CpuCalcCustomCentroidBondForceKernel() {
+    deleteInteraction();
 }
 
-void CpuCalcGayBerneForceKernel::initialize(const System& system, const GayBerneForce& force) {
-    ixn = new CpuGayBerneForce(force);
-    data.isPeriodic |= (force.getNonbondedMethod() == GayBerneForce::CutoffPeriodic);
-    if (force.getNonbondedMethod() != GayBerneForce::NoCutoff) {
-        double cutoff = force.getCutoffDistance();
-        data.requestNeighborList(cutoff, 0.1*cutoff, true, ixn->getExclusions());
-    }
-}
+void CpuCalcCustomCentroidBondForceKernel::initialize(const System& system, const CustomCentroidBondForce& force) {
+    usePeriodic = force.usesPeriodicBoundaryConditions();
 
-double CpuCalcGayBerneForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
-    return ixn->calculateForce(extractPositions(context), extractForces(context), data.threadForce, extractBoxVectors(context), data);
-}
+    // Build the arrays.
 
-void CpuCalcGayBerneForceKernel::copyParametersToContext(ContextImpl& context, const GayBerneForce& force) {
-    delete ixn;
-    ixn = NULL;
-    ixn = new CpuGayBerneForce(force);
+    int numGroups = force.getNumGroups();
+    groupAtoms.resize(numGroups);
+    vector<double> ignored;
+    for (int i = 0; i < numGroups; i++)
+        force.getGroupParameters(i, groupAtoms[i], ignored);
+    CustomCentroidBondForceImpl::computeNormalizedWeights(force, system, normalizedWeights);
+    numBonds = force.getNumBonds();
+    bondGroups.resize(numBonds);
+    bondParamArray.resize(numBonds);
+    for (int i = 0; i < numBonds; ++i)
+        force.getBondParameters(i, bondGroups[i], bondParamArray[i]);
+    groupCenters.resize(numGroups);
+    groupForces.resize(numGroups);
+
+    // Bonds are divided between threads with groups playing the role of atoms.  Record which
+    // groups each atom belongs to so the group forces can be distributed one atom at a time.
+
+    bondForce.initialize(numGroups, numBonds, force.getNumGroupsPerBond(), bondGroups, data.threads);
+    vector<vector<pair<int, double> > > weights(system.getNumParticles());
+    for (int group = 0; group < numGroups; group++)
+        for (int i = 0; i < groupAtoms[group].size(); i++)
+            weights[groupAtoms[group][i]].push_back(make_pair(group, normalizedWeights[group][i]));
+    for (int atom = 0; atom < weights.size(); atom++)
+        if (!weights[atom].empty()) {
+            groupedAtoms.push_back(atom);
+            atomGroupWeights.push_back(weights[atom]);
+        }
+
+    // Record the tabulated function update counts for future reference.
+
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++)
+        tabulatedFunctionUpdateCount[force.getTabulatedFunctionName(i)] = force.getTabulatedFunction(i).getUpdateCount();
+
+    // Create the interaction.
+
+    createInteraction(force);
 }
 
-CpuIntegrateLangevinMiddleStepKernel::~CpuIntegrateLangevinMiddleStepKernel() {
-    if (dynamics)
-        delete dynamics;
+void CpuCalcCustomCentroidBondForceKernel::createInteraction(const CustomCentroidBondForce& force) {
+    // Create custom functions for the tabulated functions.
+
+    map<string, Lepton::CustomFunction*> functions;
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++)
+        functions[force.getTabulatedFunctionName(i)] = createReferenceTabulatedFunction(force.getTabulatedFunction(i));
+
+    // Create implementations of point functions.
+
+    functions["pointdistance"] = new ReferencePointDistanceFunction(usePeriodic, &boxVectors);
+    functions["pointangle"] = new ReferencePointAngleFunction(usePeriodic, &boxVectors);
+    functions["pointdihedral"] = new ReferencePointDihedralFunction(usePeriodic, &boxVectors);
+
+    // Parse the expression and create one object per thread to calculate the interaction.
+
+    Lepton::ParsedExpression energyExpression = CustomCentroidBondForceImpl::prepareExpression(force, functions);
+    vector<string> bondParameterNames;
+    for (int i = 0; i < force.getNumPerBondParameters(); i++)
+        bondParameterNames.push_back(force.getPerBondParameterName(i));
+    globalParameterNames.clear();
+    for (int i = 0; i < force.getNumGlobalParameters(); i++)
+        globalParameterNames.push_back(force.getGlobalParameterName(i));
+    energyParamDerivNames.clear();
+    vector<Lepton::CompiledExpression> energyParamDerivExpressions;
+    for (int i = 0; i < force.getNumEnergyParameterDerivatives(); i++) {
+        string param = force.getEnergyParameterDerivativeName(i);
+        energyParamDerivNames.push_back(param);
+        energyParamDerivExpressions.push_back(energyExpression.differentiate(param).createCompiledExpression());
+    }
+    for (int i = 0; i < data.threads.getNumThreads(); i++)
+        threadIxn.push_back(new ReferenceCustomCentroidBondIxn(force.getNumGroupsPerBond(), groupAtoms, normalizedWeights, bondGroups, energyExpression, bondParameterNames, energyParamDerivExpressions));
+
+    // Delete the custom functions.
+
+    for (auto& function : functions)
+        delete function.second;
 }
 
-void CpuIntegrateLangevinMiddleStepKernel::initialize(const System& system, const LangevinMiddleIntegrator& integrator) {
-    int numParticles = system.getNumParticles();
-    masses.resize(numParticles);
-    for (int i = 0; i < numParticles; ++i)
-        masses[i] = system.getParticleMass(i);
-    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+void CpuCalcCustomCentroidBondForceKernel::deleteInteraction() {
+    for (auto ixn : threadIxn)
+        delete ixn;
+    threadIxn.clear();
 }
 
-void CpuIntegrateLangevinMiddleStepKernel::execute(ContextImpl& context, const LangevinMiddleIntegrator& integrator) {
-    double temperature = integrator.getTemperature();
-    double friction = integrator.getFriction();
-    double stepSize = integrator.getStepSize();
+double CpuCalcCustomCentroidBondForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
     vector<Vec3>& posData = extractPositions(context);
-    vector<Vec3>& velData = extractVelocities(context);
-    if (dynamics == 0 || temperature != prevTemp || friction != prevFriction || stepSize != prevStepSize) {
-        // Recreate the computation objects with the new parameters.
-        
-        if (dynamics)
-            delete dynamics;
-        dynamics = new CpuLangevinMiddleDynamics(context.getSystem().getNumParticles(), stepSize, friction, temperature, data.threads, data.random);
-        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
-        dynamics->setVirtualSites(extractVirtualSites(context));
-        prevTemp = temperature;
-        prevFriction = friction;
-        prevStepSize = stepSize;
+    vector<Vec3>& forceData = extractForces(context);
+    double energy = 0;
+    map<string, double> globalParameters;
+    for (auto& name : globalParameterNames)
+        globalParameters[name] = context.getParameter(name);
+    if (usePeriodic)
+        boxVectors = extractBoxVectors(context);
+    for (auto ixn : threadIxn) {
+        ixn->setGlobalParameters(globalParameters);
+        if (usePeriodic)
+            ixn->setPeriodic(boxVectors);
     }
-    dynamics->update(context, posData, velData, masses, integrator.getConstraintTolerance());
-    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
-    refData->time += stepSize;
-    refData->stepCount++;
+
+    // Compute the center of each group.
+
+    int numGroups = groupAtoms.size();
+    int numThreads = data.threads.getNumThreads();
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numGroups/numThreads;
+        int end = (threadIndex+1)*numGroups/numThreads;
+        for (int group = start; group < end; group++) {
+            Vec3 center;
+            for (int i = 0; i < groupAtoms[group].size(); i++)
+                center += posData[groupAtoms[group][i]]*normalizedWeights[group][i];
+            groupCenters[group] = center;
+            groupForces[group] = Vec3();
+        }
+    });
+    data.threads.waitForThreads();
+
+    // Compute the forces on groups.
+
+    vector<ReferenceBondIxn*> ixns(threadIxn.begin(), threadIxn.end());
+    vector<double> energyParamDerivValues(energyParamDerivNames.size(), 0.0);
+    bondForce.calculateForce(groupCenters, bondParamArray, groupForces, includeEnergy ? &energy : NULL, ixns, energyParamDerivValues.data(), energyParamDerivNames.size());
+
+    // Apply the forces to the individual atoms.
+
+    int numGroupedAtoms = groupedAtoms.size();
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numGroupedAtoms/numThreads;
+        int end = (threadIndex+1)*numGroupedAtoms/numThreads;
+        for (int i = start; i < end; i++) {
+            Vec3 f;
+            for (auto& groupWeight : atomGroupWeights[i])
+                f += groupForces[groupWeight.first]*groupWeight.second;
+            forceData[groupedAtoms[i]] += f;
+        }
+    });
+    data.threads.waitForThreads();
+    map<string, double>& energyParamDerivs = extractEnergyParameterDerivatives(context);
+    for (int i = 0; i < energyParamDerivNames.size(); i++)
+        energyParamDerivs[energyParamDerivNames[i]] += energyParamDerivValues[i];
+    return energy;
 }
 
-double CpuIntegrateLangevinMiddleStepKernel::computeKineticEnergy(ContextImpl& context, const LangevinMiddleIntegrator& integrator) {
-    return computeShiftedKineticEnergy(context, masses, 0.0);
+void CpuCalcCustomCentroidBondForceKernel::copyParametersToContext(ContextImpl& context, const CustomCentroidBondForce& force) {
+    if (numBonds != force.getNumBonds())
+        throw OpenMMException("updateParametersInContext: The number of bonds has changed");
+
+    // Record the values.
+
+    int numParameters = force.getNumPerBondParameters();
+    vector<int> groups;
+    vector<double> params;
+    for (int i = 0; i < numBonds; ++i) {
+        force.getBondParameters(i, groups, params);
+        for (int j = 0; j < groups.size(); j++)
+            if (groups[j] != bondGroups[i][j])
+                throw OpenMMException("updateParametersInContext: The set of groups in a bond has changed");
+        for (int j = 0; j < numParameters; j++)
+            bondParamArray[i][j] = params[j];
+    }
+
+    // See if any tabulated functions have changed.
+
+    bool changed = false;
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++) {
+        string name = force.getTabulatedFunctionName(i);
+        if (force.getTabulatedFunction(i).getUpdateCount() != tabulatedFunctionUpdateCount[name]) {
+            tabulatedFunctionUpdateCount[name] = force.getTabulatedFunction(i).getUpdateCount();
+            changed = true;
+        }
+    }
+    if (changed) {
+        deleteInteraction();
+        createInteraction(force);
+    }
+}
+
+CpuCalcCustomCompoundBondForceKernel::~CpuCalcCustomCompoundBondForceKernel() {
+    deleteInteraction();
+}
+
+void CpuCalcCustomCompoundBondForceKernel::initialize(const System& system, const CustomCompoundBondForce& force) {
+    usePeriodic = force.usesPeriodicBoundaryConditions();
+
+    // Build the arrays.
+
+    numBonds = force.getNumBonds();
+    bondParticles.resize(numBonds);
+    bondParamArray.resize(numBonds);
+    for (int i = 0; i < numBonds; ++i)
+        force.getBondParameters(i, bondParticles[i], bondParamArray[i]);
+    bondForce.initialize(system.getNumParticles(), numBonds, force.getNumParticlesPerBond(), bondParticles, data.threads);
+
+    // Record the tabulated function update counts for future reference.
+
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++)
+        tabulatedFunctionUpdateCount[force.getTabulatedFunctionName(i)] = force.getTabulatedFunction(i).getUpdateCount();
+
+    // Create the interaction.
+
+    createInteraction(force);
+}
+
+void CpuCalcCustomCompoundBondForceKernel::createInteraction(const CustomCompoundBondForce& force) {
+    // Create custom functions for the tabulated functions.
+
+    map<string, Lepton::CustomFunction*> functions;
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++)
+        functions[force.getTabulatedFunctionName(i)] = createReferenceTabulatedFunction(force.getTabulatedFunction(i));
+
+    // Create implementations of point functions.
+
+    functions["pointdistance"] = new ReferencePointDistanceFunction(usePeriodic, &boxVectors);
+    functions["pointangle"] = new ReferencePointAngleFunction(usePeriodic, &boxVectors);
+    functions["pointdihedral"] = new ReferencePointDihedralFunction(usePeriodic, &boxVectors);
+
+    // Parse the expression and create one object per thread to calculate the interaction.
+
+    Lepton::ParsedExpression energyExpression = CustomCompoundBondForceImpl::prepareExpression(force, functions);
+    vector<string> bondParameterNames;
+    for (int i = 0; i < force.getNumPerBondParameters(); i++)
+        bondParameterNames.push_back(force.getPerBondParameterName(i));
+    globalParameterNames.clear();
+    for (int i = 0; i < force.getNumGlobalParameters(); i++)
+        globalParameterNames.push_back(force.getGlobalParameterName(i));
+    energyParamDerivNames.clear();
+    vector<Lepton::CompiledExpression> energyParamDerivExpressions;
+    for (int i = 0; i < force.getNumEnergyParameterDerivatives(); i++) {
+        string param = force.getEnergyParameterDerivativeName(i);
+        energyParamDerivNames.push_back(param);
+        energyParamDerivExpressions.push_back(energyExpression.differentiate(param).createCompiledExpression());
+    }
+    for (int i = 0; i < data.threads.getNumThreads(); i++)
+        threadIxn.push_back(new ReferenceCustomCompoundBondIxn(force.getNumParticlesPerBond(), bondParticles, energyExpression, bondParameterNames, energyParamDerivExpressions));
+
+    // Delete the custom functions.
+
+    for (auto& function : functions)
+        delete function.second;
+}
+
+void CpuCalcCustomCompoundBondForceKernel::deleteInteraction() {
+    for (auto ixn : threadIxn)
+        delete ixn;
+    threadIxn.clear();
+}
+
+double CpuCalcCustomCompoundBondForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& forceData = extractForces(context);
+    double energy = 0;
+    map<string, double> globalParameters;
+    for (auto& name : globalParameterNames)
+        globalParameters[name] = context.getParameter(name);
+    if (usePeriodic)
+        boxVectors = extractBoxVectors(context);
+    for (auto ixn : threadIxn) {
+        ixn->setGlobalParameters(globalParameters);
+        if (usePeriodic)
+            ixn->setPeriodic(boxVectors);
+    }
+    vector<ReferenceBondIxn*> ixns(threadIxn.begin(), threadIxn.end());
+    vector<double> energyParamDerivValues(energyParamDerivNames.size(), 0.0);
+    bondForce.calculateForce(posData, bondParamArray, forceData, includeEnergy ? &energy : NULL, ixns, energyParamDerivValues.data(), energyParamDerivNames.size());
+    map<string, double>& energyParamDerivs = extractEnergyParameterDerivatives(context);
+    for (int i = 0; i < energyParamDerivNames.size(); i++)
+        energyParamDerivs[energyParamDerivNames[i]] += energyParamDerivValues[i];
+    return energy;
+}
+
+void CpuCalcCustomCompoundBondForceKernel::copyParametersToContext(ContextImpl& context, const CustomCompoundBondForce& force) {
+    if (numBonds != force.getNumBonds())
+        throw OpenMMException("updateParametersInContext: The number of bonds has changed");
+
+    // Record the values.
+
+    int numParameters = force.getNumPerBondParameters();
+    vector<int> particles;
+    vector<double> params;
+    for (int i = 0; i < numBonds; ++i) {
+        force.getBondParameters(i, particles, params);
+        for (int j = 0; j < particles.size(); j++)
+            if (particles[j] != bondParticles[i][j])
+                throw OpenMMException("updateParametersInContext: The set of particles in a bond has changed");
+        for (int j = 0; j < numParameters; j++)
+            bondParamArray[i][j] = params[j];
+    }
+
+    // See if any tabulated functions have changed.
+
+    bool changed = false;
+    for (int i = 0; i < force.getNumTabulatedFunctions(); i++) {
+        string name = force.getTabulatedFunctionName(i);
+        if (force.getTabulatedFunction(i).getUpdateCount() != tabulatedFunctionUpdateCount[name]) {
+            tabulatedFunctionUpdateCount[name] = force.getTabulatedFunction(i).getUpdateCount();
+            changed = true;
+        }
+    }
+    if (changed) {
+        deleteInteraction();
+        createInteraction(force);
+    }
+}
+
+CpuCalcGayBerneForceKernel::~CpuCalcGayBerneForceKernel() {
+    if (ixn != NULL)
+        delete ixn;
+}
+
+void CpuCalcGayBerneForceKernel::initialize(const System& system, const GayBerneForce& force) {
+    ixn = new CpuGayBerneForce(force);
+    data.isPeriodic |= (force.getNonbondedMethod() == GayBerneForce::CutoffPeriodic);
+    if (force.getNonbondedMethod() != GayBerneForce::NoCutoff) {
+        double cutoff = force.getCutoffDistance();
+        data.requestNeighborList(cutoff, 0.1*cutoff, true, ixn->getExclusions());
+    }
+}
+
+double CpuCalcGayBerneForceKernel::execute(ContextImpl& context, bool includeForces, bool includeEnergy) {
+    vector<Vec3>& forceData = extractForces(context);
+    double energy = ixn->calculateForce(extractPositions(context), forceData, data.threadForce, extractBoxVectors(context), data);
+    if (data.useMixedPrecision)
+        data.accumulateThreadForces(forceData);
+    return energy;
+}
+
+void CpuCalcGayBerneForceKernel::copyParametersToContext(ContextImpl& context, const GayBerneForce& force) {
+    delete ixn;
+    ixn = NULL;
+    ixn = new CpuGayBerneForce(force);
+}
+
+CpuIntegrateVerletStepKernel::~CpuIntegrateVerletStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuCalcATMForceKernel::calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+        double& energy0, double& energy1) {
+    if (!concurrent) {
+        ReferenceCalcATMForceKernel::calcInnerForcesAndEnergies(innerContext0, innerContext1, includeForces, energy0, energy1);
+        return;
+    }
+    ContextImpl* innerContexts[] = {&innerContext0, &innerContext1};
+    double energies[2];
+    string errors[2];
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        try {
+            energies[threadIndex] = innerContexts[threadIndex]->calcForcesAndEnergy(includeForces, true);
+        }
+        catch (exception& ex) {
+            errors[threadIndex] = ex.what();
+        }
+    });
+    threads.waitForThreads();
+    for (string& error : errors)
+        if (error.size() > 0)
+            throw OpenMMException(error);
+    energy0 = energies[0];
+    energy1 = energies[1];
+}
+
+Context* CpuCalcATMForceKernel::createInnerContext(ContextImpl& context, const System& innerSystem, Integrator& innerIntegrator, int index) {
+    // Split the threads between the two inner contexts, unless there are too few threads or they are pinned to cores.
+
+    int numThreads = data.threads.getNumThreads();
+    concurrent = (numThreads > 1 && data.propertyValues[CpuPlatform::CpuPinThreads()] != "true");
+    if (!concurrent)
+        return NULL;
+    return data.createWorkerContext(context, innerSystem, innerIntegrator, index == 0 ? (numThreads+1)/2 : numThreads/2);
+}
+
+void CpuApplyMonteCarloBarostatKernel::initialize(const System& system, const Force& barostat, bool rigidMolecules) {
+    this->rigidMolecules = rigidMolecules;
+}
+
+void CpuApplyMonteCarloBarostatKernel::saveCoordinates(ContextImpl& context) {
+    if (!hasInitializedMolecules) {
+        if (rigidMolecules)
+            molecules = context.getMolecules();
+        else {
+            molecules.resize(context.getSystem().getNumParticles());
+            for (int i = 0; i < molecules.size(); i++)
+                molecules[i].push_back(i);
+        }
+        moleculeOffsets.resize(molecules.size());
+        hasInitializedMolecules = true;
+    }
+    savedPositions = extractPositions(context);
+    context.getPeriodicBoxVectors(savedBoxVectors[0], savedBoxVectors[1], savedBoxVectors[2]);
+}
+
+void CpuApplyMonteCarloBarostatKernel::scaleCoordinates(ContextImpl& context, double scaleX, double scaleY, double scaleZ) {
+    // Translate each molecule so its center is scaled, applying the same offset to the positions
+    // the neighbor list was built from, and record the largest distance of any atom from the center
+    // of its molecule.
+
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& neighborListPositions = data.neighborListPositions;
+    int numMolecules = molecules.size();
+    int numThreads = data.threads.getNumThreads();
+    vector<double> threadMaxRadius(numThreads, 0.0);
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        double maxRadius2 = 0.0;
+        int start = (threadIndex*numMolecules)/numThreads;
+        int end = ((threadIndex+1)*numMolecules)/numThreads;
+        for (int i = start; i < end; i++) {
+            const vector<int>& molecule = molecules[i];
+            Vec3 center;
+            for (int atom : molecule)
+                center += posData[atom];
+            center /= molecule.size();
+            for (int atom : molecule) {
+                Vec3 delta = posData[atom]-center;
+                maxRadius2 = max(maxRadius2, delta.dot(delta));
+            }
+            Vec3 offset(center[0]*(scaleX-1), center[1]*(scaleY-1), center[2]*(scaleZ-1));
+            moleculeOffsets[i] = offset;
+            for (int atom : molecule) {
+                posData[atom] += offset;
+                neighborListPositions[atom] += offset;
+            }
+        }
+        threadMaxRadius[threadIndex] = sqrt(maxRadius2);
+    });
+    data.threads.waitForThreads();
+
+    // The offsets preserve distances within molecules, but the distance between two atoms in different
+    // molecules changes by up to |scale-1| times the distance between the molecule centers.  For atoms
+    // that can be within the padded cutoff of each other, the centers are at most that distance plus two
+    // molecule radii apart.  Record the bound for this step and for undoing it.  That only holds if the
+    // box vectors were scaled the same way as the coordinates.  If they were not (for example, a change
+    // in shape), the neighbor list must be rebuilt.
+
+    Vec3 box[3];
+    context.getPeriodicBoxVectors(box[0], box[1], box[2]);
+    bool boxWasScaled = true;
+    for (int i = 0; i < 3; i++) {
+        Vec3 expected(savedBoxVectors[i][0]*scaleX, savedBoxVectors[i][1]*scaleY, savedBoxVectors[i][2]*scaleZ);
+        Vec3 delta = box[i]-expected;
+        if (sqrt(delta.dot(delta)) > 1e-6*sqrt(box[i].dot(box[i])))
+            boxWasScaled = false;
+    }
+    double maxRadius = *max_element(threadMaxRadius.begin(), threadMaxRadius.end());
+    double minScale = min(scaleX, min(scaleY, scaleZ));
+    double maxScale = max(scaleX, max(scaleY, scaleZ));
+    double maxChange = max(fabs(scaleX-1), max(fabs(scaleY-1), fabs(scaleZ-1)));
+    double maxDistance = data.paddedCutoff+2*maxRadius;
+    savedDrift = data.neighborListDrift;
+    savedNumBuilds = data.neighborListStats.numBuilds;
+    data.neighborListDrift += maxChange*maxDistance/min(minScale, 1.0);
+    inverseDrift = maxChange*maxDistance*max(maxScale, 1.0)/minScale;
+    if (!boxWasScaled) {
+        data.neighborListDrift = data.paddedCutoff;
+        inverseDrift = data.paddedCutoff;
+    }
+}
+
+void CpuApplyMonteCarloBarostatKernel::restoreCoordinates(ContextImpl& context) {
+    extractPositions(context).swap(savedPositions);
+    vector<Vec3>& neighborListPositions = data.neighborListPositions;
+    int numMolecules = molecules.size();
+    int numThreads = data.threads.getNumThreads();
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = (threadIndex*numMolecules)/numThreads;
+        int end = ((threadIndex+1)*numMolecules)/numThreads;
+        for (int i = start; i < end; i++)
+            for (int atom : molecules[i])
+                neighborListPositions[atom] -= moleculeOffsets[i];
+    });
+    data.threads.waitForThreads();
+
+    // If the neighbor list was rebuilt at the scaled positions, undoing the scaling counts as a new move.
+
+    if (data.neighborListStats.numBuilds == savedNumBuilds)
+        data.neighborListDrift = savedDrift;
+    else
+        data.neighborListDrift = inverseDrift;
+}
+
+void CpuIntegrateVerletStepKernel::initialize(const System& system, const VerletIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+}
+
+void CpuIntegrateVerletStepKernel::execute(ContextImpl& context, const VerletIntegrator& integrator) {
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || stepSize != prevStepSize) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuVerletDynamics(context.getSystem().getNumParticles(), stepSize, data.threads);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevStepSize = stepSize;
+    }
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateVerletStepKernel::computeKineticEnergy(ContextImpl& context, const VerletIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.5*integrator.getStepSize());
+}
+
+ReferenceNoseHooverDynamics* CpuIntegrateNoseHooverStepKernel::createDynamics(ContextImpl& context, double stepSize) {
+    return new CpuNoseHooverDynamics(context.getSystem().getNumParticles(), stepSize, cpuData.threads);
+}
+
+CpuIntegrateBrownianStepKernel::~CpuIntegrateBrownianStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateBrownianStepKernel::initialize(const System& system, const BrownianIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateBrownianStepKernel::execute(ContextImpl& context, const BrownianIntegrator& integrator) {
+    double temperature = integrator.getTemperature();
+    double friction = integrator.getFriction();
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || temperature != prevTemp || friction != prevFriction || stepSize != prevStepSize) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuBrownianDynamics(context.getSystem().getNumParticles(), stepSize, friction, temperature, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevFriction = friction;
+        prevStepSize = stepSize;
+    }
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateBrownianStepKernel::computeKineticEnergy(ContextImpl& context, const BrownianIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0);
+}
+
+CpuIntegrateVariableVerletStepKernel::~CpuIntegrateVariableVerletStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateVariableVerletStepKernel::initialize(const System& system, const VariableVerletIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+}
+
+double CpuIntegrateVariableVerletStepKernel::execute(ContextImpl& context, const VariableVerletIntegrator& integrator, double maxTime) {
+    double errorTol = integrator.getErrorTolerance();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || errorTol != prevErrorTol) {
+        // Recreate the computation objects with the new parameters.
+
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuVariableVerletDynamics(context.getSystem().getNumParticles(), errorTol, data.threads);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevErrorTol = errorTol;
+    }
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    double maxStepSize = maxTime-refData->time;
+    if (integrator.getMaximumStepSize() > 0)
+        maxStepSize = min(integrator.getMaximumStepSize(), maxStepSize);
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, maxStepSize, integrator.getConstraintTolerance());
+    refData->time += dynamics->getDeltaT();
+    if (dynamics->getDeltaT() == maxStepSize)
+        refData->time = maxTime; // Avoid round-off error
+    refData->stepCount++;
+    return dynamics->getDeltaT();
+}
+
+double CpuIntegrateVariableVerletStepKernel::computeKineticEnergy(ContextImpl& context, const VariableVerletIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.5*integrator.getStepSize());
+}
+
+CpuIntegrateVariableLangevinStepKernel::~CpuIntegrateVariableLangevinStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateVariableLangevinStepKernel::initialize(const System& system, const VariableLangevinIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+double CpuIntegrateVariableLangevinStepKernel::execute(ContextImpl& context, const VariableLangevinIntegrator& integrator, double maxTime) {
+    double temperature = integrator.getTemperature();
+    double friction = integrator.getFriction();
+    double errorTol = integrator.getErrorTolerance();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || temperature != prevTemp || friction != prevFriction || errorTol != prevErrorTol) {
+        // Recreate the computation objects with the new parameters.
+
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuVariableStochasticDynamics(context.getSystem().getNumParticles(), friction, temperature, errorTol, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevFriction = friction;
+        prevErrorTol = errorTol;
+    }
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    double maxStepSize = maxTime-refData->time;
+    if (integrator.getMaximumStepSize() > 0)
+        maxStepSize = min(integrator.getMaximumStepSize(), maxStepSize);
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, maxStepSize, integrator.getConstraintTolerance());
+    refData->time += dynamics->getDeltaT();
+    if (dynamics->getDeltaT() == maxStepSize)
+        refData->time = maxTime; // Avoid round-off error
+    refData->stepCount++;
+    return dynamics->getDeltaT();
+}
+
+double CpuIntegrateVariableLangevinStepKernel::computeKineticEnergy(ContextImpl& context, const VariableLangevinIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.5*integrator.getStepSize());
+}
+
+void CpuIntegrateCustomStepKernel::initialize(const System& system, const CustomIntegrator& integrator) {
+    ReferenceIntegrateCustomStepKernel::initialize(system, integrator);
+    cpuData.random.initialize(integrator.getRandomNumberSeed(), cpuData.threads.getNumThreads());
+}
+
+ReferenceCustomDynamics* CpuIntegrateCustomStepKernel::createDynamics(const System& system, const CustomIntegrator& integrator) {
+    return new CpuCustomDynamics(system.getNumParticles(), integrator, cpuData.threads, cpuData.random);
+}
+
+CpuIntegrateLangevinMiddleStepKernel::~CpuIntegrateLangevinMiddleStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateLangevinMiddleStepKernel::initialize(const System& system, const LangevinMiddleIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateLangevinMiddleStepKernel::execute(ContextImpl& context, const LangevinMiddleIntegrator& integrator) {
+    double temperature = integrator.getTemperature();
+    double friction = integrator.getFriction();
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    if (dynamics == 0 || temperature != prevTemp || friction != prevFriction || stepSize != prevStepSize) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuLangevinMiddleDynamics(context.getSystem().getNumParticles(), stepSize, friction, temperature, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevFriction = friction;
+        prevStepSize = stepSize;
+    }
+    dynamics->update(context, posData, velData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateLangevinMiddleStepKernel::computeKineticEnergy(ContextImpl& context, const LangevinMiddleIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.0);
+}
+
+CpuIntegrateIndirectReconstructionStepKernel::~CpuIntegrateIndirectReconstructionStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateIndirectReconstructionStepKernel::initialize(const System& system, const IndirectReconstructionIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateIndirectReconstructionStepKernel::execute(ContextImpl& context, const IndirectReconstructionIntegrator& integrator) {
+    double temperature = integrator.getTemperature();
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || temperature != prevTemp || stepSize != prevStepSize || lambda != prevLambda || reactionCoordinate != prevReactionCoordinate) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuIndirectReconstructionDynamics(context.getSystem().getNumParticles(), stepSize, temperature, reactionCoordinate, lambda, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevStepSize = stepSize;
+        prevLambda = lambda;
+        prevReactionCoordinate = reactionCoordinate;
+    }
+    dynamics->setMacroscopicVariable(macroscopicVariable);
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateIndirectReconstructionStepKernel::computeKineticEnergy(ContextImpl& context, const IndirectReconstructionIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.0);
+}
+
+CpuIntegrateDampedReconstructionStepKernel::~CpuIntegrateDampedReconstructionStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateDampedReconstructionStepKernel::initialize(const System& system, const DampedReconstructionIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateDampedReconstructionStepKernel::execute(ContextImpl& context, const DampedReconstructionIntegrator& integrator) {
+    double temperature = integrator.getTemperature();
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || temperature != prevTemp || stepSize != prevStepSize || lambda != prevLambda || gamma != prevGamma ||
+            reactionCoordinate != prevReactionCoordinate) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuDampedReconstructionDynamics(context.getSystem().getNumParticles(), stepSize, temperature, reactionCoordinate, lambda, gamma, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevStepSize = stepSize;
+        prevLambda = lambda;
+        prevGamma = gamma;
+        prevReactionCoordinate = reactionCoordinate;
+    }
+    dynamics->setMacroscopicVariable(macroscopicVariable);
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateDampedReconstructionStepKernel::computeKineticEnergy(ContextImpl& context, const DampedReconstructionIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.0);
+}
+
+CpuIntegrateRandomWalkStepKernel::~CpuIntegrateRandomWalkStepKernel() {
+    if (dynamics)
+        delete dynamics;
+}
+
+void CpuIntegrateRandomWalkStepKernel::initialize(const System& system, const RandomWalkIntegrator& integrator) {
+    int numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateRandomWalkStepKernel::execute(ContextImpl& context, const RandomWalkIntegrator& integrator) {
+    double temperature = integrator.getTemperature();
+    double stepSize = integrator.getStepSize();
+    vector<Vec3>& posData = extractPositions(context);
+    vector<Vec3>& velData = extractVelocities(context);
+    vector<Vec3>& forceData = extractForces(context);
+    if (dynamics == 0 || temperature != prevTemp || stepSize != prevStepSize || _period != prevPeriod) {
+        // Recreate the computation objects with the new parameters.
+        
+        if (dynamics)
+            delete dynamics;
+        dynamics = new CpuRandomWalkDynamics(context.getSystem().getNumParticles(), stepSize, temperature, _period, data.threads, data.random);
+        dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
+        prevTemp = temperature;
+        prevStepSize = stepSize;
+        prevPeriod = _period;
+    }
+    dynamics->update(context.getSystem(), posData, velData, forceData, masses, integrator.getConstraintTolerance());
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    refData->time += stepSize;
+    refData->stepCount++;
+}
+
+double CpuIntegrateRandomWalkStepKernel::computeKineticEnergy(ContextImpl& context, const RandomWalkIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0.0);
+}
+
+void CpuIntegrateRandomWalkEnsembleStepKernel::initialize(const System& system, const RandomWalkEnsembleIntegrator& integrator) {
+    ReferenceIntegrateRandomWalkEnsembleStepKernel::initialize(system, integrator);
+    threadNoise.resize(data.threads.getNumThreads());
+    for (auto& noise : threadNoise)
+        noise.resize(3*numParticles);
+    data.random.initialize(integrator.getRandomNumberSeed(), data.threads.getNumThreads());
+}
+
+void CpuIntegrateRandomWalkEnsembleStepKernel::propose(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator) {
+    const double noiseAmplitude = sqrt(2.0*BOLTZ*integrator.getTemperature()*integrator.getStepSize());
+    const double period = integrator.getPeriod();
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numChains/threads.getNumThreads();
+        int end = (threadIndex+1)*numChains/threads.getNumThreads();
+        float* noise = &threadNoise[threadIndex][0];
+        double* current[] = {&x[0], &y[0], &z[0]};
+        double* proposed[] = {&proposedX[0], &proposedY[0], &proposedZ[0]};
+        for (int chain = start; chain < end; chain++) {
+            data.random.getGaussianRandom(threadIndex, noise, 3*numParticles);
+            int offset = chain*numParticles;
+            for (int j = 0; j < 3; j++) {
+                const double* from = current[j]+offset;
+                double* to = proposed[j]+offset;
+                const float* chainNoise = noise+j*numParticles;
+                for (int i = 0; i < numParticles; i++)
+                    to[i] = (masses[i] == 0.0 ? from[i] : from[i]+noiseAmplitude*chainNoise[i]);
+                if (period > 0.0)
+                    for (int i = 0; i < numParticles; i++)
+                        to[i] -= round(to[i]/(2.0*period))*2.0*period;
+            }
+        }
+    });
+    data.threads.waitForThreads();
+}
+
+void CpuIntegrateRandomWalkEnsembleStepKernel::acceptOrReject(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator, const vector<double>& energies) {
+    const double kT = BOLTZ*integrator.getTemperature();
+    data.threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numChains/threads.getNumThreads();
+        int end = (threadIndex+1)*numChains/threads.getNumThreads();
+        for (int chain = start; chain < end; chain++) {
+            double deltaEnergy = energies[chain]-chainEnergy[chain];
+            if (deltaEnergy <= 0.0 || data.random.getUniformRandom(threadIndex) < exp(-deltaEnergy/kT)) {
+                int offset = chain*numParticles;
+                copy(proposedX.begin()+offset, proposedX.begin()+offset+numParticles, x.begin()+offset);
+                copy(proposedY.begin()+offset, proposedY.begin()+offset+numParticles, y.begin()+offset);
+                copy(proposedZ.begin()+offset, proposedZ.begin()+offset+numParticles, z.begin()+offset);
+                chainEnergy[chain] = energies[chain];
+                numAccepted[chain]++;
+            }
+        }
+    });
+    data.threads.waitForThreads();
+    numProposed++;
+    ReferenceIntegrateRandomWalkEnsembleStepKernel::data.time += integrator.getStepSize();
+    ReferenceIntegrateRandomWalkEnsembleStepKernel::data.stepCount++;
 }
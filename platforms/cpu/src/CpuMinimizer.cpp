@@ -0,0 +1,278 @@
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuMinimizer.h"
+#include "ReferencePlatform.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/Platform.h"
+#include "lbfgs.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+using namespace OpenMM;
+using namespace std;
+
+// For small systems copying between the arrays is cheaper than synchronizing the threads.
+
+static const int minParticlesPerThread = 2000;
+
+CpuMinimizer::CpuMinimizer(const System& system, ThreadPool& threads) : system(system), threads(threads), context(NULL), reporter(NULL),
+        k(0.0), x(NULL), doubleIntegrator(1.0), doubleContext(NULL) {
+    numParticles = system.getNumParticles();
+    isMassless.resize(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        isMassless[i] = (system.getParticleMass(i) == 0.0);
+    threadNonfinite.resize(threads.getNumThreads());
+    x = lbfgs_malloc(3*numParticles);
+    if (x == NULL)
+        throw OpenMMException("CpuMinimizer: Failed to allocate memory");
+}
+
+CpuMinimizer::~CpuMinimizer() {
+    if (doubleContext != NULL)
+        delete doubleContext;
+    lbfgs_free(x);
+}
+
+template <class F>
+void CpuMinimizer::forEachRange(F function) {
+    int numThreads = threads.getNumThreads();
+    if (numThreads == 1 || numParticles < numThreads*minParticlesPerThread) {
+        function(0, numParticles, 0);
+        return;
+    }
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numParticles/numThreads;
+        int end = (threadIndex+1)*numParticles/numThreads;
+        function(start, end, threadIndex);
+    });
+    threads.waitForThreads();
+}
+
+double CpuMinimizer::evaluateCallback(void* instance, const double* coords, double* grad, const int n, const double step) {
+    return reinterpret_cast<CpuMinimizer*>(instance)->evaluate(coords, grad);
+}
+
+int CpuMinimizer::reportCallback(void* instance, const double* coords, const double* grad, const double fx, const double xnorm,
+            const double gnorm, const double step, int n, int iteration, int ls) {
+    return reinterpret_cast<CpuMinimizer*>(instance)->report(iteration-1, coords, grad, fx) ? 1 : 0;
+}
+
+double CpuMinimizer::evaluate(const double* coords, double* grad) {
+    ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(context->getPlatformData());
+    vector<Vec3>& positions = *data->positions;
+    vector<Vec3>& forces = *data->forces;
+
+    // Compute the force and energy for this configuration.
+
+    forEachRange([&] (int start, int end, int threadIndex) {
+        for (int i = start; i < end; i++)
+            positions[i] = Vec3(coords[3*i], coords[3*i+1], coords[3*i+2]);
+    });
+    context->computeVirtualSites();
+    double energy = context->calcForcesAndEnergy(true, true, context->getIntegrator().getIntegrationForceGroups());
+    fill(threadNonfinite.begin(), threadNonfinite.end(), 0);
+    forEachRange([&] (int start, int end, int threadIndex) {
+        bool finite = true;
+        for (int i = start; i < end; i++) {
+            if (isMassless[i]) {
+                grad[3*i] = 0.0;
+                grad[3*i+1] = 0.0;
+                grad[3*i+2] = 0.0;
+            }
+            else {
+                grad[3*i] = -forces[i][0];
+                grad[3*i+1] = -forces[i][1];
+                grad[3*i+2] = -forces[i][2];
+                finite &= (isfinite(forces[i][0]) && isfinite(forces[i][1]) && isfinite(forces[i][2]));
+            }
+        }
+        if (!finite)
+            threadNonfinite[threadIndex] = 1;
+    });
+    bool finite = isfinite(energy);
+    for (char flag : threadNonfinite)
+        finite &= (flag == 0);
+    if (!finite)
+        energy = evaluateInDoublePrecision(grad);
+
+    // Add harmonic forces for any constraints.
+
+    int numConstraints = system.getNumConstraints();
+    for (int i = 0; i < numConstraints; i++) {
+        int particle1, particle2;
+        double distance;
+        system.getConstraintParameters(i, particle1, particle2, distance);
+        Vec3 delta(coords[3*particle2]-coords[3*particle1], coords[3*particle2+1]-coords[3*particle1+1], coords[3*particle2+2]-coords[3*particle1+2]);
+        double r = sqrt(delta.dot(delta));
+        delta *= 1/r;
+        double dr = r-distance;
+        double kdr = k*dr;
+        energy += 0.5*kdr*dr;
+        if (!isMassless[particle1]) {
+            grad[3*particle1] -= kdr*delta[0];
+            grad[3*particle1+1] -= kdr*delta[1];
+            grad[3*particle1+2] -= kdr*delta[2];
+        }
+        if (!isMassless[particle2]) {
+            grad[3*particle2] += kdr*delta[0];
+            grad[3*particle2+1] += kdr*delta[1];
+            grad[3*particle2+2] += kdr*delta[2];
+        }
+    }
+    return energy;
+}
+
+double CpuMinimizer::evaluateInDoublePrecision(double* grad) {
+    if (doubleContext == NULL) {
+        doubleContext = new Context(system, doubleIntegrator, Platform::getPlatformByName("Reference"));
+        doubleContext->setState(context->getOwner().getState(State::Positions | State::Velocities | State::Parameters));
+    }
+    vector<Vec3>& positions = *reinterpret_cast<ReferencePlatform::PlatformData*>(context->getPlatformData())->positions;
+    doubleContext->setPositions(positions);
+    State state = doubleContext->getState(State::Forces | State::Energy, false, context->getIntegrator().getIntegrationForceGroups());
+    const vector<Vec3>& forces = state.getForces();
+    for (int i = 0; i < numParticles; i++) {
+        for (int j = 0; j < 3; j++)
+            grad[3*i+j] = (isMassless[i] ? 0.0 : -forces[i][j]);
+    }
+    return state.getPotentialEnergy();
+}
+
+bool CpuMinimizer::report(int iteration, const double* coords, const double* grad, double objective) {
+    int n = 3*numParticles;
+    reportX.assign(coords, coords+n);
+    reportGrad.assign(grad, grad+n);
+    double restraintEnergy = 0.0, maxError = 0.0;
+    for (int i = 0; i < system.getNumConstraints(); i++) {
+        int p1, p2;
+        double distance;
+        system.getConstraintParameters(i, p1, p2, distance);
+        Vec3 delta(coords[3*p1]-coords[3*p2], coords[3*p1+1]-coords[3*p2+1], coords[3*p1+2]-coords[3*p2+2]);
+        double dr = sqrt(delta.dot(delta))-distance;
+        restraintEnergy += 0.5*k*dr*dr;
+        maxError = max(maxError, fabs(dr)/distance);
+    }
+    map<string, double> args;
+    args["restraint energy"] = restraintEnergy;
+    args["system energy"] = objective-restraintEnergy;
+    args["restraint strength"] = k;
+    args["max constraint error"] = maxError;
+    return reporter->report(iteration, reportX, reportGrad, args);
+}
+
+void CpuMinimizer::minimize(ContextImpl& context, double tolerance, int maxIterations, MinimizationReporter* reporter) {
+    this->context = &context;
+    this->reporter = reporter;
+    double constraintTol = context.getIntegrator().getConstraintTolerance();
+    double workingConstraintTol = max(1e-4, constraintTol);
+    k = 100/workingConstraintTol;
+
+    // Use the same parameters as LocalEnergyMinimizer.
+
+    lbfgs_parameter_t param;
+    lbfgs_parameter_init(&param);
+    if (!context.getPlatform().supportsDoublePrecision())
+        param.xtol = 1e-7;
+    param.max_iterations = maxIterations;
+    param.linesearch = LBFGS_LINESEARCH_BACKTRACKING_STRONG_WOLFE;
+
+    // Make sure the initial configuration satisfies all constraints.
+
+    context.applyConstraints(workingConstraintTol);
+
+    // Record the initial positions and determine a normalization constant for scaling the tolerance.
+
+    vector<Vec3> initialPos;
+    context.getPositions(initialPos);
+    double norm = 0.0;
+    for (int i = 0; i < numParticles; i++) {
+        x[3*i] = initialPos[i][0];
+        x[3*i+1] = initialPos[i][1];
+        x[3*i+2] = initialPos[i][2];
+        norm += initialPos[i].dot(initialPos[i]);
+    }
+    norm /= numParticles;
+    norm = (norm < 1 ? 1 : sqrt(norm));
+    param.epsilon = tolerance/norm;
+
+    // Repeatedly minimize, steadily increasing the strength of the springs until all constraints are satisfied.
+    // Just as with LocalEnergyMinimizer, the result of each round is whatever positions were last evaluated,
+    // which evaluate() has left in the context.
+
+    double prevMaxError = 1e10;
+    vector<Vec3> positions;
+    while (true) {
+        double fx;
+        lbfgs(3*numParticles, x, &fx, evaluateCallback, (reporter == NULL ? NULL : reportCallback), this, &param);
+
+        // Check whether all constraints are satisfied.
+
+        context.getPositions(positions);
+        int numConstraints = system.getNumConstraints();
+        double maxError = 0.0;
+        for (int i = 0; i < numConstraints; i++) {
+            int particle1, particle2;
+            double distance;
+            system.getConstraintParameters(i, particle1, particle2, distance);
+            Vec3 delta = positions[particle2]-positions[particle1];
+            double r = sqrt(delta.dot(delta));
+            maxError = max(maxError, fabs(r-distance)/distance);
+        }
+        if (maxError <= workingConstraintTol)
+            break; // All constraints are satisfied.
+        context.setPositions(initialPos);
+        if (maxError >= prevMaxError)
+            break; // Further tightening the springs doesn't seem to be helping, so just give up.
+        prevMaxError = maxError;
+        k *= 10;
+        if (maxError > 100*workingConstraintTol) {
+            // We've gotten far enough from a valid state that we might have trouble getting
+            // back, so reset to the original positions.
+
+            for (int i = 0; i < numParticles; i++) {
+                x[3*i] = initialPos[i][0];
+                x[3*i+1] = initialPos[i][1];
+                x[3*i+2] = initialPos[i][2];
+            }
+        }
+    }
+    context.computeVirtualSites();
+
+    // If necessary, do a final constraint projection to make sure they are satisfied
+    // to the full precision requested by the user.
+
+    if (constraintTol < workingConstraintTol)
+        context.applyConstraints(workingConstraintTol);
+}
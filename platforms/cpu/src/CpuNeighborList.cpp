@@ -410,11 +410,35 @@ private:
     vector<vector<vector<pair<float, int> > > > bins;
 };
 
-CpuNeighborList::CpuNeighborList(int blockSize) : blockSize(blockSize) {
+/**
+ * Sort a list that is expected to already be nearly sorted, using an insertion sort.  If the total
+ * number of elements that need to be moved exceeds maxMoves, it gives up and falls back to std::sort().
+ */
+static void sortNearlySorted(vector<pair<int, int> >& values, long long maxMoves) {
+    long long moves = 0;
+    int size = values.size();
+    for (int i = 1; i < size; i++) {
+        pair<int, int> value = values[i];
+        int j = i;
+        while (j > 0 && value < values[j-1]) {
+            values[j] = values[j-1];
+            j--;
+        }
+        values[j] = value;
+        moves += i-j;
+        if (moves > maxMoves) {
+            sort(values.begin(), values.end());
+            return;
+        }
+    }
+}
+
+CpuNeighborList::CpuNeighborList(int blockSize) : blockSize(blockSize), numAtoms(0), dense(false), hasSortedOrder(false) {
 }
 
 void CpuNeighborList::computeNeighborList(int numAtoms, const AlignedArray<float>& atomLocations, const vector<set<int> >& exclusions,
             const Vec3* periodicBoxVectors, bool usePeriodic, float maxDistance, ThreadPool& threads) {
+    reuseSortedOrder = (hasSortedOrder && !dense && numAtoms == this->numAtoms);
     dense = false;
     int numBlocks = (numAtoms+blockSize-1)/blockSize;
     blockNeighbors.resize(numBlocks);
@@ -449,12 +473,18 @@ void CpuNeighborList::computeNeighborList(int numAtoms, const AlignedArray<float
     minz = minPos[2];
     maxz = maxPos[2];
     
-    // Sort the atoms based on a Hilbert curve.
+    // Sort the atoms based on a Hilbert curve.  Atoms move only a short distance between builds, so
+    // if we have the order from the previous build, the new list is nearly sorted when generated in
+    // that order and can be repaired much more cheaply than sorting from scratch.
     
     atomBins.resize(numAtoms);
     threads.execute([&] (ThreadPool& threads, int threadIndex) { threadComputeNeighborList(threads, threadIndex); });
     threads.waitForThreads();
-    sort(atomBins.begin(), atomBins.end());
+    if (reuseSortedOrder)
+        sortNearlySorted(atomBins, 8LL*numAtoms);
+    else
+        sort(atomBins.begin(), atomBins.end());
+    hasSortedOrder = true;
 
     // Build the voxel hash.
 
@@ -583,12 +613,13 @@ void CpuNeighborList::threadComputeNeighborList(ThreadPool& threads, int threadI
     bitmask_t coords[3];
     int numThreads = threads.getNumThreads();
     for (int i = threadIndex; i < numAtoms; i += numThreads) {
-        const float* pos = &atomLocations[4*i];
+        int atom = (reuseSortedOrder ? sortedAtoms[i] : i);
+        const float* pos = &atomLocations[4*atom];
         coords[0] = (bitmask_t) ((pos[0]-minx)*invBinWidth);
         coords[1] = (bitmask_t) ((pos[1]-miny)*invBinWidth);
         coords[2] = (bitmask_t) ((pos[2]-minz)*invBinWidth);
         int bin = (int) hilbert_c2i(3, 8, coords);
-        atomBins[i] = pair<int, int>(bin, i);
+        atomBins[i] = pair<int, int>(bin, atom);
     }
     threads.syncThreads();
 
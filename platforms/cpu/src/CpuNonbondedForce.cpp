@@ -49,7 +49,7 @@ const int CpuNonbondedForce::NUM_TABLE_POINTS = 2048;
 
 CpuNonbondedForce::CpuNonbondedForce(const CpuNeighborList& neighbors) : neighborList(&neighbors), cutoff(false), useSwitch(false), periodic(false),
         periodicExceptions(false), ewald(false), pme(false), ljpme(false), tableIsValid(false), expTableIsValid(false), cutoffDistance(0.0f),
-        alphaDispersionEwald(0.0f), alphaEwald(0.0f) {
+        alphaDispersionEwald(0.0f), alphaEwald(0.0f), pmeOrder(5) {
 }
 
 CpuNonbondedForce::~CpuNonbondedForce() {
@@ -172,6 +172,10 @@ void CpuNonbondedForce::setUsePME(float alpha, int meshSize[3]) {
 }
 
 
+void CpuNonbondedForce::setPMEInterpolationOrder(int order) {
+    pmeOrder = order;
+}
+
 /**---------------------------------------------------------------------------------------
 
      Set the force to use Particle-Mesh Ewald (PME) summation for dispersion.
@@ -256,7 +260,7 @@ void CpuNonbondedForce::calculateReciprocalIxn(int numberOfAtoms, float* posq, c
 
     if (pme) {
         pme_t pmedata;
-        pme_init(&pmedata, alphaEwald, numberOfAtoms, meshDim, 5, 1);
+        pme_init(&pmedata, alphaEwald, numberOfAtoms, meshDim, pmeOrder, 1);
         vector<double> charges(numberOfAtoms);
         for (int i = 0; i < numberOfAtoms; i++)
             charges[i] = posq[4*i+3];
@@ -268,7 +272,7 @@ void CpuNonbondedForce::calculateReciprocalIxn(int numberOfAtoms, float* posq, c
 
         if (ljpme) {
             // Dispersion reciprocal space terms
-            pme_init(&pmedata,alphaDispersionEwald,numberOfAtoms,dispersionMeshDim,5,1);
+            pme_init(&pmedata,alphaDispersionEwald,numberOfAtoms,dispersionMeshDim,pmeOrder,1);
 
             std::vector<Vec3> dpmeforces;
             for (int i = 0; i < numberOfAtoms; i++){
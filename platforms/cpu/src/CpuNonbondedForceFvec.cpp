@@ -31,16 +31,26 @@ using namespace OpenMM;
 CpuNonbondedForce* createCpuNonbondedForceVec4(const CpuNeighborList& neighbors);
 CpuNonbondedForce* createCpuNonbondedForceAvx(const CpuNeighborList& neighbors);
 CpuNonbondedForce* createCpuNonbondedForceAvx2(const CpuNeighborList& neighbors);
+CpuNonbondedForce* createCpuNonbondedForceAvx512(const CpuNeighborList& neighbors);
 
 bool isAvx2Supported();
+bool isAvx512Supported();
 
 #include <iostream>
 
 CpuNonbondedForce* createCpuNonbondedForceVec(const CpuNeighborList& neighbors) {
-    if (isAvx2Supported())
+    if (isAvx512Supported())
+        return createCpuNonbondedForceAvx512(neighbors);
+    else if (isAvx2Supported())
         return createCpuNonbondedForceAvx2(neighbors);
     else if (isAvxSupported())
         return createCpuNonbondedForceAvx(neighbors);
     else
         return createCpuNonbondedForceVec4(neighbors);
 }
+
+int OpenMM::getCpuNonbondedForceBlockSize() {
+    if (isAvx512Supported())
+        return 16;
+    return getVectorWidth();
+}
@@ -0,0 +1,116 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CpuNoseHooverDynamics.h"
+#include "ReferenceVirtualSites.h"
+#include "openmm/internal/ContextImpl.h"
+
+using namespace OpenMM;
+using namespace std;
+
+CpuNoseHooverDynamics::CpuNoseHooverDynamics(int numberOfAtoms, double deltaT, ThreadPool& threads) :
+           ReferenceNoseHooverDynamics(numberOfAtoms, deltaT), threads(threads) {
+}
+
+CpuNoseHooverDynamics::~CpuNoseHooverDynamics() {
+}
+
+void CpuNoseHooverDynamics::step1(ContextImpl& context, const System& system, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                  vector<Vec3>& forces, vector<double>& masses, double tolerance, const vector<int>& atomList,
+                                  const vector<tuple<int, int, double> >& pairList, double maxPairDistance) {
+    int numThreads = threads.getNumThreads();
+    if (getTimeStep() == 0) {
+        for (int i = 0; i < numberOfAtoms; i++)
+            inverseMasses[i] = (masses[i] == 0.0 ? 0.0 : 1.0/masses[i]);
+    }
+
+    // Update the velocities of regular atoms in parallel, and Drude-like pairs serially.
+
+    const double dt = getDeltaT();
+    int numInList = atomList.size();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numInList/numThreads;
+        int end = (threadIndex+1)*numInList/numThreads;
+        for (int i = start; i < end; i++) {
+            int atom = atomList[i];
+            if (masses[atom] != 0.0)
+                velocities[atom] += inverseMasses[atom]*forces[atom]*dt;
+        }
+    });
+    threads.waitForThreads();
+    updatePairVelocities(velocities, forces, masses, pairList);
+    ReferenceConstraintAlgorithm* referenceConstraintAlgorithm = getReferenceConstraintAlgorithm();
+    if (referenceConstraintAlgorithm)
+        referenceConstraintAlgorithm->applyToVelocities(atomCoordinates, velocities, inverseMasses, tolerance);
+
+    // Advance the positions by half a step.
+
+    const double halfdt = 0.5*dt;
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0)
+                xPrime[i] = atomCoordinates[i] + velocities[i]*halfdt;
+    });
+    threads.waitForThreads();
+}
+
+void CpuNoseHooverDynamics::step2(ContextImpl& context, const System& system, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                  vector<Vec3>& forces, vector<double>& masses, double tolerance, const vector<int>& atomList,
+                                  const vector<tuple<int, int, double> >& pairList, double maxPairDistance) {
+    int numThreads = threads.getNumThreads();
+    const double halfdt = 0.5*getDeltaT();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0) {
+                xPrime[i] += velocities[i]*halfdt;
+                oldx[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+    ReferenceConstraintAlgorithm* referenceConstraintAlgorithm = getReferenceConstraintAlgorithm();
+    if (referenceConstraintAlgorithm)
+        referenceConstraintAlgorithm->apply(atomCoordinates, xPrime, inverseMasses, tolerance);
+
+    // Update the positions and velocities.
+
+    const double dt = getDeltaT();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (inverseMasses[i] != 0.0) {
+                velocities[i] += (xPrime[i]-oldx[i])/dt;
+                atomCoordinates[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+    if (maxPairDistance > 0)
+        applyHardWallConstraints(atomCoordinates, velocities, masses, pairList, maxPairDistance);
+    getVirtualSites().computePositions(context.getSystem(), atomCoordinates);
+    incrementTimeStep();
+}
@@ -0,0 +1,99 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CpuOverdampedUpdater.h"
+#include "openmm/internal/vectorize.h"
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+CpuOverdampedUpdater::CpuOverdampedUpdater(ThreadPool& threads, CpuRandom& random) : threads(threads), random(random) {
+    threadNoise.resize(threads.getNumThreads());
+}
+
+void CpuOverdampedUpdater::update(int numberOfAtoms, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities, const vector<double>& masses,
+            double deltaT, double noiseScale, const Vec3* drift, double driftScale, const Vec3* bias, double biasScale, double period) {
+    // Record the parameters for the threads.
+
+    this->numberOfAtoms = numberOfAtoms;
+    this->atomCoordinates = &atomCoordinates[0];
+    this->velocities = &velocities[0];
+    this->masses = &masses[0];
+    this->deltaT = deltaT;
+    this->noiseScale = noiseScale;
+    this->drift = drift;
+    this->driftScale = driftScale;
+    this->bias = bias;
+    this->biasScale = biasScale;
+    this->period = period;
+
+    // Signal the threads to start running and wait for them to finish.
+
+    threads.execute([&] (ThreadPool& threads, int threadIndex) { threadUpdate(threadIndex); });
+    threads.waitForThreads();
+}
+
+void CpuOverdampedUpdater::threadUpdate(int threadIndex) {
+    int start = threadIndex*numberOfAtoms/threads.getNumThreads();
+    int end = (threadIndex+1)*numberOfAtoms/threads.getNumThreads();
+    if (end <= start)
+        return;
+
+    // Generate all the random numbers this thread needs at once.  The buffer has one extra element
+    // so the noise for every atom can be loaded as a full vector.
+
+    vector<float>& noise = threadNoise[threadIndex];
+    int numValues = 3*(end-start);
+    if ((int) noise.size() < numValues+1)
+        noise.resize(numValues+1, 0.0f);
+    random.getGaussianRandom(threadIndex, noise.data(), numValues);
+
+    // The displacement of each atom is small compared to its position, so it is computed in single
+    // precision with one atom per vector, then added to the double precision coordinates.
+
+    const fvec4 fNoiseScale((float) noiseScale);
+    const fvec4 fDriftScale((float) driftScale);
+    const fvec4 fBiasScale((float) biasScale);
+    const double velocityScale = 1.0/deltaT;
+    const double boxSize = 2.0*period;
+    const double invBoxSize = (period > 0.0 ? 1.0/boxSize : 0.0);
+    float d[4];
+    for (int i = start; i < end; i++) {
+        if (masses[i] == 0.0)
+            continue;
+        fvec4 delta = fNoiseScale*fvec4(&noise[3*(i-start)]);
+        if (drift != NULL)
+            delta += fDriftScale*fvec4((float) drift[i][0], (float) drift[i][1], (float) drift[i][2], 0.0f);
+        if (bias != NULL)
+            delta += fBiasScale*fvec4((float) bias[i][0], (float) bias[i][1], (float) bias[i][2], 0.0f);
+        delta.store(d);
+        Vec3 xPrime = atomCoordinates[i] + Vec3(d[0], d[1], d[2]);
+        if (period > 0.0)
+            for (int j = 0; j < 3; j++)
+                xPrime[j] -= round(xPrime[j]*invBoxSize)*boxSize;
+        velocities[i] = (xPrime-atomCoordinates[i])*velocityScale;
+        atomCoordinates[i] = xPrime;
+    }
+}
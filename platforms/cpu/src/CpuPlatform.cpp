@@ -32,8 +32,10 @@
 #include "CpuPlatform.h"
 #include "CpuKernelFactory.h"
 #include "CpuKernels.h"
+#include "CpuCCMA.h"
 #include "CpuSETTLE.h"
 #include "ReferenceConstraints.h"
+#include "openmm/Context.h"
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/hardware.h"
 #include "openmm/internal/vectorize.h"
@@ -65,18 +67,42 @@ CpuPlatform::CpuPlatform() {
     CpuKernelFactory* factory = new CpuKernelFactory();
     registerKernelFactory(CalcForcesAndEnergyKernel::Name(), factory);
     registerKernelFactory(UpdateStateDataKernel::Name(), factory);
+    registerKernelFactory(MinimizeKernel::Name(), factory);
+    registerKernelFactory(ScheduleForcesKernel::Name(), factory);
+    registerKernelFactory(CalcHarmonicBondForceKernel::Name(), factory);
+    registerKernelFactory(CalcCustomBondForceKernel::Name(), factory);
     registerKernelFactory(CalcHarmonicAngleForceKernel::Name(), factory);
+    registerKernelFactory(CalcCustomAngleForceKernel::Name(), factory);
     registerKernelFactory(CalcPeriodicTorsionForceKernel::Name(), factory);
     registerKernelFactory(CalcRBTorsionForceKernel::Name(), factory);
+    registerKernelFactory(CalcCMAPTorsionForceKernel::Name(), factory);
+    registerKernelFactory(CalcCustomTorsionForceKernel::Name(), factory);
     registerKernelFactory(CalcNonbondedForceKernel::Name(), factory);
     registerKernelFactory(CalcCustomNonbondedForceKernel::Name(), factory);
     registerKernelFactory(CalcCustomManyParticleForceKernel::Name(), factory);
+    registerKernelFactory(CalcCustomCentroidBondForceKernel::Name(), factory);
+    registerKernelFactory(CalcCustomCompoundBondForceKernel::Name(), factory);
     registerKernelFactory(CalcGBSAOBCForceKernel::Name(), factory);
     registerKernelFactory(CalcCustomGBForceKernel::Name(), factory);
     registerKernelFactory(CalcGayBerneForceKernel::Name(), factory);
+    registerKernelFactory(CalcATMForceKernel::Name(), factory);
+    registerKernelFactory(ApplyMonteCarloBarostatKernel::Name(), factory);
+    registerKernelFactory(IntegrateVerletStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateNoseHooverStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateBrownianStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateVariableVerletStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateVariableLangevinStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateCustomStepKernel::Name(), factory);
     registerKernelFactory(IntegrateLangevinMiddleStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateIndirectReconstructionStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateDampedReconstructionStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateRandomWalkStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateRandomWalkEnsembleStepKernel::Name(), factory);
     platformProperties.push_back(CpuThreads());
     platformProperties.push_back(CpuDeterministicForces());
+    platformProperties.push_back(CpuNeighborListPadding());
+    platformProperties.push_back(CpuPrecision());
+    platformProperties.push_back(CpuPinThreads());
     int threads = getNumProcessors();
     char* threadsEnv = getenv("OPENMM_CPU_THREADS");
     if (threadsEnv != NULL)
@@ -85,6 +111,9 @@ CpuPlatform::CpuPlatform() {
     defaultThreads << threads;
     setPropertyDefaultValue(CpuThreads(), defaultThreads.str());
     setPropertyDefaultValue(CpuDeterministicForces(), "false");
+    setPropertyDefaultValue(CpuNeighborListPadding(), "fixed");
+    setPropertyDefaultValue(CpuPrecision(), "single");
+    setPropertyDefaultValue(CpuPinThreads(), "false");
 }
 
 const string& CpuPlatform::getPropertyValue(const Context& context, const string& property) const {
@@ -99,6 +128,10 @@ const string& CpuPlatform::getPropertyValue(const Context& context, const string
     return ReferencePlatform::getPropertyValue(context, property);
 }
 
+CpuPlatform::NeighborListStatistics CpuPlatform::getNeighborListStatistics(const Context& context) const {
+    return getPlatformData(getContextImpl(context)).neighborListStats;
+}
+
 double CpuPlatform::getSpeed() const {
     return 10;
 }
@@ -117,18 +150,39 @@ void CpuPlatform::contextCreated(ContextImpl& context, const map<string, string>
             getPropertyDefaultValue(CpuThreads()) : properties.find(CpuThreads())->second);
     string deterministicForcesValue = (properties.find(CpuDeterministicForces()) == properties.end() ?
             getPropertyDefaultValue(CpuDeterministicForces()) : properties.find(CpuDeterministicForces())->second);
+    string paddingValue = (properties.find(CpuNeighborListPadding()) == properties.end() ?
+            getPropertyDefaultValue(CpuNeighborListPadding()) : properties.find(CpuNeighborListPadding())->second);
+    string precisionValue = (properties.find(CpuPrecision()) == properties.end() ?
+            getPropertyDefaultValue(CpuPrecision()) : properties.find(CpuPrecision())->second);
+    string pinThreadsValue = (properties.find(CpuPinThreads()) == properties.end() ?
+            getPropertyDefaultValue(CpuPinThreads()) : properties.find(CpuPinThreads())->second);
     int numThreads;
     stringstream(threadsPropValue) >> numThreads;
     transform(deterministicForcesValue.begin(), deterministicForcesValue.end(), deterministicForcesValue.begin(), ::tolower);
     bool deterministicForces = (deterministicForcesValue == "true");
-    PlatformData* data = new PlatformData(context.getSystem().getNumParticles(), numThreads, deterministicForces);
+    transform(paddingValue.begin(), paddingValue.end(), paddingValue.begin(), ::tolower);
+    if (paddingValue != "fixed" && paddingValue != "adaptive")
+        throw OpenMMException("Illegal value for NeighborListPadding: "+paddingValue);
+    bool adaptivePadding = (paddingValue == "adaptive");
+    transform(precisionValue.begin(), precisionValue.end(), precisionValue.begin(), ::tolower);
+    if (precisionValue != "single" && precisionValue != "mixed")
+        throw OpenMMException("Illegal value for Precision: "+precisionValue);
+    transform(pinThreadsValue.begin(), pinThreadsValue.end(), pinThreadsValue.begin(), ::tolower);
+    bool pinThreads = (pinThreadsValue == "true");
+    PlatformData* data = new PlatformData(context.getSystem().getNumParticles(), numThreads, deterministicForces, adaptivePadding, precisionValue, pinThreads);
     contextData[&context] = data;
-    ReferenceConstraints& constraints = *(ReferenceConstraints*) reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData())->constraints;
+    ReferencePlatform::PlatformData* refData = reinterpret_cast<ReferencePlatform::PlatformData*>(context.getPlatformData());
+    ReferenceConstraints& constraints = *(ReferenceConstraints*) refData->constraints;
     if (constraints.settle != NULL) {
         CpuSETTLE* parallelSettle = new CpuSETTLE(context.getSystem(), *(ReferenceSETTLEAlgorithm*) constraints.settle, data->threads);
         delete constraints.settle;
         constraints.settle = parallelSettle;
     }
+    if (constraints.ccma != NULL) {
+        CpuCCMA* parallelCCMA = new CpuCCMA(*(ReferenceCCMAAlgorithm*) constraints.ccma, data->threads);
+        delete constraints.ccma;
+        constraints.ccma = parallelCCMA;
+    }
 }
 
 void CpuPlatform::contextDestroyed(ContextImpl& context) const {
@@ -147,28 +201,83 @@ const CpuPlatform::PlatformData& CpuPlatform::getPlatformData(const ContextImpl&
     return *contextData[&context];
 }
 
-CpuPlatform::PlatformData::PlatformData(int numParticles, int numThreads, bool deterministicForces) : posq(4*numParticles), threads(numThreads),
-        deterministicForces(deterministicForces), numParticles(numParticles), neighborList(NULL), cutoff(0.0), paddedCutoff(0.0), anyExclusions(false),
-        currentPosqIndex(-1), nextPosqIndex(0) {
+CpuPlatform::PlatformData::PlatformData(int numParticles, int numThreads, bool deterministicForces, bool adaptivePadding, const string& precision, bool pinThreads) :
+        posq(4*numParticles), threads(numThreads, pinThreads), numParticles(numParticles), neighborList(NULL), cutoff(0.0), paddedCutoff(0.0),
+        anyExclusions(false), deterministicForces(deterministicForces), adaptivePadding(adaptivePadding), useMixedPrecision(precision == "mixed"), evaluationsSinceBuild(0), lastBuildTime(0.0), pairTimeSinceBuild(0.0), currentPosqIndex(-1), nextPosqIndex(0),
+        neighborListPositions(numParticles, Vec3(1e10, 1e10, 1e10)), neighborListDrift(0.0),
+        concurrentForces(NULL), concurrentEnergyParameterDerivatives(NULL), workerSystemChangeCount(0) {
+    neighborListStats.padding = 0.0;
+    neighborListStats.numBuilds = 0;
+    neighborListStats.numEvaluations = 0;
+    neighborListStats.buildTime = 0.0;
+    neighborListStats.pairTime = 0.0;
     numThreads = threads.getNumThreads();
     threadForce.resize(numThreads);
-    for (int i = 0; i < numThreads; i++)
-        threadForce[i].resize(4*numParticles);
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        // Each thread allocates and clears its own force buffer, so on NUMA systems the memory is placed
+        // on the node where it will be used.
+
+        threadForce[threadIndex].resize(4*numParticles);
+        for (int i = 0; i < 4*numParticles; i++)
+            threadForce[threadIndex][i] = 0.0f;
+    });
+    threads.waitForThreads();
     isPeriodic = false;
     stringstream threadsProperty;
     threadsProperty << numThreads;
     propertyValues[CpuThreads()] = threadsProperty.str();
     propertyValues[CpuDeterministicForces()] = deterministicForces ? "true" : "false";
+    propertyValues[CpuNeighborListPadding()] = adaptivePadding ? "adaptive" : "fixed";
+    propertyValues[CpuPrecision()] = precision;
+    propertyValues[CpuPinThreads()] = pinThreads ? "true" : "false";
 }
 
 CpuPlatform::PlatformData::~PlatformData() {
     if (neighborList != NULL)
         delete neighborList;
+    deleteWorkerContexts();
+}
+
+Context* CpuPlatform::PlatformData::createWorkerContext(ContextImpl& context, const System& system, Integrator& integrator, int numThreads) {
+    map<string, string> properties = propertyValues;
+    properties[CpuThreads()] = to_string(numThreads);
+    properties[CpuPinThreads()] = "false";
+    return new Context(system, integrator, context.getOwner().getPlatform(), properties);
+}
+
+const vector<Context*>& CpuPlatform::PlatformData::getWorkerContexts(ContextImpl& context, int numWorkers) {
+    if (workerContexts.size() > 0 && workerSystemChangeCount != context.getSystemChangeCount())
+        deleteWorkerContexts();
+    workerSystemChangeCount = context.getSystemChangeCount();
+    while (workerContexts.size() < numWorkers) {
+        workerIntegrators.push_back(new VerletIntegrator(1.0));
+        workerContexts.push_back(createWorkerContext(context, context.getSystem(), *workerIntegrators.back(), 1));
+    }
+
+    // Bring the parameters of every worker up to date.
+
+    const Integrator& integrator = context.getIntegrator();
+    State parameters = context.getOwner().getState(State::Parameters);
+    for (int i = 0; i < workerContexts.size(); i++) {
+        workerIntegrators[i]->setConstraintTolerance(integrator.getConstraintTolerance());
+        workerIntegrators[i]->setIntegrationForceGroups(integrator.getIntegrationForceGroups());
+        workerContexts[i]->setState(parameters);
+    }
+    return workerContexts;
+}
+
+void CpuPlatform::PlatformData::deleteWorkerContexts() {
+    for (Context* worker : workerContexts)
+        delete worker;
+    for (VerletIntegrator* integrator : workerIntegrators)
+        delete integrator;
+    workerContexts.clear();
+    workerIntegrators.clear();
 }
 
 void CpuPlatform::PlatformData::requestNeighborList(double cutoffDistance, double padding, bool useExclusions, const vector<set<int> >& exclusionList) {
     if (neighborList == NULL) {
-        neighborList = new CpuNeighborList(getVectorWidth());
+        neighborList = new CpuNeighborList(getCpuNonbondedForceBlockSize());
         if (cutoffDistance == 0.0)
             neighborList->createDenseNeighborList(numParticles, exclusionList);
     }
@@ -190,6 +299,63 @@ void CpuPlatform::PlatformData::requestNeighborList(double cutoffDistance, doubl
         exclusions = exclusionList;
 }
 
+void CpuPlatform::PlatformData::updateNeighborListPadding() {
+    double padding = paddedCutoff-cutoff;
+    if (evaluationsSinceBuild == 0 || padding <= 0.0 || pairTimeSinceBuild <= 0.0)
+        return;
+
+    // Model the cost per evaluation as the build time amortized over the number of evaluations
+    // between builds, plus the time for pair interactions.  The number of evaluations between builds
+    // is assumed proportional to the padding, and the number of pairs to the cube of the padded cutoff.
+
+    double buildCost = lastBuildTime;
+    double stepsPerPadding = evaluationsSinceBuild/padding;
+    double pairCost = pairTimeSinceBuild/evaluationsSinceBuild;
+    double bestPadding = padding, bestCost = 0.0;
+    const int numTrials = 40;
+    for (int i = 0; i <= numTrials; i++) {
+        double trial = cutoff*(0.05+0.45*i/(double) numTrials);
+        double scale = (cutoff+trial)/paddedCutoff;
+        double cost = buildCost/(stepsPerPadding*trial) + pairCost*scale*scale*scale;
+        if (i == 0 || cost < bestCost) {
+            bestCost = cost;
+            bestPadding = trial;
+        }
+    }
+
+    // Limit how quickly the padding can change, since the measurements are noisy.
+
+    bestPadding = max(padding/1.5, min(padding*1.5, bestPadding));
+    paddedCutoff = cutoff+bestPadding;
+}
+
+void CpuPlatform::PlatformData::recordPairTime(double time) {
+    pairTimeSinceBuild += time;
+    neighborListStats.pairTime += time;
+}
+
+void CpuPlatform::PlatformData::accumulateThreadForces(vector<Vec3>& forces) {
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int numThreads = threads.getNumThreads();
+        int start = threadIndex*numParticles/numThreads;
+        int end = (threadIndex+1)*numParticles/numThreads;
+        for (int i = start; i < end; i++) {
+            double fx = 0.0, fy = 0.0, fz = 0.0;
+            for (int j = 0; j < numThreads; j++) {
+                float* f = &threadForce[j][4*i];
+                fx += f[0];
+                fy += f[1];
+                fz += f[2];
+                f[0] = f[1] = f[2] = 0.0f;
+            }
+            forces[i][0] += fx;
+            forces[i][1] += fy;
+            forces[i][2] += fz;
+        }
+    });
+    threads.waitForThreads();
+}
+
 int CpuPlatform::PlatformData::requestPosqIndex() {
     return nextPosqIndex++;
 }
\ No newline at end of file
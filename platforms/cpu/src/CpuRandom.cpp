@@ -25,6 +25,8 @@
 #include "CpuRandom.h"
 #include "openmm/internal/OSRngSeed.h"
 #include "openmm/OpenMMException.h"
+#include "openmm/internal/vectorize.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -85,6 +87,30 @@ float CpuRandom::getGaussianRandom(int threadIndex) {
     return x*multiplier;
 }
 
+void CpuRandom::getGaussianRandom(int threadIndex, float* values, int count) {
+    // This uses the same polar Box-Muller transformation as above.  Candidate points are accepted or rejected
+    // one at a time, but the transformation is applied to four pairs at once.
+
+    OpenMM_SFMT::SFMT& sfmt = *threadRandom[threadIndex];
+    float x[4], y[4], r2[4], result[8];
+    for (int i = 0; i < count; i += 8) {
+        for (int j = 0; j < 4; j++) {
+            do {
+                x[j] = 2.0f*(float) genrand_real2(sfmt)-1.0f;
+                y[j] = 2.0f*(float) genrand_real2(sfmt)-1.0f;
+                r2[j] = x[j]*x[j] + y[j]*y[j];
+            } while (r2[j] >= 1.0f || r2[j] == 0.0f);
+        }
+        fvec4 r2Vec(r2);
+        fvec4 multiplier = sqrt((-2.0f*log(r2Vec))/r2Vec);
+        (fvec4(x)*multiplier).store(result);
+        (fvec4(y)*multiplier).store(result+4);
+        int numToCopy = min(8, count-i);
+        for (int j = 0; j < numToCopy; j++)
+            values[i+j] = result[j];
+    }
+}
+
 float CpuRandom::getUniformRandom(int threadIndex) {
     return genrand_real2(*threadRandom[threadIndex]);
 }
@@ -30,7 +30,6 @@
  * -------------------------------------------------------------------------- */
 
 #include "CpuSETTLE.h"
-#include <atomic>
 
 using namespace OpenMM;
 using namespace std;
@@ -61,29 +60,15 @@ CpuSETTLE::~CpuSETTLE() {
 }
 
 void CpuSETTLE::apply(vector<OpenMM::Vec3>& atomCoordinates, vector<OpenMM::Vec3>& atomCoordinatesP, vector<double>& inverseMasses, double tolerance) {
-    atomic<int> atomicCounter;
-    atomicCounter = 0;
-    threads.execute([&] (ThreadPool& threads, int threadIndex) {
-        while (true) {
-            int index = atomicCounter++;
-            if (index >= threadSettle.size())
-                break;
+    threads.parallelFor(0, threadSettle.size(), 1, [&] (ThreadPool& threads, int threadIndex, int start, int end) {
+        for (int index = start; index < end; index++)
             threadSettle[index]->apply(atomCoordinates, atomCoordinatesP, inverseMasses, tolerance);
-        }
     });
-    threads.waitForThreads();
 }
 
 void CpuSETTLE::applyToVelocities(vector<OpenMM::Vec3>& atomCoordinates, vector<OpenMM::Vec3>& velocities, vector<double>& inverseMasses, double tolerance) {
-    atomic<int> atomicCounter;
-    atomicCounter = 0;
-    threads.execute([&] (ThreadPool& threads, int threadIndex) {
-        while (true) {
-            int index = atomicCounter++;
-            if (index >= threadSettle.size())
-                break;
+    threads.parallelFor(0, threadSettle.size(), 1, [&] (ThreadPool& threads, int threadIndex, int start, int end) {
+        for (int index = start; index < end; index++)
             threadSettle[index]->applyToVelocities(atomCoordinates, velocities, inverseMasses, tolerance);
-        }
     });
-    threads.waitForThreads();
 }
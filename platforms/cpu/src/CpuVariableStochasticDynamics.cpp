@@ -0,0 +1,130 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SimTKOpenMMUtilities.h"
+#include "CpuVariableStochasticDynamics.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+CpuVariableStochasticDynamics::CpuVariableStochasticDynamics(int numberOfAtoms, double friction, double temperature, double accuracy,
+            ThreadPool& threads, CpuRandom& random) :
+           ReferenceVariableStochasticDynamics(numberOfAtoms, friction, temperature, accuracy), threads(threads), random(random) {
+    threadError.resize(threads.getNumThreads());
+    threadNoise.resize(threads.getNumThreads());
+}
+
+CpuVariableStochasticDynamics::~CpuVariableStochasticDynamics() {
+}
+
+void CpuVariableStochasticDynamics::updatePart1(int numberOfAtoms, vector<Vec3>& velocities, vector<Vec3>& forces, vector<double>& inverseMasses, double maxStepSize) {
+    // Compute the error norm.  Each thread sums over its own atoms, then the partial sums are combined.
+
+    int numThreads = threads.getNumThreads();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        double sum = 0.0;
+        for (int i = start; i < end; i++) {
+            Vec3 xerror = forces[i]*inverseMasses[i];
+            sum += xerror.dot(xerror);
+        }
+        threadError[threadIndex] = sum;
+    });
+    threads.waitForThreads();
+    double error = 0.0;
+    for (int i = 0; i < numThreads; i++)
+        error += threadError[i];
+    error = sqrt(error/(numberOfAtoms*3));
+
+    // Select the step size.
+
+    double dt = sqrt(getAccuracy()/error);
+    if (getDeltaT() > 0.0f)
+        dt = std::min(dt, getDeltaT()*2.0f); // For safety, limit how quickly dt can increase.
+    if (dt > getDeltaT() && dt < 1.2f*getDeltaT())
+        dt = getDeltaT(); // Keeping dt constant between steps improves the behavior of the integrator.
+    if (dt > maxStepSize)
+        dt = maxStepSize;
+    setDeltaT(dt);
+
+    // Update the velocities.
+
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (inverseMasses[i] != 0.0)
+                velocities[i] += (dt*inverseMasses[i])*forces[i];
+    });
+    threads.waitForThreads();
+}
+
+void CpuVariableStochasticDynamics::updatePart2(int numberOfAtoms, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                                vector<double>& inverseMasses, vector<Vec3>& xPrime) {
+    const double halfdt = 0.5*getDeltaT();
+    const double kT = BOLTZ*getTemperature();
+    const double vscale = exp(-getDeltaT()*getFriction());
+    const double noisescale = sqrt(1-vscale*vscale);
+    int numThreads = threads.getNumThreads();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        if (end <= start)
+            return;
+
+        // Generate all the random numbers this thread needs at once.
+
+        vector<float>& noise = threadNoise[threadIndex];
+        noise.resize(3*(end-start));
+        random.getGaussianRandom(threadIndex, noise.data(), noise.size());
+        for (int i = start; i < end; i++)
+            if (inverseMasses[i] != 0.0) {
+                const float* n = &noise[3*(i-start)];
+                xPrime[i] = atomCoordinates[i] + velocities[i]*halfdt;
+                velocities[i] = vscale*velocities[i] + noisescale*sqrt(kT*inverseMasses[i])*Vec3(n[0], n[1], n[2]);
+                xPrime[i] = xPrime[i] + velocities[i]*halfdt;
+                oldx[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+}
+
+void CpuVariableStochasticDynamics::updatePart3(int numberOfAtoms, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                                vector<double>& inverseMasses, vector<Vec3>& xPrime) {
+    const double invStepSize = 1.0/getDeltaT();
+    int numThreads = threads.getNumThreads();
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (inverseMasses[i] != 0.0) {
+                velocities[i] += (xPrime[i]-oldx[i])*invStepSize;
+                atomCoordinates[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+}
@@ -0,0 +1,112 @@
+/* Portions copyright (c) 2013-2024 Stanford University and Simbios.
+ * Authors: Peter Eastman
+ * Contributors:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CpuVariableVerletDynamics.h"
+#include "ReferenceVirtualSites.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenMM;
+using namespace std;
+
+CpuVariableVerletDynamics::CpuVariableVerletDynamics(int numberOfAtoms, double accuracy, ThreadPool& threads) :
+           ReferenceVariableVerletDynamics(numberOfAtoms, accuracy), threads(threads) {
+    threadError.resize(threads.getNumThreads());
+}
+
+CpuVariableVerletDynamics::~CpuVariableVerletDynamics() {
+}
+
+void CpuVariableVerletDynamics::update(const System& system, vector<Vec3>& atomCoordinates, vector<Vec3>& velocities,
+                                       vector<Vec3>& forces, vector<double>& masses, double maxStepSize, double tolerance) {
+    int numberOfAtoms = system.getNumParticles();
+    int numThreads = threads.getNumThreads();
+    if (getTimeStep() == 0) {
+        for (int i = 0; i < numberOfAtoms; i++)
+            inverseMasses[i] = (masses[i] == 0.0 ? 0.0 : 1.0/masses[i]);
+    }
+
+    // Compute the error norm.  Each thread sums over its own atoms, then the partial sums are combined.
+
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        double sum = 0.0;
+        for (int i = start; i < end; i++) {
+            Vec3 xerror = forces[i]*inverseMasses[i];
+            sum += xerror.dot(xerror);
+        }
+        threadError[threadIndex] = sum;
+    });
+    threads.waitForThreads();
+    double error = 0.0;
+    for (int i = 0; i < numThreads; i++)
+        error += threadError[i];
+    error = sqrt(error/(numberOfAtoms*3));
+
+    // Select the step size.
+
+    double newStepSize = sqrt(getAccuracy()/error);
+    if (getDeltaT() > 0.0f)
+        newStepSize = std::min(newStepSize, getDeltaT()*2.0f); // For safety, limit how quickly dt can increase.
+    if (newStepSize > getDeltaT() && newStepSize < 1.2f*getDeltaT())
+        newStepSize = getDeltaT(); // Keeping dt constant between steps improves the behavior of the integrator.
+    if (newStepSize > maxStepSize)
+        newStepSize = maxStepSize;
+    const double vstep = 0.5f*(newStepSize+getDeltaT()); // The time interval by which to advance the velocities
+    setDeltaT(newStepSize);
+    const double dt = getDeltaT();
+
+    // Compute the unconstrained positions.
+
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0) {
+                Vec3 vPrime = velocities[i] + inverseMasses[i]*forces[i]*vstep;
+                xPrime[i] = atomCoordinates[i] + vPrime*dt;
+            }
+    });
+    threads.waitForThreads();
+    ReferenceConstraintAlgorithm* referenceConstraintAlgorithm = getReferenceConstraintAlgorithm();
+    if (referenceConstraintAlgorithm)
+        referenceConstraintAlgorithm->apply(atomCoordinates, xPrime, inverseMasses, tolerance);
+
+    // Update the positions and velocities.
+
+    const double velocityScale = 1.0/dt;
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        int start = threadIndex*numberOfAtoms/numThreads;
+        int end = (threadIndex+1)*numberOfAtoms/numThreads;
+        for (int i = start; i < end; i++)
+            if (masses[i] != 0.0) {
+                velocities[i] = (xPrime[i]-atomCoordinates[i])*velocityScale;
+                atomCoordinates[i] = xPrime[i];
+            }
+    });
+    threads.waitForThreads();
+    getVirtualSites().computePositions(system, atomCoordinates);
+    incrementTimeStep();
+}
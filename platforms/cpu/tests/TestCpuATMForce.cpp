@@ -0,0 +1,95 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestATMForce.h"
+#include "ReferencePlatform.h"
+
+void testConcurrentInnerContexts(bool pinThreads) {
+    // The two inner contexts are evaluated at the same time, each with half the threads.  When threads
+    // are pinned, they are instead evaluated one after the other.  Compare the result to the Reference
+    // platform for a system with a multithreaded nonbonded force.
+
+    const int numParticles = 512;
+    const double width = 3.0;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(width, 0, 0), Vec3(0, width, 0), Vec3(0, 0, width));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(1.0);
+    nonbonded->setPMEParameters(3.0, 24, 24, 24);
+    ATMForce* atm = new ATMForce(0.0, 0.0, 0.1, 0.0, 0.0, 1e6, 5e5, 1.0/16, 1.0);
+    vector<Vec3> positions;
+    double spacing = width/8;
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 8; j++)
+            for (int k = 0; k < 8; k++) {
+                system.addParticle(10.0);
+                nonbonded->addParticle((i+j+k)%2 == 0 ? 0.2 : -0.2, 0.3, 0.5);
+                positions.push_back(Vec3(i*spacing, j*spacing, k*spacing));
+                atm->addParticle(Vec3());
+            }
+    for (int i = 0; i < 10; i++)
+        atm->setParticleParameters(i, Vec3(0.1*i, 0.05, 0), Vec3(0, 0, 0.02*i));
+    atm->addForce(nonbonded);
+    system.addForce(atm);
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "4";
+    properties[CpuPlatform::CpuPinThreads()] = (pinThreads ? "true" : "false");
+    Context context(system, integrator1, platform, properties);
+    ReferencePlatform reference;
+    Context referenceContext(system, integrator2, reference);
+    context.setPositions(positions);
+    referenceContext.setPositions(positions);
+    for (double lambda : {0.0, 0.5, 1.0}) {
+        context.setParameter(ATMForce::Lambda1(), lambda);
+        context.setParameter(ATMForce::Lambda2(), lambda);
+        referenceContext.setParameter(ATMForce::Lambda1(), lambda);
+        referenceContext.setParameter(ATMForce::Lambda2(), lambda);
+        State state = context.getState(State::Energy | State::Forces);
+        State referenceState = referenceContext.getState(State::Energy | State::Forces);
+        ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), state.getPotentialEnergy(), 1e-4);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(referenceState.getForces()[i], state.getForces()[i], 1e-3);
+        double u0, u1, energy, referenceU0, referenceU1, referenceEnergy;
+        atm->getPerturbationEnergy(context, u1, u0, energy);
+        atm->getPerturbationEnergy(referenceContext, referenceU1, referenceU0, referenceEnergy);
+        ASSERT_EQUAL_TOL(referenceU0, u0, 1e-4);
+        ASSERT_EQUAL_TOL(referenceU1, u1, 1e-4);
+    }
+}
+
+void runPlatformTests() {
+    testConcurrentInnerContexts(false);
+    testConcurrentInnerContexts(true);
+}
@@ -0,0 +1,130 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2013 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+/**
+ * This tests the parallel CPU implementation of CCMA.
+ */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/ThreadPool.h"
+#include "openmm/HarmonicAngleForce.h"
+#include "openmm/System.h"
+#include "CpuCCMA.h"
+#include "CpuPlatform.h"
+#include "ReferenceConstraints.h"
+#include "sfmt/SFMT.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+void testCompareToReference() {
+    // Create a set of branched molecules with all bonds constrained.  One of them also contains a triangle of constraints.
+
+    const int numMolecules = 30;
+    const int atomsPerMolecule = 7;
+    const int numParticles = numMolecules*atomsPerMolecule;
+    System system;
+    HarmonicAngleForce* angles = new HarmonicAngleForce();
+    system.addForce(angles);
+    vector<Vec3> positions(numParticles);
+    for (int i = 0; i < numMolecules; i++) {
+        int first = i*atomsPerMolecule;
+        for (int j = 0; j < atomsPerMolecule; j++)
+            system.addParticle(j%3 == 2 ? 1.0 : 12.0);
+        positions[first] = Vec3(i*2.0, 0, 0);
+        for (int j = 1; j < atomsPerMolecule; j++) {
+            double distance = 0.1+0.01*(j%3);
+            Vec3 dir(1.0, j%2 == 0 ? -1.0 : 1.0, 0.3*(j%3));
+            positions[first+j] = positions[first+(j-1)/2]+dir*(distance/sqrt(dir.dot(dir)));
+            system.addConstraint(first+(j-1)/2, first+j, distance);
+        }
+        for (int j = 0; 2*j+2 < atomsPerMolecule; j++) {
+            angles->addAngle(first+2*j+1, first+j, first+2*j+2, 1.9, 100.0);
+            if (j > 0)
+                angles->addAngle(first+(j-1)/2, first+j, first+2*j+1, 2.0, 100.0);
+        }
+    }
+    system.addConstraint(1, 2, 0.17);
+    ReferenceConstraints constraints(system);
+    ASSERT(constraints.ccma != NULL);
+    ThreadPool threads(4);
+    CpuCCMA ccma(*(ReferenceCCMAAlgorithm*) constraints.ccma, threads);
+
+    // Perturb the positions and velocities, then apply both implementations.
+
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<double> inverseMasses(numParticles);
+    vector<Vec3> newPositions(numParticles), velocities(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        inverseMasses[i] = 1.0/system.getParticleMass(i);
+        newPositions[i] = positions[i]+Vec3(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5)*0.01;
+        velocities[i] = Vec3(genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5, genrand_real2(sfmt)-0.5);
+    }
+    const double tol = 1e-8;
+    vector<Vec3> refPositions = newPositions, cpuPositions = newPositions;
+    vector<Vec3> refVelocities = velocities, cpuVelocities = velocities;
+    constraints.ccma->apply(positions, refPositions, inverseMasses, tol);
+    ccma.apply(positions, cpuPositions, inverseMasses, tol);
+    constraints.ccma->applyToVelocities(positions, refVelocities, inverseMasses, tol);
+    ccma.applyToVelocities(positions, cpuVelocities, inverseMasses, tol);
+    for (int i = 0; i < numParticles; i++) {
+        ASSERT_EQUAL_VEC(refPositions[i], cpuPositions[i], 1e-6);
+        ASSERT_EQUAL_VEC(refVelocities[i], cpuVelocities[i], 1e-6);
+    }
+    for (int i = 0; i < system.getNumConstraints(); i++) {
+        int p1, p2;
+        double distance;
+        system.getConstraintParameters(i, p1, p2, distance);
+        Vec3 delta = cpuPositions[p1]-cpuPositions[p2];
+        ASSERT_EQUAL_TOL(distance, sqrt(delta.dot(delta)), 1e-6);
+        Vec3 dir = positions[p1]-positions[p2];
+        ASSERT_EQUAL_TOL(0.0, (cpuVelocities[p1]-cpuVelocities[p2]).dot(dir), 1e-6);
+    }
+}
+
+int main() {
+    try {
+        if (!CpuPlatform::isProcessorSupported()) {
+            cout << "CPU is not supported.  Exiting." << endl;
+            return 0;
+        }
+        testCompareToReference();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestCustomExternalForce.h"
+#include "ReferencePlatform.h"
+#include "openmm/CustomHbondForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/RMSDForce.h"
+
+void testConcurrentForces() {
+    // Forces computed by reference kernels are evaluated at the same time as the multithreaded
+    // CPU kernels.  Compare the result to the Reference platform.
+
+    const int numParticles = 200;
+    const double width = 3.0;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(width, 0, 0), Vec3(0, width, 0), Vec3(0, 0, width));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    system.addForce(nonbonded);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system.addForce(bonds);
+    CustomExternalForce* external = new CustomExternalForce("k*(x^2+y^2+z^2)");
+    external->addGlobalParameter("k", 1.5);
+    system.addForce(external);
+    CustomHbondForce* hbond = new CustomHbondForce("c*(distance(d1,a1)-0.3)^2");
+    hbond->addGlobalParameter("c", 2.0);
+    system.addForce(hbond);
+    vector<Vec3> positions;
+    vector<int> rmsdParticles;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.1 : -0.1, 0.2, 0.5);
+        external->addParticle(i);
+        positions.push_back(Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*width);
+        if (i%2 == 1) {
+            bonds->addBond(i-1, i, 0.2, 100.0);
+            nonbonded->addException(i-1, i, 0.0, 1.0, 0.0);
+        }
+        if (i < 10) {
+            hbond->addDonor(i, -1, -1);
+            hbond->addAcceptor(i+10, -1, -1);
+        }
+        if (i%5 == 0)
+            rmsdParticles.push_back(i);
+    }
+    vector<Vec3> referencePositions = positions;
+    for (Vec3& p : referencePositions)
+        p += Vec3(0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt), 0.1*genrand_real2(sfmt));
+    system.addForce(new RMSDForce(referencePositions, rmsdParticles));
+    VerletIntegrator integrator1(0.001);
+    VerletIntegrator integrator2(0.001);
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "4";
+    Context context(system, integrator1, platform, properties);
+    ReferencePlatform reference;
+    Context referenceContext(system, integrator2, reference);
+    context.setPositions(positions);
+    referenceContext.setPositions(positions);
+    for (int step = 0; step < 3; step++) {
+        State state = context.getState(State::Energy | State::Forces);
+        State referenceState = referenceContext.getState(State::Energy | State::Forces);
+        ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), state.getPotentialEnergy(), 1e-4);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(referenceState.getForces()[i], state.getForces()[i], 1e-3);
+        ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), context.getState(State::Energy).getPotentialEnergy(), 1e-4);
+        context.setParameter("k", 0.5*(step+1));
+        referenceContext.setParameter("k", 0.5*(step+1));
+    }
+}
+
+void runPlatformTests() {
+    testConcurrentForces();
+}
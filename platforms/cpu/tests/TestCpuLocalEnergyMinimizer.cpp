@@ -0,0 +1,127 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestLocalEnergyMinimizer.h"
+#include "ReferencePlatform.h"
+
+void testParallelVectorOperations() {
+    // Minimize a system large enough that the vector operations are divided between threads, and
+    // compare the result to the Reference platform.
+
+    const int numParticles = 10000;
+    System system;
+    CustomExternalForce* external = new CustomExternalForce("k*((x-x0)^2+(y-y0)^2+(z-z0)^2)+0.1*(x-x0)^4");
+    external->addPerParticleParameter("k");
+    external->addPerParticleParameter("x0");
+    external->addPerParticleParameter("y0");
+    external->addPerParticleParameter("z0");
+    system.addForce(external);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system.addForce(bonds);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<Vec3> positions(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        external->addParticle(i, {1.0+genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt)});
+        positions[i] = Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*5.0;
+        if (i > 0)
+            bonds->addBond(i-1, i, 0.1, 10.0);
+    }
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "4";
+    VerletIntegrator integrator1(0.001), integrator2(0.001);
+    Context context(system, integrator1, platform, properties);
+    ReferencePlatform reference;
+    Context referenceContext(system, integrator2, reference);
+    context.setPositions(positions);
+    referenceContext.setPositions(positions);
+    const double tolerance = 1.0;
+    LocalEnergyMinimizer::minimize(context, tolerance);
+    LocalEnergyMinimizer::minimize(referenceContext, tolerance);
+    State state = context.getState(State::Energy | State::Forces);
+    State referenceState = referenceContext.getState(State::Energy);
+    ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), state.getPotentialEnergy(), 1e-3);
+    double forceNorm = 0.0;
+    for (Vec3 f : state.getForces())
+        forceNorm += f.dot(f);
+    forceNorm = sqrt(forceNorm/(3*numParticles));
+    ASSERT(forceNorm < 2*tolerance);
+}
+
+void testBatch() {
+    // Minimize a batch of conformations of a chain with constraints, and compare the results to
+    // minimizing each one separately.
+
+    const int numParticles = 20;
+    const int numConformations = 7;
+    System system;
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system.addForce(bonds);
+    NonbondedForce* nonbonded = new NonbondedForce();
+    system.addForce(nonbonded);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.2 : -0.2, 0.3, 0.5);
+        if (i%5 == 0)
+            system.addConstraint(i, i+1, 0.15);
+        else if (i > 0)
+            bonds->addBond(i-1, i, 0.15, 1000.0);
+    }
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<vector<Vec3> > positions(numConformations, vector<Vec3>(numParticles));
+    for (int i = 0; i < numConformations; i++)
+        for (int j = 0; j < numParticles; j++)
+            positions[i][j] = Vec3(0.15*j, 0, 0) + Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*0.1;
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "3";
+    VerletIntegrator integrator(0.001);
+    Context context(system, integrator, platform, properties);
+    vector<vector<Vec3> > minimized = positions;
+    vector<double> energies;
+    LocalEnergyMinimizer::minimizeBatch(context, minimized, energies, 1.0);
+    ASSERT_EQUAL(numConformations, energies.size());
+    for (int i = 0; i < numConformations; i++) {
+        context.setPositions(positions[i]);
+        LocalEnergyMinimizer::minimize(context, 1.0);
+        State state = context.getState(State::Positions | State::Energy);
+        ASSERT_EQUAL_TOL(state.getPotentialEnergy(), energies[i], 1e-5);
+        for (int j = 0; j < numParticles; j++)
+            ASSERT_EQUAL_VEC(state.getPositions()[j], minimized[i][j], 1e-5);
+    }
+}
+
+void runPlatformTests() {
+    testParallelVectorOperations();
+    testBatch();
+}
@@ -0,0 +1,98 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestMonteCarloBarostat.h"
+#include "openmm/LangevinMiddleIntegrator.h"
+
+void testNeighborListAfterScaling() {
+    // Volume moves adjust the neighbor list in place instead of rebuilding it.  After every step, compare
+    // the energy and forces to a new Context whose neighbor list was built from scratch.
+
+    const int gridSize = 8;
+    const double spacing = 0.35;
+    const double width = gridSize*spacing;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(width, 0, 0), Vec3(0, width, 0), Vec3(0, 0, width));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    system.addForce(nonbonded);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    system.addForce(bonds);
+    vector<Vec3> positions;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < gridSize; i++)
+        for (int j = 0; j < gridSize; j++)
+            for (int k = 0; k < gridSize; k += 2) {
+                // Each molecule is a pair of bonded particles.
+
+                Vec3 pos(i*spacing, j*spacing, k*spacing);
+                int first = system.getNumParticles();
+                system.addParticle(20.0);
+                system.addParticle(20.0);
+                nonbonded->addParticle(0.2, 0.3, 0.5);
+                nonbonded->addParticle(-0.2, 0.3, 0.5);
+                nonbonded->addException(first, first+1, 0.0, 1.0, 0.0);
+                bonds->addBond(first, first+1, spacing, 1000.0);
+                positions.push_back(pos+Vec3(0.02*genrand_real2(sfmt), 0.02*genrand_real2(sfmt), 0.02*genrand_real2(sfmt)));
+                positions.push_back(pos+Vec3(0, 0, spacing));
+            }
+    MonteCarloBarostat* barostat = new MonteCarloBarostat(100.0, 300.0, 1);
+    system.addForce(barostat);
+    LangevinMiddleIntegrator integrator(300.0, 1.0, 0.002);
+    integrator.setRandomNumberSeed(1);
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "4";
+    Context context(system, integrator, platform, properties);
+    context.setPositions(positions);
+    const int numSteps = 50;
+    for (int step = 0; step < numSteps; step++) {
+        integrator.step(1);
+        State state = context.getState(State::Positions | State::Energy | State::Forces);
+        Vec3 a, b, c;
+        state.getPeriodicBoxVectors(a, b, c);
+        VerletIntegrator integrator2(0.001);
+        Context context2(system, integrator2, platform, properties);
+        context2.setPeriodicBoxVectors(a, b, c);
+        context2.setPositions(state.getPositions());
+        State state2 = context2.getState(State::Energy | State::Forces);
+        ASSERT_EQUAL_TOL(state2.getPotentialEnergy(), state.getPotentialEnergy(), 1e-5);
+        for (int i = 0; i < system.getNumParticles(); i++)
+            ASSERT_EQUAL_VEC(state2.getForces()[i], state.getForces()[i], 1e-4);
+    }
+    ASSERT(platform.getNeighborListStatistics(context).numBuilds < numSteps);
+}
+
+void runPlatformTests() {
+    testNeighborListAfterScaling();
+}
@@ -48,7 +48,7 @@
 using namespace OpenMM;
 using namespace std;
 
-void testNeighborList(bool periodic, bool triclinic) {
+void testNeighborList(bool periodic, bool triclinic, int blockSize) {
     const int numParticles = 500;
     const float cutoff = 2.0f;
     Vec3 boxVectors[3];
@@ -63,7 +63,6 @@ void testNeighborList(bool periodic, bool triclinic) {
         boxVectors[2] = Vec3(0, 0, 11);
     }
     const float boxSize[3] = {(float) boxVectors[0][0], (float) boxVectors[1][1], (float) boxVectors[2][2]};
-    const int blockSize = 8;
     OpenMM_SFMT::SFMT sfmt;
     init_gen_rand(0, sfmt);
     AlignedArray<float> positions(4*numParticles);
@@ -88,7 +87,7 @@ void testNeighborList(bool periodic, bool triclinic) {
     for (int i = 0; i < (int) neighborList.getSortedAtoms().size(); i++) {
         int blockIndex = i/blockSize;
         int indexInBlock = i-blockIndex*blockSize;
-        char mask = 1<<indexInBlock;
+        int mask = 1<<indexInBlock;
         for (int j = 0; j < (int) neighborList.getBlockExclusions(blockIndex).size(); j++) {
             if ((neighborList.getBlockExclusions(blockIndex)[j] & mask) == 0) {
                 int atom1 = neighborList.getSortedAtoms()[i];
@@ -119,15 +118,54 @@ void testNeighborList(bool periodic, bool triclinic) {
         }
 }
 
+void testRebuildAfterMotion() {
+    // Rebuilding a neighbor list after atoms have moved should give the same result as building a new one.
+
+    const int numParticles = 1000;
+    const float cutoff = 1.5f;
+    Vec3 boxVectors[3] = {Vec3(8, 0, 0), Vec3(0, 8, 0), Vec3(0, 0, 8)};
+    const int blockSize = 8;
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    AlignedArray<float> positions(4*numParticles);
+    for (int i = 0; i < 4*numParticles; i++)
+        if (i%4 < 3)
+            positions[i] = 8*genrand_real2(sfmt);
+    vector<set<int> > exclusions(numParticles);
+    ThreadPool threads;
+    CpuNeighborList neighborList(blockSize);
+    neighborList.computeNeighborList(numParticles, positions, exclusions, boxVectors, true, cutoff, threads);
+    for (int step = 0; step < 3; step++) {
+        // The last iteration moves the atoms so far that the previous order is useless.
+
+        float displacement = (step < 2 ? 0.05f : 8.0f);
+        for (int i = 0; i < 4*numParticles; i++)
+            if (i%4 < 3)
+                positions[i] = fmod(positions[i]+displacement*(float) genrand_real2(sfmt), 8.0f);
+        neighborList.computeNeighborList(numParticles, positions, exclusions, boxVectors, true, cutoff, threads);
+        CpuNeighborList newList(blockSize);
+        newList.computeNeighborList(numParticles, positions, exclusions, boxVectors, true, cutoff, threads);
+        ASSERT(neighborList.getSortedAtoms() == newList.getSortedAtoms());
+        ASSERT_EQUAL(newList.getNumBlocks(), neighborList.getNumBlocks());
+        for (int i = 0; i < newList.getNumBlocks(); i++) {
+            ASSERT(neighborList.getBlockNeighbors(i) == newList.getBlockNeighbors(i));
+            ASSERT(neighborList.getBlockExclusions(i) == newList.getBlockExclusions(i));
+        }
+    }
+}
+
 int main() {
     try {
         if (!CpuPlatform::isProcessorSupported()) {
             cout << "CPU is not supported.  Exiting." << endl;
             return 0;
         }
-        testNeighborList(false, false);
-        testNeighborList(true, false);
-        testNeighborList(true, true);
+        for (int blockSize : {4, 8, 16}) {
+            testNeighborList(false, false, blockSize);
+            testNeighborList(true, false, blockSize);
+            testNeighborList(true, true, blockSize);
+        }
+        testRebuildAfterMotion();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -32,6 +32,119 @@
 #include "CpuTests.h"
 #include "TestNonbondedForce.h"
 
+void testAdaptivePadding() {
+    // Simulate a fluid with adaptive neighbor list padding and make sure the results match
+    // those with a fixed padding.
+
+    const int numParticles = 1000;
+    const double boxSize = 3.5;
+    const double cutoff = 0.9;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(cutoff);
+    system.addForce(nonbonded);
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    int gridSize = 10;
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(20.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.2 : -0.2, 0.25, 0.5);
+        int x = i%gridSize, y = (i/gridSize)%gridSize, z = i/(gridSize*gridSize);
+        positions[i] = Vec3(x, y, z)*(boxSize/gridSize) + Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*0.02;
+    }
+    VerletIntegrator integrator1(0.002), integrator2(0.002);
+    map<string, string> fixedProperties, adaptiveProperties;
+    adaptiveProperties[CpuPlatform::CpuNeighborListPadding()] = "adaptive";
+    Context context1(system, integrator1, platform, fixedProperties);
+    Context context2(system, integrator2, platform, adaptiveProperties);
+    ASSERT_EQUAL("fixed", platform.getPropertyValue(context1, CpuPlatform::CpuNeighborListPadding()));
+    ASSERT_EQUAL("adaptive", platform.getPropertyValue(context2, CpuPlatform::CpuNeighborListPadding()));
+    context1.setPositions(positions);
+    context2.setPositions(positions);
+    context1.setVelocitiesToTemperature(300.0, 1);
+    context2.setVelocities(context1.getState(State::Velocities).getVelocities());
+    for (int i = 0; i < 10; i++) {
+        integrator2.step(20);
+        State state2 = context2.getState(State::Positions | State::Energy | State::Forces);
+        context1.setPositions(state2.getPositions());
+        State state1 = context1.getState(State::Energy | State::Forces);
+        ASSERT_EQUAL_TOL(state1.getPotentialEnergy(), state2.getPotentialEnergy(), 1e-4);
+        for (int j = 0; j < numParticles; j++)
+            ASSERT_EQUAL_VEC(state1.getForces()[j], state2.getForces()[j], 1e-3);
+    }
+    CpuPlatform::NeighborListStatistics stats = platform.getNeighborListStatistics(context2);
+    ASSERT(stats.numBuilds > 1);
+    ASSERT(stats.numEvaluations >= 200);
+    ASSERT(stats.padding >= 0.05*cutoff/1.5);
+    ASSERT(stats.padding <= 0.5*cutoff);
+    ASSERT(stats.buildTime > 0.0);
+    ASSERT(stats.pairTime > 0.0);
+    ASSERT_EQUAL_TOL(0.25*cutoff, platform.getNeighborListStatistics(context1).padding, 1e-6);
+}
+
+void testPrecision() {
+    // Compute forces with each precision mode and compare them to the Reference platform.
+
+    const int numParticles = 512;
+    const double boxSize = 3.0;
+    const int gridSize = 8;
+    System system;
+    system.setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->setCutoffDistance(1.0);
+    nonbonded->setPMEParameters(3.0, 24, 24, 24);
+    system.addForce(nonbonded);
+    vector<Vec3> positions(numParticles);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.5 : -0.5, 0.2, 0.5);
+        int x = i%gridSize, y = (i/gridSize)%gridSize, z = i/(gridSize*gridSize);
+        positions[i] = Vec3(x, y, z)*(boxSize/gridSize) + Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*0.1;
+    }
+    ReferencePlatform reference;
+    VerletIntegrator referenceIntegrator(0.001);
+    Context referenceContext(system, referenceIntegrator, reference);
+    referenceContext.setPositions(positions);
+    State referenceState = referenceContext.getState(State::Forces | State::Energy);
+    string precisions[] = {"single", "mixed"};
+    for (string precision : precisions) {
+        map<string, string> properties;
+        properties[CpuPlatform::CpuPrecision()] = precision;
+        properties[CpuPlatform::CpuThreads()] = "4";
+        VerletIntegrator integrator(0.001);
+        Context context(system, integrator, platform, properties);
+        ASSERT_EQUAL(precision, platform.getPropertyValue(context, CpuPlatform::CpuPrecision()));
+        context.setPositions(positions);
+        State state = context.getState(State::Forces | State::Energy);
+        double tol = 1e-4;
+        ASSERT_EQUAL_TOL(referenceState.getPotentialEnergy(), state.getPotentialEnergy(), tol);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(referenceState.getForces()[i], state.getForces()[i], tol);
+    }
+
+    // An illegal value should be rejected.
+
+    map<string, string> properties;
+    properties[CpuPlatform::CpuPrecision()] = "quadruple";
+    VerletIntegrator integrator(0.001);
+    bool threwException = false;
+    try {
+        Context context(system, integrator, platform, properties);
+    }
+    catch (OpenMMException& ex) {
+        threwException = true;
+    }
+    ASSERT(threwException);
+}
+
 void runPlatformTests() {
     testHugeSystem();
+    testAdaptivePadding();
+    testPrecision();
 }
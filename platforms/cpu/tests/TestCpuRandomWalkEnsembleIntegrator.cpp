@@ -0,0 +1,84 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2019 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "CpuTests.h"
+#include "TestRandomWalkEnsembleIntegrator.h"
+
+#include "openmm/HarmonicBondForce.h"
+#include <map>
+#include <string>
+
+void testParallelEnergies() {
+    // With several threads the proposals and Metropolis decisions are divided between threads.  The chain
+    // energies must follow changes to global parameters and to the parameters of Forces.
+
+    const int numChains = 7;
+    const int numParticles = 4;
+    System system;
+    CustomExternalForce* external = new CustomExternalForce("k*(x^2+y^2+z^2)");
+    external->addGlobalParameter("k", 1.0);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        external->addParticle(i);
+        if (i > 0)
+            bonds->addBond(i-1, i, 0.1, 100.0);
+    }
+    system.addForce(external);
+    system.addForce(bonds);
+    RandomWalkEnsembleIntegrator integrator(numChains, 300.0, 0.01);
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "3";
+    Context context(system, integrator, platform, properties);
+    vector<Vec3> positions(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        positions[i] = Vec3(0.1*i, 0, 0);
+    context.setPositions(positions);
+    for (int iteration = 0; iteration < 3; iteration++) {
+        if (iteration == 1)
+            context.setParameter("k", 2.0);
+        if (iteration == 2) {
+            bonds->setBondParameters(0, 0, 1, 0.15, 200.0);
+            bonds->updateParametersInContext(context);
+        }
+        integrator.step(10);
+        for (int chain = 0; chain < numChains; chain++) {
+            integrator.getChainPositions(chain, positions);
+            context.setPositions(positions);
+            double energy = context.getState(State::Energy).getPotentialEnergy();
+            ASSERT_EQUAL_TOL(energy, integrator.getChainEnergy(chain), 1e-5);
+        }
+    }
+}
+
+void runPlatformTests() {
+    testParallelEnergies();
+}
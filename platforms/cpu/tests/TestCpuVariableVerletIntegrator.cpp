@@ -0,0 +1,81 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2019 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+
+#include "CpuTests.h"
+#include "TestVariableVerletIntegrator.h"
+
+void testMultipleThreads() {
+    // Divide the particles between several threads and check that the trajectory, including the
+    // sequence of step sizes, matches the Reference platform.
+
+    System system;
+    const int numParticles = 100;
+    for (int i = 0; i < numParticles; i++)
+        system.addParticle(i%7 == 0 ? 0.0 : 1.0+0.1*(i%4));
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    for (int i = 1; i < numParticles; i++)
+        bonds->addBond(i-1, i, 1.0, 100.0+i);
+    system.addForce(bonds);
+    for (int i = 2; i < numParticles-2; i += 7)
+        system.addConstraint(i, i+1, 1.0);
+    vector<Vec3> positions(numParticles), velocities(numParticles);
+    for (int i = 0; i < numParticles; i++) {
+        positions[i] = Vec3(i, 0.1*(i%3), 0.05*(i%2));
+        velocities[i] = Vec3(0.1*(i%2), -0.2*(i%3), 0.1);
+    }
+    VariableVerletIntegrator integrator1(1e-4);
+    ReferencePlatform reference;
+    Context context1(system, integrator1, reference);
+    context1.setPositions(positions);
+    context1.setVelocities(velocities);
+    context1.applyConstraints(1e-6);
+    VariableVerletIntegrator integrator2(1e-4);
+    map<string, string> properties;
+    properties[CpuPlatform::CpuThreads()] = "4";
+    Context context2(system, integrator2, platform, properties);
+    context2.setPositions(positions);
+    context2.setVelocities(velocities);
+    context2.applyConstraints(1e-6);
+    integrator1.step(20);
+    integrator2.step(20);
+    State state1 = context1.getState(State::Positions | State::Velocities);
+    State state2 = context2.getState(State::Positions | State::Velocities);
+    ASSERT_EQUAL_TOL(state1.getTime(), state2.getTime(), 1e-5);
+    for (int i = 0; i < numParticles; i++) {
+        ASSERT_EQUAL_VEC(state1.getPositions()[i], state2.getPositions()[i], 1e-5);
+        ASSERT_EQUAL_VEC(state1.getVelocities()[i], state2.getVelocities()[i], 1e-5);
+    }
+}
+
+void runPlatformTests() {
+    testMultipleThreads();
+}
@@ -86,6 +86,13 @@ double CudaCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context, bo
     return sum;
 }
 
+void CudaCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    ContextSelector selector(cu);
+    ComputeEvent event = cu.createEvent();
+    event->enqueue();
+    event->wait();
+}
+
 class CudaCalcNonbondedForceKernel::ForceInfo : public CudaForceInfo {
 public:
     ForceInfo(const NonbondedForce& force) : force(force) {
@@ -415,6 +422,8 @@ void CudaCalcNonbondedForceKernel::initialize(const System& system, const Nonbon
     else if (((nonbondedMethod == PME || nonbondedMethod == LJPME) && hasCoulomb) || doLJPME) {
         // Compute the PME parameters.
 
+        if (force.getPMEInterpolationOrder() != PmeOrder)
+            throw OpenMMException("This platform only supports a PME interpolation order of 5");
         NonbondedForceImpl::calcPMEParameters(system, force, alpha, gridSizeX, gridSizeY, gridSizeZ, false);
         gridSizeX = CudaFFT3D::findLegalDimension(gridSizeX);
         gridSizeY = CudaFFT3D::findLegalDimension(gridSizeY);
@@ -478,7 +487,7 @@ void CudaCalcNonbondedForceKernel::initialize(const System& system, const Nonbon
 
                 try {
                     cpuPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), *cu.getPlatformData().context);
-                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, cu.getPlatformData().deterministicForces);
+                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, cu.getPlatformData().deterministicForces, PmeOrder);
                     CUfunction addForcesKernel = cu.getKernel(module, "addForces");
                     pmeio = new PmeIO(cu, addForcesKernel);
                     cu.addPreComputation(new PmePreComputation(cu, cpuPme, *pmeio));
@@ -270,6 +270,16 @@ double CudaParallelCalcForcesAndEnergyKernel::finishComputation(ContextImpl& con
     return energy;
 }
 
+void CudaParallelCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    data.syncContexts();
+    for (CudaContext* cu : data.contexts) {
+        ContextSelector selector(*cu);
+        ComputeEvent event = cu->createEvent();
+        event->enqueue();
+        event->wait();
+    }
+}
+
 class CudaParallelCalcNonbondedForceKernel::Task : public CudaContext::WorkTask {
 public:
     Task(ContextImpl& context, CudaCalcNonbondedForceKernel& kernel, bool includeForce,
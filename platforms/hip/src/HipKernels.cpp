@@ -88,6 +88,13 @@ double HipCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context, boo
     return sum;
 }
 
+void HipCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    ContextSelector selector(cu);
+    ComputeEvent event = cu.createEvent();
+    event->enqueue();
+    event->wait();
+}
+
 class HipCalcNonbondedForceKernel::ForceInfo : public HipForceInfo {
 public:
     ForceInfo(const NonbondedForce& force) : force(force) {
@@ -409,6 +416,8 @@ void HipCalcNonbondedForceKernel::initialize(const System& system, const Nonbond
     else if (((nonbondedMethod == PME || nonbondedMethod == LJPME) && hasCoulomb) || doLJPME) {
         // Compute the PME parameters.
 
+        if (force.getPMEInterpolationOrder() != PmeOrder)
+            throw OpenMMException("This platform only supports a PME interpolation order of 5");
         NonbondedForceImpl::calcPMEParameters(system, force, alpha, gridSizeX, gridSizeY, gridSizeZ, false);
         gridSizeX = cu.findLegalFFTDimension(gridSizeX);
         gridSizeY = cu.findLegalFFTDimension(gridSizeY);
@@ -470,7 +479,7 @@ void HipCalcNonbondedForceKernel::initialize(const System& system, const Nonbond
 
                 try {
                     cpuPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), *cu.getPlatformData().context);
-                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, cu.getPlatformData().deterministicForces);
+                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, cu.getPlatformData().deterministicForces, PmeOrder);
                     hipFunction_t addForcesKernel = cu.getKernel(module, "addForces");
                     pmeio = new PmeIO(cu, addForcesKernel);
                     cu.addPreComputation(new PmePreComputation(cu, cpuPme, *pmeio));
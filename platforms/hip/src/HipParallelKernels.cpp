@@ -259,6 +259,16 @@ double HipParallelCalcForcesAndEnergyKernel::finishComputation(ContextImpl& cont
     return energy;
 }
 
+void HipParallelCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    data.syncContexts();
+    for (HipContext* cu : data.contexts) {
+        ContextSelector selector(*cu);
+        ComputeEvent event = cu->createEvent();
+        event->enqueue();
+        event->wait();
+    }
+}
+
 class HipParallelCalcNonbondedForceKernel::Task : public HipContext::WorkTask {
 public:
     Task(ContextImpl& context, HipCalcNonbondedForceKernel& kernel, bool includeForce,
@@ -101,6 +101,12 @@ double OpenCLCalcForcesAndEnergyKernel::finishComputation(ContextImpl& context,
     return sum;
 }
 
+void OpenCLCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    ComputeEvent event = cl.createEvent();
+    event->enqueue();
+    event->wait();
+}
+
 class OpenCLCalcNonbondedForceKernel::ForceInfo : public OpenCLForceInfo {
 public:
     ForceInfo(int requiredBuffers, const NonbondedForce& force) : OpenCLForceInfo(requiredBuffers), force(force) {
@@ -418,6 +424,8 @@ void OpenCLCalcNonbondedForceKernel::initialize(const System& system, const Nonb
     else if (((nonbondedMethod == PME || nonbondedMethod == LJPME) && hasCoulomb) || doLJPME) {
         // Compute the PME parameters.
 
+        if (force.getPMEInterpolationOrder() != PmeOrder)
+            throw OpenMMException("This platform only supports a PME interpolation order of 5");
         NonbondedForceImpl::calcPMEParameters(system, force, alpha, gridSizeX, gridSizeY, gridSizeZ, false);
         gridSizeX = OpenCLFFT3D::findLegalDimension(gridSizeX);
         gridSizeY = OpenCLFFT3D::findLegalDimension(gridSizeY);
@@ -472,7 +480,7 @@ void OpenCLCalcNonbondedForceKernel::initialize(const System& system, const Nonb
 
                 try {
                     cpuPme = getPlatform().createKernel(CalcPmeReciprocalForceKernel::Name(), *cl.getPlatformData().context);
-                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, false);
+                    cpuPme.getAs<CalcPmeReciprocalForceKernel>().initialize(gridSizeX, gridSizeY, gridSizeZ, numParticles, alpha, false, PmeOrder);
                     cl::Program program = cl.createProgram(CommonKernelSources::pme, pmeDefines);
                     cl::Kernel addForcesKernel = cl::Kernel(program, "addForces");
                     pmeio = new PmeIO(cl, addForcesKernel);
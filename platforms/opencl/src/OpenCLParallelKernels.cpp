@@ -190,6 +190,15 @@ double OpenCLParallelCalcForcesAndEnergyKernel::finishComputation(ContextImpl& c
     return energy;
 }
 
+void OpenCLParallelCalcForcesAndEnergyKernel::synchronize(ContextImpl& context) {
+    data.syncContexts();
+    for (OpenCLContext* cl : data.contexts) {
+        ComputeEvent event = cl->createEvent();
+        event->enqueue();
+        event->wait();
+    }
+}
+
 class OpenCLParallelCalcNonbondedForceKernel::Task : public OpenCLContext::WorkTask {
 public:
     Task(ContextImpl& context, OpenCLCalcNonbondedForceKernel& kernel, bool includeForce,
@@ -42,7 +42,9 @@ private:
     std::vector<std::string> variableNames, paramDerivNames, globalParameterNames;
     std::vector<Lepton::CompiledExpression> variableDerivExpressions;
     std::vector<Lepton::CompiledExpression> paramDerivExpressions;
-    std::vector<double> globalValues, cvValues;
+    std::vector<double> globalValues, cvValues, cvDerivatives;
+    std::vector<std::vector<OpenMM::Vec3> > cvForces;
+    std::vector<std::map<std::string, double> > cvParamDerivs;
     std::vector<Lepton::CustomFunction*> tabulatedFunctions;
 
 public:
@@ -68,13 +70,13 @@ public:
      * @param innerContext       the context created by the force for evaluating collective variables
      * @param atomCoordinates    atom coordinates
      * @param globalParameters   the values of global parameters
-     * @param forces             the forces are added to this
+     * @param forces             the forces are added to this.  If this is NULL, forces are not computed.
      * @param totalEnergy        the energy is added to this
      * @param energyParamDerivs  parameter derivatives are added to this
      */
    void calculateIxn(ContextImpl& innerContext, std::vector<OpenMM::Vec3>& atomCoordinates,
                      const std::map<std::string, double>& globalParameters,
-                     std::vector<OpenMM::Vec3>& forces, double* totalEnergy, std::map<std::string, double>& energyParamDerivs);
+                     std::vector<OpenMM::Vec3>* forces, double* totalEnergy, std::map<std::string, double>& energyParamDerivs);
 };
 
 } // namespace OpenMM
@@ -55,14 +55,14 @@ class ReferenceCustomCentroidBondIxn : public ReferenceBondIxn {
 
          Calculate custom interaction for one bond
 
-         @param bond             the index of the bond
+         @param groups           the indices of the groups in the bond
          @param groupCenters     group center coordinates
          @param forces           force array (forces added)
          @param totalEnergy      total energy
 
          --------------------------------------------------------------------------------------- */
 
-      void calculateOneIxn(int bond, std::vector<OpenMM::Vec3>& groupCenters,
+      void calculateOneIxn(const std::vector<int>& groups, std::vector<OpenMM::Vec3>& groupCenters,
                            std::vector<OpenMM::Vec3>& forces, double* totalEnergy, double* energyParamDerivs);
 
       void computeDelta(int group1, int group2, double* delta, std::vector<OpenMM::Vec3>& groupCenters) const;
@@ -126,6 +126,36 @@ class ReferenceCustomCentroidBondIxn : public ReferenceBondIxn {
                             const std::map<std::string, double>& globalParameters,
                             std::vector<OpenMM::Vec3>& forces, double* totalEnergy, double* energyParamDerivs);
 
+      /**---------------------------------------------------------------------------------------
+
+         Set the values of global parameters.  This must be called before calculateBondIxn().
+
+         @param globalParameters   the values of global parameters
+
+         --------------------------------------------------------------------------------------- */
+
+      void setGlobalParameters(const std::map<std::string, double>& globalParameters);
+
+      /**---------------------------------------------------------------------------------------
+
+         Calculate the interaction for a single bond, given the precomputed group centers.  The
+         "atoms" seen by this method are groups: atomIndices holds the group indices of the bond,
+         atomCoordinates the group centers, and forces receives the force on each group.  The
+         caller is responsible for computing the centers and distributing the forces to atoms.
+
+         @param atomIndices      the indices of the groups in the bond
+         @param atomCoordinates  group center coordinates
+         @param parameters       the parameter values for the bond
+         @param forces           group force array (forces added)
+         @param totalEnergy      total energy
+         @param energyParamDerivs derivatives of the energy with respect to global parameters (added)
+
+         --------------------------------------------------------------------------------------- */
+
+      void calculateBondIxn(std::vector<int>& atomIndices, std::vector<OpenMM::Vec3>& atomCoordinates,
+                            std::vector<double>& parameters, std::vector<OpenMM::Vec3>& forces,
+                            double* totalEnergy, double* energyParamDerivs);
+
 // ---------------------------------------------------------------------------------------
 
 };
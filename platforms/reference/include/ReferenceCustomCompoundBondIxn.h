@@ -53,14 +53,14 @@ class ReferenceCustomCompoundBondIxn : public ReferenceBondIxn {
 
          Calculate custom interaction for one bond
 
-         @param bond             the index of the bond
+         @param atoms            the indices of the atoms in the bond
          @param atomCoordinates  atom coordinates
          @param forces           force array (forces added)
          @param totalEnergy      total energy
 
          --------------------------------------------------------------------------------------- */
 
-      void calculateOneIxn(int bond, std::vector<OpenMM::Vec3>& atomCoordinates,
+      void calculateOneIxn(const std::vector<int>& atoms, std::vector<OpenMM::Vec3>& atomCoordinates,
                            std::vector<OpenMM::Vec3>& forces, double* totalEnergy, double* energyParamDerivs);
 
       void computeDelta(int atom1, int atom2, double* delta, std::vector<OpenMM::Vec3>& atomCoordinates) const;
@@ -123,6 +123,34 @@ class ReferenceCustomCompoundBondIxn : public ReferenceBondIxn {
                             const std::map<std::string, double>& globalParameters,
                             std::vector<OpenMM::Vec3>& forces, double* totalEnergy, double* energyParamDerivs);
 
+      /**---------------------------------------------------------------------------------------
+
+         Set the values of global parameters.  This must be called before calculateBondIxn().
+
+         @param globalParameters   the values of global parameters
+
+         --------------------------------------------------------------------------------------- */
+
+      void setGlobalParameters(const std::map<std::string, double>& globalParameters);
+
+      /**---------------------------------------------------------------------------------------
+
+         Calculate the interaction for a single bond.  This allows bonds to be divided between
+         threads, each using its own copy of this object.
+
+         @param atomIndices      the indices of the atoms in the bond
+         @param atomCoordinates  atom coordinates
+         @param parameters       the parameter values for the bond
+         @param forces           force array (forces added)
+         @param totalEnergy      total energy
+         @param energyParamDerivs derivatives of the energy with respect to global parameters (added)
+
+         --------------------------------------------------------------------------------------- */
+
+      void calculateBondIxn(std::vector<int>& atomIndices, std::vector<OpenMM::Vec3>& atomCoordinates,
+                            std::vector<double>& parameters, std::vector<OpenMM::Vec3>& forces,
+                            double* totalEnergy, double* energyParamDerivs);
+
 // ---------------------------------------------------------------------------------------
 
 };
@@ -16,9 +16,9 @@ namespace OpenMM {
 
 class ReferenceDampedReconstructionDynamics : public ReferenceDynamics {
 
-   private:
+   protected:
 
-      std::vector<OpenMM::Vec3> xPrime, macroVariable;
+      std::vector<OpenMM::Vec3> xPrime, macroVariable, residual, bias;
       double lambda;
       double gamma;
       ReactionCoordinate* reactionCoordinate;
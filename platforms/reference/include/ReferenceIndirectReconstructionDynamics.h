@@ -16,9 +16,9 @@ namespace OpenMM {
 
 class ReferenceIndirectReconstructionDynamics : public ReferenceDynamics {
 
-   private:
+   protected:
 
-      std::vector<OpenMM::Vec3> xPrime, macroVariable;
+      std::vector<OpenMM::Vec3> xPrime, macroVariable, residual, bias;
       double lambda;
       ReactionCoordinate* reactionCoordinate;
 
@@ -122,7 +122,7 @@ private:
  */
 class OPENMM_EXPORT ReferenceUpdateStateDataKernel : public UpdateStateDataKernel {
 public:
-    ReferenceUpdateStateDataKernel(std::string name, const Platform& platform, ReferencePlatform::PlatformData& data) : UpdateStateDataKernel(name, platform), data(data) {
+    ReferenceUpdateStateDataKernel(std::string name, const Platform& platform, ReferencePlatform::PlatformData& data) : UpdateStateDataKernel(name, platform), data(data), hasSnapshot(false) {
     }
     /**
      * Initialize the kernel.
@@ -227,9 +227,28 @@ public:
      * @param stream    an input stream the checkpoint data should be read from
      */
     void loadCheckpoint(ContextImpl& context, std::istream& stream);
+    /**
+     * Save the current positions, velocities, forces, time, and periodic box vectors so they can later be
+     * restored with restoreSnapshot().
+     *
+     * @param energy     the potential energy corresponding to the current positions
+     */
+    void saveSnapshot(ContextImpl& context, double energy);
+    /**
+     * Restore the positions, velocities, forces, time, and periodic box vectors saved by the most recent
+     * call to saveSnapshot().  The buffers are exchanged with the
+     * Context's rather than copied, so this consumes the snapshot.
+     *
+     * @return the potential energy that was passed to saveSnapshot()
+     */
+    double restoreSnapshot(ContextImpl& context);
 private:
     ReferencePlatform::PlatformData& data;
     std::vector<double> masses;
+    std::vector<Vec3> snapshotPositions, snapshotVelocities, snapshotForces;
+    Vec3 snapshotBoxVectors[3];
+    double snapshotEnergy, snapshotTime;
+    bool hasSnapshot;
 };
 
 /**
@@ -668,7 +687,7 @@ private:
     std::map<std::pair<std::string, int>, std::array<double, 3> > particleParamOffsets, exceptionParamOffsets;
     std::map<int, int> nb14Index;
     double nonbondedCutoff, switchingDistance, rfDielectric, ewaldAlpha, ewaldDispersionAlpha, dispersionCoefficient;
-    int kmax[3], gridSize[3], dispersionGridSize[3];
+    int kmax[3], gridSize[3], dispersionGridSize[3], pmeOrder;
     bool useSwitchingFunction, exceptionsArePeriodic;
     std::vector<std::set<int> > exclusions;
     NonbondedMethod nonbondedMethod;
@@ -1110,6 +1129,11 @@ public:
      */
     void copyParametersToContext(ContextImpl& context, const CustomCVForce& force);
 private:
+    /**
+     * Copy the information needed for computing forces (positions, box vectors, time, and any parameters
+     * that have changed) to the inner context.
+     */
+    void copyCoordinatesAndParameters(ContextImpl& context, ContextImpl& innerContext);
     ReferenceCustomCVForce* ixn;
     std::vector<std::string> globalParameterNames, energyParamDerivNames;
 };
@@ -1275,7 +1299,15 @@ public:
      * @param velocities    element [i][j] contains the velocity of bead j for chain i
      */
     void setChainStates(ContextImpl& context, const std::vector<std::vector<double> >& positions, const std::vector<std::vector<double> >& velocities);
-private:
+protected:
+    /**
+     * Create the object that updates particle positions and velocities.  Subclasses may override
+     * this to provide a different implementation.
+     *
+     * @param context    the context this kernel is updating
+     * @param stepSize   the step size to integrate with
+     */
+    virtual ReferenceNoseHooverDynamics* createDynamics(ContextImpl& context, double stepSize);
     ReferencePlatform::PlatformData& data;
     ReferenceNoseHooverChain* chainPropagator;
     ReferenceNoseHooverDynamics* dynamics;
@@ -1505,7 +1537,15 @@ public:
      * @param values    a vector containing the values
      */
     void setPerDofVariable(ContextImpl& context, int variable, const std::vector<Vec3>& values);
-private:
+protected:
+    /**
+     * Create the object that executes the integration steps.  Subclasses may override this to provide
+     * a different implementation.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the CustomIntegrator this kernel will be used for
+     */
+    virtual ReferenceCustomDynamics* createDynamics(const System& system, const CustomIntegrator& integrator);
     ReferencePlatform::PlatformData& data;
     ReferenceCustomDynamics* dynamics;
     std::vector<double> masses, globalValues;
@@ -1614,7 +1654,6 @@ private:
 };
 
 /**
-<<<<<<< HEAD
  * This kernel is invoked by RandomWalkIntegrator to take one time step.
  */
 class ReferenceIntegrateRandomWalkStepKernel : public IntegrateRandomWalkStepKernel {
@@ -1651,6 +1690,106 @@ private:
     double prevTemp, prevStepSize;
 };
 
+/**
+ * This kernel is invoked by RandomWalkEnsembleIntegrator.  The positions of all chains are stored as
+ * structure-of-arrays, with the coordinates of particle i in chain c at index c*numParticles+i.
+ */
+class ReferenceIntegrateRandomWalkEnsembleStepKernel : public IntegrateRandomWalkEnsembleStepKernel {
+public:
+    ReferenceIntegrateRandomWalkEnsembleStepKernel(std::string name, const Platform& platform, ReferencePlatform::PlatformData& data) :
+            IntegrateRandomWalkEnsembleStepKernel(name, platform), data(data) {
+    }
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const RandomWalkEnsembleIntegrator& integrator);
+    /**
+     * Set the current positions of one chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param positions  the positions of the particles
+     */
+    void setChainPositions(ContextImpl& context, int chain, const std::vector<Vec3>& positions);
+    /**
+     * Get the current positions of one chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param positions  on exit, contains the positions of the particles
+     */
+    void getChainPositions(ContextImpl& context, int chain, std::vector<Vec3>& positions);
+    /**
+     * Copy the current positions of the context into every chain whose positions have not been set yet.
+     *
+     * @param context    the context in which to execute this kernel
+     */
+    void initializeChains(ContextImpl& context);
+    /**
+     * Copy the positions of one chain into the context.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param chain      the index of the chain
+     * @param proposal   if true, copy the proposed positions.  Otherwise copy the current positions.
+     */
+    void loadChain(ContextImpl& context, int chain, bool proposal);
+    /**
+     * Make a new proposal for every chain.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     */
+    void propose(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator);
+    /**
+     * Set the energies of the current positions of all chains.
+     *
+     * @param energies   the energy of each chain
+     */
+    void setChainEnergies(const std::vector<double>& energies);
+    /**
+     * Accept or reject the proposal of every chain with the Metropolis criterion.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     * @param energies   the energy of each chain's proposal
+     */
+    void acceptOrReject(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator, const std::vector<double>& energies);
+    /**
+     * Get the energy of the current positions of one chain.
+     */
+    double getChainEnergy(int chain);
+    /**
+     * Get the number of proposals made for each chain since the statistics were last reset.
+     */
+    long long getNumProposed();
+    /**
+     * Get the number of proposals accepted for one chain since the statistics were last reset.
+     */
+    long long getNumAccepted(int chain);
+    /**
+     * Reset the acceptance statistics of all chains.
+     */
+    void resetStatistics();
+    /**
+     * Compute the kinetic energy.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the RandomWalkEnsembleIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator);
+protected:
+    ReferencePlatform::PlatformData& data;
+    int numChains, numParticles;
+    std::vector<double> masses;
+    std::vector<double> x, y, z, proposedX, proposedY, proposedZ, chainEnergy;
+    std::vector<long long> numAccepted;
+    std::vector<int> chainIsSet;
+    long long numProposed;
+};
+
 /**
  * This kernel is invoked by IndirectReconstructionIntegrator to take one time step.
  */
@@ -1697,7 +1836,36 @@ public:
         data(data), dynamics(0) {
     }
     ~ReferenceIntegrateDampedReconstructionStepKernel();
-=======
+    /**
+     * Initialize the kernel.
+     *
+     * @param system     the System this kernel will be applied to
+     * @param integrator the DampedReconstructionIntegrator this kernel will be used for
+     */
+    void initialize(const System& system, const DampedReconstructionIntegrator& integrator);
+    /**
+     * Execute the kernel.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
+     */
+    void execute(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
+    /**
+     * Compute the kinetic energy.
+     *
+     * @param context    the context in which to execute this kernel
+     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
+     */
+    double computeKineticEnergy(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
+private:
+    ReferencePlatform::PlatformData& data;
+    ReferenceDampedReconstructionDynamics* dynamics;
+    std::vector<double> masses;
+    double prevTemp, prevStepSize;
+};
+
+
+/**
  * This kernel is invoked by ATMForce to calculate the forces acting on the system and the energy of the system.
  */
 class ReferenceCalcATMForceKernel : public CalcATMForceKernel {
@@ -1738,6 +1906,17 @@ public:
      * @param innerContext2  the second context created by the ATMForce for computing displaced energy
      */
     void copyState(ContextImpl& context, ContextImpl& innerContext0, ContextImpl& innerContext1);
+    /**
+     * Compute the energies of the two inner contexts, and optionally their forces.
+     *
+     * @param innerContext0  the first context created by the ATMForce for computing displaced energy
+     * @param innerContext1  the second context created by the ATMForce for computing displaced energy
+     * @param includeForces  true if forces should be computed
+     * @param energy0        on exit, the potential energy of the first inner context
+     * @param energy1        on exit, the potential energy of the second inner context
+     */
+    void calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+                                    double& energy0, double& energy1);
 private:
     int numParticles;
     std::vector<Vec3> displ1;
@@ -1751,38 +1930,10 @@ class ReferenceCalcCustomCPPForceKernel : public CalcCustomCPPForceKernel {
 public:
     ReferenceCalcCustomCPPForceKernel(std::string name, const Platform& platform) : CalcCustomCPPForceKernel(name, platform), force(NULL) {
     }
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
     /**
      * Initialize the kernel.
      *
      * @param system     the System this kernel will be applied to
-<<<<<<< HEAD
-     * @param integrator the DampedReconstructionIntegrator this kernel will be used for
-     */
-    void initialize(const System& system, const DampedReconstructionIntegrator& integrator);
-    /**
-     * Execute the kernel.
-     *
-     * @param context    the context in which to execute this kernel
-     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
-     */
-    void execute(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
-    /**
-     * Compute the kinetic energy.
-     *
-     * @param context    the context in which to execute this kernel
-     * @param integrator the DampedReconstructionIntegrator this kernel is being used for
-     */
-    double computeKineticEnergy(ContextImpl& context, const DampedReconstructionIntegrator& integrator);
-private:
-    ReferencePlatform::PlatformData& data;
-    ReferenceDampedReconstructionDynamics* dynamics;
-    std::vector<double> masses;
-    double prevTemp, prevStepSize;
-};
-
-
-=======
      * @param force      the CustomCPPForceImpl this kernel will be used for
      */
     void initialize(const System& system, CustomCPPForceImpl& force);
@@ -1800,7 +1951,6 @@ private:
     std::vector<Vec3> forces;
 };
 
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
 } // namespace OpenMM
 
 #endif /*OPENMM_REFERENCEKERNELS_H_*/
@@ -46,6 +46,7 @@ class ReferenceLJCoulombIxn {
       double alphaEwald, alphaDispersionEwald;
       int numRx, numRy, numRz;
       int meshDim[3], dispersionMeshDim[3];
+      int pmeOrder;
 
       // parameter indices
 
@@ -158,6 +159,16 @@ class ReferenceLJCoulombIxn {
          --------------------------------------------------------------------------------------- */
 
       void setUseLJPME(double dalpha, int dmeshSize[3]);
+
+      /**---------------------------------------------------------------------------------------
+
+         Set the B-spline interpolation order to use for PME and LJPME.
+
+         @param order    the interpolation order
+
+         --------------------------------------------------------------------------------------- */
+
+      void setPMEInterpolationOrder(int order);
       
       /**---------------------------------------------------------------------------------------
 
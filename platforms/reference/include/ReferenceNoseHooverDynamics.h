@@ -35,12 +35,41 @@ class ContextImpl;
 
 class ReferenceNoseHooverDynamics : public ReferenceDynamics {
 
-   private:
+   protected:
       std::vector<OpenMM::Vec3> xPrime;
       std::vector<OpenMM::Vec3> oldx;
       std::vector<double> inverseMasses;
       int numberOfAtoms;
 
+      /**---------------------------------------------------------------------------------------
+      
+         Update the center of mass and relative velocities of each Drude-like pair based on the forces.
+      
+         @param velocities          velocities
+         @param forces              forces
+         @param masses              atom masses
+         @param allPairs            a list of all Drude-like pairs, and their KT values, in the system
+      
+         --------------------------------------------------------------------------------------- */
+
+      void updatePairVelocities(std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses,
+                                const std::vector<std::tuple<int, int, double>> & allPairs);
+
+      /**---------------------------------------------------------------------------------------
+      
+         Make any Drude-like pair whose separation exceeds maxPairDistance bounce off the hard wall.
+      
+         @param atomCoordinates     atom coordinates
+         @param velocities          velocities
+         @param masses              atom masses
+         @param allPairs            a list of all Drude-like pairs, and their KT values, in the system
+         @param maxPairDistance     the maximum separation allowed for a Drude-like pair
+      
+         --------------------------------------------------------------------------------------- */
+
+      void applyHardWallConstraints(std::vector<OpenMM::Vec3>& atomCoordinates, std::vector<OpenMM::Vec3>& velocities, std::vector<double>& masses,
+                                    const std::vector<std::tuple<int, int, double>> & allPairs, double maxPairDistance);
+
    public:
 
       /**---------------------------------------------------------------------------------------
@@ -80,7 +109,7 @@ class ReferenceNoseHooverDynamics : public ReferenceDynamics {
       
          --------------------------------------------------------------------------------------- */
      
-      void step1(OpenMM::ContextImpl &context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
+      virtual void step1(OpenMM::ContextImpl &context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
                  std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance,
                  const std::vector<int> & allAtoms, const std::vector<std::tuple<int, int, double>> & allPairs, double maxPairDistance);
       /**---------------------------------------------------------------------------------------
@@ -98,14 +127,9 @@ class ReferenceNoseHooverDynamics : public ReferenceDynamics {
          @param maxPairDistance     the maximum separation allowed for a Drude-like pair
       
          --------------------------------------------------------------------------------------- */
-      void step2(OpenMM::ContextImpl &context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
-<<<<<<< HEAD
-                 std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance, bool &forcesAreValid,
-                 const std::vector<int> & allAtoms, const std::vector<std::tuple<int, int, double> > & allPairs, double maxPairDistance);
-=======
+      virtual void step2(OpenMM::ContextImpl &context, const OpenMM::System& system, std::vector<OpenMM::Vec3>& atomCoordinates,
                  std::vector<OpenMM::Vec3>& velocities, std::vector<OpenMM::Vec3>& forces, std::vector<double>& masses, double tolerance,
                  const std::vector<int> & allAtoms, const std::vector<std::tuple<int, int, double>> & allPairs, double maxPairDistance);
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
       
 };
 
@@ -15,7 +15,7 @@ namespace OpenMM {
 
 class ReferenceRandomWalkDynamics : public ReferenceDynamics {
 
-   private:
+   protected:
 
       std::vector<OpenMM::Vec3> xPrime;
     double _period;
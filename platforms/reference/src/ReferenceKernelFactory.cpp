@@ -112,6 +112,8 @@ KernelImpl* ReferenceKernelFactory::createKernelImpl(std::string name, const Pla
         return new ReferenceRemoveCMMotionKernel(name, platform, data);
     if (name == IntegrateRandomWalkStepKernel::Name())
         return new ReferenceIntegrateRandomWalkStepKernel(name, platform, data);
+    if (name == IntegrateRandomWalkEnsembleStepKernel::Name())
+        return new ReferenceIntegrateRandomWalkEnsembleStepKernel(name, platform, data);
     if (name == IntegrateIndirectReconstructionStepKernel::Name())
         return new ReferenceIntegrateIndirectReconstructionStepKernel(name, platform, data);
     if (name == IntegrateDampedReconstructionStepKernel::Name())
@@ -63,11 +63,7 @@
 #include "ReferenceProperDihedralBond.h"
 #include "ReferenceRbDihedralBond.h"
 #include "ReferenceRMSDForce.h"
-<<<<<<< HEAD
 #include "ReferenceRandomWalkDynamics.h"
-#include "ReferenceStochasticDynamics.h"
-=======
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
 #include "ReferenceTabulatedFunction.h"
 #include "ReferenceVariableStochasticDynamics.h"
 #include "ReferenceVariableVerletDynamics.h"
@@ -90,6 +86,7 @@
 #include "lepton/Operation.h"
 #include "lepton/Parser.h"
 #include "lepton/ParsedExpression.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -336,6 +333,34 @@ void ReferenceUpdateStateDataKernel::loadCheckpoint(ContextImpl& context, istrea
     SimTKOpenMMUtilities::loadCheckpoint(stream);
 }
 
+void ReferenceUpdateStateDataKernel::saveSnapshot(ContextImpl& context, double energy) {
+    // Assigning to the existing vectors reuses their storage, so no memory is allocated after the first call.
+
+    snapshotPositions = extractPositions(context);
+    snapshotVelocities = extractVelocities(context);
+    snapshotForces = extractForces(context);
+    getPeriodicBoxVectors(context, snapshotBoxVectors[0], snapshotBoxVectors[1], snapshotBoxVectors[2]);
+    snapshotTime = data.time;
+    snapshotEnergy = energy;
+    hasSnapshot = true;
+}
+
+double ReferenceUpdateStateDataKernel::restoreSnapshot(ContextImpl& context) {
+    if (!hasSnapshot)
+        throw OpenMMException("restoreSnapshot() was called without a saved snapshot");
+
+    // Exchange the buffers instead of copying them.  The snapshot now holds the discarded state,
+    // so it has been consumed.
+
+    extractPositions(context).swap(snapshotPositions);
+    extractVelocities(context).swap(snapshotVelocities);
+    extractForces(context).swap(snapshotForces);
+    setPeriodicBoxVectors(context, snapshotBoxVectors[0], snapshotBoxVectors[1], snapshotBoxVectors[2]);
+    data.time = snapshotTime;
+    hasSnapshot = false;
+    return snapshotEnergy;
+}
+
 void ReferenceApplyConstraintsKernel::initialize(const System& system) {
     int numParticles = system.getNumParticles();
     masses.resize(numParticles);
@@ -963,6 +988,7 @@ void ReferenceCalcNonbondedForceKernel::initialize(const System& system, const N
         useSwitchingFunction = force.getUseSwitchingFunction();
         switchingDistance = force.getSwitchingDistance();
     }
+    pmeOrder = force.getPMEInterpolationOrder();
     if (nonbondedMethod == Ewald) {
         double alpha;
         NonbondedForceImpl::calcEwaldParameters(system, force, alpha, kmax[0], kmax[1], kmax[2]);
@@ -1016,6 +1042,7 @@ double ReferenceCalcNonbondedForceKernel::execute(ContextImpl& context, bool inc
     }
     if (ewald)
         clj.setUseEwald(ewaldAlpha, kmax[0], kmax[1], kmax[2]);
+    clj.setPMEInterpolationOrder(pmeOrder);
     if (pme)
         clj.setUsePME(ewaldAlpha, gridSize);
     if (ljpme){
@@ -2239,7 +2266,9 @@ void ReferenceCalcCustomCVForceKernel::initialize(const System& system, const Cu
 }
 
 double ReferenceCalcCustomCVForceKernel::execute(ContextImpl& context, ContextImpl& innerContext, bool includeForces, bool includeEnergy) {
-    copyState(context, innerContext);
+    // Forces never depend on velocities, so there is no need to copy them every step.
+
+    copyCoordinatesAndParameters(context, innerContext);
     vector<Vec3>& posData = extractPositions(context);
     vector<Vec3>& forceData = extractForces(context);
     double energy = 0;
@@ -2247,20 +2276,26 @@ double ReferenceCalcCustomCVForceKernel::execute(ContextImpl& context, ContextIm
     for (auto& name : globalParameterNames)
         globalParameters[name] = context.getParameter(name);
     map<string, double>& energyParamDerivs = extractEnergyParameterDerivatives(context);
-    ixn->calculateIxn(innerContext, posData, globalParameters, forceData, includeEnergy ? &energy : NULL, energyParamDerivs);
+    ixn->calculateIxn(innerContext, posData, globalParameters, includeForces ? &forceData : NULL, includeEnergy ? &energy : NULL, energyParamDerivs);
     return energy;
 }
 
 void ReferenceCalcCustomCVForceKernel::copyState(ContextImpl& context, ContextImpl& innerContext) {
-    extractPositions(innerContext) = extractPositions(context);
     extractVelocities(innerContext) = extractVelocities(context);
+    copyCoordinatesAndParameters(context, innerContext);
+}
+
+void ReferenceCalcCustomCVForceKernel::copyCoordinatesAndParameters(ContextImpl& context, ContextImpl& innerContext) {
+    extractPositions(innerContext) = extractPositions(context);
     Vec3 a, b, c;
     context.getPeriodicBoxVectors(a, b, c);
     innerContext.setPeriodicBoxVectors(a, b, c);
     innerContext.setTime(context.getTime());
-    map<string, double> innerParameters = innerContext.getParameters();
-    for (auto& param : innerParameters)
-        innerContext.setParameter(param.first, context.getParameter(param.first));
+    for (auto& param : innerContext.getParameters()) {
+        double value = context.getParameter(param.first);
+        if (value != param.second)
+            innerContext.setParameter(param.first, value);
+    }
 }
 
 void ReferenceCalcCustomCVForceKernel::copyParametersToContext(ContextImpl& context, const CustomCVForce& force) {
@@ -2364,7 +2399,7 @@ void ReferenceIntegrateNoseHooverStepKernel::execute(ContextImpl& context, const
         // Recreate the computation objects with the new parameters.
         if (dynamics)
             delete dynamics;
-        dynamics = new ReferenceNoseHooverDynamics(context.getSystem().getNumParticles(), stepSize);
+        dynamics = createDynamics(context, stepSize);
         dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
         dynamics->setVirtualSites(extractVirtualSites(context));
         prevStepSize = stepSize;
@@ -2384,6 +2419,10 @@ void ReferenceIntegrateNoseHooverStepKernel::execute(ContextImpl& context, const
     data.stepCount++;
 }
 
+ReferenceNoseHooverDynamics* ReferenceIntegrateNoseHooverStepKernel::createDynamics(ContextImpl& context, double stepSize) {
+    return new ReferenceNoseHooverDynamics(context.getSystem().getNumParticles(), stepSize);
+}
+
 double ReferenceIntegrateNoseHooverStepKernel::computeKineticEnergy(ContextImpl& context, const NoseHooverIntegrator& integrator) {
     return computeShiftedKineticEnergy(context, masses, 0);
 }
@@ -2797,10 +2836,14 @@ void ReferenceIntegrateCustomStepKernel::initialize(const System& system, const
 
     // Create the computation objects.
 
-    dynamics = new ReferenceCustomDynamics(system.getNumParticles(), integrator);
+    dynamics = createDynamics(system, integrator);
     SimTKOpenMMUtilities::setRandomNumberSeed((unsigned int) integrator.getRandomNumberSeed());
 }
 
+ReferenceCustomDynamics* ReferenceIntegrateCustomStepKernel::createDynamics(const System& system, const CustomIntegrator& integrator) {
+    return new ReferenceCustomDynamics(system.getNumParticles(), integrator);
+}
+
 void ReferenceIntegrateCustomStepKernel::execute(ContextImpl& context, CustomIntegrator& integrator, bool& forcesAreValid) {
     vector<Vec3>& posData = extractPositions(context);
     vector<Vec3>& velData = extractVelocities(context);
@@ -2960,7 +3003,6 @@ void ReferenceRemoveCMMotionKernel::execute(ContextImpl& context) {
     }
 }
 
-<<<<<<< HEAD
 ReferenceIntegrateRandomWalkStepKernel::~ReferenceIntegrateRandomWalkStepKernel() {
     if (dynamics)
         delete dynamics;
@@ -2992,6 +3034,7 @@ void ReferenceIntegrateRandomWalkStepKernel::execute(ContextImpl& context, const
                 temperature,
                 _period);
         dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
         prevTemp = temperature;
         prevStepSize = stepSize;
     }
@@ -3004,6 +3047,123 @@ double ReferenceIntegrateRandomWalkStepKernel::computeKineticEnergy(ContextImpl&
 	return computeShiftedKineticEnergy(context, masses, 0);;
 }
 
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::initialize(const System& system, const RandomWalkEnsembleIntegrator& integrator) {
+    numChains = integrator.getNumChains();
+    numParticles = system.getNumParticles();
+    masses.resize(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        masses[i] = system.getParticleMass(i);
+    int size = numChains*numParticles;
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+    proposedX.resize(size);
+    proposedY.resize(size);
+    proposedZ.resize(size);
+    chainEnergy.resize(numChains, 0.0);
+    numAccepted.resize(numChains, 0);
+    chainIsSet.resize(numChains, 0);
+    numProposed = 0;
+    SimTKOpenMMUtilities::setRandomNumberSeed((unsigned int) integrator.getRandomNumberSeed());
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::setChainPositions(ContextImpl& context, int chain, const vector<Vec3>& positions) {
+    int offset = chain*numParticles;
+    for (int i = 0; i < numParticles; i++) {
+        x[offset+i] = positions[i][0];
+        y[offset+i] = positions[i][1];
+        z[offset+i] = positions[i][2];
+    }
+    chainIsSet[chain] = 1;
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::getChainPositions(ContextImpl& context, int chain, vector<Vec3>& positions) {
+    int offset = chain*numParticles;
+    positions.resize(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        positions[i] = Vec3(x[offset+i], y[offset+i], z[offset+i]);
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::initializeChains(ContextImpl& context) {
+    vector<Vec3>& posData = extractPositions(context);
+    for (int chain = 0; chain < numChains; chain++)
+        if (!chainIsSet[chain])
+            setChainPositions(context, chain, posData);
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::loadChain(ContextImpl& context, int chain, bool proposal) {
+    vector<Vec3>& posData = extractPositions(context);
+    const double* chainX = (proposal ? &proposedX[0] : &x[0]) + chain*numParticles;
+    const double* chainY = (proposal ? &proposedY[0] : &y[0]) + chain*numParticles;
+    const double* chainZ = (proposal ? &proposedZ[0] : &z[0]) + chain*numParticles;
+    for (int i = 0; i < numParticles; i++)
+        posData[i] = Vec3(chainX[i], chainY[i], chainZ[i]);
+    extractVirtualSites(context).computePositions(context.getSystem(), posData);
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::propose(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator) {
+    const double noiseAmplitude = sqrt(2.0*BOLTZ*integrator.getTemperature()*integrator.getStepSize());
+    const double period = integrator.getPeriod();
+    double* current[] = {&x[0], &y[0], &z[0]};
+    double* proposed[] = {&proposedX[0], &proposedY[0], &proposedZ[0]};
+    for (int chain = 0; chain < numChains; chain++) {
+        int offset = chain*numParticles;
+        for (int i = 0; i < numParticles; i++)
+            for (int j = 0; j < 3; j++) {
+                double value = current[j][offset+i];
+                if (masses[i] != 0.0) {
+                    value += noiseAmplitude*SimTKOpenMMUtilities::getNormallyDistributedRandomNumber();
+                    if (period > 0.0)
+                        value -= round(value/(2.0*period))*2.0*period;
+                }
+                proposed[j][offset+i] = value;
+            }
+    }
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::setChainEnergies(const vector<double>& energies) {
+    chainEnergy = energies;
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::acceptOrReject(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator, const vector<double>& energies) {
+    const double kT = BOLTZ*integrator.getTemperature();
+    for (int chain = 0; chain < numChains; chain++) {
+        double deltaEnergy = energies[chain]-chainEnergy[chain];
+        if (deltaEnergy <= 0.0 || SimTKOpenMMUtilities::getUniformlyDistributedRandomNumber() < exp(-deltaEnergy/kT)) {
+            int offset = chain*numParticles;
+            copy(proposedX.begin()+offset, proposedX.begin()+offset+numParticles, x.begin()+offset);
+            copy(proposedY.begin()+offset, proposedY.begin()+offset+numParticles, y.begin()+offset);
+            copy(proposedZ.begin()+offset, proposedZ.begin()+offset+numParticles, z.begin()+offset);
+            chainEnergy[chain] = energies[chain];
+            numAccepted[chain]++;
+        }
+    }
+    numProposed++;
+    data.time += integrator.getStepSize();
+    data.stepCount++;
+}
+
+double ReferenceIntegrateRandomWalkEnsembleStepKernel::getChainEnergy(int chain) {
+    return chainEnergy[chain];
+}
+
+long long ReferenceIntegrateRandomWalkEnsembleStepKernel::getNumProposed() {
+    return numProposed;
+}
+
+long long ReferenceIntegrateRandomWalkEnsembleStepKernel::getNumAccepted(int chain) {
+    return numAccepted[chain];
+}
+
+void ReferenceIntegrateRandomWalkEnsembleStepKernel::resetStatistics() {
+    numProposed = 0;
+    fill(numAccepted.begin(), numAccepted.end(), 0);
+}
+
+double ReferenceIntegrateRandomWalkEnsembleStepKernel::computeKineticEnergy(ContextImpl& context, const RandomWalkEnsembleIntegrator& integrator) {
+    return computeShiftedKineticEnergy(context, masses, 0);
+}
+
 ReferenceIntegrateIndirectReconstructionStepKernel::~ReferenceIntegrateIndirectReconstructionStepKernel() {
     if (dynamics)
         delete dynamics;
@@ -3036,6 +3196,7 @@ void ReferenceIntegrateIndirectReconstructionStepKernel::execute(ContextImpl& co
 				reactionCoordinate,
 			    lambda);
         dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
         prevTemp = temperature;
         prevStepSize = stepSize;
     }
@@ -3082,6 +3243,7 @@ void ReferenceIntegrateDampedReconstructionStepKernel::execute(ContextImpl& cont
                 lambda,
                 gamma);
         dynamics->setReferenceConstraintAlgorithm(&extractConstraints(context));
+        dynamics->setVirtualSites(extractVirtualSites(context));
         prevTemp = temperature;
         prevStepSize = stepSize;
     }
@@ -3095,7 +3257,6 @@ double ReferenceIntegrateDampedReconstructionStepKernel::computeKineticEnergy(Co
     return computeShiftedKineticEnergy(context, masses, 0);;
 }
 
-=======
 void ReferenceCalcATMForceKernel::initialize(const System& system, const ATMForce& force) {
     numParticles = force.getNumParticles();
 
@@ -3167,6 +3328,12 @@ void ReferenceCalcATMForceKernel::copyState(ContextImpl& context, ContextImpl& i
 
 }
 
+void ReferenceCalcATMForceKernel::calcInnerForcesAndEnergies(ContextImpl& innerContext0, ContextImpl& innerContext1, bool includeForces,
+        double& energy0, double& energy1) {
+    energy0 = innerContext0.calcForcesAndEnergy(includeForces, true);
+    energy1 = innerContext1.calcForcesAndEnergy(includeForces, true);
+}
+
 void ReferenceCalcATMForceKernel::copyParametersToContext(ContextImpl& context, const ATMForce& force) {
     if (force.getNumParticles() != numParticles)
           throw OpenMMException("copyParametersToContext: The number of ATMForce particles has changed");
@@ -3194,4 +3361,4 @@ double ReferenceCalcCustomCPPForceKernel::execute(ContextImpl& context, bool inc
             forceData[i] += forces[i];
     return energy;
 }
->>>>>>> 2f0ec953199bbb39205202882d27e3f47d7ac198
+
@@ -74,6 +74,7 @@ ReferencePlatform::ReferencePlatform() {
     registerKernelFactory(IntegrateIndirectReconstructionStepKernel::Name(), factory);
     registerKernelFactory(IntegrateDampedReconstructionStepKernel::Name(), factory);
     registerKernelFactory(IntegrateRandomWalkStepKernel::Name(), factory);
+    registerKernelFactory(IntegrateRandomWalkEnsembleStepKernel::Name(), factory);
     registerKernelFactory(IntegrateVariableLangevinStepKernel::Name(), factory);
     registerKernelFactory(IntegrateVariableVerletStepKernel::Name(), factory);
     registerKernelFactory(IntegrateCustomStepKernel::Name(), factory);
@@ -124,44 +124,78 @@ ReferenceCustomCVForce::~ReferenceCustomCVForce() {
 }
 
 void ReferenceCustomCVForce::calculateIxn(ContextImpl& innerContext, vector<Vec3>& atomCoordinates,
-                                          const map<string, double>& globalParameters, vector<Vec3>& forces,
+                                          const map<string, double>& globalParameters, vector<Vec3>* forces,
                                           double* totalEnergy, map<string, double>& energyParamDerivs) {
     // Compute the collective variables, and their derivatives with respect to particle positions.
+    // The inner forces are only needed if we are computing forces or parameter derivatives.
+    // Each collective variable gets its own force and parameter derivative buffers, which are
+    // kept between calls.  While a variable is being evaluated, the inner context writes
+    // directly into its buffers, so they never need to be copied.
     
     int numCVs = variableNames.size();
+    int numParticles = atomCoordinates.size();
+    bool includeForces = (forces != NULL);
+    bool includeParamDerivs = (paramDerivExpressions.size() > 0);
     ReferencePlatform::PlatformData* data = reinterpret_cast<ReferencePlatform::PlatformData*>(innerContext.getPlatformData());
-    vector<Vec3>& innerForces = *((vector<Vec3>*) data->forces);
-    map<string, double>& innerDerivs = *((map<string, double>*) data->energyParameterDerivatives);
-    vector<vector<Vec3> > cvForces;
-    vector<map<string, double> > cvDerivs;
-    for (int i = 0; i < numCVs; i++) {
-        cvValues[i] = innerContext.calcForcesAndEnergy(true, true, 1<<i);
-        cvForces.push_back(innerForces);
-        cvDerivs.push_back(innerDerivs);
+    vector<Vec3>* innerForces = data->forces;
+    map<string, double>* innerDerivs = data->energyParameterDerivatives;
+    cvForces.resize(numCVs, vector<Vec3>(numParticles));
+    cvParamDerivs.resize(numCVs, *innerDerivs);
+    try {
+        for (int i = 0; i < numCVs; i++) {
+            data->forces = &cvForces[i];
+            data->energyParameterDerivatives = &cvParamDerivs[i];
+            cvValues[i] = innerContext.calcForcesAndEnergy(includeForces || includeParamDerivs, true, 1<<i);
+        }
     }
+    catch (...) {
+        data->forces = innerForces;
+        data->energyParameterDerivatives = innerDerivs;
+        throw;
+    }
+    data->forces = innerForces;
+    data->energyParameterDerivatives = innerDerivs;
     
-    // Compute the energy and forces.
+    // Compute the energy and the derivatives with respect to the collective variables.
     
     for (int i = 0; i < globalParameterNames.size(); i++)
         globalValues[i] = globalParameters.at(globalParameterNames[i]);
-    int numParticles = atomCoordinates.size();
     if (totalEnergy != NULL)
         *totalEnergy += energyExpression.evaluate();
-    for (int i = 0; i < numCVs; i++) {
-        double dEdV = variableDerivExpressions[i].evaluate();
-        for (int j = 0; j < numParticles; j++)
-            forces[j] += cvForces[i][j]*dEdV;
+    cvDerivatives.resize(numCVs);
+    if (includeForces || includeParamDerivs)
+        for (int i = 0; i < numCVs; i++)
+            cvDerivatives[i] = variableDerivExpressions[i].evaluate();
+    
+    // Apply the chain rule to compute the forces, combining all collective variables in a
+    // single pass over the particles.
+    
+    if (includeForces) {
+        vector<const Vec3*> activeForces;
+        vector<double> activeDerivatives;
+        for (int i = 0; i < numCVs; i++)
+            if (cvDerivatives[i] != 0.0) {
+                activeForces.push_back(&cvForces[i][0]);
+                activeDerivatives.push_back(cvDerivatives[i]);
+            }
+        int numActive = activeForces.size();
+        if (numActive > 0) {
+            for (int j = 0; j < numParticles; j++) {
+                Vec3 f = (*forces)[j];
+                for (int i = 0; i < numActive; i++)
+                    f += activeForces[i][j]*activeDerivatives[i];
+                (*forces)[j] = f;
+            }
+        }
     }
     
     // Compute the energy parameter derivatives.
     
-    if (paramDerivExpressions.size() > 0) {
+    if (includeParamDerivs) {
         for (int i = 0; i < paramDerivExpressions.size(); i++)
             energyParamDerivs[paramDerivNames[i]] += paramDerivExpressions[i].evaluate();
-        for (int i = 0; i < numCVs; i++) {
-            double dEdV = variableDerivExpressions[i].evaluate();
-            for (auto& deriv : cvDerivs[i])
-                energyParamDerivs[deriv.first] += dEdV*deriv.second;
-        }
+        for (int i = 0; i < numCVs; i++)
+            for (auto& deriv : cvParamDerivs[i])
+                energyParamDerivs[deriv.first] += cvDerivatives[i]*deriv.second;
     }
 }
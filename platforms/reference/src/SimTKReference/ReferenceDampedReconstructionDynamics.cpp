@@ -73,18 +73,13 @@ void ReferenceDampedReconstructionDynamics::update(const OpenMM::System& system,
     double beta = sqrt(2.0*BOLTZ*getTemperature());
    const double noiseAmplitude = beta*sqrt(getDeltaT());
 
-   std::vector<Vec3> rcValue = reactionCoordinate->value(atomCoordinates);
-   for (int i = 0; i < macroVariable.size(); ++i) {
-	   rcValue[i][0] -= macroVariable[i][0];
-	   rcValue[i][1] -= macroVariable[i][1];
-	   rcValue[i][2] -= macroVariable[i][2];
-   }
-   std::vector<Vec3> rcGrad = reactionCoordinate->gradMatMul(atomCoordinates, rcValue);
+   reactionCoordinate->computeResidual(atomCoordinates, macroVariable, residual);
+   reactionCoordinate->computeGradMatMul(atomCoordinates, residual, bias);
 
    for (int i = 0; i < numberOfAtoms; ++i) {
        if (masses[i] != 0.0)
            for (int j = 0; j < 3; ++j) {
-               xPrime[i][j] = atomCoordinates[i][j] + getGamma()*getDeltaT()*forces[i][j] - (1.0 - getGamma())*getDeltaT()*getLambda()*rcGrad[i][j] + noiseAmplitude*SimTKOpenMMUtilities::getNormallyDistributedRandomNumber();
+               xPrime[i][j] = atomCoordinates[i][j] + getGamma()*getDeltaT()*forces[i][j] - (1.0 - getGamma())*getDeltaT()*getLambda()*bias[i][j] + noiseAmplitude*SimTKOpenMMUtilities::getNormallyDistributedRandomNumber();
            }
    }
 
@@ -97,7 +92,7 @@ void ReferenceDampedReconstructionDynamics::update(const OpenMM::System& system,
                atomCoordinates[i][j] = xPrime[i][j];
            }
    }
-   ReferenceVirtualSites::computePositions(system, atomCoordinates);
+   getVirtualSites().computePositions(system, atomCoordinates);
    incrementTimeStep();
 }
 
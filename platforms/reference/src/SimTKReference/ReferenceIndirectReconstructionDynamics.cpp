@@ -72,18 +72,13 @@ void ReferenceIndirectReconstructionDynamics::update(const OpenMM::System& syste
     double beta = sqrt(2.0*BOLTZ*getTemperature());
    const double noiseAmplitude = beta*sqrt(getDeltaT());
 
-   std::vector<Vec3> rcValue = reactionCoordinate->value(atomCoordinates);
-   for (int i = 0; i < macroVariable.size(); ++i) {
-	   rcValue[i][0] -= macroVariable[i][0];
-	   rcValue[i][1] -= macroVariable[i][1];
-	   rcValue[i][2] -= macroVariable[i][2];
-   }
-   std::vector<Vec3> rcGrad = reactionCoordinate->gradMatMul(atomCoordinates, rcValue);
+   reactionCoordinate->computeResidual(atomCoordinates, macroVariable, residual);
+   reactionCoordinate->computeGradMatMul(atomCoordinates, residual, bias);
 
    for (int i = 0; i < numberOfAtoms; ++i) {
        if (masses[i] != 0.0)
            for (int j = 0; j < 3; ++j) {
-               xPrime[i][j] = atomCoordinates[i][j] + getDeltaT()*forces[i][j] - getDeltaT()*getLambda()*rcGrad[i][j] + noiseAmplitude*SimTKOpenMMUtilities::getNormallyDistributedRandomNumber();
+               xPrime[i][j] = atomCoordinates[i][j] + getDeltaT()*forces[i][j] - getDeltaT()*getLambda()*bias[i][j] + noiseAmplitude*SimTKOpenMMUtilities::getNormallyDistributedRandomNumber();
            }
    }
 
@@ -96,7 +91,7 @@ void ReferenceIndirectReconstructionDynamics::update(const OpenMM::System& syste
                atomCoordinates[i][j] = xPrime[i][j];
            }
    }
-   ReferenceVirtualSites::computePositions(system, atomCoordinates);
+   getVirtualSites().computePositions(system, atomCoordinates);
    incrementTimeStep();
 }
 
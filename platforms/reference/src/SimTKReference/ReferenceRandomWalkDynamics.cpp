@@ -70,10 +70,6 @@ void ReferenceRandomWalkDynamics::update(const OpenMM::System& system, vector<Ve
                    double numb = round(xPrime[i][j]/(2.0*_period));
                    xPrime[i][j] = xPrime[i][j] - numb*2.0*_period;
                }
-               
-               if ( i ==0 && (xPrime[i][j] < -_period || xPrime[i][j] > _period)) {
-                   std::cout << "Sampling error: " << atomCoordinates[i][j] << " " << xPrime[i][j] << std::endl;
-               }
            }
        }
    }
@@ -88,7 +84,7 @@ void ReferenceRandomWalkDynamics::update(const OpenMM::System& system, vector<Ve
                atomCoordinates[i][j] = xPrime[i][j];
            }
    }
-   ReferenceVirtualSites::computePositions(system, atomCoordinates);
+   getVirtualSites().computePositions(system, atomCoordinates);
    incrementTimeStep();
 }
 
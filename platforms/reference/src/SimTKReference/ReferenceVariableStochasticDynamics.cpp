@@ -187,16 +187,21 @@ void ReferenceVariableStochasticDynamics::update(const OpenMM::System& system, v
     if (referenceConstraintAlgorithm)
         referenceConstraintAlgorithm->apply(atomCoordinates, xPrime, inverseMasses, tolerance);
 
-    // copy xPrime -> atomCoordinates
+    // 3rd update
 
+    updatePart3(numberOfAtoms, atomCoordinates, velocities, inverseMasses, xPrime);
+    getVirtualSites().computePositions(system, atomCoordinates);
+    incrementTimeStep();
+}
+
+void ReferenceVariableStochasticDynamics::updatePart3(int numberOfAtoms, vector<Vec3>& atomCoordinates,
+                                         vector<Vec3>& velocities, vector<double>& inverseMasses,
+                                         vector<Vec3>& xPrime) {
     double invStepSize = 1.0/getDeltaT();
     for (int i = 0; i < numberOfAtoms; i++) {
-        if (masses[i] != 0.0) {
+        if (inverseMasses[i] != 0.0) {
             velocities[i] += (xPrime[i]-oldx[i])*invStepSize;
             atomCoordinates[i] = xPrime[i];
         }
     }
-
-    getVirtualSites().computePositions(system, atomCoordinates);
-    incrementTimeStep();
 }
@@ -44,6 +44,7 @@
 #include "pocketfft_hdronly.h"
 #include <cmath>
 #include <algorithm>
+#include <climits>
 #include <cstring>
 #include <sstream>
 #include <cstdlib>
@@ -51,24 +52,120 @@
 using namespace OpenMM;
 using namespace std;
 
-static const int PME_ORDER = 5;
-
 bool CpuCalcDispersionPmeReciprocalForceKernel::hasInitializedThreads = false;
 int CpuCalcDispersionPmeReciprocalForceKernel::numThreads = 0;
 
+/**
+ * This holds values needed for spreading charges that depend only on the box and grid size.
+ */
+struct SpreadingParams {
+    SpreadingParams(int gridx, int gridy, int gridz, const Vec3* periodicBoxVectors, const Vec3* recipBoxVectors) :
+            gridx(gridx), gridy(gridy), gridz(gridz),
+            boxSize((float) periodicBoxVectors[0][0], (float) periodicBoxVectors[1][1], (float) periodicBoxVectors[2][2], 0),
+            invBoxSize((float) recipBoxVectors[0][0], (float) recipBoxVectors[1][1], (float) recipBoxVectors[2][2], 0),
+            recipBoxVec0((float) recipBoxVectors[0][0], (float) recipBoxVectors[0][1], (float) recipBoxVectors[0][2], 0),
+            recipBoxVec1((float) recipBoxVectors[1][0], (float) recipBoxVectors[1][1], (float) recipBoxVectors[1][2], 0),
+            recipBoxVec2((float) recipBoxVectors[2][0], (float) recipBoxVectors[2][1], (float) recipBoxVectors[2][2], 0),
+            gridSize(gridx, gridy, gridz, 0), gridSizeInt(gridx, gridy, gridz, 0) {
+    }
+    int gridx, gridy, gridz;
+    fvec4 boxSize, invBoxSize, recipBoxVec0, recipBoxVec1, recipBoxVec2, gridSize;
+    ivec4 gridSizeInt;
+};
+
+/**
+ * Find the grid point a particle is associated with.  On return, dr contains its offset from that point.
+ */
+static inline ivec4 findGridIndex(const float* position, const SpreadingParams& params, fvec4& dr) {
+    float posInBox[4] = {0,0,0,0};
+    fvec4 pos(position);
+    (pos-params.boxSize*floor(pos*params.invBoxSize)).store(posInBox);
+    fvec4 t = posInBox[0]*params.recipBoxVec0 + posInBox[1]*params.recipBoxVec1 + posInBox[2]*params.recipBoxVec2;
+    t = (t-floor(t))*params.gridSize;
+    ivec4 ti = t;
+    dr = t-ti;
+    return ti-(params.gridSizeInt&ti==params.gridSizeInt);
+}
+
+/**
+ * Spread the charge of one particle onto a grid.  The grid may contain only a subset of the planes along the
+ * x axis, starting from firstPlane.  Indices along x wrap around at xwrap.
+ */
+template <int ORDER>
+static inline void spreadParticle(const float* posq, int i, float* grid, const SpreadingParams& params, int firstPlane, int xwrap, float epsilonFactor) {
+    const int gridy = params.gridy, gridz = params.gridz;
+    const fvec4 one(1);
+    const fvec4 scale(1.0f/(ORDER-1));
+
+    // Find the position relative to the nearest grid point.
+
+    fvec4 dr;
+    ivec4 gridIndex = findGridIndex(&posq[4*i], params, dr);
+
+    // Compute the B-spline coefficients.
+
+    fvec4 data[ORDER];
+    data[ORDER-1] = 0.0f;
+    data[1] = dr;
+    data[0] = one-dr;
+    for (int j = 3; j < ORDER; j++) {
+        fvec4 div(1.0f/(j-1));
+        data[j-1] = div*dr*data[j-2];
+        for (int k = 1; k < j-1; k++)
+            data[j-k-1] = div*((dr+k)*data[j-k-2]+(fvec4(j-k)-dr)*data[j-k-1]);
+        data[0] = div*(one-dr)*data[0];
+    }
+    data[ORDER-1] = scale*dr*data[ORDER-2];
+    for (int j = 1; j < (ORDER-1); j++)
+        data[ORDER-j-1] = scale*((dr+j)*data[ORDER-j-2]+(fvec4(ORDER-j)-dr)*data[ORDER-j-1]);
+    data[0] = scale*(one-dr)*data[0];
+
+    // Spread the charges.
+
+    int gridIndexX = gridIndex[0]-firstPlane;
+    int gridIndexY = gridIndex[1];
+    int gridIndexZ = gridIndex[2];
+    if (gridIndex[0] < 0)
+        return; // This happens when a simulation blows up and coordinates become NaN.
+    int zindex[ORDER];
+    float zdata[ORDER];
+    for (int j = 0; j < ORDER; j++) {
+        zindex[j] = gridIndexZ+j;
+        zindex[j] -= (zindex[j] >= gridz ? gridz : 0);
+        zdata[j] = data[j][2];
+    }
+    float charge = epsilonFactor*posq[4*i+3];
+    bool contiguous = (gridIndexZ+ORDER-1 < gridz);
+    for (int ix = 0; ix < ORDER; ix++) {
+        int xbase = gridIndexX+ix;
+        xbase -= (xbase >= xwrap ? xwrap : 0);
+        xbase = xbase*gridy*gridz;
+        float xdata = charge*data[ix][0];
+        for (int iy = 0; iy < ORDER; iy++) {
+            int ybase = gridIndexY+iy;
+            ybase -= (ybase >= gridy ? gridy : 0);
+            ybase = xbase + ybase*gridz;
+            float multiplier = xdata*data[iy][1];
+            if (contiguous) {
+                float* row = &grid[ybase+gridIndexZ];
+                int j = 0;
+                for (; j+4 <= ORDER; j += 4)
+                    (fvec4(&row[j])+fvec4(&zdata[j])*multiplier).store(&row[j]);
+                for (; j < ORDER; j++)
+                    row[j] += multiplier*zdata[j];
+            }
+            else {
+                for (int j = 0; j < ORDER; j++)
+                    grid[ybase+zindex[j]] += multiplier*zdata[j];
+            }
+        }
+    }
+}
+
+template <int ORDER>
 static void spreadCharge(float* posq, vector<float>& grid, int gridx, int gridy, int gridz, int numParticles, Vec3* periodicBoxVectors, Vec3* recipBoxVectors,
         atomic<int>& atomicCounter, const float epsilonFactor, int threadIndex, int numThreads, bool deterministic) {
-    float temp[4];
-    fvec4 boxSize((float) periodicBoxVectors[0][0], (float) periodicBoxVectors[1][1], (float) periodicBoxVectors[2][2], 0);
-    fvec4 invBoxSize((float) recipBoxVectors[0][0], (float) recipBoxVectors[1][1], (float) recipBoxVectors[2][2], 0);
-    fvec4 recipBoxVec0((float) recipBoxVectors[0][0], (float) recipBoxVectors[0][1], (float) recipBoxVectors[0][2], 0);
-    fvec4 recipBoxVec1((float) recipBoxVectors[1][0], (float) recipBoxVectors[1][1], (float) recipBoxVectors[1][2], 0);
-    fvec4 recipBoxVec2((float) recipBoxVectors[2][0], (float) recipBoxVectors[2][1], (float) recipBoxVectors[2][2], 0);
-    fvec4 gridSize(gridx, gridy, gridz, 0);
-    ivec4 gridSizeInt(gridx, gridy, gridz, 0);
-    fvec4 one(1);
-    fvec4 scale(1.0f/(PME_ORDER-1));
-    float posInBox[4] = {0,0,0,0};
+    SpreadingParams params(gridx, gridy, gridz, periodicBoxVectors, recipBoxVectors);
     memset(grid.data(), 0, sizeof(float)*gridx*gridy*gridz);
 
     const int groupSize = max(1, numParticles / (10 * numThreads));
@@ -81,92 +178,142 @@ static void spreadCharge(float* posq, vector<float>& grid, int gridx, int gridy,
             break;
 
         int end = min(start + groupSize, numParticles);
-        for (int i = start; i < end; ++i) {
-            // Find the position relative to the nearest grid point.
+        for (int i = start; i < end; ++i)
+            spreadParticle<ORDER>(posq, i, grid.data(), params, 0, gridx, epsilonFactor);
 
-            fvec4 pos(&posq[4*i]);
-            (pos-boxSize*floor(pos*invBoxSize)).store(posInBox);
-            fvec4 t = posInBox[0]*recipBoxVec0 + posInBox[1]*recipBoxVec1 + posInBox[2]*recipBoxVec2;
-            t = (t-floor(t))*gridSize;
-            ivec4 ti = t;
-            fvec4 dr = t-ti;
-            ivec4 gridIndex = ti-(gridSizeInt&ti==gridSizeInt);
+        if (deterministic)
+            start += groupSize * numThreads;
+    }
+}
 
-            // Compute the B-spline coefficients.
+static void spreadCharge(int order, float* posq, vector<float>& grid, int gridx, int gridy, int gridz, int numParticles, Vec3* periodicBoxVectors, Vec3* recipBoxVectors,
+        atomic<int>& atomicCounter, const float epsilonFactor, int threadIndex, int numThreads, bool deterministic) {
+    switch (order) {
+    case 4:
+        spreadCharge<4>(posq, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, threadIndex, numThreads, deterministic);
+        break;
+    case 5:
+        spreadCharge<5>(posq, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, threadIndex, numThreads, deterministic);
+        break;
+    case 6:
+        spreadCharge<6>(posq, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, threadIndex, numThreads, deterministic);
+        break;
+    case 8:
+        spreadCharge<8>(posq, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, threadIndex, numThreads, deterministic);
+        break;
+    }
+}
 
-            fvec4 data[PME_ORDER];
-            data[PME_ORDER-1] = 0.0f;
-            data[1] = dr;
-            data[0] = one-dr;
-            for (int j = 3; j < PME_ORDER; j++) {
-                fvec4 div(1.0f/(j-1));
-                data[j-1] = div*dr*data[j-2];
-                for (int k = 1; k < j-1; k++)
-                    data[j-k-1] = div*((dr+k)*data[j-k-2]+(fvec4(j-k)-dr)*data[j-k-1]);
-                data[0] = div*(one-dr)*data[0];
-            }
-            data[PME_ORDER-1] = scale*dr*data[PME_ORDER-2];
-            for (int j = 1; j < (PME_ORDER-1); j++)
-                data[PME_ORDER-j-1] = scale*((dr+j)*data[PME_ORDER-j-2]+(fvec4(PME_ORDER-j)-dr)*data[PME_ORDER-j-1]);
-            data[0] = scale*(one-dr)*data[0];
+bool CpuPmeSlabSpreader::isSupported(int gridx, int numThreads) {
+    // Every slab needs at least one plane, and there is no benefit with only a single thread.
 
-            // Spread the charges.
+    return (numThreads > 1 && gridx >= numThreads);
+}
 
-            int gridIndexX = gridIndex[0];
-            int gridIndexY = gridIndex[1];
-            int gridIndexZ = gridIndex[2];
-            if (gridIndexX < 0)
-                return; // This happens when a simulation blows up and coordinates become NaN.
-            int zindex[PME_ORDER];
-            for (int j = 0; j < PME_ORDER; j++) {
-                zindex[j] = gridIndexZ+j;
-                zindex[j] -= (zindex[j] >= gridz ? gridz : 0);
-            }
-            float charge = epsilonFactor*posq[4*i+3];
-            fvec4 zdata0to3(data[0][2], data[1][2], data[2][2], data[3][2]);
-            float zdata4 = data[4][2];
-            if (gridIndexZ+4 < gridz) {
-                for (int ix = 0; ix < PME_ORDER; ix++) {
-                    int xbase = gridIndexX+ix;
-                    xbase -= (xbase >= gridx ? gridx : 0);
-                    xbase = xbase*gridy*gridz;
-                    float xdata = charge*data[ix][0];
-                    for (int iy = 0; iy < PME_ORDER; iy++) {
-                        int ybase = gridIndexY+iy;
-                        ybase -= (ybase >= gridy ? gridy : 0);
-                        ybase = xbase + ybase*gridz;
-                        float multiplier = xdata*data[iy][1];
-                        fvec4 add0to3 = zdata0to3*multiplier;
-                        (fvec4(&grid[ybase+gridIndexZ])+add0to3).store(&grid[ybase+gridIndexZ]);
-                        grid[ybase+zindex[4]] += multiplier*zdata4;
-                    }
-                }
-            }
-            else {
-                for (int ix = 0; ix < PME_ORDER; ix++) {
-                    int xbase = gridIndexX+ix;
-                    xbase -= (xbase >= gridx ? gridx : 0);
-                    xbase = xbase*gridy*gridz;
-                    float xdata = charge*data[ix][0];
-                    for (int iy = 0; iy < PME_ORDER; iy++) {
-                        int ybase = gridIndexY+iy;
-                        ybase -= (ybase >= gridy ? gridy : 0);
-                        ybase = xbase + ybase*gridz;
-                        float multiplier = xdata*data[iy][1];
-                        fvec4 add0to3 = zdata0to3*multiplier;
-                        add0to3.store(temp);
-                        grid[ybase+zindex[0]] += temp[0];
-                        grid[ybase+zindex[1]] += temp[1];
-                        grid[ybase+zindex[2]] += temp[2];
-                        grid[ybase+zindex[3]] += temp[3];
-                        grid[ybase+zindex[4]] += multiplier*zdata4;
-                    }
-                }
-            }
+void CpuPmeSlabSpreader::initialize(int gridx, int gridy, int gridz, int numParticles, int numThreads, int order) {
+    this->gridx = gridx;
+    this->gridy = gridy;
+    this->gridz = gridz;
+    this->numParticles = numParticles;
+    this->order = order;
+    numSlabs = numThreads;
+    firstPlane.resize(numSlabs+1);
+    for (int i = 0; i <= numSlabs; i++)
+        firstPlane[i] = (i*gridx)/numSlabs;
+    planeSlab.resize(gridx);
+    for (int i = 0; i < numSlabs; i++)
+        for (int j = firstPlane[i]; j < firstPlane[i+1]; j++)
+            planeSlab[j] = i;
+    slabGrids.resize(numSlabs);
+    for (int i = 0; i < numSlabs; i++)
+        slabGrids[i].resize((firstPlane[i+1]-firstPlane[i]+order-1)*gridy*gridz+3);
+    particleSlab.resize(numParticles);
+    sortedParticles.resize(numParticles);
+    slabCounts.resize(numThreads, vector<int>(numSlabs));
+}
+
+void CpuPmeSlabSpreader::assignParticles(const float* posq, const Vec3* periodicBoxVectors, const Vec3* recipBoxVectors, int threadIndex) {
+    SpreadingParams params(gridx, gridy, gridz, periodicBoxVectors, recipBoxVectors);
+    vector<int>& counts = slabCounts[threadIndex];
+    fill(counts.begin(), counts.end(), 0);
+    int start = (threadIndex*numParticles)/numSlabs;
+    int end = ((threadIndex+1)*numParticles)/numSlabs;
+    for (int i = start; i < end; i++) {
+        fvec4 dr;
+        int x = findGridIndex(&posq[4*i], params, dr)[0];
+        int slab = (x < 0 || x >= gridx ? 0 : planeSlab[x]);
+        particleSlab[i] = slab;
+        counts[slab]++;
+    }
+}
+
+void CpuPmeSlabSpreader::sortParticles(int threadIndex) {
+    // Find where this thread's particles go in the sorted list.  Particles in each slab are ordered first by
+    // which thread assigned them, then by index, so the result is deterministic.
+
+    vector<int> offset(numSlabs);
+    int total = 0;
+    for (int slab = 0; slab < numSlabs; slab++)
+        for (int thread = 0; thread < numSlabs; thread++) {
+            if (thread == threadIndex)
+                offset[slab] = total;
+            total += slabCounts[thread][slab];
         }
+    int start = (threadIndex*numParticles)/numSlabs;
+    int end = ((threadIndex+1)*numParticles)/numSlabs;
+    for (int i = start; i < end; i++)
+        sortedParticles[offset[particleSlab[i]]++] = i;
+}
 
-        if (deterministic)
-            start += groupSize * numThreads;
+void CpuPmeSlabSpreader::spreadCharge(const float* posq, const Vec3* periodicBoxVectors, const Vec3* recipBoxVectors, float epsilonFactor, int threadIndex) {
+    SpreadingParams params(gridx, gridy, gridz, periodicBoxVectors, recipBoxVectors);
+    vector<float>& grid = slabGrids[threadIndex];
+    memset(grid.data(), 0, sizeof(float)*grid.size());
+    int first = 0;
+    for (int thread = 0; thread < numSlabs; thread++)
+        for (int slab = 0; slab < threadIndex; slab++)
+            first += slabCounts[thread][slab];
+    int last = first;
+    for (int thread = 0; thread < numSlabs; thread++)
+        last += slabCounts[thread][threadIndex];
+    int plane = firstPlane[threadIndex];
+    for (int i = first; i < last; i++) {
+        switch (order) {
+        case 4:
+            spreadParticle<4>(posq, sortedParticles[i], grid.data(), params, plane, INT_MAX, epsilonFactor);
+            break;
+        case 5:
+            spreadParticle<5>(posq, sortedParticles[i], grid.data(), params, plane, INT_MAX, epsilonFactor);
+            break;
+        case 6:
+            spreadParticle<6>(posq, sortedParticles[i], grid.data(), params, plane, INT_MAX, epsilonFactor);
+            break;
+        case 8:
+            spreadParticle<8>(posq, sortedParticles[i], grid.data(), params, plane, INT_MAX, epsilonFactor);
+            break;
+        }
+    }
+}
+
+void CpuPmeSlabSpreader::mergeSlabs(vector<float>& grid, int threadIndex) {
+    // Each plane owned by this thread receives contributions from its own slab, plus the halo of any other
+    // slab that overlaps it.
+
+    int planeSize = gridy*gridz;
+    for (int plane = firstPlane[threadIndex]; plane < firstPlane[threadIndex+1]; plane++) {
+        float* dest = &grid[plane*planeSize];
+        memset(dest, 0, sizeof(float)*planeSize);
+        for (int slab = 0; slab < numSlabs; slab++) {
+            int numLocalPlanes = firstPlane[slab+1]-firstPlane[slab]+order-1;
+            for (int local = (plane-firstPlane[slab]+gridx)%gridx; local < numLocalPlanes; local += gridx) {
+                const float* src = &slabGrids[slab][local*planeSize];
+                int i = 0;
+                for (; i+4 <= planeSize; i += 4)
+                    (fvec4(&dest[i])+fvec4(&src[i])).store(&dest[i]);
+                for (; i < planeSize; i++)
+                    dest[i] += src[i];
+            }
+        }
     }
 }
 
@@ -320,6 +467,7 @@ static void reciprocalConvolution(int start, int end, vector<complex<float> >& g
     }
 }
 
+template <int ORDER>
 static void interpolateForces(float* posq, vector<float>& force, vector<float>& grid, int gridx, int gridy, int gridz, int numParticles, Vec3* periodicBoxVectors, Vec3* recipBoxVectors, atomic<int>& atomicCounter, const float epsilonFactor, int numThreads) {
     fvec4 boxSize((float) periodicBoxVectors[0][0], (float) periodicBoxVectors[1][1], (float) periodicBoxVectors[2][2], 0);
     fvec4 invBoxSize((float) recipBoxVectors[0][0], (float) recipBoxVectors[1][1], (float) recipBoxVectors[2][2], 0);
@@ -329,7 +477,7 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
     fvec4 gridSize(gridx, gridy, gridz, 0);
     ivec4 gridSizeInt(gridx, gridy, gridz, 0);
     fvec4 one(1);
-    fvec4 scale(1.0f/(PME_ORDER-1));
+    fvec4 scale(1.0f/(ORDER-1));
 
     const int groupSize = max(1, numParticles / (10 * numThreads));
     while (true) {
@@ -353,12 +501,12 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
 
             // Compute the B-spline coefficients.
 
-            fvec4 data[PME_ORDER];
-            fvec4 ddata[PME_ORDER];
-            data[PME_ORDER-1] = 0.0f;
+            fvec4 data[ORDER];
+            fvec4 ddata[ORDER];
+            data[ORDER-1] = 0.0f;
             data[1] = dr;
             data[0] = one-dr;
-            for (int j = 3; j < PME_ORDER; j++) {
+            for (int j = 3; j < ORDER; j++) {
                 fvec4 div(1.0f/(j-1));
                 data[j-1] = div*dr*data[j-2];
                 for (int k = 1; k < j-1; k++)
@@ -366,11 +514,11 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
                 data[0] = div*(one-dr)*data[0];
             }
             ddata[0] = -data[0];
-            for (int j = 1; j < PME_ORDER; j++)
+            for (int j = 1; j < ORDER; j++)
                 ddata[j] = data[j-1]-data[j];
-            data[PME_ORDER-1] = scale*dr*data[PME_ORDER-2];
-            for (int j = 1; j < (PME_ORDER-1); j++)
-                data[PME_ORDER-j-1] = scale*((dr+j)*data[PME_ORDER-j-2]+(fvec4(PME_ORDER-j)-dr)*data[PME_ORDER-j-1]);
+            data[ORDER-1] = scale*dr*data[ORDER-2];
+            for (int j = 1; j < (ORDER-1); j++)
+                data[ORDER-j-1] = scale*((dr+j)*data[ORDER-j-2]+(fvec4(ORDER-j)-dr)*data[ORDER-j-1]);
             data[0] = scale*(one-dr)*data[0];
 
             // Compute the force on this atom.
@@ -380,16 +528,16 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
             int gridIndexZ = gridIndex[2];
             if (gridIndexX < 0)
                 return; // This happens when a simulation blows up and coordinates become NaN.
-            int zindex[PME_ORDER];
-            for (int j = 0; j < PME_ORDER; j++) {
+            int zindex[ORDER];
+            for (int j = 0; j < ORDER; j++) {
                 zindex[j] = gridIndexZ+j;
                 zindex[j] -= (zindex[j] >= gridz ? gridz : 0);
             }
-            fvec4 zdata[PME_ORDER];
-            for (int j = 0; j < PME_ORDER; j++)
+            fvec4 zdata[ORDER];
+            for (int j = 0; j < ORDER; j++)
                 zdata[j] = fvec4(data[j][2], data[j][2], ddata[j][2], 0);
             fvec4 f = 0.0f;
-            for (int ix = 0; ix < PME_ORDER; ix++) {
+            for (int ix = 0; ix < ORDER; ix++) {
                 int xbase = gridIndexX+ix;
                 xbase -= (xbase >= gridx ? gridx : 0);
                 xbase = xbase*gridy*gridz;
@@ -397,7 +545,7 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
                 float ddx = ddata[ix][0];
                 fvec4 xdata(ddx, dx, dx, 0);
 
-                for (int iy = 0; iy < PME_ORDER; iy++) {
+                for (int iy = 0; iy < ORDER; iy++) {
                     int ybase = gridIndexY+iy;
                     ybase -= (ybase >= gridy ? gridy : 0);
                     ybase = xbase + ybase*gridz;
@@ -405,7 +553,7 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
                     float ddy = ddata[iy][1];
                     fvec4 xydata = xdata*fvec4(dy, ddy, dy, 0);
 
-                    for (int iz = 0; iz < PME_ORDER; iz++) {
+                    for (int iz = 0; iz < ORDER; iz++) {
                         fvec4 gridValue(grid[ybase+zindex[iz]]);
                         f = f+xydata*zdata[iz]*gridValue;
                     }
@@ -421,13 +569,32 @@ static void interpolateForces(float* posq, vector<float>& force, vector<float>&
     }
 }
 
+static void interpolateForces(int order, float* posq, vector<float>& force, vector<float>& grid, int gridx, int gridy, int gridz, int numParticles, Vec3* periodicBoxVectors, Vec3* recipBoxVectors, atomic<int>& atomicCounter, const float epsilonFactor, int numThreads) {
+    switch (order) {
+    case 4:
+        interpolateForces<4>(posq, force, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+        break;
+    case 5:
+        interpolateForces<5>(posq, force, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+        break;
+    case 6:
+        interpolateForces<6>(posq, force, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+        break;
+    case 8:
+        interpolateForces<8>(posq, force, grid, gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+        break;
+    }
+}
+
 static void* threadBody(void* args) {
     CpuCalcPmeReciprocalForceKernel& owner = *reinterpret_cast<CpuCalcPmeReciprocalForceKernel*>(args);
     owner.runMainThread();
     return 0;
 }
 
-void CpuCalcPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic) {
+void CpuCalcPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic, int order) {
+    if (order != 4 && order != 5 && order != 6 && order != 8)
+        throw OpenMMException("PME interpolation order must be 4, 5, 6, or 8");
     if (!hasInitializedThreads) {
         numThreads = getNumProcessors();
         char* threadsEnv = getenv("OPENMM_CPU_THREADS");
@@ -454,6 +621,7 @@ void CpuCalcPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize
     this->numParticles = numParticles;
     this->alpha = alpha;
     this->deterministic = deterministic;
+    this->order = order;
     force.resize(4*numParticles);
     recipEterm.resize(gridx*gridy*gridz);
     
@@ -472,19 +640,22 @@ void CpuCalcPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize
     
     // Initialize the FFT grids.
 
-    realGrids.resize(numThreads, vector<float>(gridx*gridy*gridz+3));
+    useSlabs = CpuPmeSlabSpreader::isSupported(gridx, numThreads);
+    if (useSlabs)
+        slabSpreader.initialize(gridx, gridy, gridz, numParticles, numThreads, order);
+    realGrids.resize(useSlabs ? 1 : numThreads, vector<float>(gridx*gridy*gridz+3));
     complexGrid.resize(gridx*gridy*(gridz/2+1));
     
     // Initialize the b-spline moduli.
 
     int maxSize = std::max(std::max(gridx, gridy), gridz);
-    vector<double> data(PME_ORDER);
-    vector<double> ddata(PME_ORDER);
-    vector<double> bsplinesData(maxSize);
-    data[PME_ORDER-1] = 0.0;
+    vector<double> data(order);
+    vector<double> ddata(order);
+    vector<double> bsplinesData(std::max(maxSize, order+1));
+    data[order-1] = 0.0;
     data[1] = 0.0;
     data[0] = 1.0;
-    for (int i = 3; i < PME_ORDER; i++) {
+    for (int i = 3; i < order; i++) {
         double div = 1.0/(i-1.0);
         data[i-1] = 0.0;
         for (int j = 1; j < (i-1); j++)
@@ -495,16 +666,16 @@ void CpuCalcPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize
     // Differentiate.
 
     ddata[0] = -data[0];
-    for (int i = 1; i < PME_ORDER; i++)
+    for (int i = 1; i < order; i++)
         ddata[i] = data[i-1]-data[i];
-    double div = 1.0/(PME_ORDER-1);
-    data[PME_ORDER-1] = 0.0;
-    for (int i = 1; i < (PME_ORDER-1); i++)
-        data[PME_ORDER-i-1] = div*(i*data[PME_ORDER-i-2]+(PME_ORDER-i)*data[PME_ORDER-i-1]);
+    double div = 1.0/(order-1);
+    data[order-1] = 0.0;
+    for (int i = 1; i < (order-1); i++)
+        data[order-i-1] = div*(i*data[order-i-2]+(order-i)*data[order-i-1]);
     data[0] = div*data[0];
     for (int i = 0; i < maxSize; i++)
         bsplinesData[i] = 0.0;
-    for (int i = 1; i <= PME_ORDER; i++)
+    for (int i = 1; i <= order; i++)
         bsplinesData[i] = data[i-1];
 
     // Evaluate the actual bspline moduli for X/Y/Z.
@@ -556,6 +727,12 @@ void CpuCalcPmeReciprocalForceKernel::runMainThread() {
         atomicCounter = 0;
         threads.execute([&] (ThreadPool& threads, int threadIndex) { runWorkerThread(threads, threadIndex); }); // Signal threads to perform charge spreading.
         threads.waitForThreads();
+        if (useSlabs) {
+            threads.resumeThreads(); // Signal threads to sort particles into slabs.
+            threads.waitForThreads();
+            threads.resumeThreads(); // Signal threads to spread the charge in each slab.
+            threads.waitForThreads();
+        }
         threads.resumeThreads(); // Signal threads to sum the charge grids.
         threads.waitForThreads();
         pocketfft::r2c(gridShape, realGridStride, complexGridStride, fftAxes, true, realGrids[0].data(), complexGrid.data(), 1.0f, 0);
@@ -593,14 +770,25 @@ void CpuCalcPmeReciprocalForceKernel::runWorkerThread(ThreadPool& threads, int i
     int complexStart = std::max(1, ((index*complexSize)/numThreads));
     int complexEnd = (((index+1)*complexSize)/numThreads);
     const float epsilonFactor = sqrt(ONE_4PI_EPS0);
-    spreadCharge(posq, realGrids[index], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, index, numThreads, deterministic);
-    threads.syncThreads();
-    int numGrids = realGrids.size();
-    for (int i = gridStart; i < gridEnd; i += 4) {
-        fvec4 sum(&realGrids[0][i]);
-        for (int j = 1; j < numGrids; j++)
-            sum += fvec4(&realGrids[j][i]);
-        sum.store(&realGrids[0][i]);
+    if (useSlabs) {
+        slabSpreader.assignParticles(posq, periodicBoxVectors, recipBoxVectors, index);
+        threads.syncThreads();
+        slabSpreader.sortParticles(index);
+        threads.syncThreads();
+        slabSpreader.spreadCharge(posq, periodicBoxVectors, recipBoxVectors, epsilonFactor, index);
+        threads.syncThreads();
+        slabSpreader.mergeSlabs(realGrids[0], index);
+    }
+    else {
+        spreadCharge(order, posq, realGrids[index], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, index, numThreads, deterministic);
+        threads.syncThreads();
+        int numGrids = realGrids.size();
+        for (int i = gridStart; i < gridEnd; i += 4) {
+            fvec4 sum(&realGrids[0][i]);
+            for (int j = 1; j < numGrids; j++)
+                sum += fvec4(&realGrids[j][i]);
+            sum.store(&realGrids[0][i]);
+        }
     }
     threads.syncThreads();
     if (lastBoxVectors[0] != periodicBoxVectors[0] || lastBoxVectors[1] != periodicBoxVectors[1] || lastBoxVectors[2] != periodicBoxVectors[2]) {
@@ -613,7 +801,7 @@ void CpuCalcPmeReciprocalForceKernel::runWorkerThread(ThreadPool& threads, int i
     }
     reciprocalConvolution(complexStart, complexEnd, complexGrid, recipEterm);
     threads.syncThreads();
-    interpolateForces(posq, force, realGrids[0], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+    interpolateForces(order, posq, force, realGrids[0], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
 }
 
 void CpuCalcPmeReciprocalForceKernel::beginComputation(IO& io, const Vec3* periodicBoxVectors, bool includeEnergy) {
@@ -703,7 +891,9 @@ static void* dispersionThreadBody(void* args) {
     return 0;
 }
 
-void CpuCalcDispersionPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic) {
+void CpuCalcDispersionPmeReciprocalForceKernel::initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic, int order) {
+    if (order != 4 && order != 5 && order != 6 && order != 8)
+        throw OpenMMException("PME interpolation order must be 4, 5, 6, or 8");
     if (!hasInitializedThreads) {
         numThreads = getNumProcessors();
         char* threadsEnv = getenv("OPENMM_CPU_THREADS");
@@ -730,6 +920,7 @@ void CpuCalcDispersionPmeReciprocalForceKernel::initialize(int xsize, int ysize,
     this->numParticles = numParticles;
     this->alpha = alpha;
     this->deterministic = deterministic;
+    this->order = order;
     force.resize(4*numParticles);
     recipEterm.resize(gridx*gridy*gridz);
     
@@ -748,19 +939,22 @@ void CpuCalcDispersionPmeReciprocalForceKernel::initialize(int xsize, int ysize,
 
     // Initialize the FFT grids.
 
-    realGrids.resize(numThreads, vector<float>(gridx*gridy*gridz+3));
+    useSlabs = CpuPmeSlabSpreader::isSupported(gridx, numThreads);
+    if (useSlabs)
+        slabSpreader.initialize(gridx, gridy, gridz, numParticles, numThreads, order);
+    realGrids.resize(useSlabs ? 1 : numThreads, vector<float>(gridx*gridy*gridz+3));
     complexGrid.resize(gridx*gridy*(gridz/2+1));
     
     // Initialize the b-spline moduli.
 
     int maxSize = std::max(std::max(gridx, gridy), gridz);
-    vector<double> data(PME_ORDER);
-    vector<double> ddata(PME_ORDER);
-    vector<double> bsplinesData(maxSize);
-    data[PME_ORDER-1] = 0.0;
+    vector<double> data(order);
+    vector<double> ddata(order);
+    vector<double> bsplinesData(std::max(maxSize, order+1));
+    data[order-1] = 0.0;
     data[1] = 0.0;
     data[0] = 1.0;
-    for (int i = 3; i < PME_ORDER; i++) {
+    for (int i = 3; i < order; i++) {
         double div = 1.0/(i-1.0);
         data[i-1] = 0.0;
         for (int j = 1; j < (i-1); j++)
@@ -771,16 +965,16 @@ void CpuCalcDispersionPmeReciprocalForceKernel::initialize(int xsize, int ysize,
     // Differentiate.
 
     ddata[0] = -data[0];
-    for (int i = 1; i < PME_ORDER; i++)
+    for (int i = 1; i < order; i++)
         ddata[i] = data[i-1]-data[i];
-    double div = 1.0/(PME_ORDER-1);
-    data[PME_ORDER-1] = 0.0;
-    for (int i = 1; i < (PME_ORDER-1); i++)
-        data[PME_ORDER-i-1] = div*(i*data[PME_ORDER-i-2]+(PME_ORDER-i)*data[PME_ORDER-i-1]);
+    double div = 1.0/(order-1);
+    data[order-1] = 0.0;
+    for (int i = 1; i < (order-1); i++)
+        data[order-i-1] = div*(i*data[order-i-2]+(order-i)*data[order-i-1]);
     data[0] = div*data[0];
     for (int i = 0; i < maxSize; i++)
         bsplinesData[i] = 0.0;
-    for (int i = 1; i <= PME_ORDER; i++)
+    for (int i = 1; i <= order; i++)
         bsplinesData[i] = data[i-1];
 
     // Evaluate the actual bspline moduli for X/Y/Z.
@@ -833,6 +1027,12 @@ void CpuCalcDispersionPmeReciprocalForceKernel::runMainThread() {
         atomicCounter = 0;
         threads.execute(task); // Signal threads to perform charge spreading.
         threads.waitForThreads();
+        if (useSlabs) {
+            threads.resumeThreads(); // Signal threads to sort particles into slabs.
+            threads.waitForThreads();
+            threads.resumeThreads(); // Signal threads to spread the charge in each slab.
+            threads.waitForThreads();
+        }
         threads.resumeThreads(); // Signal threads to sum the charge grids.
         threads.waitForThreads();
         pocketfft::r2c(gridShape, realGridStride, complexGridStride, fftAxes, true, realGrids[0].data(), complexGrid.data(), 1.0f, 0);
@@ -870,14 +1070,25 @@ void CpuCalcDispersionPmeReciprocalForceKernel::runWorkerThread(ThreadPool& thre
     int complexStart = std::max(1, ((index*complexSize)/numThreads));
     int complexEnd = (((index+1)*complexSize)/numThreads);
     const float epsilonFactor = 1.0f;
-    spreadCharge(posq, realGrids[index], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, index, numThreads, deterministic);
-    threads.syncThreads();
-    int numGrids = realGrids.size();
-    for (int i = gridStart; i < gridEnd; i += 4) {
-        fvec4 sum(&realGrids[0][i]);
-        for (int j = 1; j < numGrids; j++)
-            sum += fvec4(&realGrids[j][i]);
-        sum.store(&realGrids[0][i]);
+    if (useSlabs) {
+        slabSpreader.assignParticles(posq, periodicBoxVectors, recipBoxVectors, index);
+        threads.syncThreads();
+        slabSpreader.sortParticles(index);
+        threads.syncThreads();
+        slabSpreader.spreadCharge(posq, periodicBoxVectors, recipBoxVectors, epsilonFactor, index);
+        threads.syncThreads();
+        slabSpreader.mergeSlabs(realGrids[0], index);
+    }
+    else {
+        spreadCharge(order, posq, realGrids[index], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, index, numThreads, deterministic);
+        threads.syncThreads();
+        int numGrids = realGrids.size();
+        for (int i = gridStart; i < gridEnd; i += 4) {
+            fvec4 sum(&realGrids[0][i]);
+            for (int j = 1; j < numGrids; j++)
+                sum += fvec4(&realGrids[j][i]);
+            sum.store(&realGrids[0][i]);
+        }
     }
     threads.syncThreads();
     if (lastBoxVectors[0] != periodicBoxVectors[0] || lastBoxVectors[1] != periodicBoxVectors[1] || lastBoxVectors[2] != periodicBoxVectors[2]) {
@@ -892,7 +1103,7 @@ void CpuCalcDispersionPmeReciprocalForceKernel::runWorkerThread(ThreadPool& thre
     complexStart = (index*complexSize)/numThreads;
     reciprocalConvolution(complexStart, complexEnd, complexGrid, recipEterm);
     threads.syncThreads();
-    interpolateForces(posq, force, realGrids[0], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
+    interpolateForces(order, posq, force, realGrids[0], gridx, gridy, gridz, numParticles, periodicBoxVectors, recipBoxVectors, atomicCounter, epsilonFactor, numThreads);
 }
 
 void CpuCalcDispersionPmeReciprocalForceKernel::beginComputation(CalcPmeReciprocalForceKernel::IO& io, const Vec3* periodicBoxVectors, bool includeEnergy) {
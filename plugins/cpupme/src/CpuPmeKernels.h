@@ -46,6 +46,45 @@
 
 namespace OpenMM {
 
+/**
+ * This class spreads charges onto the PME grid by dividing it into slabs along the x axis, which is the
+ * outermost axis of the grid and the first one transformed by the FFT.  Each thread owns one slab, plus a
+ * halo of order-1 planes for particles near its upper edge.  The slabs are then merged directly into
+ * the grid used for the FFT.  Compared to giving every thread a full copy of the grid, this greatly reduces
+ * the memory and bandwidth needed when there are many threads.
+ *
+ * Each step of the calculation is performed by every thread, with a synchronization between them.
+ */
+class OPENMM_EXPORT_PME CpuPmeSlabSpreader {
+public:
+    /**
+     * Get whether slab decomposition can be used for a grid.
+     */
+    static bool isSupported(int gridx, int numThreads);
+    void initialize(int gridx, int gridy, int gridz, int numParticles, int numThreads, int order);
+    /**
+     * Identify which slab each particle belongs to.
+     */
+    void assignParticles(const float* posq, const Vec3* periodicBoxVectors, const Vec3* recipBoxVectors, int threadIndex);
+    /**
+     * Sort the particles by slab.
+     */
+    void sortParticles(int threadIndex);
+    /**
+     * Spread the charges of the particles in this thread's slab.
+     */
+    void spreadCharge(const float* posq, const Vec3* periodicBoxVectors, const Vec3* recipBoxVectors, float epsilonFactor, int threadIndex);
+    /**
+     * Sum the slabs to compute this thread's planes of the full grid.
+     */
+    void mergeSlabs(std::vector<float>& grid, int threadIndex);
+private:
+    int gridx, gridy, gridz, numParticles, numSlabs, order;
+    std::vector<int> firstPlane, planeSlab, particleSlab, sortedParticles;
+    std::vector<std::vector<int> > slabCounts;
+    std::vector<std::vector<float> > slabGrids;
+};
+
 /**
  * This is an optimized CPU implementation of CalcPmeReciprocalForceKernel.  It is both
  * vectorized (requiring SSE 4.1) and multithreaded.  It uses PocketFFT to perform the FFTs.
@@ -65,8 +104,9 @@ public:
      * @param numParticles the number of particles in the system
      * @param alpha        the Ewald blending parameter
      * @param deterministic whether it should attempt to make the resulting forces deterministic
+     * @param order        the B-spline interpolation order (4, 5, 6, or 8)
      */
-    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic);
+    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic, int order);
     ~CpuCalcPmeReciprocalForceKernel();
     /**
      * Begin computing the force and energy.
@@ -111,7 +151,7 @@ private:
     int findFFTDimension(int minimum);
     static bool hasInitializedThreads;
     static int numThreads;
-    int gridx, gridy, gridz, numParticles;
+    int gridx, gridy, gridz, numParticles, order;
     double alpha;
     bool deterministic;
     bool isFinished, isDeleted;
@@ -121,6 +161,8 @@ private:
     Vec3 lastBoxVectors[3];
     std::vector<float> threadEnergy;
     std::vector<std::vector<float> > realGrids;
+    bool useSlabs;
+    CpuPmeSlabSpreader slabSpreader;
     std::vector<std::complex<float> > complexGrid;
     std::vector<std::size_t> gridShape, fftAxes;
     std::vector<std::ptrdiff_t> realGridStride, complexGridStride;
@@ -158,8 +200,9 @@ public:
      * @param numParticles the number of particles in the system
      * @param alpha        the Ewald blending parameter
      * @param deterministic whether it should attempt to make the resulting forces deterministic
+     * @param order        the B-spline interpolation order (4, 5, 6, or 8)
      */
-    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic);
+    void initialize(int xsize, int ysize, int zsize, int numParticles, double alpha, bool deterministic, int order);
     ~CpuCalcDispersionPmeReciprocalForceKernel();
     /**
      * Begin computing the force and energy.
@@ -205,7 +248,7 @@ private:
     int findFFTDimension(int minimum);
     static bool hasInitializedThreads;
     static int numThreads;
-    int gridx, gridy, gridz, numParticles;
+    int gridx, gridy, gridz, numParticles, order;
     double alpha;
     bool deterministic;
     bool isFinished, isDeleted;
@@ -215,6 +258,8 @@ private:
     Vec3 lastBoxVectors[3];
     std::vector<float> threadEnergy;
     std::vector<std::vector<float> > realGrids;
+    bool useSlabs;
+    CpuPmeSlabSpreader slabSpreader;
     std::vector<std::complex<float> > complexGrid;
     std::vector<std::size_t> gridShape, fftAxes;
     std::vector<std::ptrdiff_t> realGridStride, complexGridStride;
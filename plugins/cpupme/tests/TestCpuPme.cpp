@@ -535,7 +535,7 @@ void test_water2_dpme_energies_forces_no_exclusions() {
         io.posq.push_back(c6);
         selfEwaldEnergy += dalpha6 * c6 * c6 / 12.0;
     }
-    pme.initialize(grid, grid, grid, NATOMS, dalpha, false);
+    pme.initialize(grid, grid, grid, NATOMS, dalpha, false, 5);
     Vec3 boxVectors[3];
     system.getDefaultPeriodicBoxVectors(boxVectors[0], boxVectors[1], boxVectors[2]);
     pme.beginComputation(io, boxVectors, true);
@@ -565,7 +565,7 @@ void test_water2_dpme_energies_forces_no_exclusions() {
 }
 
 
-void testPME(bool triclinic) {
+void testPME(bool triclinic, int order) {
     // Create a cloud of random point charges.
 
     const int numParticles = 51;
@@ -599,17 +599,12 @@ void testPME(bool triclinic) {
     force->setCutoffDistance(cutoff);
     force->setReciprocalSpaceForceGroup(1);
     force->setEwaldErrorTolerance(1e-4);
+    force->setPMEInterpolationOrder(order);
     
-    // Compute the reciprocal space forces with the reference platform.
+    // Compute the reciprocal space forces with the optimized kernel.  It may round the grid up to a size
+    // that is efficient for FFTs, so the reference platform is given the same grid.
     
     Platform& platform = Platform::getPlatformByName("Reference");
-    VerletIntegrator integrator(0.01);
-    Context context(system, integrator, platform);
-    context.setPositions(positions);
-    State refState = context.getState(State::Forces | State::Energy, false, 1<<1);
-    
-    // Now compute them with the optimized kernel.
-    
     double alpha;
     int gridx, gridy, gridz;
     NonbondedForceImpl::calcPMEParameters(system, *force, alpha, gridx, gridy, gridz, false);
@@ -626,9 +621,18 @@ void testPME(bool triclinic) {
         sumSquaredCharges += charge*charge;
     }
     double ewaldSelfEnergy = -ONE_4PI_EPS0*alpha*sumSquaredCharges/sqrt(M_PI);
-    pme.initialize(gridx, gridy, gridz, numParticles, alpha, true);
+    pme.initialize(gridx, gridy, gridz, numParticles, alpha, true, order);
     pme.beginComputation(io, boxVectors, true);
     double energy = pme.finishComputation(io);
+    pme.getPMEParameters(alpha, gridx, gridy, gridz);
+    force->setPMEParameters(alpha, gridx, gridy, gridz);
+
+    // Now compute them with the reference platform.
+    
+    VerletIntegrator integrator(0.01);
+    Context context(system, integrator, platform);
+    context.setPositions(positions);
+    State refState = context.getState(State::Forces | State::Energy, false, 1<<1);
 
     // See if they match.
     
@@ -637,7 +641,7 @@ void testPME(bool triclinic) {
         ASSERT_EQUAL_VEC(refState.getForces()[i], Vec3(io.force[4*i], io.force[4*i+1], io.force[4*i+2]), 1e-3);
 }
 
-void testLJPME(bool triclinic) {
+void testLJPME(bool triclinic, int order) {
     // Create a cloud of random LJ particles.
 
     const int numParticles = 51;
@@ -672,6 +676,7 @@ void testLJPME(bool triclinic) {
     force->setCutoffDistance(cutoff);
     force->setReciprocalSpaceForceGroup(1);
     force->setLJPMEParameters(alpha, 64, 64, 64);
+    force->setPMEInterpolationOrder(order);
     
     // Compute the reciprocal space forces with the reference platform.
     
@@ -695,7 +700,7 @@ void testLJPME(bool triclinic) {
         io.posq.push_back(pow(sigma, 3.0) * 2.0*sqrt(epsilon));
         ewaldSelfEnergy += pow(alpha*sigma, 6.0) * epsilon / 3.0;
     }
-    pme.initialize(64, 64, 64, numParticles, alpha, true);
+    pme.initialize(64, 64, 64, numParticles, alpha, true, order);
     pme.beginComputation(io, boxVectors, true);
     double energy = pme.finishComputation(io);
 
@@ -706,16 +711,81 @@ void testLJPME(bool triclinic) {
         ASSERT_EQUAL_VEC(refState.getForces()[i], Vec3(io.force[4*i], io.force[4*i+1], io.force[4*i+2]), 1e-3);
 }
 
+vector<float> spreadWithSlabs(vector<float>& posq, Vec3* boxVectors, int gridx, int gridy, int gridz, int numThreads, int order) {
+    Vec3 recipBoxVectors[3];
+    double scale = 1.0/(boxVectors[0][0]*boxVectors[1][1]*boxVectors[2][2]);
+    recipBoxVectors[0] = Vec3(boxVectors[1][1]*boxVectors[2][2], 0, 0)*scale;
+    recipBoxVectors[1] = Vec3(-boxVectors[1][0]*boxVectors[2][2], boxVectors[0][0]*boxVectors[2][2], 0)*scale;
+    recipBoxVectors[2] = Vec3(boxVectors[1][0]*boxVectors[2][1]-boxVectors[1][1]*boxVectors[2][0], -boxVectors[0][0]*boxVectors[2][1], boxVectors[0][0]*boxVectors[1][1])*scale;
+    int numParticles = posq.size()/4;
+    CpuPmeSlabSpreader spreader;
+    spreader.initialize(gridx, gridy, gridz, numParticles, numThreads, order);
+    vector<float> grid(gridx*gridy*gridz+3);
+    ThreadPool threads(numThreads);
+    threads.execute([&] (ThreadPool& threads, int threadIndex) {
+        spreader.assignParticles(&posq[0], boxVectors, recipBoxVectors, threadIndex);
+        threads.syncThreads();
+        spreader.sortParticles(threadIndex);
+        threads.syncThreads();
+        spreader.spreadCharge(&posq[0], boxVectors, recipBoxVectors, 1.0f, threadIndex);
+        threads.syncThreads();
+        spreader.mergeSlabs(grid, threadIndex);
+    });
+    threads.waitForThreads();
+    for (int i = 0; i < 3; i++) {
+        threads.resumeThreads();
+        threads.waitForThreads();
+    }
+    return grid;
+}
+
+void testSlabSpreading(bool triclinic, int order) {
+    // Spread charges with different numbers of slabs, including ones so thin that the halo
+    // spans several slabs, and make sure the grids agree.
+
+    const int numParticles = 500;
+    const double boxWidth = 3.0;
+    const int gridx = 24, gridy = 20, gridz = 18;
+    Vec3 boxVectors[3];
+    boxVectors[0] = Vec3(boxWidth, 0, 0);
+    boxVectors[1] = (triclinic ? Vec3(0.2*boxWidth, boxWidth, 0) : Vec3(0, boxWidth, 0));
+    boxVectors[2] = (triclinic ? Vec3(-0.3*boxWidth, -0.1*boxWidth, boxWidth) : Vec3(0, 0, boxWidth));
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<float> posq;
+    double totalCharge = 0.0;
+    for (int i = 0; i < numParticles; i++) {
+        for (int j = 0; j < 3; j++)
+            posq.push_back(3*boxWidth*genrand_real2(sfmt)-boxWidth);
+        posq.push_back(genrand_real2(sfmt)-0.5);
+        totalCharge += posq[4*i+3];
+    }
+    vector<float> expected = spreadWithSlabs(posq, boxVectors, gridx, gridy, gridz, 1, order);
+    double sum = 0.0;
+    for (float value : expected)
+        sum += value;
+    ASSERT_EQUAL_TOL(totalCharge, sum, 1e-4);
+    for (int numThreads : {2, 5, 11, 24}) {
+        vector<float> grid = spreadWithSlabs(posq, boxVectors, gridx, gridy, gridz, numThreads, order);
+        for (int i = 0; i < gridx*gridy*gridz; i++)
+            ASSERT_EQUAL_TOL(expected[i], grid[i], 1e-4);
+    }
+}
+
 int main(int argc, char* argv[]) {
     try {
         if (!CpuCalcPmeReciprocalForceKernel::isProcessorSupported()) {
             cout << "CPU is not supported.  Exiting." << endl;
             return 0;
         }
-        testPME(false);
-        testPME(true);
-        testLJPME(false);
-        testLJPME(true);
+        for (int order : {4, 5, 6, 8}) {
+            testPME(false, order);
+            testPME(true, order);
+            testLJPME(false, order);
+            testLJPME(true, order);
+            testSlabSpreading(false, order);
+            testSlabSpreading(true, order);
+        }
         test_water2_dpme_energies_forces_no_exclusions();
     }
     catch(const exception& e) {
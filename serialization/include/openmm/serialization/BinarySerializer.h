@@ -0,0 +1,131 @@
+#ifndef OPENMM_BINARY_SERIALIZER_H_
+#define OPENMM_BINARY_SERIALIZER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/SerializationNode.h"
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/OpenMMException.h"
+#include "openmm/internal/windowsExport.h"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace OpenMM {
+
+/**
+ * BinarySerializer is used for serializing objects in a compact binary format, and for reconstructing
+ * them again.  It uses the same SerializationProxies as XmlSerializer, so any object that can be
+ * serialized as XML can also be serialized in this format.
+ *
+ * Numeric values are stored in binary form, so no conversions between numbers and strings are needed
+ * when writing or reading them.  When a node has a series of child nodes that all have the same name
+ * and the same set of properties, and no children of their own (for example, the particles of a System
+ * or the bonds of a HarmonicBondForce), they are stored as a table in which the values of each property
+ * form a contiguous array.  This makes the data much smaller than XML, and allows it to be loaded
+ * directly from a memory mapped file.
+ *
+ * The data is written in the native byte order, and can only be read on a machine with the same byte order.
+ * Streams used for reading and writing should be opened in binary mode.
+ */
+
+class OPENMM_EXPORT BinarySerializer {
+public:
+    /**
+     * Serialize an object in binary format.
+     *
+     * @param object    the object to serialize
+     * @param rootName  the name to use for the root node
+     * @param stream    an output stream to write the data to
+     */
+    template <class T>
+    static void serialize(const T* object, const std::string& rootName, std::ostream& stream) {
+        const SerializationProxy& proxy = SerializationProxy::getProxy(typeid(*object));
+        SerializationNode node;
+        node.setName(rootName);
+        proxy.serialize(object, node);
+        if (node.hasProperty("type"))
+            throw OpenMMException(proxy.getTypeName()+" created node with reserved property 'type'");
+        node.setStringProperty("type", proxy.getTypeName());
+        serialize(node, stream);
+    }
+    /**
+     * Reconstruct an object that has been serialized in binary format.
+     *
+     * @param stream    an input stream to read the data from
+     * @return a pointer to the newly created object.  The caller assumes ownership of the object.
+     */
+    template <class T>
+    static T* deserialize(std::istream& stream) {
+        return reinterpret_cast<T*>(deserializeStream(stream));
+    }
+    /**
+     * Reconstruct an object that has been serialized in binary format, reading it from a block of memory.
+     *
+     * @param data      a pointer to the serialized data
+     * @param size      the size of the serialized data in bytes
+     * @return a pointer to the newly created object.  The caller assumes ownership of the object.
+     */
+    template <class T>
+    static T* deserialize(const char* data, size_t size) {
+        return reinterpret_cast<T*>(deserializeBuffer(data, size));
+    }
+    /**
+     * Reconstruct an object that has been serialized in binary format, reading it from a file.  Where the
+     * operating system supports it, the file is memory mapped rather than being read into a buffer.
+     *
+     * @param filename  the path to the file to read
+     * @return a pointer to the newly created object.  The caller assumes ownership of the object.
+     */
+    template <class T>
+    static T* deserializeFile(const std::string& filename) {
+        return reinterpret_cast<T*>(deserializeMappedFile(filename));
+    }
+private:
+    class Writer;
+    class Reader;
+    static void serialize(const SerializationNode& node, std::ostream& stream);
+    static void* deserializeStream(std::istream& stream);
+    static void* deserializeBuffer(const char* data, size_t size);
+    static void* deserializeMappedFile(const std::string& filename);
+    static bool isSameStructure(const SerializationNode& node1, const SerializationNode& node2);
+    static void encodeNode(const SerializationNode& node, Writer& writer);
+    static void encodeTable(const SerializationNode& node, int start, int end, Writer& writer);
+    static void encodeValue(const SerializationNode::Property& value, Writer& writer);
+    static void decodeNode(SerializationNode& node, Reader& reader);
+    static void decodeTable(SerializationNode& node, Reader& reader);
+    static void decodeValue(SerializationNode::Property& value, int type, Reader& reader);
+};
+
+} // namespace OpenMM
+
+#endif /*OPENMM_BINARY_SERIALIZER_H_*/
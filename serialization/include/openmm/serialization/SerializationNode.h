@@ -36,6 +36,7 @@
 #include "openmm/OpenMMException.h"
 #include "openmm/internal/windowsExport.h"
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -62,10 +63,17 @@ namespace OpenMM {
  * property as a string.  Similarly, you can use setStringProperty() to specify a property and then access it
  * using getIntProperty().  This will produce the expected result if the original value was, in fact, the
  * string representation of an int, but if the original string was non-numeric, the result is undefined.
+ *
+ * Values specified as numbers are stored in binary form, and are only converted to strings when they are
+ * accessed as strings.  This allows serializers that do not use a text format to avoid the conversions.
+ * The converted strings are cached, but it is still safe for multiple threads to call const methods on
+ * the same node at once.  As with standard containers, modifying a node while other threads are reading
+ * it is not safe.
  */
 
 class OPENMM_EXPORT SerializationNode {
 public:
+    SerializationNode();
     /**
      * Get the name of this SerializationNode.
      */
@@ -263,9 +271,62 @@ public:
         return reinterpret_cast<T*>(SerializationProxy::getProxy(getStringProperty("type")).deserialize(*this));
     }
 private:
+    friend class BinarySerializer;
+    /**
+     * The value of a property, together with the data type that was used to specify it.
+     */
+    class Property {
+    public:
+        enum Type {String = 0, Int = 1, Double = 2};
+        Property() : type(String), intValue(0) {
+        }
+        const std::string& getString() const;
+        long long getLong() const;
+        bool getBool() const;
+        double getDouble() const;
+        Type type;
+        union {
+            long long intValue;
+            double doubleValue;
+        };
+    private:
+        friend class SerializationNode;
+        friend class BinarySerializer;
+        mutable std::string stringValue;
+    };
+    /**
+     * BinarySerializer stores a series of leaf nodes with the same structure as a table.  Rather than
+     * giving each one its own set of properties, the nodes all refer to a shared copy of the table,
+     * with the values of each property stored as a column.
+     */
+    class Table {
+    public:
+        union Value {
+            long long intValue;
+            double doubleValue;
+            const std::string* stringValue;
+        };
+        int findColumn(const std::string& name) const;
+        const std::string& getString(int row, int column) const;
+        int numRows;
+        std::vector<std::string> columnNames;
+        std::vector<Property::Type> columnTypes;
+        std::vector<Value> values;
+        std::shared_ptr<const std::vector<std::string> > strings;
+    private:
+        mutable std::map<size_t, std::string> stringCache;
+    };
+    Property& setProperty(const std::string& name, Property::Type type);
+    bool findProperty(const std::string& name, Property& value) const;
+    void getTableValue(int column, Property& value) const;
+    const std::string* findStringProperty(const std::string& name) const;
     std::string name;
     std::vector<SerializationNode> children;
-    std::map<std::string, std::string> properties;
+    std::map<std::string, Property> properties;
+    mutable std::map<std::string, std::string> stringProperties;
+    mutable bool stringPropertiesValid;
+    std::shared_ptr<const Table> table;
+    int tableRow;
 };
 
 } // namespace OpenMM
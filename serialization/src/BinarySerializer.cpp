@@ -0,0 +1,370 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/serialization/BinarySerializer.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * The data starts with a header containing these values, followed by a table of all strings that appear
+ * in it, and then the tree of nodes.  Each node consists of its name, its properties, and its children.
+ * The children are stored as a list of groups, each of which is either a single node, or a table holding
+ * a series of leaf nodes with identical structure.  The values in a table are stored by column, and each
+ * column begins at an offset that is a multiple of ALIGNMENT.
+ */
+static const char MAGIC[8] = {'O', 'p', 'e', 'n', 'M', 'M', 'B', '\0'};
+static const int VERSION = 1;
+static const int BYTE_ORDER_MARK = 0x01020304;
+static const int ALIGNMENT = 8;
+static const char SINGLE_NODE = 0;
+static const char NODE_TABLE = 1;
+
+/**
+ * This class accumulates the encoded data in memory.  It is written to the stream once it is complete,
+ * since the string table must precede the nodes that refer to it.
+ */
+class BinarySerializer::Writer {
+public:
+    int getStringIndex(const string& str) {
+        map<string, int>::iterator iter = stringIndex.find(str);
+        if (iter != stringIndex.end())
+            return iter->second;
+        int index = strings.size();
+        stringIndex[str] = index;
+        strings.push_back(str);
+        return index;
+    }
+    template <class T>
+    void write(T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes+sizeof(T));
+    }
+    void align() {
+        buffer.resize(((buffer.size()+ALIGNMENT-1)/ALIGNMENT)*ALIGNMENT, 0);
+    }
+    vector<char> buffer;
+    vector<string> strings;
+private:
+    map<string, int> stringIndex;
+};
+
+/**
+ * This class reads values from a block of memory, checking that it does not go past the end.  Values are
+ * copied with memcpy(), so the block need not have any particular alignment.
+ */
+class BinarySerializer::Reader {
+public:
+    Reader(const char* data, size_t size, const shared_ptr<const vector<string> >& strings) : data(data), size(size), position(0), strings(strings) {
+    }
+    const char* advance(size_t bytes) {
+        if (bytes > size-position)
+            throw OpenMMException("BinarySerializer: Unexpected end of data");
+        const char* result = data+position;
+        position += bytes;
+        return result;
+    }
+    template <class T>
+    T read() {
+        T value;
+        memcpy(&value, advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+    void align() {
+        advance((ALIGNMENT-position%ALIGNMENT)%ALIGNMENT);
+    }
+    size_t getRemainingBytes() const {
+        return size-position;
+    }
+    const string& readString() {
+        unsigned int index = read<unsigned int>();
+        if (index >= strings->size())
+            throw OpenMMException("BinarySerializer: Illegal string index");
+        return (*strings)[index];
+    }
+    const shared_ptr<const vector<string> >& getStrings() const {
+        return strings;
+    }
+private:
+    const char* data;
+    size_t size, position;
+    shared_ptr<const vector<string> > strings;
+};
+
+void BinarySerializer::serialize(const SerializationNode& node, std::ostream& stream) {
+    Writer nodes;
+    encodeNode(node, nodes);
+    Writer header;
+    for (char c : MAGIC)
+        header.write(c);
+    header.write<int>(VERSION);
+    header.write<int>(BYTE_ORDER_MARK);
+    header.write<unsigned int>(nodes.strings.size());
+    for (const string& str : nodes.strings) {
+        header.write<unsigned int>(str.size());
+        header.buffer.insert(header.buffer.end(), str.begin(), str.end());
+    }
+    header.align();
+    stream.write(&header.buffer[0], header.buffer.size());
+    stream.write(&nodes.buffer[0], nodes.buffer.size());
+}
+
+bool BinarySerializer::isSameStructure(const SerializationNode& node1, const SerializationNode& node2) {
+    if (node1.children.size() != 0 || node2.children.size() != 0 || node1.properties.size() != node2.properties.size() || node1.name != node2.name)
+        return false;
+    auto iter1 = node1.properties.begin();
+    auto iter2 = node2.properties.begin();
+    for (; iter1 != node1.properties.end(); ++iter1, ++iter2)
+        if (iter1->first != iter2->first || iter1->second.type != iter2->second.type)
+            return false;
+    return true;
+}
+
+void BinarySerializer::encodeNode(const SerializationNode& node, Writer& writer) {
+    writer.write<unsigned int>(writer.getStringIndex(node.name));
+    writer.write<unsigned int>(node.properties.size());
+    for (auto& prop : node.properties) {
+        writer.write<unsigned int>(writer.getStringIndex(prop.first));
+        writer.write<char>(prop.second.type);
+        encodeValue(prop.second, writer);
+    }
+
+    // Divide the children into groups.  Consecutive leaf nodes with the same structure are stored
+    // together as a table.
+
+    const vector<SerializationNode>& children = node.children;
+    vector<int> groupStart;
+    for (int i = 0; i < children.size(); ) {
+        int end = i+1;
+        if (children[i].properties.size() > 0)
+            while (end < children.size() && isSameStructure(children[i], children[end]))
+                end++;
+        groupStart.push_back(i);
+        i = end;
+    }
+    groupStart.push_back(children.size());
+    writer.write<unsigned int>(groupStart.size()-1);
+    for (int i = 0; i < groupStart.size()-1; i++) {
+        if (groupStart[i+1]-groupStart[i] == 1) {
+            writer.write<char>(SINGLE_NODE);
+            encodeNode(children[groupStart[i]], writer);
+        }
+        else {
+            writer.write<char>(NODE_TABLE);
+            encodeTable(node, groupStart[i], groupStart[i+1], writer);
+        }
+    }
+}
+
+void BinarySerializer::encodeTable(const SerializationNode& node, int start, int end, Writer& writer) {
+    const SerializationNode& first = node.children[start];
+    writer.write<unsigned int>(end-start);
+    writer.write<unsigned int>(writer.getStringIndex(first.name));
+    writer.write<unsigned int>(first.properties.size());
+    for (auto& prop : first.properties) {
+        writer.write<unsigned int>(writer.getStringIndex(prop.first));
+        writer.write<char>(prop.second.type);
+    }
+    for (auto& prop : first.properties) {
+        writer.align();
+        for (int i = start; i < end; i++)
+            encodeValue(node.children[i].properties.find(prop.first)->second, writer);
+    }
+    writer.align();
+}
+
+void BinarySerializer::encodeValue(const SerializationNode::Property& value, Writer& writer) {
+    if (value.type == SerializationNode::Property::Int)
+        writer.write<long long>(value.intValue);
+    else if (value.type == SerializationNode::Property::Double)
+        writer.write<double>(value.doubleValue);
+    else
+        writer.write<unsigned int>(writer.getStringIndex(value.stringValue));
+}
+
+void* BinarySerializer::deserializeStream(std::istream& stream) {
+    vector<char> data((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+    return deserializeBuffer(data.data(), data.size());
+}
+
+void* BinarySerializer::deserializeBuffer(const char* data, size_t size) {
+    shared_ptr<vector<string> > strings = make_shared<vector<string> >();
+    Reader reader(data, size, strings);
+    if (memcmp(reader.advance(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)) != 0)
+        throw OpenMMException("BinarySerializer: The data is not in OpenMM binary serialization format");
+    if (reader.read<int>() != VERSION)
+        throw OpenMMException("BinarySerializer: Unsupported format version");
+    if (reader.read<int>() != BYTE_ORDER_MARK)
+        throw OpenMMException("BinarySerializer: The data was written on a computer with a different byte order");
+    unsigned int numStrings = reader.read<unsigned int>();
+    if (numStrings > reader.getRemainingBytes()/sizeof(int))
+        throw OpenMMException("BinarySerializer: Unexpected end of data");
+    strings->resize(numStrings);
+    for (string& str : *strings) {
+        unsigned int length = reader.read<unsigned int>();
+        str.assign(reader.advance(length), length);
+    }
+    reader.align();
+
+    // Decode the nodes, then process them.
+
+    SerializationNode root;
+    decodeNode(root, reader);
+    const SerializationProxy& proxy = SerializationProxy::getProxy(root.getStringProperty("type"));
+    return proxy.deserialize(root);
+}
+
+void* BinarySerializer::deserializeMappedFile(const std::string& filename) {
+#if defined(_WIN32)
+    ifstream stream(filename.c_str(), ios::in | ios::binary);
+    if (!stream.is_open())
+        throw OpenMMException("BinarySerializer: Failed to open file "+filename);
+    return deserializeStream(stream);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw OpenMMException("BinarySerializer: Failed to open file "+filename);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw OpenMMException("BinarySerializer: Failed to read file "+filename);
+    }
+    size_t size = info.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw OpenMMException("BinarySerializer: Failed to map file "+filename);
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+    try {
+        void* result = deserializeBuffer((const char*) data, size);
+        munmap(data, size);
+        return result;
+    }
+    catch (...) {
+        munmap(data, size);
+        throw;
+    }
+#endif
+}
+
+void BinarySerializer::decodeNode(SerializationNode& node, Reader& reader) {
+    node.name = reader.readString();
+    unsigned int numProperties = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < numProperties; i++) {
+        const string& name = reader.readString();
+        int type = reader.read<char>();
+        auto iter = node.properties.emplace_hint(node.properties.end(), name, SerializationNode::Property());
+        decodeValue(iter->second, type, reader);
+    }
+    node.stringPropertiesValid = (numProperties == 0);
+    unsigned int numGroups = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < numGroups; i++) {
+        char groupType = reader.read<char>();
+        if (groupType == SINGLE_NODE)
+            decodeNode(node.createChildNode(""), reader);
+        else if (groupType == NODE_TABLE)
+            decodeTable(node, reader);
+        else
+            throw OpenMMException("BinarySerializer: Illegal group type");
+    }
+}
+
+void BinarySerializer::decodeTable(SerializationNode& node, Reader& reader) {
+    unsigned int numNodes = reader.read<unsigned int>();
+    const string& name = reader.readString();
+    unsigned int numColumns = reader.read<unsigned int>();
+    if (numColumns == 0 || numColumns > reader.getRemainingBytes() || numNodes > reader.getRemainingBytes()/(numColumns*sizeof(int)))
+        throw OpenMMException("BinarySerializer: Unexpected end of data");
+
+    // The nodes all share a single copy of the table, which stores the values of each column contiguously.
+
+    shared_ptr<SerializationNode::Table> table = make_shared<SerializationNode::Table>();
+    table->numRows = numNodes;
+    table->columnNames.resize(numColumns);
+    table->columnTypes.resize(numColumns);
+    for (unsigned int i = 0; i < numColumns; i++) {
+        table->columnNames[i] = reader.readString();
+        int type = reader.read<char>();
+        if (type != SerializationNode::Property::Int && type != SerializationNode::Property::Double && type != SerializationNode::Property::String)
+            throw OpenMMException("BinarySerializer: Illegal property type");
+        table->columnTypes[i] = (SerializationNode::Property::Type) type;
+    }
+    table->values.resize((size_t) numNodes*numColumns);
+    table->strings = reader.getStrings();
+    for (unsigned int i = 0; i < numColumns; i++) {
+        reader.align();
+        SerializationNode::Table::Value* values = &table->values[(size_t) i*numNodes];
+        if (table->columnTypes[i] == SerializationNode::Property::String)
+            for (unsigned int j = 0; j < numNodes; j++)
+                values[j].stringValue = &reader.readString();
+        else {
+            // Integer and double values are both 8 bytes, so the column can be copied directly.
+
+            memcpy(values, reader.advance((size_t) numNodes*sizeof(double)), (size_t) numNodes*sizeof(double));
+        }
+    }
+    reader.align();
+    vector<SerializationNode>& children = node.children;
+    children.reserve(children.size()+numNodes);
+    for (unsigned int i = 0; i < numNodes; i++) {
+        children.push_back(SerializationNode());
+        SerializationNode& child = children.back();
+        child.name = name;
+        child.table = table;
+        child.tableRow = i;
+        child.stringPropertiesValid = false;
+    }
+}
+
+void BinarySerializer::decodeValue(SerializationNode::Property& value, int type, Reader& reader) {
+    if (type == SerializationNode::Property::Int)
+        value.intValue = reader.read<long long>();
+    else if (type == SerializationNode::Property::Double)
+        value.doubleValue = reader.read<double>();
+    else if (type == SerializationNode::Property::String)
+        value.stringValue = reader.readString();
+    else
+        throw OpenMMException("BinarySerializer: Illegal property type");
+    value.type = (SerializationNode::Property::Type) type;
+}
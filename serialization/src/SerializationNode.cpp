@@ -31,6 +31,7 @@
 
 #include "openmm/serialization/SerializationNode.h"
 #include "openmm/OpenMMException.h"
+#include <mutex>
 #include <sstream>
 
 using namespace OpenMM;
@@ -39,6 +40,148 @@ using namespace std;
 extern "C" char* g_fmt(char*, double);
 extern "C" double strtod2(const char* s00, char** se);
 
+// Converting numeric properties to strings fills in caches from const methods.  These locks make it safe
+// for several threads to read the same node at once.
+
+static mutex stringValueLock, stringPropertiesLock;
+
+SerializationNode::SerializationNode() : stringPropertiesValid(true), tableRow(0) {
+}
+
+const string& SerializationNode::Property::getString() const {
+    if (type == String)
+        return stringValue;
+    lock_guard<mutex> lock(stringValueLock);
+    if (stringValue.empty()) {
+        if (type == Int) {
+            stringstream s;
+            s << intValue;
+            stringValue = s.str();
+        }
+        else {
+            char buffer[32];
+            g_fmt(buffer, doubleValue);
+            stringValue = string(buffer);
+        }
+    }
+    return stringValue;
+}
+
+long long SerializationNode::Property::getLong() const {
+    if (type == Int)
+        return intValue;
+    if (type == Double)
+        return (long long) doubleValue;
+    long long value;
+    stringstream(stringValue) >> value;
+    return value;
+}
+
+bool SerializationNode::Property::getBool() const {
+    if (type == Int)
+        return (intValue != 0);
+    if (type == Double)
+        return (doubleValue != 0.0);
+    bool value;
+    stringstream(stringValue) >> value;
+    return value;
+}
+
+double SerializationNode::Property::getDouble() const {
+    if (type == Double)
+        return doubleValue;
+    if (type == Int)
+        return (double) intValue;
+    return strtod2(stringValue.c_str(), NULL);
+}
+
+int SerializationNode::Table::findColumn(const string& name) const {
+    for (int i = 0; i < columnNames.size(); i++)
+        if (columnNames[i] == name)
+            return i;
+    return -1;
+}
+
+const string& SerializationNode::Table::getString(int row, int column) const {
+    size_t index = (size_t) column*numRows+row;
+    if (columnTypes[column] == Property::String)
+        return *values[index].stringValue;
+    Property prop;
+    prop.type = columnTypes[column];
+    if (prop.type == Property::Int)
+        prop.intValue = values[index].intValue;
+    else
+        prop.doubleValue = values[index].doubleValue;
+    string value = prop.getString();
+    lock_guard<mutex> lock(stringValueLock);
+    string& cached = stringCache[index];
+    if (cached.empty())
+        cached = value;
+    return cached;
+}
+
+SerializationNode::Property& SerializationNode::setProperty(const string& name, Property::Type type) {
+    if (table) {
+        // This node is about to be modified, so give it its own copy of the values from the table.
+
+        for (int i = 0; i < table->columnNames.size(); i++)
+            getTableValue(i, properties[table->columnNames[i]]);
+        table.reset();
+    }
+    Property& prop = properties[name];
+    prop.type = type;
+    prop.stringValue.clear();
+    stringPropertiesValid = false;
+    return prop;
+}
+
+bool SerializationNode::findProperty(const string& name, Property& value) const {
+    map<string, Property>::const_iterator iter = properties.find(name);
+    if (iter != properties.end()) {
+        // Only copy the string if it is the actual value.  For other types it is a cache that another
+        // thread could be filling in.
+
+        value.type = iter->second.type;
+        if (value.type == Property::String)
+            value.stringValue = iter->second.stringValue;
+        else if (value.type == Property::Int)
+            value.intValue = iter->second.intValue;
+        else
+            value.doubleValue = iter->second.doubleValue;
+        return true;
+    }
+    if (!table)
+        return false;
+    int column = table->findColumn(name);
+    if (column == -1)
+        return false;
+    getTableValue(column, value);
+    return true;
+}
+
+void SerializationNode::getTableValue(int column, Property& value) const {
+    const Table::Value& tableValue = table->values[(size_t) column*table->numRows+tableRow];
+    value.type = table->columnTypes[column];
+    if (value.type == Property::String)
+        value.stringValue = *tableValue.stringValue;
+    else if (value.type == Property::Int)
+        value.intValue = tableValue.intValue;
+    else
+        value.doubleValue = tableValue.doubleValue;
+}
+
+const string* SerializationNode::findStringProperty(const string& name) const {
+    map<string, Property>::const_iterator iter = properties.find(name);
+    if (iter != properties.end())
+        return &iter->second.getString();
+    if (!table)
+        return NULL;
+    int column = table->findColumn(name);
+    if (column == -1)
+        return NULL;
+    return &table->getString(tableRow, column);
+}
+
 const string& SerializationNode::getName() const {
     return name;
 }
@@ -70,125 +213,115 @@ SerializationNode& SerializationNode::getChildNode(const std::string& name) {
 }
 
 const map<string, string>& SerializationNode::getProperties() const {
-    return properties;
+    lock_guard<mutex> lock(stringPropertiesLock);
+    if (!stringPropertiesValid) {
+        stringProperties.clear();
+        for (auto& prop : properties)
+            stringProperties.insert(stringProperties.end(), make_pair(prop.first, prop.second.getString()));
+        if (table)
+            for (int i = 0; i < table->columnNames.size(); i++)
+                stringProperties.insert(make_pair(table->columnNames[i], table->getString(tableRow, i)));
+        stringPropertiesValid = true;
+    }
+    return stringProperties;
 }
 
 bool SerializationNode::hasProperty(const string& name) const {
-    return (properties.find(name) != properties.end());
+    return (properties.find(name) != properties.end() || (table && table->findColumn(name) != -1));
 }
 
 const string& SerializationNode::getStringProperty(const string& name) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    const string* value = findStringProperty(name);
+    if (value == NULL)
         throw OpenMMException("Unknown property '"+name+"' in node '"+getName()+"'");
-    return iter->second;
+    return *value;
 }
 
 const string& SerializationNode::getStringProperty(const string& name, const string& defaultValue) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    const string* value = findStringProperty(name);
+    if (value == NULL)
         return defaultValue;
-    return iter->second;
+    return *value;
 }
 
 SerializationNode& SerializationNode::setStringProperty(const string& name, const string& value) {
-    properties[name] = value;
+    setProperty(name, Property::String).stringValue = value;
     return *this;
 }
 
 int SerializationNode::getIntProperty(const string& name) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         throw OpenMMException("Unknown property '"+name+"' in node '"+getName()+"'");
-    int value;
-    stringstream(iter->second) >> value;
-    return value;
+    return (int) prop.getLong();
 }
 
 int SerializationNode::getIntProperty(const string& name, int defaultValue) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         return defaultValue;
-    int value;
-    stringstream(iter->second) >> value;
-    return value;
+    return (int) prop.getLong();
 }
 
 SerializationNode& SerializationNode::setIntProperty(const string& name, int value) {
-    stringstream s;
-    s << value;
-    properties[name] = s.str();
+    setProperty(name, Property::Int).intValue = value;
     return *this;
 }
 
 long long SerializationNode::getLongProperty(const string& name) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         throw OpenMMException("Unknown property '"+name+"' in node '"+getName()+"'");
-    long long value;
-    stringstream(iter->second) >> value;
-    return value;
+    return prop.getLong();
 }
 
 long long SerializationNode::getLongProperty(const string& name, long long defaultValue) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         return defaultValue;
-    long long value;
-    stringstream(iter->second) >> value;
-    return value;
+    return prop.getLong();
 }
 
 SerializationNode& SerializationNode::setLongProperty(const string& name, long long value) {
-    stringstream s;
-    s << value;
-    properties[name] = s.str();
+    setProperty(name, Property::Int).intValue = value;
     return *this;
 }
 
 bool SerializationNode::getBoolProperty(const string& name) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         throw OpenMMException("Unknown property '"+name+"' in node '"+getName()+"'");
-    bool value;
-    stringstream(iter->second) >> value;
-    return value;
+    return prop.getBool();
 }
 
 bool SerializationNode::getBoolProperty(const string& name, bool defaultValue) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         return defaultValue;
-    bool value;
-    stringstream(iter->second) >> value;
-    return value;
+    return prop.getBool();
 }
 
 SerializationNode& SerializationNode::setBoolProperty(const string& name, bool value) {
-    stringstream s;
-    s << value;
-    properties[name] = s.str();
+    setProperty(name, Property::Int).intValue = (value ? 1 : 0);
     return *this;
 }
 
 double SerializationNode::getDoubleProperty(const string& name) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         throw OpenMMException("Unknown property '"+name+"' in node '"+getName()+"'");
-    return strtod2(iter->second.c_str(), NULL);
+    return prop.getDouble();
 }
 
 double SerializationNode::getDoubleProperty(const string& name, double defaultValue) const {
-    map<string, string>::const_iterator iter = properties.find(name);
-    if (iter == properties.end())
+    Property prop;
+    if (!findProperty(name, prop))
         return defaultValue;
-    return strtod2(iter->second.c_str(), NULL);
+    return prop.getDouble();
 }
 
 SerializationNode& SerializationNode::setDoubleProperty(const string& name, double value) {
-    char buffer[32];
-    g_fmt(buffer, value);
-    properties[name] = string(buffer);
+    setProperty(name, Property::Double).doubleValue = value;
     return *this;
 }
 
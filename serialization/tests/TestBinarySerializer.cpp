@@ -0,0 +1,271 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/CustomIntegrator.h"
+#include "openmm/CustomNonbondedForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/System.h"
+#include "openmm/TabulatedFunction.h"
+#include "openmm/VerletIntegrator.h"
+#include "openmm/VirtualSite.h"
+#include "openmm/serialization/BinarySerializer.h"
+#include "openmm/serialization/SerializationProxy.h"
+#include "openmm/serialization/XmlSerializer.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * Serialize an object as XML.  Two objects are considered identical if their XML representations match.
+ */
+template <class T>
+string toXml(const T& object, const string& rootName) {
+    stringstream buffer;
+    XmlSerializer::serialize<T>(&object, rootName, buffer);
+    return buffer.str();
+}
+
+/**
+ * An object that just holds a SerializationNode.  Its proxy keeps the node it is deserialized from, so the
+ * nodes created by BinarySerializer can be examined directly.
+ */
+class NodeHolder {
+public:
+    SerializationNode node;
+};
+
+class NodeHolderProxy : public SerializationProxy {
+public:
+    NodeHolderProxy() : SerializationProxy("NodeHolder") {
+    }
+    void serialize(const void* object, SerializationNode& node) const {
+        node.getChildren() = reinterpret_cast<const NodeHolder*>(object)->node.getChildren();
+    }
+    void* deserialize(const SerializationNode& node) const {
+        NodeHolder* holder = new NodeHolder();
+        holder->node = node;
+        return holder;
+    }
+};
+
+System* createSystem() {
+    const int numParticles = 1000;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(5, 0, 0), Vec3(0, 5.1, 0), Vec3(0.3, 0.2, 5.2));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::PME);
+    nonbonded->addGlobalParameter("scale", 0.5);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    CustomNonbondedForce* custom = new CustomNonbondedForce("a*tab(r)*(sigma1+sigma2)");
+    custom->addGlobalParameter("a", 1.5);
+    custom->addPerParticleParameter("sigma");
+    custom->addTabulatedFunction("tab", new Continuous1DFunction({1.0, 0.5, 0.25, 0.1}, 0.0, 2.0));
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(i == 5 ? 0.0 : 1.0+0.1*(i%7)+1.0/3.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.417 : -0.834, 0.3+0.001*i, 0.6364/(i+1));
+        custom->addParticle({0.1*sin((double) i)});
+        if (i > 0) {
+            bonds->addBond(i-1, i, 0.1+1e-5*i, 1e5);
+            nonbonded->addException(i-1, i, 0.0, 1.0, 0.0);
+        }
+    }
+    for (int i = 0; i < numParticles; i += 10)
+        system->addConstraint(i, i+1, 0.1);
+    system->setVirtualSite(5, new TwoParticleAverageSite(3, 4, 0.3, 0.7));
+    system->addForce(nonbonded);
+    system->addForce(bonds);
+    system->addForce(custom);
+    return system;
+}
+
+void testSystem() {
+    System* system = createSystem();
+    stringstream buffer;
+    BinarySerializer::serialize<System>(system, "System", buffer);
+    System* copy = BinarySerializer::deserialize<System>(buffer);
+    ASSERT_EQUAL(toXml(*system, "System"), toXml(*copy, "System"));
+    ASSERT(buffer.str().size() < toXml(*system, "System").size()/2);
+
+    // Deserializing from a block of memory should produce the same result.
+
+    string data = buffer.str();
+    System* copy2 = BinarySerializer::deserialize<System>(data.c_str(), data.size());
+    ASSERT_EQUAL(toXml(*system, "System"), toXml(*copy2, "System"));
+    delete system;
+    delete copy;
+    delete copy2;
+}
+
+void testIntegrator() {
+    CustomIntegrator integrator(0.002);
+    integrator.addGlobalVariable("temp", 300.0);
+    integrator.addPerDofVariable("oldx", 0.0);
+    integrator.addComputePerDof("oldx", "x");
+    integrator.addComputePerDof("v", "v+dt*f/m");
+    integrator.addComputePerDof("x", "x+dt*v");
+    integrator.addConstrainPositions();
+    integrator.addComputePerDof("v", "(x-oldx)/dt");
+    integrator.setRandomNumberSeed(123456789);
+    stringstream buffer;
+    BinarySerializer::serialize<Integrator>(&integrator, "Integrator", buffer);
+    Integrator* copy = BinarySerializer::deserialize<Integrator>(buffer);
+    ASSERT_EQUAL(toXml<Integrator>(integrator, "Integrator"), toXml(*copy, "Integrator"));
+    delete copy;
+}
+
+void testState() {
+    System* system = createSystem();
+    VerletIntegrator integrator(0.001);
+    Context context(*system, integrator, Platform::getPlatformByName("Reference"));
+    vector<Vec3> positions, velocities;
+    for (int i = 0; i < system->getNumParticles(); i++) {
+        positions.push_back(Vec3(0.1*(i%10), 0.1*((i/10)%10), 0.1*(i/100)));
+        velocities.push_back(Vec3(sin((double) i), cos((double) i), 0.1));
+    }
+    context.setPositions(positions);
+    context.setVelocities(velocities);
+    context.setTime(1.5);
+    State state = context.getState(State::Positions | State::Velocities | State::Parameters);
+    stringstream buffer;
+    BinarySerializer::serialize<State>(&state, "State", buffer);
+    State* copy = BinarySerializer::deserialize<State>(buffer);
+    ASSERT_EQUAL(toXml(state, "State"), toXml(*copy, "State"));
+    for (int i = 0; i < system->getNumParticles(); i++) {
+        ASSERT_EQUAL_VEC(state.getPositions()[i], copy->getPositions()[i], 0);
+        ASSERT_EQUAL_VEC(state.getVelocities()[i], copy->getVelocities()[i], 0);
+    }
+    delete copy;
+    delete system;
+}
+
+void testFile() {
+    System* system = createSystem();
+    string filename = "TestBinarySerializer.bin";
+    {
+        ofstream stream(filename.c_str(), ios::out | ios::binary);
+        BinarySerializer::serialize<System>(system, "System", stream);
+    }
+    System* copy = BinarySerializer::deserializeFile<System>(filename);
+    remove(filename.c_str());
+    ASSERT_EQUAL(toXml(*system, "System"), toXml(*copy, "System"));
+    delete system;
+    delete copy;
+}
+
+void testTableNodes() {
+    // Leaf nodes that were stored as a table should support all the same operations as other nodes.
+
+    SerializationProxy::registerProxy(typeid(NodeHolder), new NodeHolderProxy());
+    NodeHolder holder;
+    for (int i = 0; i < 3; i++)
+        holder.node.createChildNode("Row").setIntProperty("i", i).setDoubleProperty("x", 0.5*i).setStringProperty("s", "row"+to_string(i));
+    stringstream buffer;
+    BinarySerializer::serialize<NodeHolder>(&holder, "Holder", buffer);
+    NodeHolder* copy = BinarySerializer::deserialize<NodeHolder>(buffer);
+    vector<SerializationNode>& rows = copy->node.getChildren();
+    ASSERT_EQUAL(3, rows.size());
+    for (int i = 0; i < 3; i++) {
+        SerializationNode& row = rows[i];
+        ASSERT_EQUAL("Row", row.getName());
+        ASSERT(row.hasProperty("x"));
+        ASSERT(!row.hasProperty("y"));
+        ASSERT_EQUAL(i, row.getIntProperty("i"));
+        ASSERT_EQUAL(0.5*i, row.getDoubleProperty("x"));
+        ASSERT_EQUAL(0.5*i, row.getDoubleProperty("x", 1.0));
+        ASSERT_EQUAL(1.0, row.getDoubleProperty("y", 1.0));
+        ASSERT_EQUAL("row"+to_string(i), row.getStringProperty("s"));
+        ASSERT_EQUAL(to_string(i), row.getStringProperty("i"));
+        ASSERT_EQUAL(3, row.getProperties().size());
+        ASSERT_EQUAL(to_string(i), row.getProperties().at("i"));
+
+        // Modifying a node should not affect the other values in it.
+
+        row.setIntProperty("i", 10+i);
+        ASSERT_EQUAL(10+i, row.getIntProperty("i"));
+        ASSERT_EQUAL(0.5*i, row.getDoubleProperty("x"));
+        ASSERT_EQUAL("row"+to_string(i), row.getStringProperty("s"));
+        ASSERT_EQUAL(to_string(10+i), row.getProperties().at("i"));
+    }
+    delete copy;
+}
+
+void testInvalidData() {
+    // Data in the wrong format should be rejected.
+
+    System* system = createSystem();
+    stringstream xml(toXml(*system, "System"));
+    bool succeeded = false;
+    try {
+        delete BinarySerializer::deserialize<System>(xml);
+        succeeded = true;
+    }
+    catch (const exception& ex) {
+    }
+    ASSERT_EQUAL(false, succeeded);
+
+    // So should data that has been truncated.
+
+    stringstream buffer;
+    BinarySerializer::serialize<System>(system, "System", buffer);
+    string data = buffer.str();
+    try {
+        delete BinarySerializer::deserialize<System>(data.c_str(), data.size()/2);
+        succeeded = true;
+    }
+    catch (const exception& ex) {
+    }
+    ASSERT_EQUAL(false, succeeded);
+    delete system;
+}
+
+int main() {
+    try {
+        testSystem();
+        testIntegrator();
+        testState();
+        testFile();
+        testTableNodes();
+        testInvalidData();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
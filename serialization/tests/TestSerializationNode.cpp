@@ -32,6 +32,8 @@
 #include "openmm/internal/AssertionUtilities.h"
 #include "openmm/serialization/SerializationNode.h"
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace OpenMM;
 using namespace std;
@@ -75,9 +77,60 @@ void testProperties() {
     ASSERT_EQUAL(false, node.hasProperty("prop2"));
 }
 
+void testConversions() {
+    SerializationNode node;
+    node.setIntProperty("prop1", 12);
+    node.setDoubleProperty("prop2", 2.5);
+    node.setBoolProperty("prop3", true);
+    node.setStringProperty("prop4", "7");
+    ASSERT_EQUAL("12", node.getStringProperty("prop1"));
+    ASSERT_EQUAL(12.0, node.getDoubleProperty("prop1"));
+    ASSERT_EQUAL("2.5", node.getStringProperty("prop2"));
+    ASSERT_EQUAL(2, node.getIntProperty("prop2"));
+    ASSERT_EQUAL("1", node.getStringProperty("prop3"));
+    ASSERT_EQUAL(7, node.getIntProperty("prop4"));
+    ASSERT_EQUAL(7.0, node.getDoubleProperty("prop4"));
+    const map<string, string>& properties = node.getProperties();
+    ASSERT_EQUAL(4, properties.size());
+    ASSERT_EQUAL("12", properties.at("prop1"));
+    ASSERT_EQUAL("2.5", properties.at("prop2"));
+    node.setDoubleProperty("prop1", 0.5);
+    ASSERT_EQUAL(0.5, node.getDoubleProperty("prop1"));
+    ASSERT_EQUAL(node.getStringProperty("prop1"), node.getProperties().at("prop1"));
+}
+
+void testConcurrentReads() {
+    // Several threads convert the same numeric properties to strings at once.
+
+    const int numProperties = 1000;
+    const int numThreads = 4;
+    SerializationNode node;
+    for (int i = 0; i < numProperties; i++)
+        node.setDoubleProperty("prop"+to_string(i), 0.25*i);
+    const SerializationNode& constNode = node;
+    vector<int> errors(numThreads, 0);
+    vector<thread> threads;
+    for (int t = 0; t < numThreads; t++)
+        threads.push_back(thread([&, t] () {
+            for (int i = 0; i < numProperties; i++) {
+                string name = "prop"+to_string(i);
+                if (stod(constNode.getStringProperty(name)) != 0.25*i)
+                    errors[t]++;
+            }
+            if (constNode.getProperties().size() != numProperties)
+                errors[t]++;
+        }));
+    for (auto& t : threads)
+        t.join();
+    for (int t = 0; t < numThreads; t++)
+        ASSERT_EQUAL(0, errors[t]);
+}
+
 int main() {
     try {
         testProperties();
+        testConversions();
+        testConcurrentReads();
     }
     catch(const exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -53,6 +53,7 @@ void testSerialization() {
     force.setUseDispersionCorrection(false);
     force.setExceptionsUsePeriodicBoundaryConditions(true);
     force.setIncludeDirectSpace(false);
+    force.setPMEInterpolationOrder(6);
     double alpha = 0.5;
     int nx = 3, ny = 5, nz = 7;
     force.setPMEParameters(alpha, nx, ny, nz);
@@ -94,6 +95,7 @@ void testSerialization() {
     ASSERT_EQUAL(force.getNumParticleParameterOffsets(), force2.getNumParticleParameterOffsets());
     ASSERT_EQUAL(force.getNumExceptionParameterOffsets(), force2.getNumExceptionParameterOffsets());
     ASSERT_EQUAL(force.getIncludeDirectSpace(), force2.getIncludeDirectSpace());
+    ASSERT_EQUAL(force.getPMEInterpolationOrder(), force2.getPMEInterpolationOrder());
     double alpha2;
     int nx2, ny2, nz2;
     force2.getPMEParameters(alpha2, nx2, ny2, nz2);
@@ -44,6 +44,7 @@
 #include "sfmt/SFMT.h"
 #include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 using namespace OpenMM;
@@ -268,6 +269,60 @@ void testMolecules() {
     }
 }
 
+void testManyCVs() {
+    // Use many collective variables, some of which have zero derivative, and verify that
+    // energies and forces are combined correctly.
+
+    const int numCVs = 8;
+    System system;
+    for (int i = 0; i <= numCVs; i++)
+        system.addParticle(1.0);
+    string energy = "0";
+    for (int i = 0; i < numCVs; i++) {
+        stringstream term;
+        term << "+" << (i%3)*0.5 << "*v" << i << "^2";
+        energy += term.str();
+    }
+    CustomCVForce* cv = new CustomCVForce(energy);
+    system.addForce(cv);
+    for (int i = 0; i < numCVs; i++) {
+        CustomBondForce* bond = new CustomBondForce("r");
+        bond->addBond(0, i+1);
+        stringstream name;
+        name << "v" << i;
+        cv->addCollectiveVariable(name.str(), bond);
+    }
+    VerletIntegrator integrator(1.0);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numCVs+1);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    for (int i = 0; i <= numCVs; i++)
+        positions[i] = Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt));
+    context.setPositions(positions);
+
+    // Compute the expected energy and forces.
+
+    double expectedEnergy = 0;
+    vector<Vec3> expectedForces(numCVs+1);
+    for (int i = 0; i < numCVs; i++) {
+        double scale = (i%3)*0.5;
+        Vec3 delta = positions[i+1]-positions[0];
+        double r = sqrt(delta.dot(delta));
+        expectedEnergy += scale*r*r;
+        expectedForces[0] += delta*2*scale;
+        expectedForces[i+1] -= delta*2*scale;
+    }
+
+    // Computing just the energy should give the same result as computing energy and forces.
+
+    ASSERT_EQUAL_TOL(expectedEnergy, context.getState(State::Energy).getPotentialEnergy(), 1e-5);
+    State state = context.getState(State::Energy | State::Forces);
+    ASSERT_EQUAL_TOL(expectedEnergy, state.getPotentialEnergy(), 1e-5);
+    for (int i = 0; i <= numCVs; i++)
+        ASSERT_EQUAL_VEC(expectedForces[i], state.getForces()[i], 1e-5);
+}
+
 void runPlatformTests();
 
 int main(int argc, char* argv[]) {
@@ -278,6 +333,7 @@ int main(int argc, char* argv[]) {
         testTabulatedFunction();
         testReordering();
         testMolecules();
+        testManyCVs();
         runPlatformTests();
     }
     catch(const exception& e) {
@@ -0,0 +1,169 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2015 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/CustomReactionCoordinate.h"
+#include "openmm/OpenMMException.h"
+#include "sfmt/SFMT.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * A reaction coordinate that only implements the required methods, so the buffer interface
+ * uses the default implementations.
+ */
+class ScaledPositionsCoordinate : public ReactionCoordinate {
+public:
+    vector<Vec3> value(const vector<Vec3>& x) {
+        vector<Vec3> result(x.size());
+        for (int i = 0; i < x.size(); i++)
+            result[i] = x[i]*2.0;
+        return result;
+    }
+    vector<Vec3> gradMatMul(const vector<Vec3>& x, const vector<Vec3>& z) {
+        vector<Vec3> result(z.size());
+        for (int i = 0; i < z.size(); i++)
+            result[i] = z[i]*2.0;
+        return result;
+    }
+    double getBiasedEnergy(const vector<Vec3>& x, const vector<Vec3>& z) {
+        return 0.0;
+    }
+};
+
+void testDefaultBufferInterface() {
+    ScaledPositionsCoordinate rc;
+    vector<Vec3> x = {Vec3(1, 2, 3), Vec3(-1, 0.5, 2)};
+    vector<Vec3> z = {Vec3(1, 1, 1)};
+    vector<Vec3> residual, grad;
+    rc.computeResidual(x, z, residual);
+    ASSERT_EQUAL(2, residual.size());
+    ASSERT_EQUAL_VEC(Vec3(1, 3, 5), residual[0], 1e-10);
+    ASSERT_EQUAL_VEC(Vec3(-2, 1, 4), residual[1], 1e-10);
+    rc.computeGradMatMul(x, residual, grad);
+    ASSERT_EQUAL_VEC(Vec3(2, 6, 10), grad[0], 1e-10);
+    ASSERT_EQUAL_VEC(Vec3(-4, 2, 8), grad[1], 1e-10);
+}
+
+void testDistances() {
+    const int numParticles = 20;
+    const int numGroups = 11;
+    CustomReactionCoordinate rc(2, "sqrt((x2-x1)^2+(y2-y1)^2+(z2-z1)^2)");
+    ASSERT_EQUAL(2, rc.getNumParticlesPerGroup());
+    for (int i = 0; i < numGroups; i++)
+        ASSERT_EQUAL(i, rc.addGroup({i, (3*i+1)%numParticles}));
+    ASSERT_EQUAL(numGroups, rc.getNumGroups());
+    vector<int> group;
+    rc.getGroupParameters(4, group);
+    ASSERT_EQUAL(4, group[0]);
+    ASSERT_EQUAL(13, group[1]);
+    OpenMM_SFMT::SFMT sfmt;
+    init_gen_rand(0, sfmt);
+    vector<Vec3> x(numParticles);
+    for (int i = 0; i < numParticles; i++)
+        x[i] = Vec3(genrand_real2(sfmt), genrand_real2(sfmt), genrand_real2(sfmt))*2.0;
+
+    // Check the values against a double precision calculation.  The components are packed three
+    // to an element.
+
+    vector<Vec3> value = rc.value(x);
+    ASSERT_EQUAL((numGroups+2)/3, value.size());
+    for (int i = 0; i < numGroups; i++) {
+        Vec3 delta = x[(3*i+1)%numParticles]-x[i];
+        ASSERT_EQUAL_TOL(sqrt(delta.dot(delta)), value[i/3][i%3], 1e-10);
+    }
+    ASSERT_EQUAL(0.0, value[3][2]);
+
+    // The residual should be the value minus the target.
+
+    vector<Vec3> z(value.size());
+    for (int i = 0; i < z.size(); i++)
+        z[i] = Vec3(0.1*i, 0.2, 0.3);
+    vector<Vec3> residual;
+    rc.computeResidual(x, z, residual);
+    for (int i = 0; i < numGroups; i++)
+        ASSERT_EQUAL_TOL(value[i/3][i%3]-z[i/3][i%3], residual[i/3][i%3], 1e-10);
+
+    // gradMatMul() applied to the residual should be the gradient of the bias energy.
+
+    vector<Vec3> grad;
+    rc.computeGradMatMul(x, residual, grad);
+    ASSERT_EQUAL(numParticles, grad.size());
+    const double step = 1e-3;
+    for (int i = 0; i < numParticles; i++)
+        for (int j = 0; j < 3; j++) {
+            vector<Vec3> x2 = x;
+            x2[i][j] += step;
+            double e1 = rc.getBiasedEnergy(x2, z);
+            x2[i][j] -= 2*step;
+            double e2 = rc.getBiasedEnergy(x2, z);
+            ASSERT_EQUAL_TOL((e1-e2)/(2*step), grad[i][j], 1e-4);
+        }
+}
+
+void testErrors() {
+    CustomReactionCoordinate rc(2, "x1-x2");
+    bool threw = false;
+    try {
+        rc.addGroup({0});
+    }
+    catch (const OpenMMException& ex) {
+        threw = true;
+    }
+    ASSERT(threw);
+    rc.addGroup({0, 5});
+    threw = false;
+    try {
+        rc.value(vector<Vec3>(3));
+    }
+    catch (const OpenMMException& ex) {
+        threw = true;
+    }
+    ASSERT(threw);
+}
+
+int main() {
+    try {
+        testDefaultBufferInterface();
+        testDistances();
+        testErrors();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
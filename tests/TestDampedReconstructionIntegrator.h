@@ -0,0 +1,170 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2008-2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/CustomExternalForce.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/System.h"
+#include "openmm/DampedReconstructionIntegrator.h"
+#include "openmm/ReactionCoordinate.h"
+#include "SimTKOpenMMRealType.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+/**
+ * A reaction coordinate that is simply the particle positions.
+ */
+class IdentityReactionCoordinate : public ReactionCoordinate {
+public:
+    vector<Vec3> value(const vector<Vec3>& x) {
+        return x;
+    }
+    vector<Vec3> gradMatMul(const vector<Vec3>& x, const vector<Vec3>& z) {
+        return z;
+    }
+    double getBiasedEnergy(const vector<Vec3>& x, const vector<Vec3>& z) {
+        double energy = 0.0;
+        for (int i = 0; i < x.size(); i++)
+            energy += 0.5*(x[i]-z[i]).dot(x[i]-z[i]);
+        return energy;
+    }
+};
+
+void testSingleBond() {
+    System system;
+    system.addParticle(2.0);
+    system.addParticle(2.0);
+    IdentityReactionCoordinate rc;
+    DampedReconstructionIntegrator integrator(0, 0, 0.01, 1.0, &rc);
+    HarmonicBondForce* forceField = new HarmonicBondForce();
+    forceField->addBond(0, 1, 1.5, 1);
+    system.addForce(forceField);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(2);
+    positions[0] = Vec3(-1, 0, 0);
+    positions[1] = Vec3(1, 0, 0);
+    context.setPositions(positions);
+
+    // With gamma=1 and no noise this is an overdamped harmonic oscillator, so compare it to the analytical solution.
+
+    double rate = 2.0;
+    for (int i = 0; i < 1000; ++i) {
+        State state = context.getState(State::Positions);
+        double time = state.getTime();
+        double expectedDist = 1.5+0.5*std::exp(-rate*time);
+        ASSERT_EQUAL_VEC(Vec3(-0.5*expectedDist, 0, 0), state.getPositions()[0], 0.02);
+        ASSERT_EQUAL_VEC(Vec3(0.5*expectedDist, 0, 0), state.getPositions()[1], 0.02);
+        integrator.step(1);
+    }
+}
+
+void testBias() {
+    const int numParticles = 10;
+    const double lambda = 5.0;
+    System system;
+    for (int i = 0; i < numParticles; ++i)
+        system.addParticle(1.0);
+    IdentityReactionCoordinate rc;
+    DampedReconstructionIntegrator integrator(0, lambda, 0.001, 0.0, &rc);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numParticles), target(numParticles);
+    for (int i = 0; i < numParticles; ++i) {
+        positions[i] = Vec3(i, 0, 0);
+        target[i] = Vec3(i, 1, -1);
+    }
+    context.setPositions(positions);
+    integrator.setMacroscopicVariable(target);
+
+    // With gamma=0 the biasing potential alone should pull every particle exponentially toward its target.
+
+    integrator.step(500);
+    State state = context.getState(State::Positions);
+    double decay = std::exp(-lambda*state.getTime());
+    for (int i = 0; i < numParticles; ++i)
+        ASSERT_EQUAL_VEC(Vec3(i, 1-decay, -1+decay), state.getPositions()[i], 0.01);
+}
+
+void testTemperature() {
+    const int numParticles = 8;
+    const double temp = 100.0;
+    System system;
+    IdentityReactionCoordinate rc;
+    DampedReconstructionIntegrator integrator(temp, 0, 0.001, 1.0, &rc);
+    CustomExternalForce* forceField = new CustomExternalForce("0.5*k*(x^2+y^2+z^2)");
+    forceField->addGlobalParameter("k", 10.0);
+    for (int i = 0; i < numParticles; ++i) {
+        system.addParticle(1.0);
+        forceField->addParticle(i);
+    }
+    system.addForce(forceField);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numParticles, Vec3());
+    context.setPositions(positions);
+
+    // Let it equilibrate.
+
+    integrator.step(1000);
+
+    // Now run it for a while and see if the potential energy matches the equipartition value.
+
+    double pe = 0.0;
+    const int steps = 20000;
+    for (int i = 0; i < steps; ++i) {
+        State state = context.getState(State::Energy);
+        pe += state.getPotentialEnergy();
+        integrator.step(1);
+    }
+    pe /= steps;
+    double expected = 1.5*numParticles*BOLTZ*temp;
+    ASSERT_USUALLY_EQUAL_TOL(expected, pe, 0.1*expected);
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testSingleBond();
+        testBias();
+        testTemperature();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
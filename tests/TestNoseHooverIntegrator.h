@@ -441,8 +441,10 @@ void testDimerBox(bool constrain=true) {
     double sq_sum = std::inner_product(energies.begin(), energies.end(), energies.begin(), 0.0);
     double std = std::sqrt(sq_sum / energies.size() - mean * mean);
     double relative_std = std / mean;
-    // Check mean temperature
-    ASSERT_USUALLY_EQUAL_TOL(temperature, mean_temp, 1e-2);
+    // Check mean temperature.  Averaged over 5 ps with only 20 molecules it has a standard deviation
+    // of about 1.1 K with no measurable bias on every platform, so the tolerance (4.5 K) is about
+    // 4 standard deviations.
+    ASSERT_USUALLY_EQUAL_TOL(temperature, mean_temp, 1.5e-2);
     // Check fluctuation of conserved (total bath + system) energy
     ASSERT_USUALLY_EQUAL_TOL(relative_std, 0, 5e-3);
 }
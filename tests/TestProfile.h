@@ -0,0 +1,136 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/HarmonicBondForce.h"
+#include "openmm/NonbondedForce.h"
+#include "openmm/System.h"
+#include "openmm/VerletIntegrator.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+System* createProfileSystem(vector<Vec3>& positions) {
+    const int numParticles = 100;
+    const double boxSize = 3.0;
+    System* system = new System();
+    system->setDefaultPeriodicBoxVectors(Vec3(boxSize, 0, 0), Vec3(0, boxSize, 0), Vec3(0, 0, boxSize));
+    NonbondedForce* nonbonded = new NonbondedForce();
+    nonbonded->setNonbondedMethod(NonbondedForce::CutoffPeriodic);
+    nonbonded->setCutoffDistance(1.0);
+    system->addForce(nonbonded);
+    HarmonicBondForce* bonds = new HarmonicBondForce();
+    bonds->setForceGroup(2);
+    system->addForce(bonds);
+    positions.clear();
+    for (int i = 0; i < numParticles; i++) {
+        system->addParticle(1.0);
+        nonbonded->addParticle(i%2 == 0 ? 0.1 : -0.1, 0.2, 0.1);
+        positions.push_back(Vec3((i%5)*0.6, ((i/5)%5)*0.6, (i/25)*0.6));
+        if (i%2 == 1) {
+            bonds->addBond(i-1, i, 0.6, 100.0);
+            nonbonded->addException(i-1, i, 0.0, 1.0, 0.0);
+        }
+    }
+    return system;
+}
+
+void testProfile() {
+    vector<Vec3> positions;
+    System* system = createProfileSystem(positions);
+    VerletIntegrator integrator(0.001);
+    Context context(*system, integrator, platform);
+    context.setPositions(positions);
+
+    // Nothing should be recorded until profiling is enabled.
+
+    ASSERT(!context.getProfilingEnabled());
+    context.getState(State::Energy);
+    ASSERT_EQUAL(0, context.getProfile().size());
+    double energy = context.getState(State::Energy).getPotentialEnergy();
+
+    // Enable it and see whether each Force and force group is recorded.  Profiling should not change the results.
+
+    context.setProfilingEnabled(true);
+    ASSERT(context.getProfilingEnabled());
+    ASSERT_EQUAL_TOL(energy, context.getState(State::Energy).getPotentialEnergy(), 1e-5);
+    integrator.step(4);
+    map<string, double> profile = context.getProfile();
+    map<string, int> counts = context.getProfileCounts();
+    for (string name : {"Begin computation", "Finish computation", "Force 0 (NonbondedForce)", "Force 1 (HarmonicBondForce)", "Force group 0", "Force group 2"}) {
+        ASSERT(profile.find(name) != profile.end());
+        ASSERT(profile[name] >= 0.0);
+        ASSERT_EQUAL(5, counts[name]);
+    }
+    ASSERT(profile.find("Force group 1") == profile.end());
+    ASSERT_EQUAL(counts.size(), profile.size());
+
+    // Resetting it should discard the information, but leave profiling enabled.
+
+    context.resetProfile();
+    ASSERT_EQUAL(0, context.getProfile().size());
+    context.getState(State::Forces, false, 1<<2);
+    ASSERT_EQUAL(1, context.getProfileCounts()["Force group 2"]);
+
+    // Reinitializing the Context should preserve whether profiling is enabled.
+
+    context.reinitialize(true);
+    ASSERT(context.getProfilingEnabled());
+    ASSERT_EQUAL(0, context.getProfile().size());
+    context.getState(State::Energy);
+    ASSERT_EQUAL(1, context.getProfileCounts()["Begin computation"]);
+
+    // Disabling it should stop recording.
+
+    context.setProfilingEnabled(false);
+    context.getState(State::Energy);
+    ASSERT_EQUAL(0, context.getProfile().size());
+    delete system;
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testProfile();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
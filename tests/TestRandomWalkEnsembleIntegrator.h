@@ -0,0 +1,143 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2008-2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/CustomExternalForce.h"
+#include "openmm/System.h"
+#include "openmm/RandomWalkEnsembleIntegrator.h"
+#include "SimTKOpenMMRealType.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+void testHarmonicWell() {
+    const int numChains = 200;
+    const double temp = 300.0;
+    const double k = 100.0;
+    System system;
+    system.addParticle(1.0);
+    CustomExternalForce* force = new CustomExternalForce("0.5*k*(x^2+y^2+z^2)");
+    force->addGlobalParameter("k", k);
+    force->addParticle(0);
+    system.addForce(force);
+    RandomWalkEnsembleIntegrator integrator(numChains, temp, 0.01);
+    Context context(system, integrator, platform);
+    context.setPositions(vector<Vec3>(1));
+    integrator.step(100);
+
+    // Every chain should sample the Boltzmann distribution, for which <r^2> = 3kT/k.
+
+    double meanR2 = 0.0;
+    int numSamples = 0;
+    vector<Vec3> positions;
+    for (int i = 0; i < 10; i++) {
+        integrator.step(10);
+        for (int chain = 0; chain < numChains; chain++) {
+            integrator.getChainPositions(chain, positions);
+            meanR2 += positions[0].dot(positions[0]);
+            numSamples++;
+        }
+    }
+    meanR2 /= numSamples;
+    ASSERT_USUALLY_EQUAL_TOL(3*BOLTZ*temp/k, meanR2, 0.1);
+    for (int chain = 0; chain < numChains; chain++) {
+        ASSERT(integrator.getAcceptanceRate(chain) > 0.0);
+        ASSERT(integrator.getAcceptanceRate(chain) < 1.0);
+    }
+}
+
+void testChainState() {
+    const int numChains = 5;
+    const int numParticles = 3;
+    System system;
+    CustomExternalForce* force = new CustomExternalForce("x^2+2*y^2+3*z^2");
+    for (int i = 0; i < numParticles; i++) {
+        system.addParticle(1.0);
+        force->addParticle(i);
+    }
+    system.addForce(force);
+    RandomWalkEnsembleIntegrator integrator(numChains, 300.0, 0.001);
+    Context context(system, integrator, platform);
+    context.setPositions(vector<Vec3>(numParticles));
+    for (int chain = 0; chain < numChains; chain++) {
+        vector<Vec3> positions(numParticles);
+        for (int i = 0; i < numParticles; i++)
+            positions[i] = Vec3(0.1*chain, 0.2*i, -0.1*chain*i);
+        integrator.setChainPositions(chain, positions);
+        vector<Vec3> stored;
+        integrator.getChainPositions(chain, stored);
+        for (int i = 0; i < numParticles; i++)
+            ASSERT_EQUAL_VEC(positions[i], stored[i], 1e-10);
+    }
+    integrator.step(20);
+    ASSERT_EQUAL(20, integrator.getNumProposed());
+
+    // The energy reported for each chain should match its positions, and the Context should hold chain 0.
+
+    for (int chain = 0; chain < numChains; chain++) {
+        ASSERT(integrator.getNumAccepted(chain) <= 20);
+        vector<Vec3> positions;
+        integrator.getChainPositions(chain, positions);
+        context.setPositions(positions);
+        double energy = context.getState(State::Energy).getPotentialEnergy();
+        ASSERT_EQUAL_TOL(energy, integrator.getChainEnergy(chain), 1e-5);
+    }
+    integrator.step(1);
+    vector<Vec3> chain0;
+    integrator.getChainPositions(0, chain0);
+    State state = context.getState(State::Positions);
+    for (int i = 0; i < numParticles; i++)
+        ASSERT_EQUAL_VEC(chain0[i], state.getPositions()[i], 1e-6);
+    integrator.resetStatistics();
+    ASSERT_EQUAL(0, integrator.getNumProposed());
+    for (int chain = 0; chain < numChains; chain++)
+        ASSERT_EQUAL(0, integrator.getNumAccepted(chain));
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testHarmonicWell();
+        testChainState();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2008-2024 Stanford University and the Authors.      *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/Context.h"
+#include "openmm/CustomExternalForce.h"
+#include "openmm/System.h"
+#include "openmm/RandomWalkIntegrator.h"
+#include "SimTKOpenMMRealType.h"
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+void testDiffusion() {
+    const int numParticles = 1000;
+    const int numSteps = 20;
+    const double temp = 300.0;
+    const double dt = 0.01;
+    System system;
+    for (int i = 0; i < numParticles; ++i)
+        system.addParticle(1.0);
+    RandomWalkIntegrator integrator(temp, dt);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numParticles, Vec3());
+    context.setPositions(positions);
+    integrator.step(numSteps);
+
+    // The mean squared displacement should match free diffusion with D = kT.
+
+    State state = context.getState(State::Positions);
+    double msd = 0.0;
+    for (int i = 0; i < numParticles; ++i)
+        msd += state.getPositions()[i].dot(state.getPositions()[i]);
+    msd /= numParticles;
+    double expected = 6*BOLTZ*temp*dt*numSteps;
+    ASSERT_USUALLY_EQUAL_TOL(expected, msd, 0.1);
+}
+
+void testPeriod() {
+    const int numParticles = 100;
+    const double period = 0.5;
+    System system;
+    for (int i = 0; i < numParticles; ++i)
+        system.addParticle(1.0);
+    RandomWalkIntegrator integrator(300.0, 0.01, period);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numParticles, Vec3());
+    context.setPositions(positions);
+
+    // The step is large compared to the period, so particles will frequently need to be wrapped.
+
+    for (int i = 0; i < 20; ++i) {
+        integrator.step(1);
+        State state = context.getState(State::Positions);
+        for (int j = 0; j < numParticles; ++j)
+            for (int k = 0; k < 3; ++k) {
+                ASSERT(state.getPositions()[j][k] >= -period);
+                ASSERT(state.getPositions()[j][k] <= period);
+            }
+    }
+}
+
+void testAcceptReject() {
+    const int numParticles = 10;
+    System system;
+    CustomExternalForce* force = new CustomExternalForce("x^2+y^2+z^2");
+    for (int i = 0; i < numParticles; ++i) {
+        system.addParticle(1.0);
+        force->addParticle(i);
+    }
+    system.addForce(force);
+    RandomWalkIntegrator integrator(300.0, 0.01);
+    Context context(system, integrator, platform);
+    vector<Vec3> positions(numParticles);
+    for (int i = 0; i < numParticles; ++i)
+        positions[i] = Vec3(0.1*i, 0.2, -0.1*i);
+    context.setPositions(positions);
+    integrator.setupSampler();
+    State initial = context.getState(State::Positions | State::Energy);
+
+    // Rejecting a proposal should restore the positions from before it, even after repeated rejections.
+
+    for (int i = 0; i < 3; ++i) {
+        integrator.step(1);
+        integrator.accepted(false);
+        State state = context.getState(State::Positions | State::Energy);
+        for (int j = 0; j < numParticles; ++j)
+            ASSERT_EQUAL_VEC(initial.getPositions()[j], state.getPositions()[j], 1e-6);
+        ASSERT_EQUAL_TOL(initial.getPotentialEnergy(), state.getPotentialEnergy(), 1e-6);
+    }
+
+    // After accepting a proposal, a rejection should return to the accepted positions.
+
+    integrator.step(1);
+    integrator.accepted(true);
+    State accepted = context.getState(State::Positions);
+    integrator.step(1);
+    integrator.accepted(false);
+    State state = context.getState(State::Positions);
+    for (int j = 0; j < numParticles; ++j)
+        ASSERT_EQUAL_VEC(accepted.getPositions()[j], state.getPositions()[j], 1e-6);
+
+    // Rejecting should also restore the time and periodic box vectors, as setState() did.
+
+    integrator.step(1);
+    context.setPeriodicBoxVectors(Vec3(3, 0, 0), Vec3(0, 3, 0), Vec3(0, 0, 3));
+    integrator.accepted(false);
+    state = context.getState(State::Positions);
+    ASSERT_EQUAL_TOL(accepted.getTime(), state.getTime(), 1e-10);
+    Vec3 a, b, c, a2, b2, c2;
+    accepted.getPeriodicBoxVectors(a, b, c);
+    state.getPeriodicBoxVectors(a2, b2, c2);
+    ASSERT_EQUAL_VEC(a, a2, 0);
+    ASSERT_EQUAL_VEC(b, b2, 0);
+    ASSERT_EQUAL_VEC(c, c2, 0);
+}
+
+void runPlatformTests();
+
+int main(int argc, char* argv[]) {
+    try {
+        initializeTests(argc, argv);
+        testDiffusion();
+        testPeriod();
+        testAcceptReject();
+        runPlatformTests();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+/* -------------------------------------------------------------------------- *
+ *                                   OpenMM                                   *
+ * -------------------------------------------------------------------------- *
+ * This is part of the OpenMM molecular simulation toolkit originating from   *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org.               *
+ *                                                                            *
+ * Portions copyright (c) 2025 Stanford University and the Authors.           *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Permission is hereby granted, free of charge, to any person obtaining a    *
+ * copy of this software and associated documentation files (the "Software"), *
+ * to deal in the Software without restriction, including without limitation  *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,   *
+ * and/or sell copies of the Software, and to permit persons to whom the      *
+ * Software is furnished to do so, subject to the following conditions:       *
+ *                                                                            *
+ * The above copyright notice and this permission notice shall be included in *
+ * all copies or substantial portions of the Software.                        *
+ *                                                                            *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    *
+ * THE AUTHORS, CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,    *
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR      *
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE  *
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.                                     *
+ * -------------------------------------------------------------------------- */
+
+#include "openmm/internal/AssertionUtilities.h"
+#include "openmm/internal/ThreadPool.h"
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+using namespace OpenMM;
+using namespace std;
+
+void testExecute(bool pinThreads) {
+    ThreadPool threads(4, pinThreads);
+    ASSERT_EQUAL(4, threads.getNumThreads());
+    vector<int> counts(4, 0);
+    for (int i = 0; i < 100; i++) {
+        threads.execute([&] (ThreadPool& pool, int threadIndex) {
+            counts[threadIndex]++;
+            pool.syncThreads();
+            counts[threadIndex]++;
+        });
+        threads.waitForThreads();
+        threads.resumeThreads();
+        threads.waitForThreads();
+    }
+    for (int i = 0; i < 4; i++)
+        ASSERT_EQUAL(200, counts[i]);
+}
+
+void testParallelFor() {
+    // Every index should be processed exactly once, regardless of how the range divides
+    // between threads and chunks.
+
+    ThreadPool threads(3);
+    for (int size : {0, 1, 2, 5, 17, 1000}) {
+        for (int grainSize : {1, 3, 64}) {
+            vector<atomic<int> > counts(size);
+            for (auto& c : counts)
+                c = 0;
+            threads.parallelFor(10, 10+size, grainSize, [&] (ThreadPool& pool, int threadIndex, int start, int end) {
+                ASSERT(threadIndex >= 0 && threadIndex < 3);
+                ASSERT(end-start <= grainSize);
+                for (int i = start; i < end; i++)
+                    counts[i-10]++;
+            });
+            for (int i = 0; i < size; i++)
+                ASSERT_EQUAL(1, counts[i]);
+        }
+    }
+}
+
+void testUnbalancedLoad() {
+    // All the expensive iterations are in the first thread's share, so other threads will
+    // take some of them once they finish their own.  Every index must still be processed once.
+
+    ThreadPool threads(4);
+    vector<atomic<int> > counts(40);
+    for (auto& c : counts)
+        c = 0;
+    threads.parallelFor(0, 40, 1, [&] (ThreadPool& pool, int threadIndex, int start, int end) {
+        for (int i = start; i < end; i++) {
+            if (i < 10) {
+                double sum = 0.0;
+                for (int j = 0; j < 1000000; j++)
+                    sum += 1.0/(j+1);
+                ASSERT(sum > 0.0);
+            }
+            counts[i]++;
+        }
+    });
+    for (int i = 0; i < 40; i++)
+        ASSERT_EQUAL(1, counts[i]);
+}
+
+int main() {
+    try {
+        testExecute(false);
+        testExecute(true);
+        testParallelFor();
+        testUnbalancedLoad();
+    }
+    catch(const exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
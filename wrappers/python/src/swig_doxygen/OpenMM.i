@@ -18,6 +18,7 @@ namespace std {
   %template(vectorstring) vector<string>;
   %template(mapstringstring) map<string,string>;
   %template(mapstringdouble) map<string,double>;
+  %template(mapstringint) map<string,int>;
   %template(mapii) map<int,int>;
   %template(seti) set<int>;
 };
@@ -40,6 +41,7 @@ namespace std {
 #include "openmm/serialization/SerializationNode.h"
 #include "openmm/serialization/SerializationProxy.h"
 #include "openmm/serialization/XmlSerializer.h"
+#include "openmm/serialization/BinarySerializer.h"
 
 using namespace OpenMM;
 
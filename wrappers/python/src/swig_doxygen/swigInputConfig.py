@@ -95,6 +95,10 @@ SKIP_METHODS = [('State', 'getPositions'),
                 ('IntegrateDrudeSCFStepKernel',),
                 ('XmlSerializer',  'serialize'),
                 ('XmlSerializer',  'deserialize'),
+                ('BinarySerializer',  'serialize'),
+                ('BinarySerializer',  'deserialize'),
+                ('BinarySerializer',  'deserializeFile'),
+                ('LocalEnergyMinimizer',  'minimizeBatch'),
                 ('LocalCoordinatesSite',  'getOriginWeights', 0),
                 ('LocalCoordinatesSite',  'getXWeights', 0),
                 ('LocalCoordinatesSite',  'getYWeights', 0),
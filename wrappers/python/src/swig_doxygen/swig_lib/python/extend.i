@@ -128,6 +128,77 @@ Parameters:
   }
 }
 
+%fragment("Py_SequenceToVecVec3");
+%extend OpenMM::LocalEnergyMinimizer {
+  static PyObject* _minimizeBatch(OpenMM::Context& context, PyObject* positions, double tolerance, int maxIterations) {
+      std::vector<std::vector<Vec3> > conformations;
+      PyObject* iterator = PyObject_GetIter(positions);
+      if (iterator == NULL)
+          throw OpenMMException("minimizeBatch: positions must be a list of conformations");
+      PyObject* item;
+      while ((item = PyIter_Next(iterator)) != NULL) {
+          conformations.push_back(std::vector<Vec3>());
+          int res = Py_SequenceToVecVec3(item, conformations.back());
+          Py_DECREF(item);
+          if (!SWIG_IsOK(res)) {
+              Py_DECREF(iterator);
+              throw OpenMMException("minimizeBatch: each conformation must be a list of Vec3");
+          }
+      }
+      Py_DECREF(iterator);
+      std::vector<double> energies;
+      PyThreadState* _savePythonThreadState = PyEval_SaveThread();
+      try {
+          OpenMM::LocalEnergyMinimizer::minimizeBatch(context, conformations, energies, tolerance, maxIterations);
+      }
+      catch (...) {
+          PyEval_RestoreThread(_savePythonThreadState);
+          throw;
+      }
+      PyEval_RestoreThread(_savePythonThreadState);
+      PyObject* positionList = PyList_New(conformations.size());
+      PyObject* energyList = PyList_New(energies.size());
+      for (int i = 0; i < conformations.size(); i++) {
+          PyList_SET_ITEM(positionList, i, copyVVec3ToList(conformations[i]));
+          PyList_SET_ITEM(energyList, i, PyFloat_FromDouble(energies[i]));
+      }
+      return Py_BuildValue("(NN)", positionList, energyList);
+  }
+
+  %pythoncode %{
+    @staticmethod
+    def minimizeBatch(context, positions, tolerance=10*unit.kilojoules_per_mole/unit.nanometer, maxIterations=0):
+      """Minimize many conformations of the same System, such as different poses of a ligand.  Each conformation
+      is minimized independently, exactly as if its positions had been set on the Context and minimize() had
+      been called, and stops as soon as it has converged or reached maxIterations.  Platforms may process
+      several conformations at once.  The CPU platform, for example, minimizes a different conformation on
+      each of its threads.
+
+      Parameters
+      ----------
+      context : Context
+          a Context specifying the System to minimize.  On exit, it will have been updated with the minimized
+          positions of the last conformation.
+      positions : list
+          the initial particle positions of each conformation
+      tolerance : energy/distance
+          this specifies how precisely the energy minimum must be located.  Minimization of a conformation will
+          be halted once the root-mean-square value of all force components reaches this tolerance.
+      maxIterations : int
+          the maximum number of iterations to perform for each conformation.  If this is 0, minimation is
+          continued until the results converge without regard to how many iterations it takes.
+
+      Returns
+      -------
+      a tuple (positions, energies) containing the minimized positions and the potential energy of each conformation
+      """
+      if unit.is_quantity(tolerance):
+        tolerance = tolerance.value_in_unit(unit.kilojoules_per_mole/unit.nanometer)
+      positions, energies = LocalEnergyMinimizer._minimizeBatch(context, positions, tolerance, maxIterations)
+      return [p*unit.nanometers for p in positions], energies*unit.kilojoules_per_mole
+  %}
+}
+
 %extend OpenMM::Integrator {
   %pythoncode %{
     def setIntegrationForceGroups(self, groups):
@@ -423,6 +494,172 @@ Parameters:
   %}
 }
 
+%extend OpenMM::BinarySerializer {
+  static PyObject* _serializeSystem(const OpenMM::System* object) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      OpenMM::BinarySerializer::serialize<OpenMM::System>(object, "System", ss);
+      std::string data = ss.str();
+      return PyBytes_FromStringAndSize(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeSystem;
+  static OpenMM::System* _deserializeSystem(std::string data) {
+      return OpenMM::BinarySerializer::deserialize<OpenMM::System>(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeFileSystem;
+  static OpenMM::System* _deserializeFileSystem(const std::string& filename) {
+      return OpenMM::BinarySerializer::deserializeFile<OpenMM::System>(filename);
+  }
+
+  static PyObject* _serializeForce(const OpenMM::Force* object) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      OpenMM::BinarySerializer::serialize<OpenMM::Force>(object, "Force", ss);
+      std::string data = ss.str();
+      return PyBytes_FromStringAndSize(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeForce;
+  static OpenMM::Force* _deserializeForce(std::string data) {
+      return OpenMM::BinarySerializer::deserialize<OpenMM::Force>(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeFileForce;
+  static OpenMM::Force* _deserializeFileForce(const std::string& filename) {
+      return OpenMM::BinarySerializer::deserializeFile<OpenMM::Force>(filename);
+  }
+
+  static PyObject* _serializeIntegrator(const OpenMM::Integrator* object) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      OpenMM::BinarySerializer::serialize<OpenMM::Integrator>(object, "Integrator", ss);
+      std::string data = ss.str();
+      return PyBytes_FromStringAndSize(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeIntegrator;
+  static OpenMM::Integrator* _deserializeIntegrator(std::string data) {
+      return OpenMM::BinarySerializer::deserialize<OpenMM::Integrator>(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeFileIntegrator;
+  static OpenMM::Integrator* _deserializeFileIntegrator(const std::string& filename) {
+      return OpenMM::BinarySerializer::deserializeFile<OpenMM::Integrator>(filename);
+  }
+
+  static PyObject* _serializeState(const OpenMM::State* object) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      OpenMM::BinarySerializer::serialize<OpenMM::State>(object, "State", ss);
+      std::string data = ss.str();
+      return PyBytes_FromStringAndSize(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeState;
+  static OpenMM::State* _deserializeState(std::string data) {
+      return OpenMM::BinarySerializer::deserialize<OpenMM::State>(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeFileState;
+  static OpenMM::State* _deserializeFileState(const std::string& filename) {
+      return OpenMM::BinarySerializer::deserializeFile<OpenMM::State>(filename);
+  }
+
+  static PyObject* _serializeTabulatedFunction(const OpenMM::TabulatedFunction* object) {
+      std::stringstream ss(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      OpenMM::BinarySerializer::serialize<OpenMM::TabulatedFunction>(object, "TabulatedFunction", ss);
+      std::string data = ss.str();
+      return PyBytes_FromStringAndSize(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeTabulatedFunction;
+  static OpenMM::TabulatedFunction* _deserializeTabulatedFunction(std::string data) {
+      return OpenMM::BinarySerializer::deserialize<OpenMM::TabulatedFunction>(data.c_str(), data.size());
+  }
+
+  %newobject _deserializeFileTabulatedFunction;
+  static OpenMM::TabulatedFunction* _deserializeFileTabulatedFunction(const std::string& filename) {
+      return OpenMM::BinarySerializer::deserializeFile<OpenMM::TabulatedFunction>(filename);
+  }
+
+  %pythoncode %{
+    @staticmethod
+    def serialize(object):
+      """Serialize an object in binary format.  The return value is a bytes object."""
+      if isinstance(object, System):
+        return BinarySerializer._serializeSystem(object)
+      elif isinstance(object, Force):
+        return BinarySerializer._serializeForce(object)
+      elif isinstance(object, Integrator):
+        return BinarySerializer._serializeIntegrator(object)
+      elif isinstance(object, State):
+        return BinarySerializer._serializeState(object)
+      elif isinstance(object, TabulatedFunction):
+        return BinarySerializer._serializeTabulatedFunction(object)
+      raise ValueError("Unsupported object type")
+
+    @staticmethod
+    def _getRootName(stream):
+      """Read the name of the root node from a stream containing binary serialized data.  Only the header
+         is read, not the rest of the data."""
+      import struct
+      def read(format):
+        size = struct.calcsize(format)
+        data = stream.read(size)
+        if len(data) != size:
+          raise ValueError("Unexpected end of data")
+        return struct.unpack(format, data)[0]
+      if stream.read(8) != b'OpenMMB\0':
+        raise ValueError("The data is not in OpenMM binary serialization format")
+      read('=i')
+      read('=i')
+      strings = []
+      position = 20
+      for i in range(read('=I')):
+        length = read('=I')
+        strings.append(stream.read(length))
+        position += 4+length
+      stream.read((8-position%8)%8)
+      index = read('=I')
+      if index >= len(strings):
+        raise ValueError("Unexpected end of data")
+      return strings[index].decode('utf-8')
+
+    @staticmethod
+    def deserialize(data):
+      """Reconstruct an object that has been serialized in binary format.  The argument should be a bytes object."""
+      import io
+      type = BinarySerializer._getRootName(io.BytesIO(data))
+      if type == "System":
+        return BinarySerializer._deserializeSystem(data)
+      if type == "Force":
+        return BinarySerializer._deserializeForce(data)
+      if type == "Integrator":
+        return BinarySerializer._deserializeIntegrator(data)
+      if type == "State":
+        return BinarySerializer._deserializeState(data)
+      if type == "TabulatedFunction":
+        return BinarySerializer._deserializeTabulatedFunction(data)
+      raise ValueError("Unsupported object type")
+
+    @staticmethod
+    def deserializeFile(filename):
+      """Reconstruct an object that has been serialized in binary format, reading it from a file.  Where the
+         operating system supports it, the file is memory mapped rather than being read into a buffer."""
+      with open(filename, 'rb') as f:
+        type = BinarySerializer._getRootName(f)
+      if type == "System":
+        return BinarySerializer._deserializeFileSystem(filename)
+      if type == "Force":
+        return BinarySerializer._deserializeFileForce(filename)
+      if type == "Integrator":
+        return BinarySerializer._deserializeFileIntegrator(filename)
+      if type == "State":
+        return BinarySerializer._deserializeFileState(filename)
+      if type == "TabulatedFunction":
+        return BinarySerializer._deserializeFileTabulatedFunction(filename)
+      raise ValueError("Unsupported object type")
+  %}
+}
+
 %extend OpenMM::CustomIntegrator {
     PyObject* getPerDofVariable(int index) const {
         std::vector<Vec3> values;
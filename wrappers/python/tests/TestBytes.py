@@ -23,6 +23,39 @@ class TestBytes(unittest.TestCase):
 
         assert newPositions == refPositions
 
+    def test_binarySerializer(self):
+        system = mm.System()
+        system.addParticle(1.0)
+        system.addParticle(2.0)
+        force = mm.HarmonicBondForce()
+        force.addBond(0, 1, 0.1, 100.0)
+        system.addForce(force)
+
+        # serialize() should return bytes, and deserialize() should create an object of the right type
+
+        data = mm.BinarySerializer.serialize(system)
+        assert isinstance(data, bytes)
+        system2 = mm.BinarySerializer.deserialize(data)
+        assert isinstance(system2, mm.System)
+        assert system2.getNumParticles() == 2
+        assert system2.getParticleMass(1)._value == 2.0
+        force2 = mm.BinarySerializer.deserialize(mm.BinarySerializer.serialize(force))
+        assert isinstance(force2, mm.HarmonicBondForce)
+        assert force2.getNumBonds() == 1
+        integrator = mm.BinarySerializer.deserialize(mm.BinarySerializer.serialize(mm.LangevinMiddleIntegrator(300, 1, 0.002)))
+        assert isinstance(integrator, mm.LangevinMiddleIntegrator)
+
+        # Read it from a file.
+
+        import os, tempfile
+        with tempfile.TemporaryDirectory() as tempdir:
+            filename = os.path.join(tempdir, 'system.bin')
+            with open(filename, 'wb') as f:
+                f.write(data)
+            system3 = mm.BinarySerializer.deserializeFile(filename)
+            assert isinstance(system3, mm.System)
+            assert system3.getNumForces() == 1
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -224,6 +224,28 @@ class TestSimulation(unittest.TestCase):
         simulation.minimizeEnergy(reporter=reporter)
         assert not reporter.error
 
+    def testMinimizeBatch(self):
+        """Test minimizing several conformations in a single call."""
+        pdb = PDBFile('systems/alanine-dipeptide-implicit.pdb')
+        ff = ForceField('amber99sb.xml', 'tip3p.xml')
+        system = ff.createSystem(pdb.topology)
+        context = Context(system, VerletIntegrator(0.001*picoseconds), Platform.getPlatform('Reference'))
+        conformations = []
+        for i in range(3):
+            conformations.append([p+Vec3(0.01*i, 0, 0.02*i)*nanometers for p in pdb.positions])
+        positions, energies = LocalEnergyMinimizer.minimizeBatch(context, conformations, 1*kilojoules_per_mole/nanometer)
+        self.assertEqual(3, len(positions))
+        self.assertEqual(3, len(energies))
+
+        # Each conformation should have the same energy as minimizing it on its own.
+
+        for i in range(3):
+            self.assertEqual(len(pdb.positions), len(positions[i]))
+            context.setPositions(conformations[i])
+            LocalEnergyMinimizer.minimize(context, 1*kilojoules_per_mole/nanometer)
+            energy = context.getState(getEnergy=True).getPotentialEnergy()
+            self.assertAlmostEqual(energy.value_in_unit(kilojoules_per_mole), energies[i].value_in_unit(kilojoules_per_mole), delta=1e-3*abs(energy.value_in_unit(kilojoules_per_mole)))
+
 
 if __name__ == '__main__':
     unittest.main()